@@ -113,7 +113,7 @@ int main(void) {
         // Update counter display
         char counterText[64];
         snprintf(counterText, sizeof(counterText), "Current value: %d", state.counter);
-        ((RayDialLabelData*)counterDisplay->data)->text = counterText;
+        SetLabelText(counterDisplay, counterText);
         
         // Draw
         BeginDrawing();
@@ -418,17 +418,17 @@ int main(void) {
         // Update UI text based on game state
         char goldText[32];
         snprintf(goldText, sizeof(goldText), "Your gold: %d", gameState.playerGold);
-        ((RayDialLabelData*)goldLabel->data)->text = goldText;
+        SetLabelText(goldLabel, goldText);
         
         char healthText[32];
         snprintf(healthText, sizeof(healthText), "Health: %d", gameState.playerHealth);
-        ((RayDialLabelData*)healthLabel->data)->text = healthText;
+        SetLabelText(healthLabel, healthText);
         
         // Update dungeon stats text
         char dungeonStatsText[64];
         snprintf(dungeonStatsText, sizeof(dungeonStatsText), "Health: %d | Gold: %d", 
                  gameState.playerHealth, gameState.playerGold);
-        ((RayDialLabelData*)dungeonStatsLabel->data)->text = dungeonStatsText;
+        SetLabelText(dungeonStatsLabel, dungeonStatsText);
         
         // Update dungeon equipment text
         char dungeonEquipText[128];
@@ -439,7 +439,7 @@ int main(void) {
                 gameState.hasShield ? "Shield" : "",
                 (gameState.hasSword || gameState.hasShield) && (gameState.hasPotion || gameState.hasKey) ? ", " : "",
                 gameState.hasPotion ? "Potion" : "");
-        ((RayDialLabelData*)dungeonEquipLabel->data)->text = dungeonEquipText;
+        SetLabelText(dungeonEquipLabel, dungeonEquipText);
         
         // Update shop equipment text
         char shopEquipText[128];
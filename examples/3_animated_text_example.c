@@ -4,107 +4,63 @@
 #include <string.h>
 #include <stdlib.h>
 
-// Types of text animation
+// Typing speeds in characters per second
 typedef enum {
-    TEXT_SPEED_SLOW = 1,
-    TEXT_SPEED_NORMAL = 3,
-    TEXT_SPEED_FAST = 6
+    TEXT_SPEED_SLOW = 5,
+    TEXT_SPEED_NORMAL = 15,
+    TEXT_SPEED_FAST = 30
 } TextSpeed;
 
-// Animation state structure
+// Animation state shared with the button callbacks
 typedef struct {
-    const char* fullText;        // Complete text to display
-    char* displayText;           // Current displayed text (partial)
-    int textLength;              // Length of full text
-    int currentLength;           // Currently displayed length
+    RayDialComponent* label;     // Label revealing the text with its built-in typewriter
     TextSpeed speed;             // Animation speed
-    bool animationComplete;      // Flag for animation completion
-    int framesCounter;           // Frame counter for animation timing
+    int typedCount;              // Characters revealed so far
 } AnimatedText;
 
-// Function to initialize animated text
-AnimatedText InitAnimatedText(const char* text, TextSpeed speed) {
-    AnimatedText anim;
-    anim.fullText = text;
-    anim.textLength = strlen(text);
-    anim.displayText = (char*)malloc(anim.textLength + 1);
-    anim.displayText[0] = '\0';
-    anim.currentLength = 0;
-    anim.speed = speed;
-    anim.animationComplete = false;
-    anim.framesCounter = 0;
-    return anim;
-}
-
-// Function to update animated text
-void UpdateAnimatedText(AnimatedText* anim) {
-    if (anim->animationComplete) return;
-    
-    anim->framesCounter++;
+// Called by the label for every character it reveals
+void OnCharacterRevealed(int codepoint, void* userData) {
+    AnimatedText* anim = (AnimatedText*)userData;
+    anim->typedCount++;
     
-    // Update text based on speed
-    if (anim->framesCounter >= (60 / (anim->speed * 5))) {
-        anim->framesCounter = 0;
-        
-        if (anim->currentLength < anim->textLength) {
-            // Copy next character
-            anim->displayText[anim->currentLength] = anim->fullText[anim->currentLength];
-            anim->displayText[anim->currentLength + 1] = '\0';
-            anim->currentLength++;
-            
-            // Play a typing sound (simulated with console output)
-            if (anim->currentLength % 5 == 0) {
-                printf("*click*\n");
-            }
-        } else {
-            anim->animationComplete = true;
-        }
+    // Play a typing sound (simulated with console output)
+    if (codepoint != ' ' && anim->typedCount % 5 == 0) {
+        printf("*click*\n");
     }
 }
 
-// Function to get current display text
-const char* GetAnimatedText(AnimatedText* anim) {
-    return anim->displayText;
-}
-
-// Function to free animated text resources
-void FreeAnimatedText(AnimatedText* anim) {
-    free(anim->displayText);
-    anim->displayText = NULL;
+// Change the speed without restarting the reveal
+void SetAnimationSpeed(AnimatedText* anim, TextSpeed speed) {
+    anim->speed = speed;
+    ((RayDialLabelData*)anim->label->data)->typewriter.charactersPerSecond = (float)speed;
 }
 
 // Button callbacks
 void OnSetSpeedSlow(void* userData) {
-    AnimatedText* anim = (AnimatedText*)userData;
-    anim->speed = TEXT_SPEED_SLOW;
+    SetAnimationSpeed((AnimatedText*)userData, TEXT_SPEED_SLOW);
     printf("Text speed set to SLOW\n");
 }
 
 void OnSetSpeedNormal(void* userData) {
-    AnimatedText* anim = (AnimatedText*)userData;
-    anim->speed = TEXT_SPEED_NORMAL;
+    SetAnimationSpeed((AnimatedText*)userData, TEXT_SPEED_NORMAL);
     printf("Text speed set to NORMAL\n");
 }
 
 void OnSetSpeedFast(void* userData) {
-    AnimatedText* anim = (AnimatedText*)userData;
-    anim->speed = TEXT_SPEED_FAST;
+    SetAnimationSpeed((AnimatedText*)userData, TEXT_SPEED_FAST);
     printf("Text speed set to FAST\n");
 }
 
 void OnResetAnimation(void* userData) {
     AnimatedText* anim = (AnimatedText*)userData;
-    anim->currentLength = 0;
-    anim->displayText[0] = '\0';
-    anim->animationComplete = false;
+    anim->typedCount = 0;
+    StartTypewriter(anim->label, (float)anim->speed);
     printf("Animation reset\n");
 }
 
 void OnCompleteAnimation(void* userData) {
     AnimatedText* anim = (AnimatedText*)userData;
-    strcpy(anim->displayText, anim->fullText);
-    anim->currentLength = anim->textLength;
-    anim->animationComplete = true;
+    SkipTypewriter(anim->label);
     printf("Animation completed\n");
 }
 
@@ -156,7 +112,7 @@ int main(void) {
         "of darkness...\n\n"
         "TO BE CONTINUED...";
                                
-    AnimatedText animText = InitAnimatedText(dialogueText, TEXT_SPEED_NORMAL);
+    AnimatedText animText = { NULL, TEXT_SPEED_NORMAL, 0 };
 
     // Create dialogue node
     RayDialNode* rootNode = CreateDialogueNode("root", "Animated Text Example");
@@ -177,12 +133,16 @@ int main(void) {
         true
     );
     
-    // Create animated text label - this will now be scrollable
+    // Create animated text label - this will now be scrollable. The text is laid
+    // out once and revealed by the label's typewriter, one character at a time.
     RayDialComponent* textLabel = CreateLabel(
         (Rectangle){ 120, 170, 560, 220 },
-        "",  // Initially empty, will be updated with animated text
+        dialogueText,
         true
     );
+    animText.label = textLabel;
+    StartTypewriter(textLabel, (float)animText.speed);
+    SetTypewriterCallback(textLabel, OnCharacterRevealed, &animText);
     
     // Create speed control buttons
     RayDialComponent* slowButton = CreateButton(
@@ -235,13 +195,7 @@ int main(void) {
 
     // Main game loop
     while (!WindowShouldClose()) {
-        // Update animated text
-        UpdateAnimatedText(&animText);
-        
-        // Update the text label with current animation state
-        ((RayDialLabelData*)textLabel->data)->text = GetAnimatedText(&animText);
-        
-        // Update
+        // Update (the label advances its typewriter by the frame time)
         UpdateDialogueManager(manager);
         
         // Draw
@@ -254,7 +208,7 @@ int main(void) {
             DrawText("Use mouse wheel or arrow keys to scroll text", 10, screenHeight - 60, 20, DARKGRAY);
             
             // Draw animation status
-            const char* status = animText.animationComplete ? "Animation complete" : "Animating...";
+            const char* status = IsTypewriterFinished(textLabel) ? "Animation complete" : "Animating...";
             DrawText(status, 10, 10, 20, DARKGRAY);
             
             // Draw current speed
@@ -271,7 +225,6 @@ int main(void) {
     }
     
     // Cleanup
-    FreeAnimatedText(&animText);
     FreeDialogueManager(manager);
     CloseWindow();
     return 0;
@@ -204,8 +204,8 @@ int main(void) {
             gallery.imageTitles[gallery.currentImageIndex],
             gallery.currentImageIndex + 1, 
             gallery.imageCount);
-        ((RayDialLabelData*)imageTitle->data)->text = titleBuffer;
-        ((RayDialLabelData*)imageDescription->data)->text = gallery.imageDescriptions[gallery.currentImageIndex];
+        SetLabelText(imageTitle, titleBuffer);
+        SetLabelText(imageDescription, gallery.imageDescriptions[gallery.currentImageIndex]);
         
         // Draw
         BeginDrawing();
@@ -29,7 +29,7 @@ void UpdateDialogue(DialogueState* state) {
         state->currentIndex = (state->currentIndex + 1) % state->dialogueCount;
         
         // Update the label text
-        ((RayDialLabelData*)state->dialogueLabel->data)->text = state->dialogues[state->currentIndex];
+        SetLabelText(state->dialogueLabel, state->dialogues[state->currentIndex]);
     }
 }
 
@@ -0,0 +1,26 @@
+#include <stdio.h>
+#include "raylib.h"
+#include "raydial_graph.h"
+
+// Offline dialogue graph compiler:
+//   compile_dialogue_graph <source.dlg> <output.rdg>
+// Prints each finding as file:line and exits non-zero when there are errors.
+
+static void PrintFinding(bool isError, int line, const char* message, void* userData) {
+    const char* path = (const char*)userData;
+    fprintf(stderr, "%s:%d: %s: %s\n", path, line, isError ? "error" : "warning", message);
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s <source> <output>\n", argv[0]);
+        return 2;
+    }
+    
+    SetTraceLogLevel(LOG_WARNING);
+    if (!CompileDialogueGraphFile(argv[1], argv[2], PrintFinding, argv[1])) {
+        fprintf(stderr, "%s: not compiled\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
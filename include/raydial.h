@@ -11,6 +11,31 @@ extern "C" {
 // Callback function type for UI interactions
 typedef void (*RayDialCallback)(void* userData);
 
+// Called once for each character a typewriter reveals (e.g. to play a blip sound)
+typedef void (*RayDialRevealCallback)(int codepoint, void* userData);
+
+// Forward declaration of localization manager
+typedef struct RayDialI18N RayDialI18N;
+typedef struct RayDialStyledText RayDialStyledText;
+typedef struct RayDialFormatArg RayDialFormatArg;
+typedef struct RayDialTextboxState RayDialTextboxState;
+typedef struct RayDialTextLayout RayDialTextLayout;
+typedef struct RayDialStyledLayout RayDialStyledLayout;
+typedef struct RayDialTextureCache RayDialTextureCache;
+typedef struct RayDialTextureHandle RayDialTextureHandle;
+typedef struct RayDialVariables RayDialVariables;
+typedef struct RayDialCondition RayDialCondition;
+typedef struct RayDialVariableText RayDialVariableText;
+typedef struct RayDialScript RayDialScript;
+typedef struct RayDialScriptHost RayDialScriptHost;
+typedef struct RayDialGraph RayDialGraph;
+typedef struct RayDialChapterSet RayDialChapterSet;
+typedef struct RayDialHistory RayDialHistory;
+typedef struct RayDialNode RayDialNode;
+
+// Called with every node a dialogue manager enters, before the node's onEnter
+typedef void (*RayDialTransitionCallback)(RayDialNode* node, void* userData);
+
 // UI Component types
 typedef enum {
     RAYDIAL_BUTTON,
@@ -19,7 +44,8 @@ typedef enum {
     RAYDIAL_IMAGE,
     RAYDIAL_PANEL,
     RAYDIAL_SCROLLAREA,
-    RAYDIAL_PORTRAIT_DIALOGUE  // New component for portrait dialogue
+    RAYDIAL_PORTRAIT_DIALOGUE, // New component for portrait dialogue
+    RAYDIAL_HISTORY_VIEW       // Backlog of lines drawn from a RayDialHistory
 } RayDialComponentType;
 
 // Text style types for rich text rendering
@@ -48,6 +74,61 @@ typedef struct RayDialTextSegment {
     struct RayDialTextSegment* next; // Next segment in the text
 } RayDialTextSegment;
 
+// Typewriter reveal state for labels and portrait dialogues. Progress is counted
+// in characters of the full text and advanced by frame time, not frame count.
+typedef struct {
+    bool enabled;                     // Reveal gradually (false shows the whole text)
+    float charactersPerSecond;
+    float progress;                   // Characters revealed so far, including the fraction
+    int revealedGlyphs;               // Characters currently shown
+    int totalGlyphs;                  // Characters in the text being revealed
+    const char* source;               // Text the reveal cursor walks (borrowed)
+    int sourceOffset;                 // Byte offset of the next character to reveal
+    RayDialRevealCallback onReveal;   // Called for every revealed character (optional)
+    void* revealUserData;
+} RayDialTypewriter;
+
+// Sub-rectangle of a shared texture page (see the portrait atlas in raydial_textures.h)
+typedef struct {
+    Texture2D texture;                // Atlas page
+    Rectangle source;                 // Pixels of the image inside the page
+} RayDialAtlasRegion;
+
+// When a flipbook portrait advances
+typedef enum {
+    RAYDIAL_FLIPBOOK_LOOP,            // Always, wrapping around
+    RAYDIAL_FLIPBOOK_ONCE,            // Until the last frame, which then stays
+    RAYDIAL_FLIPBOOK_WHILE_TYPING     // While a typewriter is revealing text; frame 0 otherwise
+} RayDialFlipbookMode;
+
+// Frame sequence drawn in place of a static portrait (e.g. a talking mouth)
+typedef struct {
+    RayDialAtlasRegion* frames;       // Owned copy of the frames
+    int frameCount;                   // 0 when no flipbook is set
+    float framesPerSecond;
+    RayDialFlipbookMode mode;
+    float time;                       // Seconds into the sequence
+    int currentFrame;
+} RayDialFlipbook;
+
+// Nine-slice frame: the corners of the region keep their size, the edges stretch
+// along one axis and the center along both
+typedef struct {
+    RayDialAtlasRegion region;        // Frame image (any texture, ideally an atlas page)
+    float left, top, right, bottom;   // Border widths in source pixels
+    Color tint;
+} RayDialNineSlice;
+
+// Nine-slice frame held by a component, with its grid cached for the last bounds drawn
+typedef struct {
+    RayDialNineSlice slice;
+    bool enabled;                     // Draw the frame instead of flat rectangles
+    bool dirty;                       // Slice changed since the grid was built
+    Rectangle bounds;                 // Bounds the grid was built for
+    float x[4], y[4];                 // Grid lines on screen
+    float u[4], v[4];                 // Grid lines in texture coordinates
+} RayDialFrame;
+
 // Base UI component structure
 typedef struct RayDialComponent {
     RayDialComponentType type;
@@ -67,6 +148,10 @@ typedef struct {
     Color backgroundColor;
     Color hoverColor;
     int fontSize;
+    // Localization binding (set by the localized constructors/setters)
+    const char* textKey;              // Translation key the text was resolved from (borrowed)
+    RayDialI18N* i18n;                // Manager to re-resolve against when translations change
+    unsigned int i18nGeneration;      // Manager generation the text was resolved at
 } RayDialButtonData;
 
 // Label specific data
@@ -81,16 +166,34 @@ typedef struct {
     bool scrollable;
     Color scrollbarColor;
     int scrollbarWidth;
+    // Localization binding (set by the localized constructors/setters)
+    const char* textKey;              // Translation key the text was resolved from (borrowed)
+    RayDialI18N* i18n;                // Manager to re-resolve against when translations change
+    unsigned int i18nGeneration;      // Manager generation the text was resolved at
+    char* formatBuffer;               // Owned output of SetLocalizedLabelFormat, reused across calls
+    int formatBufferSize;
+    // Variable binding (set by BindLabelToVariables)
+    RayDialVariables* variables;      // Store the template reads (borrowed)
+    RayDialVariableText* variableText;// Owned compiled template
+    unsigned int variableVersion;     // Store version the text was formatted at
+    struct RayDialTextLayout* layout; // Cached line index for wrapped text (internal)
+    RayDialTypewriter typewriter;
 } RayDialLabelData;
 
 // Textbox specific data
 typedef struct {
-    char* text;
-    int maxLength;
+    char* text;                       // Current contents, refreshed after every edit (read-only)
+    int maxLength;                    // Maximum number of characters (0 for no limit)
     Color textColor;
     Color backgroundColor;
     int fontSize;
-    bool isPassword;
+    bool isPassword;                  // Draw every character as '*'
+    bool hasFocus;                    // Receives keyboard input
+    Color borderColor;
+    Color focusColor;                 // Border color while focused
+    Color selectionColor;
+    float scrollOffset;               // Horizontal scroll keeping the caret visible
+    struct RayDialTextboxState* state;  // Gap buffer and glyph layout cache (internal)
 } RayDialTextboxData;
 
 // Panel specific data
@@ -99,14 +202,26 @@ typedef struct {
     Color borderColor;
     int borderWidth;
     int padding;
+    RayDialFrame frame;               // Textured frame replacing background and border
 } RayDialPanelData;
 
 // Scroll area specific data
 typedef struct {
     float scrollPosition;
-    float contentHeight;
+    float contentHeight;              // Sum of row heights once rows are added
     Color scrollbarColor;
     int scrollbarWidth;
+    Color backgroundColor;            // BLANK draws no background
+    float rowSpacing;                 // Vertical gap between rows
+    float scrollTarget;               // Position the view is easing towards
+    // Virtualized rows (managed by AddScrollAreaRow)
+    struct RayDialComponent** rows;
+    float* rowOffsets;                // Prefix sums of row heights: top of each row
+    int rowCount;
+    int rowCapacity;
+    int firstDirtyRow;                // First row whose offset needs recomputing
+    int firstVisibleRow;
+    int visibleRowCount;
 } RayDialScrollAreaData;
 
 // Portrait dialogue specific data
@@ -114,10 +229,17 @@ typedef struct {
     const char* speakerName;          // Name of the character speaking
     const char* dialogueText;         // The dialogue text (plain text version)
     RayDialTextSegment* styledText;   // Styled segments of text (if using rich text)
+    RayDialStyledText* sharedStyledText;  // Cached localized text backing styledText (read-only)
     bool useStyledText;               // Whether to use rich text rendering
     Color portraitColor;              // Color to use for portrait (if no texture)
     Texture2D portraitTexture;        // Portrait texture (optional, uses color if no texture)
     bool useTexture;                  // Whether to use texture or color
+    RayDialTextureHandle* textureHandle;  // Cached texture replacing portraitTexture (color shows until it loads)
+    RayDialAtlasRegion atlasRegion;   // Atlas image replacing portraitTexture (when useAtlasRegion is set)
+    bool useAtlasRegion;
+    RayDialFlipbook flipbook;         // Animated frames, drawn instead of the images above while set
+    RayDialFrame boxFrame;            // Textured frames replacing the flat dialogue box and name tag
+    RayDialFrame nameTagFrame;
     Color nameTagColor;               // Background color for name tag
     Color dialogueBoxColor;           // Background color for dialogue box
     Color textColor;                  // Default color for dialogue text
@@ -127,8 +249,37 @@ typedef struct {
     bool wrapText;                    // Whether to wrap dialogue text
     int portraitSize;                 // Size of the portrait (square)
     bool showOnRight;                 // Whether to show portrait on right (default: left)
+    // Localization binding (set by the localized constructors/setters)
+    const char* speakerNameKey;       // Translation key for the speaker name (borrowed)
+    const char* dialogueTextKey;      // Translation key for the dialogue text (borrowed)
+    bool dialogueKeyStyled;           // Whether the dialogue key is rendered as styled text
+    RayDialI18N* i18n;                // Manager to re-resolve against when translations change
+    unsigned int i18nGeneration;      // Manager generation the texts were resolved at
+    struct RayDialTextLayout* layout; // Cached line index for plain dialogue text (internal)
+    struct RayDialStyledLayout* styledLayout;  // Cached word placement for styled text (internal)
+    int styledWordsDrawn;             // Styled words drawn by the last draw, cut-off ones included
+    RayDialTypewriter typewriter;
 } RayDialPortraitDialogueData;
 
+// History view specific data. Positions are measured from the top of the oldest
+// line the history still holds; lines are read from the history as they are drawn.
+typedef struct {
+    RayDialHistory* history;          // Lines to show (borrowed)
+    RayDialI18N* i18n;                // Resolves lines recorded as translation keys (optional)
+    int fontSize;
+    Color textColor;
+    Color speakerColor;
+    Color backgroundColor;            // BLANK draws no background
+    Color scrollbarColor;
+    int scrollbarWidth;
+    float scrollPosition;
+    float scrollTarget;               // Position the view is easing towards
+    bool followEnd;                   // Scrolled to the newest line; stays there as lines arrive
+    long long originLine;             // firstLine of the oldest line at the last update (internal)
+    int firstVisibleEntry;            // Entries in view as of the last update or draw
+    int visibleEntryCount;
+} RayDialHistoryViewData;
+
 // Dialogue node structure for dialogue trees
 typedef struct RayDialNode {
     const char* id;
@@ -139,6 +290,12 @@ typedef struct RayDialNode {
     RayDialCallback onEnter;
     RayDialCallback onExit;
     void* userData;
+    RayDialCondition** choiceConditions;   // Condition per choice (NULL = always shown); NULL until one is added
+    struct RayDialNode** visibleChoices;   // Cached choices whose conditions held (internal)
+    int visibleChoiceCount;
+    unsigned int visibleVersion;           // Variable store version the cache was checked at
+    const RayDialVariables* visibleVariables;
+    RayDialScript* script;                 // Owned; run by TransitionToNode after onEnter
 } RayDialNode;
 
 // Dialogue manager structure
@@ -147,11 +304,14 @@ typedef struct {
     RayDialNode* rootNode;
     bool isActive;
     void* userData;
+    RayDialGraph* graph;       // Set by CreateDialogueManagerFromGraph; ids resolve through its index
+    RayDialChapterSet* chapters;   // Set by CreateDialogueManagerFromChapters; graph follows the current chapter
+    RayDialHistory* history;   // Set by SetDialogueHistory; records lines and visited nodes
+    struct RayDialDeferredEvents* deferred;   // Callbacks queued by RunDialogueManagerUpdate (internal)
+    RayDialTransitionCallback onTransition;   // Set by SetDialogueTransitionCallback
+    void* transitionUserData;
 } RayDialManager;
 
-// Forward declaration of localization manager
-typedef struct RayDialI18N RayDialI18N;
-
 // Function declarations for UI components
 RayDialComponent* CreateButton(Rectangle bounds, const char* text, RayDialCallback onClick, void* userData);
 RayDialComponent* CreateLabel(Rectangle bounds, const char* text, bool wrapText);
@@ -160,6 +320,8 @@ RayDialComponent* CreatePanel(Rectangle bounds, Color backgroundColor);
 RayDialComponent* CreateScrollArea(Rectangle bounds, float contentHeight);
 RayDialComponent* CreatePortraitDialogue(Rectangle bounds, const char* speakerName, const char* dialogueText, Color portraitColor);
 RayDialComponent* CreatePortraitDialogueWithTexture(Rectangle bounds, const char* speakerName, const char* dialogueText, Texture2D portraitTexture);
+RayDialComponent* CreatePortraitDialogueWithTexturePath(Rectangle bounds, const char* speakerName, const char* dialogueText,
+                                                        RayDialTextureCache* cache, const char* path, Color placeholderColor);
 
 // Function declarations for component management
 void AddComponent(RayDialComponent* parent, RayDialComponent* child);
@@ -172,13 +334,28 @@ void FreeComponent(RayDialComponent* component);
 RayDialNode* CreateDialogueNode(const char* id, const char* text);
 void AddChoice(RayDialNode* node, RayDialNode* choice);
 void SetNodeCallbacks(RayDialNode* node, RayDialCallback onEnter, RayDialCallback onExit, void* userData);
+bool AddConditionalChoice(RayDialNode* node, RayDialNode* choice, RayDialVariables* variables, const char* condition);
+RayDialNode** GetVisibleChoices(RayDialNode* node, const RayDialVariables* variables, int* count);
+bool SetNodeScript(RayDialNode* node, RayDialScriptHost* host, const char* source);
+void FreeDialogueNode(RayDialNode* node);
 
 // Function declarations for dialogue manager
 RayDialManager* CreateDialogueManager(RayDialNode* rootNode);
 void UpdateDialogueManager(RayDialManager* manager);
+void BeginDialogueManagerUpdate(RayDialManager* manager);
+void RunDialogueManagerUpdate(RayDialManager* manager);
+void EndDialogueManagerUpdate(RayDialManager* manager);
 void DrawDialogueManager(RayDialManager* manager);
 void FreeDialogueManager(RayDialManager* manager);
 void TransitionToNode(RayDialManager* manager, const char* nodeId);
+RayDialManager* CreateDialogueManagerFromGraph(RayDialGraph* graph);
+RayDialManager* CreateDialogueManagerFromChapters(RayDialChapterSet* chapters, const char* id);
+void TransitionToNodeIndex(RayDialManager* manager, int index);
+int GetManagerNodeIndex(const RayDialManager* manager, const RayDialNode* node);
+RayDialNode* GetManagerNode(RayDialManager* manager, int index);
+void SetDialogueHistory(RayDialManager* manager, RayDialHistory* history);
+void SetDialogueTransitionCallback(RayDialManager* manager, RayDialTransitionCallback onTransition, void* userData);
+bool HasVisitedNode(const RayDialManager* manager, const RayDialNode* node);
 
 // Utility functions
 bool IsComponentClicked(RayDialComponent* component);
@@ -191,10 +368,56 @@ void SetPortraitDialogueText(RayDialComponent* component, const char* dialogueTe
 void SetPortraitDialogueSpeaker(RayDialComponent* component, const char* speakerName);
 void SetPortraitDialogueColor(RayDialComponent* component, Color portraitColor);
 void SetPortraitDialogueTexture(RayDialComponent* component, Texture2D portraitTexture);
+void SetPortraitDialogueTexturePath(RayDialComponent* component, RayDialTextureCache* cache, const char* path);
+void SetPortraitDialogueAtlasRegion(RayDialComponent* component, RayDialAtlasRegion region);
+bool SetPortraitDialogueFlipbook(RayDialComponent* component, const RayDialAtlasRegion* frames, int frameCount,
+                                 float framesPerSecond, RayDialFlipbookMode mode);
+void ClearPortraitDialogueFlipbook(RayDialComponent* component);
+
+// Nine-slice frames (a slice whose texture id is 0 switches back to flat colors)
+void SetPanelNineSlice(RayDialComponent* component, RayDialNineSlice slice);
+void SetPortraitDialogueBoxNineSlice(RayDialComponent* component, RayDialNineSlice slice);
+void SetPortraitDialogueNameTagNineSlice(RayDialComponent* component, RayDialNineSlice slice);
 void SetPortraitDialoguePosition(RayDialComponent* component, bool showOnRight);
 
 // Rich text utility functions
 void SetPortraitDialogueStyledText(RayDialComponent* component, const char* formattedText);
+
+// Label text and wrapped layout. The text is borrowed and its layout cached by pointer:
+// after rewriting the buffer in place, call SetLabelText again or MarkLabelTextChanged.
+void SetLabelText(RayDialComponent* component, const char* text);
+void MarkLabelTextChanged(RayDialComponent* component);
+bool BindLabelToVariables(RayDialComponent* component, RayDialVariables* variables, const char* format);
+float GetLabelContentHeight(RayDialComponent* component);
+int GetLabelVisibleLines(RayDialComponent* component, int* firstLine);
+
+// Typewriter reveal (labels and portrait dialogues)
+void StartTypewriter(RayDialComponent* component, float charactersPerSecond);
+void SetTypewriterCallback(RayDialComponent* component, RayDialRevealCallback onReveal, void* userData);
+void SkipTypewriter(RayDialComponent* component);
+bool IsTypewriterFinished(RayDialComponent* component);
+
+// Scroll area rows
+void AddScrollAreaRow(RayDialComponent* scrollArea, RayDialComponent* row);
+void SetScrollAreaRowHeight(RayDialComponent* scrollArea, int index, float height);
+void ScrollToScrollAreaRow(RayDialComponent* scrollArea, int index, bool smooth);
+int GetScrollAreaVisibleRows(RayDialComponent* scrollArea, int* firstRow);
+
+// Conversation backlog (see raydial_history.h)
+RayDialComponent* CreateHistoryView(Rectangle bounds, RayDialHistory* history, int fontSize);
+void SetHistoryViewI18N(RayDialComponent* historyView, RayDialI18N* i18n);
+void ScrollHistoryViewToEnd(RayDialComponent* historyView, bool smooth);
+int GetHistoryViewVisibleEntries(RayDialComponent* historyView, int* firstEntry);
+
+// Textbox editing
+const char* GetTextboxText(RayDialComponent* component);
+void SetTextboxText(RayDialComponent* component, const char* text);
+void InsertTextboxText(RayDialComponent* component, const char* text);
+void DeleteTextboxText(RayDialComponent* component, bool forward);
+void SetTextboxCursor(RayDialComponent* component, int characterIndex, bool extendSelection);
+int GetTextboxCursor(RayDialComponent* component);
+int GetTextboxIndexAt(RayDialComponent* component, float x);
+void SetTextboxFocus(RayDialComponent* component, bool focused);
 RayDialTextSegment* ParseStyledText(const char* formattedText, Color defaultColor, float defaultFontSize);
 void FreeStyledText(RayDialTextSegment* styledText);
 Color GetColorFromName(const char* colorName);
@@ -205,6 +428,7 @@ RayDialComponent* CreateLocalizedLabel(Rectangle bounds, const char* textKey, bo
 RayDialComponent* CreateLocalizedPortraitDialogue(Rectangle bounds, const char* speakerNameKey, const char* dialogueTextKey, Color portraitColor, RayDialI18N* i18n);
 void SetLocalizedButtonText(RayDialComponent* component, const char* textKey, RayDialI18N* i18n);
 void SetLocalizedLabelText(RayDialComponent* component, const char* textKey, RayDialI18N* i18n);
+void SetLocalizedLabelFormat(RayDialComponent* component, const char* textKey, RayDialI18N* i18n, const RayDialFormatArg* args, int argCount);
 void SetLocalizedPortraitDialogueText(RayDialComponent* component, const char* dialogueTextKey, RayDialI18N* i18n);
 void SetLocalizedPortraitDialogueSpeaker(RayDialComponent* component, const char* speakerNameKey, RayDialI18N* i18n);
 void SetLocalizedPortraitDialogueStyledText(RayDialComponent* component, const char* formattedTextKey, RayDialI18N* i18n);
@@ -0,0 +1,75 @@
+#ifndef RAYDIAL_CONTEXT_H
+#define RAYDIAL_CONTEXT_H
+
+#include <stdbool.h>
+#include "raydial.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Several conversations at once (the main dialogue, party banter, NPC barks) run as
+// managers in one context. The context updates and draws them in a single pass each,
+// in priority order, and pumps the shared translation and texture caches once per
+// frame instead of once per conversation.
+typedef struct RayDialContext RayDialContext;
+
+// How a manager fared in the last update pass
+typedef struct {
+    int priority;
+    double budgetSeconds;
+    bool updated;               // Ran in the last pass
+    int deferredFrames;         // Passes in a row it was left out of for lack of budget
+    double lastUpdateSeconds;   // Time its last update took
+} RayDialManagerStats;
+
+// The caches are borrowed and may be NULL. Components of the context's managers should
+// be created against the same i18n and texture cache.
+RayDialContext* CreateDialogueContext(RayDialI18N* i18n, RayDialTextureCache* textures);
+
+// Frees the managers the context owns, but neither their nodes nor the caches
+void FreeDialogueContext(RayDialContext* context);
+
+RayDialI18N* GetDialogueContextI18N(const RayDialContext* context);
+RayDialTextureCache* GetDialogueContextTextures(const RayDialContext* context);
+
+// Hand a manager to the context, which frees it with itself. Higher priorities update
+// first and draw on top. budgetSeconds is the share of the frame budget the manager is
+// charged each update (or its previous update time, if longer); 0 means it is never deferred.
+bool AddDialogueManager(RayDialContext* context, RayDialManager* manager, int priority, double budgetSeconds);
+
+// Take a manager back from the context without freeing it
+void RemoveDialogueManager(RayDialContext* context, RayDialManager* manager);
+
+void SetDialogueManagerPriority(RayDialContext* context, RayDialManager* manager, int priority);
+void SetDialogueManagerBudget(RayDialContext* context, RayDialManager* manager, double budgetSeconds);
+
+// Update time per frame shared by the managers (0, the default, for no limit), and
+// the time UpdateTextureCache may spend uploading each frame
+void SetDialogueContextBudget(RayDialContext* context, double frameSeconds, double textureSeconds);
+
+// Update managers on threadCount worker threads (0 to update on the main thread).
+// Each manager's update is split: chapter loading and translation refresh on the main
+// thread, the component update on a worker, then its callbacks replayed on the main
+// thread in order. Managers sharing nodes must not be in a parallel context together.
+bool SetDialogueContextWorkers(RayDialContext* context, int threadCount);
+
+// Managers in update order of their priorities, highest first
+int GetDialogueContextManagerCount(const RayDialContext* context);
+RayDialManager* GetDialogueContextManager(const RayDialContext* context, int index);
+bool GetDialogueManagerStats(const RayDialContext* context, const RayDialManager* manager, RayDialManagerStats* stats);
+
+// Pump the caches, then update managers from the highest priority down while their
+// budgets fit in what is left of the frame budget. The first manager of a pass always
+// runs. A deferred manager is treated as one priority higher for every frame it has
+// waited, so low priorities still update when the frame is busy.
+void UpdateDialogueContext(RayDialContext* context);
+
+// Draw every manager, lowest priority first so higher priorities end up on top
+void DrawDialogueContext(RayDialContext* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RAYDIAL_CONTEXT_H
@@ -0,0 +1,95 @@
+#ifndef RAYDIAL_GRAPH_H
+#define RAYDIAL_GRAPH_H
+
+#include <stdbool.h>
+#include "raydial.h"
+#include "raydial_vars.h"
+#include "raydial_script.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Compiled dialogue graphs. Authors write a text script; the offline compiler
+// checks it, drops nodes nothing can reach and writes a flat binary in which every
+// node reference is an index. Loading the binary builds ready-linked nodes.
+//
+// Source format, one directive per line ('#' at the start of a line is a comment):
+//   node <id> [entry]          Start a node. The first node and those marked entry
+//                              are where conversations begin.
+//   text: <line>               Dialogue text; repeated lines are joined by newlines
+//   choice: <id> [if <cond>]   Choice leading to a node, shown while cond holds
+//   script: <line>             Node script line (see raydial_script.h)
+// A choice or script goto target written "chapter/node" leads into another chapter's
+// graph and is resolved at runtime. Nodes other chapters lead to must be marked entry.
+typedef struct RayDialGraph RayDialGraph;
+
+// Receives compiler findings. Errors stop the binary from being written; warnings
+// (unreachable nodes, cycles without an exit) do not.
+typedef void (*RayDialGraphReport)(bool isError, int line, const char* message, void* userData);
+
+// Compile a source text into a malloc'd binary. A NULL report logs through TraceLog.
+// Returns false, with *data NULL, when the source has errors.
+bool CompileDialogueGraph(const char* source, unsigned char** data, int* size, RayDialGraphReport report, void* userData);
+
+// Same, from one file to another
+bool CompileDialogueGraphFile(const char* sourcePath, const char* outputPath, RayDialGraphReport report, void* userData);
+
+// Build the nodes of a compiled graph. Choice conditions compile against variables
+// and scripts against host; either may be NULL if the graph uses none. The data
+// is copied, so it can be freed afterwards.
+RayDialGraph* LoadDialogueGraph(const unsigned char* data, int size, RayDialVariables* variables, RayDialScriptHost* host);
+RayDialGraph* LoadDialogueGraphFile(const char* path, RayDialVariables* variables, RayDialScriptHost* host);
+
+// Frees the graph's nodes too. They belong to the graph: don't add choices to them
+// or pass them to FreeDialogueNode.
+void FreeDialogueGraph(RayDialGraph* graph);
+
+int GetGraphNodeCount(const RayDialGraph* graph);
+RayDialNode* GetGraphNode(const RayDialGraph* graph, int index);
+
+// Index of a node by id through a hash index, or -1
+int FindGraphNodeIndex(const RayDialGraph* graph, const char* id);
+
+// Chapter streaming: a story split into compiled graphs, one per chapter, of which
+// only the current chapter and the chapters it links to stay in memory. Chapters it
+// links to load on a worker thread as soon as it becomes current; the rest are freed.
+typedef struct RayDialChapterSet RayDialChapterSet;
+
+// Chapters compile their conditions against variables and their scripts against host
+RayDialChapterSet* CreateChapterSet(RayDialVariables* variables, RayDialScriptHost* host);
+void FreeChapterSet(RayDialChapterSet* chapters);
+
+// Register a compiled graph file under a name (no '/'). Nothing is loaded yet.
+bool AddChapter(RayDialChapterSet* chapters, const char* name, const char* path);
+
+// Node for "chapter/node", or the first node of "chapter", which becomes the current
+// chapter. Loads it first if needed, waiting for a prefetch still in flight.
+RayDialNode* EnterChapterNode(RayDialChapterSet* chapters, const char* id);
+
+// Node by index in the named chapter, loading the chapter if needed but not making it
+// current; unless entered, the chapter is freed again by the next UpdateChapterSet.
+// Returns NULL, with nothing left loaded for it, if either doesn't exist.
+RayDialNode* GetChapterNode(RayDialChapterSet* chapters, const char* name, int index);
+
+// For a choice leading into another chapter, enter that chapter and return the node;
+// other nodes are returned as they are, their chapter made current
+RayDialNode* FollowChapterLink(RayDialChapterSet* chapters, RayDialNode* node);
+
+// Finish prefetched chapters and free those no longer wanted. Call once per frame on
+// the thread that owns the variable store (UpdateDialogueManager does).
+void UpdateChapterSet(RayDialChapterSet* chapters);
+
+// Block until every queued prefetch has been read (it still finishes in UpdateChapterSet)
+void WaitChapterSet(RayDialChapterSet* chapters);
+
+RayDialGraph* GetCurrentChapterGraph(const RayDialChapterSet* chapters);
+const char* GetCurrentChapterName(const RayDialChapterSet* chapters);
+int GetCurrentChapterIndex(const RayDialChapterSet* chapters);   // In AddChapter order, -1 before any
+bool IsChapterResident(const RayDialChapterSet* chapters, const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RAYDIAL_GRAPH_H
@@ -0,0 +1,54 @@
+#ifndef RAYDIAL_HISTORY_H
+#define RAYDIAL_HISTORY_H
+
+#include <stdbool.h>
+#include "raydial.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Conversation history: the lines a player has been shown, for a backlog screen,
+// and which nodes they have visited, for "seen this already" flags. Lines live in a
+// fixed-capacity ring; once it is full, recording drops the oldest lines.
+typedef struct RayDialHistory RayDialHistory;
+
+typedef struct {
+    int chapter;                // Chapter index in its set, -1 outside chapters
+    int nodeIndex;              // GetManagerNodeIndex of the node, -1 for lines outside nodes
+    const char* text;           // Line, or its translation key; owned by the history
+    const char* speaker;        // Speaker name or key, NULL when nobody speaks
+    bool textIsKey;
+    bool speakerIsKey;
+    int lineCount;              // Rows of text in a history view, the speaker row not included
+    long long firstLine;        // Rows recorded before this line, speaker rows included
+} RayDialHistoryEntry;
+
+// entryCapacity lines sharing textCapacity bytes of text; both are allocated once
+RayDialHistory* CreateDialogueHistory(int entryCapacity, int textCapacity);
+void FreeDialogueHistory(RayDialHistory* history);
+
+// Forget the lines and the visited nodes
+void ClearDialogueHistory(RayDialHistory* history);
+
+// Copy a line in. firstLine is ignored, and a lineCount of 0 or less is counted from
+// the line breaks in text. Text that can't fit the whole text capacity is cut.
+// Managers with a history (SetDialogueHistory) record their lines themselves.
+bool RecordDialogueEntry(RayDialHistory* history, const RayDialHistoryEntry* entry);
+
+// A line outside any node, such as a bark
+bool RecordDialogueLine(RayDialHistory* history, const char* text, const char* speaker);
+
+// Lines from the oldest kept (0) to the newest. Entries point into the history and
+// stay valid until they are dropped, so views read them in place.
+int GetDialogueHistoryCount(const RayDialHistory* history);
+const RayDialHistoryEntry* GetDialogueHistoryEntry(const RayDialHistory* history, int index);
+
+void MarkNodeVisited(RayDialHistory* history, int chapter, int nodeIndex);
+bool IsNodeVisited(const RayDialHistory* history, int chapter, int nodeIndex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RAYDIAL_HISTORY_H
@@ -3,6 +3,7 @@
 
 #include <raylib.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -11,10 +12,83 @@ extern "C" {
 // Forward declaration for RayDialTextSegment to avoid circular dependencies
 typedef struct RayDialTextSegment RayDialTextSegment;
 
+// Opaque lookup table holding one language's translations (replaced wholesale on reload)
+typedef struct RayDialTranslationTable RayDialTranslationTable;
+
+// Opaque precomputed lookup over a language and its fallback chain
+typedef struct RayDialFallbackIndex RayDialFallbackIndex;
+
+// Shared, reference-counted parse of a styled translation
+typedef struct RayDialStyledText RayDialStyledText;
+typedef struct RayDialStyledTextCache RayDialStyledTextCache;
+
+// Opaque handle for a translation file watched for hot reload
+typedef struct RayDialTranslationWatch RayDialTranslationWatch;
+
+// Opaque precompiled placeholder list of a translation
+typedef struct RayDialMessageFormat RayDialMessageFormat;
+
+// Plural categories selected by {name, plural, ...} placeholders
+typedef enum {
+    RAYDIAL_PLURAL_ZERO,
+    RAYDIAL_PLURAL_ONE,
+    RAYDIAL_PLURAL_TWO,
+    RAYDIAL_PLURAL_FEW,
+    RAYDIAL_PLURAL_MANY,
+    RAYDIAL_PLURAL_OTHER
+} RayDialPluralCategory;
+
+// Maps a count to its plural category for a language
+typedef RayDialPluralCategory (*RayDialPluralRule)(long long n);
+
+// Named argument for FormatLocalizedText
+typedef enum {
+    RAYDIAL_FORMAT_INT,
+    RAYDIAL_FORMAT_FLOAT,
+    RAYDIAL_FORMAT_STRING
+} RayDialFormatArgType;
+
+typedef struct RayDialFormatArg {
+    const char* name;
+    RayDialFormatArgType type;
+    union {
+        long long i;
+        double f;
+        const char* s;
+    } value;
+} RayDialFormatArg;
+
+static inline RayDialFormatArg FormatArgInt(const char* name, long long value) {
+    RayDialFormatArg arg = { name, RAYDIAL_FORMAT_INT, { 0 } };
+    arg.value.i = value;
+    return arg;
+}
+
+static inline RayDialFormatArg FormatArgFloat(const char* name, double value) {
+    RayDialFormatArg arg = { name, RAYDIAL_FORMAT_FLOAT, { 0 } };
+    arg.value.f = value;
+    return arg;
+}
+
+static inline RayDialFormatArg FormatArgString(const char* name, const char* value) {
+    RayDialFormatArg arg = { name, RAYDIAL_FORMAT_STRING, { 0 } };
+    arg.value.s = value;
+    return arg;
+}
+
+// Callback invoked on the main thread after translations change
+typedef void (*RayDialI18NCallback)(void* userData);
+
+// Ownership flags for translation strings (unset means borrowed from the caller)
+#define RAYDIAL_TRANSLATION_KEY_OWNED   0x01   // Key lives in the language's string pool
+#define RAYDIAL_TRANSLATION_VALUE_OWNED 0x02   // Value lives in the language's string pool
+
 // Structure to hold translation pairs
 typedef struct RayDialTranslationEntry {
     const char* key;
     const char* value;
+    unsigned int flags;                     // RAYDIAL_TRANSLATION_*_OWNED bits
+    const RayDialMessageFormat* format;     // Compiled {placeholders}, NULL for plain text
     struct RayDialTranslationEntry* next;
 } RayDialTranslationEntry;
 
@@ -22,7 +96,11 @@ typedef struct RayDialTranslationEntry {
 typedef struct RayDialLanguage {
     const char* languageCode;
     const char* languageName;
-    RayDialTranslationEntry* translations;
+    RayDialTranslationEntry* translations;  // Entries of the active table, in insertion order
+    RayDialTranslationTable* table;         // Active lookup table and string pool
+    struct RayDialLanguage* fallback;       // Language consulted for missing keys (optional)
+    RayDialFallbackIndex* resolved;         // Flattened lookup over the fallback chain
+    RayDialPluralRule pluralRule;           // Plural category rule (NULL: "one" for 1, else "other")
     struct RayDialLanguage* next;
 } RayDialLanguage;
 
@@ -31,28 +109,88 @@ typedef struct RayDialI18N {
     RayDialLanguage* languages;
     RayDialLanguage* currentLanguage;
     bool useStyledTextParsing;
+    unsigned int generation;                 // Bumped whenever resolved strings may have changed
+    unsigned int frameCounter;               // Advanced by UpdateI18NManager
+    RayDialTranslationWatch* watches;        // Files watched for hot reload
+    RayDialTranslationTable* retiredTables;  // Replaced tables waiting out their grace period
+    struct RayDialWorkerPool* worker;        // Background parser (created on first watch)
+    struct RayDialI18NListener* listeners;   // Reload notification callbacks
+    unsigned int contentVersion;             // Bumped whenever any table or fallback link changes
+    unsigned int resolvedVersion;            // Content version all fallback indices were built at
+    RayDialStyledTextCache* styledCache;     // Parsed styled translations for the current content
 } RayDialI18N;
 
+// Memory footprint of the localization data
+typedef struct RayDialI18NStats {
+    int languageCount;
+    int entryCount;
+    int ownedStrings;           // Distinct strings interned in the language pools
+    int borrowedStrings;        // Keys and values still pointing at caller memory
+    size_t stringBytes;         // Interned string data, terminators included
+    size_t retiredBytes;        // Replaced tables still inside their grace period
+    size_t totalBytes;          // Everything above plus entries, indices and block slack
+} RayDialI18NStats;
+
+// A key whose text comes from a fallback language
+typedef struct RayDialFallbackKey {
+    const char* key;
+    const char* languageCode;   // Language that supplied the text
+} RayDialFallbackKey;
+
 // Function declarations
 RayDialI18N* CreateI18NManager(void);
 void FreeI18NManager(RayDialI18N* manager);
 
 // Language management
 bool AddLanguage(RayDialI18N* manager, const char* languageCode, const char* languageName);
+bool RemoveLanguage(RayDialI18N* manager, const char* languageCode);
 bool SetCurrentLanguage(RayDialI18N* manager, const char* languageCode);
 RayDialLanguage* GetCurrentLanguage(RayDialI18N* manager);
 const char* GetCurrentLanguageCode(RayDialI18N* manager);
 const char* GetCurrentLanguageName(RayDialI18N* manager);
 
+// Fallback chains (e.g. pt-BR -> pt -> en), flattened so lookups stay a single probe
+bool SetLanguageFallback(RayDialI18N* manager, const char* languageCode, const char* fallbackCode);
+void ResolveLanguageFallbacks(RayDialI18N* manager);
+int GetFallbackReport(RayDialI18N* manager, const char* languageCode, RayDialFallbackKey* keys, int maxKeys);
+
 // Translation management
 bool AddTranslation(RayDialI18N* manager, const char* languageCode, const char* key, const char* value);
+bool AddTranslationCopy(RayDialI18N* manager, const char* languageCode, const char* key, const char* value);
 bool LoadTranslationsFromFile(RayDialI18N* manager, const char* languageCode, const char* filename);
+bool ReloadTranslationsFromFile(RayDialI18N* manager, const char* languageCode, const char* filename);
 bool SaveTranslationsToFile(RayDialI18N* manager, const char* languageCode, const char* filename);
 
+// Hot reload: watched files are parsed on a worker thread and swapped in by UpdateI18NManager.
+// The watched file becomes the language's complete table on every reload.
+bool WatchTranslationFile(RayDialI18N* manager, const char* languageCode, const char* filename);
+void UnwatchTranslationFile(RayDialI18N* manager, const char* languageCode);
+void UpdateI18NManager(RayDialI18N* manager);
+bool AddI18NReloadListener(RayDialI18N* manager, RayDialI18NCallback callback, void* userData);
+void RemoveI18NReloadListener(RayDialI18N* manager, RayDialI18NCallback callback, void* userData);
+unsigned int GetI18NGeneration(RayDialI18N* manager);
+
+// Memory statistics
+bool GetLanguageStats(RayDialI18N* manager, const char* languageCode, RayDialI18NStats* stats);
+void GetI18NStats(RayDialI18N* manager, RayDialI18NStats* stats);
+
 // Text retrieval
 const char* GetLocalizedText(RayDialI18N* manager, const char* key);
 RayDialTextSegment* GetLocalizedStyledText(RayDialI18N* manager, const char* key, Color defaultColor, float defaultFontSize);
 
+// Cached styled text: parsed once per (language, default color, default size) and
+// shared read-only until translations change. Every acquire needs one release.
+RayDialStyledText* AcquireLocalizedStyledText(RayDialI18N* manager, const char* key, Color defaultColor, float defaultFontSize);
+RayDialStyledText* RetainStyledText(RayDialStyledText* styledText);
+void ReleaseStyledText(RayDialStyledText* styledText);
+const RayDialTextSegment* GetStyledTextSegments(const RayDialStyledText* styledText);
+const char* GetStyledTextPlain(const RayDialStyledText* styledText);
+int GetStyledTextCacheCount(RayDialI18N* manager);
+
+// Message formatting with {name}, {name, number}, {name, plural, ...} and {name, select, ...}
+int FormatLocalizedText(RayDialI18N* manager, const char* key, char* buffer, int bufferSize, const RayDialFormatArg* args, int argCount);
+bool SetLanguagePluralRule(RayDialI18N* manager, const char* languageCode, RayDialPluralRule rule);
+
 // Configuration
 void SetUseStyledTextParsing(RayDialI18N* manager, bool useStyledText);
 
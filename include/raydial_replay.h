@@ -0,0 +1,78 @@
+#ifndef RAYDIAL_REPLAY_H
+#define RAYDIAL_REPLAY_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include "raydial.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Record and replay of dialogue sessions. A recording holds the input of every frame
+// and the nodes the manager entered; replaying feeds the same input to
+// UpdateDialogueManager, with no window, and checks the manager enters the same nodes.
+
+#define RAYDIAL_INPUT_MAX_CHARS 16          // Characters typed in one frame that are kept
+
+// Left mouse button state bits
+#define RAYDIAL_INPUT_MOUSE_PRESSED 1u
+#define RAYDIAL_INPUT_MOUSE_DOWN 2u
+#define RAYDIAL_INPUT_MOUSE_RELEASED 4u
+
+// Everything RayDial reads from the keyboard, mouse and clock in one frame
+typedef struct {
+    float frameTime;                        // GetFrameTime
+    double time;                            // GetTime; recordings keep its change per frame
+    Vector2 mouse;
+    float wheel;
+    unsigned int mouseButtons;              // RAYDIAL_INPUT_MOUSE_* bits
+    unsigned int keysPressed;               // Bits over the keys RayDial uses (see PressInputKey)
+    unsigned int keysRepeat;
+    unsigned int keysDown;
+    int chars[RAYDIAL_INPUT_MAX_CHARS];     // Typed codepoints, as from GetCharPressed
+    int charCount;
+} RayDialInputFrame;
+
+// Mark a key pressed (and held) in a frame built by hand. Returns false for keys
+// RayDial never reads: arrows, page up/down, home, end, enter, backspace, delete,
+// space, escape, A, C, V, X, shift and control.
+bool PressInputKey(RayDialInputFrame* frame, int key);
+
+typedef struct RayDialRecorder RayDialRecorder;
+
+// Start recording a manager from its current node. The recorder chains onto the
+// manager's transition callback and gives it back when freed.
+RayDialRecorder* CreateDialogueRecorder(RayDialManager* manager);
+void FreeDialogueRecorder(RayDialRecorder* recorder);
+
+// Call once per frame before updating the manager. The live input (or the given one)
+// is logged and becomes what RayDial reads until the next call, so the session runs
+// on exactly the values the replay will see.
+void RecordDialogueFrame(RayDialRecorder* recorder);
+void RecordDialogueInput(RayDialRecorder* recorder, const RayDialInputFrame* input);
+
+// The log so far; valid until the next record call
+const unsigned char* GetDialogueRecording(const RayDialRecorder* recorder, int* size);
+bool SaveDialogueRecording(const RayDialRecorder* recorder, const char* fileName);
+
+typedef struct {
+    bool passed;
+    int frames;                             // Frames replayed
+    int transitions;                        // Transitions that matched the recording
+    int failedFrame;                        // Frame of the first difference, -1 if none
+    int expectedChapter, expectedNode;      // What the recording entered there (-1 for nothing)
+    int actualChapter, actualNode;          // What the replay entered (-1 for nothing)
+} RayDialReplayResult;
+
+// Replay a recording against a manager set up the way the recorded one started (same
+// dialogue, same node, same variables). Stops at the first transition that differs.
+// Only transitions made during updates, by the dialogue's own callbacks and scripts,
+// can be reproduced; the replay runs no other game code.
+RayDialReplayResult ReplayDialogueRecording(RayDialManager* manager, const unsigned char* data, int size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RAYDIAL_REPLAY_H
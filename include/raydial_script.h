@@ -0,0 +1,57 @@
+#ifndef RAYDIAL_SCRIPT_H
+#define RAYDIAL_SCRIPT_H
+
+#include <stdbool.h>
+#include "raydial_vars.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Node scripts: small register programs run when the dialogue enters a node. A
+// script reads and writes store variables, branches, emits events to the game,
+// calls natives the game registered and can move the dialogue on to another node.
+typedef struct RayDialScript RayDialScript;
+
+// What scripts compile against: the variable store, the natives and the event handler
+typedef struct RayDialScriptHost RayDialScriptHost;
+
+// A game function callable from scripts. Arguments are only valid during the call;
+// a returned string must stay valid until the script finishes.
+typedef RayDialValue (*RayDialScriptNative)(const RayDialValue* args, int argCount, void* userData);
+
+// Receives the events a script emits
+typedef void (*RayDialScriptEventCallback)(const char* event, RayDialValue value, void* userData);
+
+RayDialScriptHost* CreateScriptHost(RayDialVariables* variables);
+void FreeScriptHost(RayDialScriptHost* host);
+RayDialVariables* GetScriptHostVariables(const RayDialScriptHost* host);
+
+// Natives are bound by name when a script compiles, so register them first.
+// Registering a name again replaces the function for scripts already compiled.
+bool RegisterScriptNative(RayDialScriptHost* host, const char* name, RayDialScriptNative native, void* userData);
+void SetScriptEventHandler(RayDialScriptHost* host, RayDialScriptEventCallback callback, void* userData);
+
+// Assemble a script, one instruction per line ('#' starts a comment):
+//   load rA, x          rA = x (register, literal or variable)
+//   store var, x        var = x (register or literal)
+//   add|sub|mul|div|mod rA, x, y
+//   eq|ne|lt|le|gt|ge rA, x, y      rA = 1 or 0
+//   not rA, x
+//   label:  jump label  jumpif rA, label  jumpifnot rA, label
+//   call rA, native, n  rA = native(rA+1 .. rA+n)
+//   emit "event"[, x]   goto "nodeId"   end
+// Registers are r0-r63. Literals are integers, decimals, "strings" and true/false.
+// On failure returns NULL and describes the problem, with its line, in error.
+RayDialScript* CompileScript(RayDialScriptHost* host, const char* source, char* error, int errorSize);
+void FreeScript(RayDialScript* script);
+
+// Run the script to its end against the host it was compiled for. Returns the
+// node id of a goto, or NULL.
+const char* RunScript(const RayDialScript* script);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RAYDIAL_SCRIPT_H
@@ -0,0 +1,36 @@
+#ifndef RAYDIAL_SNAPSHOT_H
+#define RAYDIAL_SNAPSHOT_H
+
+#include <stdbool.h>
+#include "raydial.h"
+#include "raydial_vars.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Save games: a small versioned blob holding where a dialogue manager is (chapter
+// and node index) and the value of every variable. Nodes are stored by index, so
+// a snapshot restores against the same graph or the same tree it was saved from.
+// A manager with a history (SetDialogueHistory) also saves its lines and visited
+// nodes, and restoring replaces them.
+
+// Write a snapshot into buffer and return its size. Like snprintf, a size above
+// capacity means the buffer was too small and holds no snapshot; a NULL buffer just
+// asks for the size. Returns 0 when the current node is not in the manager's graph
+// or tree.
+// variables may be NULL to leave them out.
+int SaveDialogueSnapshot(const RayDialManager* manager, const RayDialVariables* variables, unsigned char* buffer, int capacity);
+
+// Check a snapshot completely, then apply it: variables it lists get their saved
+// values, other variables go back to 0, and the manager moves to the saved node
+// without running callbacks or scripts. Returns false, changing nothing, for a
+// damaged snapshot or one that doesn't fit the manager. Doesn't allocate when the
+// variables and strings already exist and the chapter is resident (quickload).
+bool RestoreDialogueSnapshot(RayDialManager* manager, RayDialVariables* variables, const unsigned char* data, int size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RAYDIAL_SNAPSHOT_H
@@ -0,0 +1,98 @@
+#ifndef RAYDIAL_TEXTURES_H
+#define RAYDIAL_TEXTURES_H
+
+#include <raylib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "raydial.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Shared texture cache keyed by file path. Images are decoded on worker threads
+// and uploaded to the GPU on the main thread by UpdateTextureCache.
+typedef struct RayDialTextureCache RayDialTextureCache;
+
+// Reference-counted cache entry; stays valid while it is held
+typedef struct RayDialTextureHandle RayDialTextureHandle;
+
+typedef enum {
+    RAYDIAL_TEXTURE_LOADING,   // Queued, decoding, or waiting for its upload
+    RAYDIAL_TEXTURE_READY,     // Uploaded; GetHandleTexture returns it
+    RAYDIAL_TEXTURE_FAILED     // The file could not be loaded
+} RayDialTextureState;
+
+// GPU memory held by the uploaded textures of a cache
+typedef struct {
+    int textureCount;
+    size_t sourceBytes;        // What the files would take uploaded at full resolution
+    size_t residentBytes;      // What was actually uploaded, mip chains included
+} RayDialTextureMemory;
+
+// Create a cache decoding with the given number of worker threads (at least one)
+RayDialTextureCache* CreateTextureCache(int workerThreads);
+
+// Unload every texture and stop the workers. Handles still held become invalid.
+void FreeTextureCache(RayDialTextureCache* cache);
+
+// Get the entry for a path, queueing a background load the first time it is asked for
+RayDialTextureHandle* AcquireTexture(RayDialTextureCache* cache, const char* path);
+
+// Same, for a texture drawn at most maxSize pixels wide or high. The image is halved
+// down to the smallest level that still covers maxSize and gets a mip chain below
+// it. Each size is its own entry; 0 loads the file unchanged like AcquireTexture.
+RayDialTextureHandle* AcquireTextureSized(RayDialTextureCache* cache, const char* path, int maxSize);
+
+void RetainTexture(RayDialTextureHandle* handle);
+void ReleaseTexture(RayDialTextureHandle* handle);
+
+RayDialTextureState GetTextureState(const RayDialTextureHandle* handle);
+
+// Uploaded texture, or a texture with id 0 while it is still loading
+Texture2D GetHandleTexture(const RayDialTextureHandle* handle);
+
+// Upload decoded images until budgetSeconds have been spent (at least one per call).
+// Call once per frame on the thread that owns the window.
+void UpdateTextureCache(RayDialTextureCache* cache, double budgetSeconds);
+
+// Block until every queued decode has finished (e.g. behind a loading screen)
+void WaitTextureCache(RayDialTextureCache* cache);
+
+// Textures still decoding or waiting for their upload
+int GetTextureCachePendingCount(const RayDialTextureCache* cache);
+
+// Memory used by the uploaded textures and what they would have used at full size
+RayDialTextureMemory GetTextureCacheMemory(const RayDialTextureCache* cache);
+
+// Unload textures no component holds any more; returns how many were unloaded
+int TrimTextureCache(RayDialTextureCache* cache);
+
+// Portrait atlas: packs many small images (characters and their expressions) into
+// a few large pages so consecutive portrait draws share a texture and batch.
+typedef struct RayDialPortraitAtlas RayDialPortraitAtlas;
+
+// pageSize is the width and height of each page; padding separates images
+RayDialPortraitAtlas* CreatePortraitAtlas(int pageSize, int padding);
+void FreePortraitAtlas(RayDialPortraitAtlas* atlas);
+
+// Queue an image under a unique name (the atlas keeps its own copy). Fails once
+// the atlas is built, for duplicate names, or for images larger than a page.
+bool AddAtlasImage(RayDialPortraitAtlas* atlas, const char* name, Image image);
+bool AddAtlasImageFile(RayDialPortraitAtlas* atlas, const char* name, const char* path);
+
+// Pack every queued image, upload the pages and drop the CPU copies
+bool BuildPortraitAtlas(RayDialPortraitAtlas* atlas);
+
+int GetAtlasPageCount(const RayDialPortraitAtlas* atlas);
+bool GetAtlasRegion(const RayDialPortraitAtlas* atlas, const char* name, RayDialAtlasRegion* region);
+
+// Solid white pixels on the first page. Pass them to SetShapesTexture so that
+// rectangles drawn around the portraits use the same texture as well.
+bool GetAtlasWhiteRegion(const RayDialPortraitAtlas* atlas, RayDialAtlasRegion* region);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RAYDIAL_TEXTURES_H
@@ -0,0 +1,103 @@
+#ifndef RAYDIAL_VARS_H
+#define RAYDIAL_VARS_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Named dialogue variables (gold, quest flags, ...) shared by conditions, labels
+// and scripts. Variables are looked up by name once and then accessed by id.
+typedef struct RayDialVariables RayDialVariables;
+
+// Compiled boolean expression over a variable store, e.g. "gold >= 50 && !hasSword"
+typedef struct RayDialCondition RayDialCondition;
+
+// Compiled text template with {name} placeholders, e.g. "Your gold: {gold}"
+typedef struct RayDialVariableText RayDialVariableText;
+
+typedef enum {
+    RAYDIAL_VAR_INT,
+    RAYDIAL_VAR_FLOAT,
+    RAYDIAL_VAR_BOOL,
+    RAYDIAL_VAR_STRING          // Interned by the store; equal strings share one pointer
+} RayDialVariableType;
+
+// A value as conditions, scripts and natives see it. Bools use the int member.
+typedef struct {
+    RayDialVariableType type;
+    union {
+        int i;
+        float f;
+        const char* s;
+    } value;
+} RayDialValue;
+
+// Called after a subscribed variable changed value
+typedef void (*RayDialVariableCallback)(RayDialVariables* variables, int id, void* userData);
+
+RayDialVariables* CreateVariableStore(void);
+void FreeVariableStore(RayDialVariables* variables);
+
+// Id of a variable, creating it as the int 0 the first time (-1 on failure)
+int GetVariableId(RayDialVariables* variables, const char* name);
+// Id of an existing variable, or -1
+int FindVariableId(const RayDialVariables* variables, const char* name);
+int GetVariableCount(const RayDialVariables* variables);
+const char* GetVariableName(const RayDialVariables* variables, int id);
+
+// Getters convert between the numeric types. A string reads as 0 from the int and
+// float getters, and as true from GetVariableBool when it is non-empty; a number
+// reads as the empty string.
+RayDialVariableType GetVariableType(const RayDialVariables* variables, int id);
+int GetVariableInt(const RayDialVariables* variables, int id);
+float GetVariableFloat(const RayDialVariables* variables, int id);
+bool GetVariableBool(const RayDialVariables* variables, int id);
+const char* GetVariableString(const RayDialVariables* variables, int id);
+RayDialValue GetVariableValue(const RayDialVariables* variables, int id);
+
+// Setters also set the type. Assigning the value a variable already has changes
+// nothing: no version bump and no notifications.
+void SetVariableInt(RayDialVariables* variables, int id, int value);
+void SetVariableFloat(RayDialVariables* variables, int id, float value);
+void SetVariableBool(RayDialVariables* variables, int id, bool value);
+void SetVariableString(RayDialVariables* variables, int id, const char* value);
+void SetVariableValue(RayDialVariables* variables, int id, RayDialValue value);
+
+// Store version: bumped by every change. A variable's version is the store version
+// of its last change, so "changed since v" is GetVariableVersion(...) > v.
+unsigned int GetVariableStoreVersion(const RayDialVariables* variables);
+unsigned int GetVariableVersion(const RayDialVariables* variables, int id);
+
+// Call back after a variable changes. Returns a subscription id (-1 on failure).
+// Callbacks may set variables and subscribe or unsubscribe.
+int SubscribeVariable(RayDialVariables* variables, int id, RayDialVariableCallback callback, void* userData);
+void UnsubscribeVariable(RayDialVariables* variables, int subscription);
+
+// Compile an expression once. Identifiers become variable ids of the store (created
+// as needed). Supported: integers, decimals, "strings", true/false, ( ) and
+// ! - * / % + - < <= > >= == != && || with C precedence. On failure returns NULL
+// and describes the problem in error (if given).
+RayDialCondition* CompileCondition(RayDialVariables* variables, const char* source, char* error, int errorSize);
+void FreeCondition(RayDialCondition* condition);
+
+// Run the compiled expression; a NULL condition is always true
+bool EvaluateCondition(const RayDialCondition* condition, const RayDialVariables* variables);
+
+// Whether a variable the condition reads changed after the given store version
+bool ConditionChangedSince(const RayDialCondition* condition, const RayDialVariables* variables, unsigned int version);
+
+// Text templates: {name} is replaced by the variable's value; other braces are kept
+RayDialVariableText* CompileVariableText(RayDialVariables* variables, const char* format);
+void FreeVariableText(RayDialVariableText* text);
+
+// Write the text like snprintf: returns the full length, truncating to bufferSize
+int FormatVariableText(const RayDialVariableText* text, const RayDialVariables* variables, char* buffer, int bufferSize);
+bool VariableTextChangedSince(const RayDialVariableText* text, const RayDialVariables* variables, unsigned int version);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RAYDIAL_VARS_H
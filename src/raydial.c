@@ -4,7 +4,78 @@
 #include <stdio.h>
 #include <math.h>
 #include <ctype.h>
+#include <limits.h>
+#include <float.h>
+#include <rlgl.h>
 #include "raydial_i18n.h"
+#include "raydial_textures.h"
+#include "raydial_vars.h"
+#include "raydial_script.h"
+#include "raydial_graph.h"
+#include "raydial_history.h"
+#include "raydial_input.h"
+#include "raydial_text_edit.h"
+#include "raydial_text_layout.h"
+
+#define RAYDIAL_TEXTBOX_PADDING 6          // Space between the textbox border and its text
+#define RAYDIAL_SCROLL_LINE_STEP 40.0f     // Pixels scrolled per arrow key press or wheel notch
+#define RAYDIAL_SCROLL_SMOOTHING 12.0f     // How quickly the view eases towards its target (1/s)
+#define RAYDIAL_MAX_SCRIPT_HOPS 32         // Node-to-node script gotos followed by one transition
+
+// Textbox editing state: the gap buffer plus a glyph layout cache that is only
+// rebuilt when the text, font size or masking changes
+struct RayDialTextboxState {
+    RayDialTextEditor editor;
+    int layoutRevision;     // Editor revision the layout was built for
+    int textRevision;       // Editor revision data->text was joined at
+    int layoutFontSize;
+    bool layoutMasked;
+    int glyphCount;         // Characters laid out
+    int* glyphBytes;        // Byte offset of every character boundary (glyphCount + 1 entries)
+    float* glyphX;          // X offset of every character boundary
+    int glyphCapacity;
+    char* mask;             // Run of '*' reused to draw password text
+    int maskCapacity;
+    bool selecting;         // Mouse drag selection in progress
+};
+
+// Point data->text at the joined contents after an edit. Joining moves the gap to
+// the end, so this costs one pass over the text per edited frame and none otherwise.
+static void SyncTextboxText(RayDialTextboxData* data) {
+    RayDialTextboxState* state = data->state;
+    if (state->textRevision == state->editor.revision) return;
+    
+    data->text = (char*)TextEditorContents(&state->editor);
+    state->textRevision = state->editor.revision;
+}
+
+// A word of styled portrait text placed relative to the text area
+typedef struct {
+    const char* text;       // Start of the word inside its segment (borrowed)
+    int bytes;
+    int glyphStart;         // Characters of the plain text before this word
+    int glyphCount;
+    float x;
+    float y;
+    float fontSize;
+    Color color;
+    bool defaultColor;      // Uses the portrait's textColor rather than a [color] tag
+} RayDialPlacedWord;
+
+// Styled text laid out once per text, width and font size. Drawing walks the
+// placed words in view; only the word under a typewriter reveal is cut short.
+struct RayDialStyledLayout {
+    const RayDialTextSegment* segments;  // Segment list the words were placed from
+    float maxWidth;
+    float baseFontSize;
+    bool dirty;
+    RayDialPlacedWord* words;
+    int wordCount;
+    int wordCapacity;
+    float lineHeight;
+    char* scratch;          // Holds one word for DrawTextEx, sized to the longest word
+    int scratchCapacity;
+};
 
 // Component creation functions
 RayDialComponent* CreateButton(Rectangle bounds, const char* text, RayDialCallback onClick, void* userData) {
@@ -25,6 +96,9 @@ RayDialComponent* CreateButton(Rectangle bounds, const char* text, RayDialCallba
     data->backgroundColor = LIGHTGRAY;
     data->hoverColor = GRAY;
     data->fontSize = 20;
+    data->textKey = NULL;
+    data->i18n = NULL;
+    data->i18nGeneration = 0;
     
     return component;
 }
@@ -54,6 +128,17 @@ RayDialComponent* CreateLabel(Rectangle bounds, const char* text, bool wrapText)
     data->scrollbarColor = GRAY;
     data->scrollbarWidth = 8;
     
+    data->textKey = NULL;
+    data->i18n = NULL;
+    data->i18nGeneration = 0;
+    data->formatBuffer = NULL;
+    data->formatBufferSize = 0;
+    data->variables = NULL;
+    data->variableText = NULL;
+    data->variableVersion = 0;
+    data->layout = NULL;
+    memset(&data->typewriter, 0, sizeof(RayDialTypewriter));
+    
     return component;
 }
 
@@ -74,6 +159,109 @@ RayDialComponent* CreatePanel(Rectangle bounds, Color backgroundColor) {
     data->borderColor = DARKGRAY;
     data->borderWidth = 2;
     data->padding = 10;
+    memset(&data->frame, 0, sizeof(RayDialFrame));
+    
+    return component;
+}
+
+RayDialComponent* CreateTextbox(Rectangle bounds, int maxLength) {
+    RayDialComponent* component = (RayDialComponent*)malloc(sizeof(RayDialComponent));
+    RayDialTextboxData* data = (RayDialTextboxData*)malloc(sizeof(RayDialTextboxData));
+    RayDialTextboxState* state = (RayDialTextboxState*)calloc(1, sizeof(RayDialTextboxState));
+    if (!component || !data || !state || !InitTextEditor(&state->editor, maxLength > 0 ? maxLength * 2 : 0)) {
+        free(state);
+        free(data);
+        free(component);
+        return NULL;
+    }
+    
+    component->type = RAYDIAL_TEXTBOX;
+    component->bounds = bounds;
+    component->visible = true;
+    component->enabled = true;
+    component->data = data;
+    component->onClick = NULL;
+    component->userData = NULL;
+    component->next = NULL;
+    
+    data->text = NULL;
+    data->maxLength = maxLength;
+    data->textColor = BLACK;
+    data->backgroundColor = WHITE;
+    data->fontSize = 20;
+    data->isPassword = false;
+    data->hasFocus = false;
+    data->borderColor = GRAY;
+    data->focusColor = DARKGRAY;
+    data->selectionColor = SKYBLUE;
+    data->scrollOffset = 0.0f;
+    data->state = state;
+    
+    state->layoutRevision = -1;
+    state->textRevision = -1;
+    SyncTextboxText(data);
+    
+    return component;
+}
+
+RayDialComponent* CreateScrollArea(Rectangle bounds, float contentHeight) {
+    RayDialComponent* component = (RayDialComponent*)malloc(sizeof(RayDialComponent));
+    RayDialScrollAreaData* data = (RayDialScrollAreaData*)malloc(sizeof(RayDialScrollAreaData));
+    
+    component->type = RAYDIAL_SCROLLAREA;
+    component->bounds = bounds;
+    component->visible = true;
+    component->enabled = true;
+    component->data = data;
+    component->onClick = NULL;
+    component->userData = NULL;
+    component->next = NULL;
+    
+    data->scrollPosition = 0.0f;
+    data->contentHeight = contentHeight;
+    data->scrollbarColor = GRAY;
+    data->scrollbarWidth = 8;
+    data->backgroundColor = BLANK;
+    data->rowSpacing = 0.0f;
+    data->scrollTarget = 0.0f;
+    data->rows = NULL;
+    data->rowOffsets = NULL;
+    data->rowCount = 0;
+    data->rowCapacity = 0;
+    data->firstDirtyRow = 0;
+    data->firstVisibleRow = 0;
+    data->visibleRowCount = 0;
+    
+    return component;
+}
+
+RayDialComponent* CreateHistoryView(Rectangle bounds, RayDialHistory* history, int fontSize) {
+    RayDialComponent* component = (RayDialComponent*)malloc(sizeof(RayDialComponent));
+    RayDialHistoryViewData* data = (RayDialHistoryViewData*)malloc(sizeof(RayDialHistoryViewData));
+    
+    component->type = RAYDIAL_HISTORY_VIEW;
+    component->bounds = bounds;
+    component->visible = true;
+    component->enabled = true;
+    component->data = data;
+    component->onClick = NULL;
+    component->userData = NULL;
+    component->next = NULL;
+    
+    data->history = history;
+    data->i18n = NULL;
+    data->fontSize = fontSize;
+    data->textColor = BLACK;
+    data->speakerColor = DARKBLUE;
+    data->backgroundColor = BLANK;
+    data->scrollbarColor = GRAY;
+    data->scrollbarWidth = 8;
+    data->scrollPosition = 0.0f;
+    data->scrollTarget = 0.0f;
+    data->followEnd = true;
+    data->originLine = 0;
+    data->firstVisibleEntry = 0;
+    data->visibleEntryCount = 0;
     
     return component;
 }
@@ -127,6 +315,17 @@ void FreeStyledText(RayDialTextSegment* styledText) {
     }
 }
 
+// Drop a portrait's styled text, releasing it instead if it is shared with the i18n cache
+static void ClearPortraitStyledText(RayDialPortraitDialogueData* data) {
+    if (data->sharedStyledText) {
+        ReleaseStyledText(data->sharedStyledText);
+        data->sharedStyledText = NULL;
+    } else if (data->styledText) {
+        FreeStyledText(data->styledText);
+    }
+    data->styledText = NULL;
+}
+
 // Parse formatted text with styling tags
 RayDialTextSegment* ParseStyledText(const char* formattedText, Color defaultColor, float defaultFontSize) {
     if (!formattedText) return NULL;
@@ -368,6 +567,7 @@ RayDialComponent* CreatePortraitDialogue(Rectangle bounds, const char* speakerNa
     data->speakerName = NULL;
     data->dialogueText = NULL;
     data->styledText = NULL;
+    data->sharedStyledText = NULL;
     data->useStyledText = false;
     
     if (speakerName) {
@@ -399,6 +599,20 @@ RayDialComponent* CreatePortraitDialogue(Rectangle bounds, const char* speakerNa
     data->wrapText = true;
     data->portraitSize = 100;
     data->showOnRight = false;
+    data->speakerNameKey = NULL;
+    data->dialogueTextKey = NULL;
+    data->dialogueKeyStyled = false;
+    data->i18n = NULL;
+    data->i18nGeneration = 0;
+    data->layout = NULL;
+    data->styledLayout = NULL;
+    data->styledWordsDrawn = 0;
+    data->textureHandle = NULL;
+    data->useAtlasRegion = false;
+    memset(&data->flipbook, 0, sizeof(RayDialFlipbook));
+    memset(&data->boxFrame, 0, sizeof(RayDialFrame));
+    memset(&data->nameTagFrame, 0, sizeof(RayDialFrame));
+    memset(&data->typewriter, 0, sizeof(RayDialTypewriter));
     
     return component;
 }
@@ -414,6 +628,15 @@ RayDialComponent* CreatePortraitDialogueWithTexture(Rectangle bounds, const char
     return component;
 }
 
+// Create a portrait dialogue whose portrait loads in the background through a
+// texture cache. placeholderColor is drawn until the texture is ready.
+RayDialComponent* CreatePortraitDialogueWithTexturePath(Rectangle bounds, const char* speakerName, const char* dialogueText,
+                                                        RayDialTextureCache* cache, const char* path, Color placeholderColor) {
+    RayDialComponent* component = CreatePortraitDialogue(bounds, speakerName, dialogueText, placeholderColor);
+    SetPortraitDialogueTexturePath(component, cache, path);
+    return component;
+}
+
 // Component management functions
 void AddComponent(RayDialComponent* parent, RayDialComponent* child) {
     if (!parent || !child) return;
@@ -439,222 +662,1312 @@ void RemoveComponent(RayDialComponent* parent, RayDialComponent* child) {
     }
 }
 
-void UpdateComponent(RayDialComponent* component) {
-    if (!component || !component->visible || !component->enabled) return;
-    
-    switch (component->type) {
-        case RAYDIAL_BUTTON: {
-            // Only trigger onClick if component is actually clicked this frame
-            if (IsComponentClicked(component) && component->onClick) {
-                component->onClick(component->userData);
-            }
-            break;
+// Parallel update. While a manager updates off the main thread, callbacks into game
+// code and the input that raylib consumes (text entry, the clipboard) are queued on
+// the manager instead, then replayed in order by EndDialogueManagerUpdate.
+typedef enum {
+    RAYDIAL_DEFERRED_CALLBACK,
+    RAYDIAL_DEFERRED_REVEAL,
+    RAYDIAL_DEFERRED_TEXTBOX
+} RayDialDeferredKind;
+
+typedef struct {
+    RayDialDeferredKind kind;
+    RayDialCallback callback;
+    RayDialRevealCallback reveal;
+    RayDialComponent* component;
+    void* userData;
+    int codepoint;
+} RayDialDeferredEvent;
+
+struct RayDialDeferredEvents {
+    RayDialDeferredEvent* events;
+    int count;
+    int capacity;
+};
+
+// Queue of the manager this thread is updating in parallel, NULL on the immediate path
+static _Thread_local struct RayDialDeferredEvents* deferredEvents = NULL;
+
+static void DeferEvent(RayDialDeferredEvent event) {
+    struct RayDialDeferredEvents* queue = deferredEvents;
+    if (queue->count == queue->capacity) {
+        int capacity = queue->capacity ? queue->capacity * 2 : 16;
+        RayDialDeferredEvent* events = (RayDialDeferredEvent*)realloc(queue->events, capacity * sizeof(RayDialDeferredEvent));
+        if (!events) {
+            TraceLog(LOG_WARNING, "RAYDIAL: Out of memory queuing a dialogue callback, dropping it");
+            return;
         }
-        case RAYDIAL_LABEL: {
-            RayDialLabelData* data = (RayDialLabelData*)component->data;
-            
-            // Handle keyboard scrolling if this component is hovered
-            if (data->scrollable && data->contentHeight > 0 && IsComponentHovered(component)) {
-                float scrollSpeed = 10.0f;
-                
-                // Up/Down arrow keys for scrolling
-                if (IsKeyDown(KEY_UP)) {
-                    data->scrollPosition -= scrollSpeed;
-                } else if (IsKeyDown(KEY_DOWN)) {
-                    data->scrollPosition += scrollSpeed;
-                } else if (IsKeyDown(KEY_PAGE_UP)) {
-                    data->scrollPosition -= component->bounds.height / 2;
-                } else if (IsKeyDown(KEY_PAGE_DOWN)) {
-                    data->scrollPosition += component->bounds.height / 2;
-                }
-                
-                // Clamp scroll position
-                if (data->scrollPosition < 0) {
-                    data->scrollPosition = 0;
-                } else if (data->scrollPosition > fmaxf(0, data->contentHeight - component->bounds.height)) {
-                    data->scrollPosition = fmaxf(0, data->contentHeight - component->bounds.height);
-                }
-            }
+        queue->events = events;
+        queue->capacity = capacity;
+    }
+    queue->events[queue->count++] = event;
+}
+
+static void InvokeCallback(RayDialCallback callback, void* userData) {
+    if (deferredEvents) {
+        DeferEvent((RayDialDeferredEvent){ .kind = RAYDIAL_DEFERRED_CALLBACK, .callback = callback, .userData = userData });
+    } else {
+        callback(userData);
+    }
+}
+
+// Typewriter reveal. Progress is counted in characters of the full text, so the
+// text is laid out once and drawing just cuts the last visible line short.
+static RayDialTypewriter* GetComponentTypewriter(RayDialComponent* component) {
+    if (component->type == RAYDIAL_LABEL) return &((RayDialLabelData*)component->data)->typewriter;
+    if (component->type == RAYDIAL_PORTRAIT_DIALOGUE) return &((RayDialPortraitDialogueData*)component->data)->typewriter;
+    return NULL;
+}
+
+// Text being revealed (portraits keep a tag-free copy of styled text)
+static const char* GetTypewriterText(RayDialComponent* component) {
+    if (component->type == RAYDIAL_LABEL) return ((RayDialLabelData*)component->data)->text;
+    if (component->type == RAYDIAL_PORTRAIT_DIALOGUE) return ((RayDialPortraitDialogueData*)component->data)->dialogueText;
+    return NULL;
+}
+
+// Start the reveal over; the cursor re-syncs with the text on the next update
+static void RestartTypewriter(RayDialTypewriter* typewriter) {
+    typewriter->progress = 0.0f;
+    typewriter->revealedGlyphs = 0;
+    typewriter->totalGlyphs = 0;
+    typewriter->source = NULL;
+    typewriter->sourceOffset = 0;
+}
+
+// Carry a running reveal over to text reloaded under it. Only the reveal position,
+// state and callbacks survive; the cursor re-syncs with the new text on the next update.
+static void KeepTypewriterReveal(RayDialTypewriter* typewriter, const RayDialTypewriter* kept) {
+    typewriter->enabled = kept->enabled;
+    typewriter->progress = kept->progress;
+    typewriter->revealedGlyphs = kept->revealedGlyphs;
+    typewriter->onReveal = kept->onReveal;
+    typewriter->revealUserData = kept->revealUserData;
+    typewriter->source = NULL;
+}
+
+// Point the reveal cursor at a new text, keeping as many revealed characters as
+// it has. Walks the text once, so it only runs when the text changes.
+static void SyncTypewriter(RayDialTypewriter* typewriter, const char* text) {
+    typewriter->source = text;
+    typewriter->totalGlyphs = 0;
+    typewriter->sourceOffset = 0;
+    if (!text) {
+        typewriter->revealedGlyphs = 0;
+        return;
+    }
+    
+    int glyphs = 0;
+    int offset = 0;
+    int position = 0;
+    for (; text[position]; position++) {
+        if (((unsigned char)text[position] & 0xC0) == 0x80) continue;
+        if (glyphs == typewriter->revealedGlyphs) offset = position;
+        glyphs++;
+    }
+    
+    if (typewriter->revealedGlyphs >= glyphs) {
+        typewriter->revealedGlyphs = glyphs;
+        offset = position;
+        if (typewriter->progress > glyphs) typewriter->progress = (float)glyphs;
+    }
+    typewriter->totalGlyphs = glyphs;
+    typewriter->sourceOffset = offset;
+}
+
+// Advance by the frame time. Costs O(characters revealed this frame), however long the text is.
+static void UpdateTypewriter(RayDialTypewriter* typewriter, const char* text) {
+    if (!typewriter->enabled) return;
+    if (typewriter->source != text) SyncTypewriter(typewriter, text);
+    if (typewriter->revealedGlyphs >= typewriter->totalGlyphs) return;
+    
+    typewriter->progress += GetInputFrameTime() * typewriter->charactersPerSecond;
+    int target = (int)typewriter->progress;
+    if (target > typewriter->totalGlyphs) target = typewriter->totalGlyphs;
+    
+    while (typewriter->revealedGlyphs < target) {
+        while (((unsigned char)text[typewriter->sourceOffset] & 0xC0) == 0x80) typewriter->sourceOffset++;
+        if (!text[typewriter->sourceOffset]) {
+            // Shortened in place without a resync; catch up on the next update
+            typewriter->source = NULL;
             break;
         }
-        case RAYDIAL_TEXTBOX: {
-            // Handle text input
-            break;
+        
+        int bytes = 1;
+        int codepoint = NextTextCodepoint(text + typewriter->sourceOffset, &bytes);
+        typewriter->sourceOffset += bytes;
+        typewriter->revealedGlyphs++;
+        
+        if (typewriter->onReveal && deferredEvents) {
+            DeferEvent((RayDialDeferredEvent){ .kind = RAYDIAL_DEFERRED_REVEAL, .reveal = typewriter->onReveal,
+                                               .userData = typewriter->revealUserData, .codepoint = codepoint });
+        } else if (typewriter->onReveal) {
+            typewriter->onReveal(codepoint, typewriter->revealUserData);
+            // The callback may have replaced the text
+            if (typewriter->source != text) break;
         }
-        case RAYDIAL_PORTRAIT_DIALOGUE: {
-            // No additional update logic needed for portrait dialogue
-            break;
+    }
+}
+
+// Advance a flipbook portrait. Runs after the typewriter so talking animations
+// stop on the frame the last character appears.
+static void UpdatePortraitFlipbook(RayDialPortraitDialogueData* data) {
+    RayDialFlipbook* flipbook = &data->flipbook;
+    if (flipbook->frameCount == 0) return;
+    
+    if (flipbook->mode == RAYDIAL_FLIPBOOK_WHILE_TYPING) {
+        const RayDialTypewriter* typewriter = &data->typewriter;
+        if (!typewriter->enabled || typewriter->revealedGlyphs >= typewriter->totalGlyphs) {
+            flipbook->time = 0.0f;
+            flipbook->currentFrame = 0;
+            return;
         }
-        default:
-            break;
     }
     
-    // Update child components
-    RayDialComponent* child = component->next;
-    while (child) {
-        UpdateComponent(child);
-        child = child->next;
+    float duration = flipbook->frameCount / flipbook->framesPerSecond;
+    flipbook->time += GetInputFrameTime();
+    if (flipbook->mode == RAYDIAL_FLIPBOOK_ONCE) {
+        if (flipbook->time > duration) flipbook->time = duration;
+    } else {
+        flipbook->time = fmodf(flipbook->time, duration);
     }
+    
+    int frame = (int)(flipbook->time * flipbook->framesPerSecond);
+    flipbook->currentFrame = frame < flipbook->frameCount ? frame : flipbook->frameCount - 1;
 }
 
-void DrawComponent(RayDialComponent* component) {
-    if (!component || !component->visible) return;
+// Characters to draw: everything unless a reveal is running
+static int GetRevealLimit(const RayDialTypewriter* typewriter) {
+    return typewriter->enabled ? typewriter->revealedGlyphs : INT_MAX;
+}
+
+// Draw a run of laid-out lines, cutting the text off after revealLimit characters
+static void DrawTextLayoutLines(RayDialTextLayout* layout, int firstLine, int lineCount, Vector2 position,
+                                float lineHeight, float fontSize, float spacing, Color color, int revealLimit) {
+    for (int i = firstLine; i < firstLine + lineCount && i < layout->lineCount; i++) {
+        int lineFirstGlyph = layout->lineGlyphs[i];
+        if (lineFirstGlyph >= revealLimit) break;
+        
+        int maxGlyphs = revealLimit - lineFirstGlyph;
+        if (maxGlyphs >= layout->lineGlyphs[i + 1] - lineFirstGlyph) maxGlyphs = -1;
+        DrawTextEx(GetFontDefault(), GetTextLayoutLine(layout, i, maxGlyphs), position, fontSize, spacing, color);
+        position.y += lineHeight;
+    }
+}
+
+// New portrait dialogue text: drop the stale layout and type the new line from the start
+static void PortraitDialogueTextChanged(RayDialPortraitDialogueData* data) {
+    if (data->layout) InvalidateTextLayout(data->layout);
+    if (data->styledLayout) data->styledLayout->dirty = true;
+    RestartTypewriter(&data->typewriter);
+}
+
+static bool AddPlacedWord(struct RayDialStyledLayout* layout, RayDialPlacedWord word) {
+    if (layout->wordCount == layout->wordCapacity) {
+        int capacity = layout->wordCapacity ? layout->wordCapacity * 2 : 64;
+        RayDialPlacedWord* words = (RayDialPlacedWord*)realloc(layout->words, capacity * sizeof(RayDialPlacedWord));
+        if (!words) return false;
+        layout->words = words;
+        layout->wordCapacity = capacity;
+    }
     
-    switch (component->type) {
-        case RAYDIAL_BUTTON: {
-            RayDialButtonData* data = (RayDialButtonData*)component->data;
-            bool isHovered = IsComponentHovered(component);
-            
-            // Draw button background
-            DrawRectangleRec(component->bounds, 
-                isHovered ? data->hoverColor : data->backgroundColor);
-            
-            // Draw button text
-            int textWidth = MeasureText(data->text, data->fontSize);
-            int textX = component->bounds.x + (component->bounds.width - textWidth) / 2;
-            int textY = component->bounds.y + (component->bounds.height - data->fontSize) / 2;
-            DrawText(data->text, textX, textY, data->fontSize, data->textColor);
-            break;
+    if (word.bytes + 1 > layout->scratchCapacity) {
+        int capacity = layout->scratchCapacity ? layout->scratchCapacity : 64;
+        while (capacity < word.bytes + 1) capacity *= 2;
+        char* scratch = (char*)realloc(layout->scratch, capacity);
+        if (!scratch) return false;
+        layout->scratch = scratch;
+        layout->scratchCapacity = capacity;
+    }
+    
+    layout->words[layout->wordCount++] = word;
+    return true;
+}
+
+// Copy the first maxGlyphs characters of a word (all of it if negative) into scratch
+static const char* GetPlacedWordText(struct RayDialStyledLayout* layout, const RayDialPlacedWord* word, int maxGlyphs) {
+    int bytes = word->bytes;
+    if (maxGlyphs >= 0 && maxGlyphs < word->glyphCount) {
+        int glyphs = 0;
+        bytes = 0;
+        while (bytes < word->bytes) {
+            if (((unsigned char)word->text[bytes] & 0xC0) != 0x80) {
+                if (glyphs == maxGlyphs) break;
+                glyphs++;
+            }
+            bytes++;
         }
-        case RAYDIAL_LABEL: {
-            RayDialLabelData* data = (RayDialLabelData*)component->data;
+    }
+    
+    memcpy(layout->scratch, word->text, bytes);
+    layout->scratch[bytes] = '\0';
+    return layout->scratch;
+}
+
+// Place every word of the styled segments. Words wrap greedily with one space
+// between them; character indices count every character of the plain text
+// (spaces and newlines included) so they line up with the typewriter cursor.
+static void BuildStyledLayout(struct RayDialStyledLayout* layout, const RayDialTextSegment* segments) {
+    layout->wordCount = 0;
+    layout->lineHeight = layout->baseFontSize * 1.5f;
+    float spaceWidth = MeasureTextEx(GetFontDefault(), " ", layout->baseFontSize, 1.0f).x;
+    
+    float x = 0.0f;
+    float y = 0.0f;
+    int glyph = 0;
+    bool pendingSpace = false;
+    
+    for (const RayDialTextSegment* segment = segments; segment; segment = segment->next) {
+        RayDialPlacedWord word = { 0 };
+        word.fontSize = layout->baseFontSize;
+        word.defaultColor = true;
+        for (RayDialTextStyle* style = segment->styles; style; style = style->next) {
+            if (style->type == RAYDIAL_TEXT_COLORED) {
+                word.color = style->value.color;
+                word.defaultColor = false;
+            } else if (style->type == RAYDIAL_TEXT_SIZED) {
+                word.fontSize = style->value.fontSize;
+            }
+        }
+        
+        const char* text = segment->text;
+        int position = 0;
+        while (text && text[position]) {
+            if (text[position] == '\n') {
+                x = 0.0f;
+                y += layout->lineHeight;
+                pendingSpace = false;
+                glyph++;
+                position++;
+                continue;
+            }
+            if (text[position] == ' ') {
+                pendingSpace = true;
+                glyph++;
+                position++;
+                continue;
+            }
             
-            // Define scissor rectangle for clipping text to bounds
-            Rectangle scissorRect = component->bounds;
-            BeginScissorMode(scissorRect.x, scissorRect.y, scissorRect.width, scissorRect.height);
+            int start = position;
+            int glyphs = 0;
+            while (text[position] && text[position] != ' ' && text[position] != '\n') {
+                if (((unsigned char)text[position] & 0xC0) != 0x80) glyphs++;
+                position++;
+            }
             
-            // Get text properties
-            const char* text = data->text;
-            int fontSize = data->fontSize;
-            float lineHeight = fontSize * 1.5f;
+            word.text = text + start;
+            word.bytes = position - start;
+            word.glyphStart = glyph;
+            word.glyphCount = glyphs;
+            glyph += glyphs;
             
-            // Draw text based on wrapping setting
-            if (data->wrapText) {
-                // Create a working copy of the text
-                size_t textLen = strlen(text);
-                char* textCopy = (char*)malloc(textLen + 1);
-                if (!textCopy) {
-                    EndScissorMode();
-                    break;
-                }
-                strcpy(textCopy, text);
-                
-                // Word wrapping implementation
-                float x = component->bounds.x;
-                float y = component->bounds.y - data->scrollPosition;
-                float maxWidth = component->bounds.width - (data->scrollable ? data->scrollbarWidth + 5 : 0);
-                
-                // Reset content height for calculation
-                data->contentHeight = lineHeight; // Start with height of one line
-                
-                char* token = strtok(textCopy, " \n");
-                char line[1024] = {0};
-                
-                while (token) {
-                    // Handle explicit newlines in token
-                    if (strchr(token, '\n')) {
-                        char* newlinePtr = strchr(token, '\n');
-                        *newlinePtr = '\0';
-                        
-                        // Add current token to line
-                        char tempLine[1024];
-                        if (strlen(line) > 0) {
-                            sprintf(tempLine, "%s %s", line, token);
-                        } else {
-                            sprintf(tempLine, "%s", token);
-                        }
-                        
-                        // Draw current line
-                        if (y + lineHeight > component->bounds.y && y < component->bounds.y + component->bounds.height) {
-                            DrawTextEx(GetFontDefault(), line, (Vector2){x, y}, fontSize, 1.0f, data->textColor);
-                        }
-                        
-                        // Move to next line
-                        y += lineHeight;
-                        data->contentHeight += lineHeight;
-                        line[0] = '\0';
-                        
-                        // Process remainder after newline
-                        token = newlinePtr + 1;
-                        if (!*token) {
-                            token = strtok(NULL, " \n");
-                        }
-                        continue;
-                    }
-                    
-                    // Check if adding this token exceeds the max width
-                    char testLine[1024];
-                    if (strlen(line) > 0) {
-                        sprintf(testLine, "%s %s", line, token);
-                    } else {
-                        sprintf(testLine, "%s", token);
-                    }
-                    
-                    int textWidth = MeasureText(testLine, fontSize);
-                    
-                    if (textWidth > maxWidth && strlen(line) > 0) {
-                        // Draw current line and move to next line
-                        if (y + lineHeight > component->bounds.y && y < component->bounds.y + component->bounds.height) {
-                            DrawTextEx(GetFontDefault(), line, (Vector2){x, y}, fontSize, 1.0f, data->textColor);
-                        }
-                        
-                        y += lineHeight;
-                        data->contentHeight += lineHeight;
-                        strcpy(line, token);
-                    } else {
-                        // Add token to current line
-                        if (strlen(line) > 0) {
-                            strcat(line, " ");
-                            strcat(line, token);
-                        } else {
-                            strcpy(line, token);
-                        }
-                    }
-                    
-                    token = strtok(NULL, " \n");
-                    
-                    // If this was the last token, draw the final line
-                    if (!token && strlen(line) > 0) {
-                        if (y + lineHeight > component->bounds.y && y < component->bounds.y + component->bounds.height) {
-                            DrawTextEx(GetFontDefault(), line, (Vector2){x, y}, fontSize, 1.0f, data->textColor);
-                        }
-                        // Only increment height if we actually added lines beyond the first
-                        // The last line's height is implicitly covered by the initial lineHeight assignment
-                        // and the increments within the loop.
-                    }
-                }
-                
-                // Draw scrollbar if content exceeds bounds
-                if (data->scrollable && data->contentHeight > component->bounds.height) {
-                    Rectangle scrollbarBg = {
-                        component->bounds.x + component->bounds.width - data->scrollbarWidth,
-                        component->bounds.y,
-                        data->scrollbarWidth,
-                        component->bounds.height
-                    };
-                    DrawRectangleRec(scrollbarBg, ColorAlpha(data->scrollbarColor, 0.2f));
-                    
-                    // Calculate scrollbar height and position
-                    float scrollRatio = component->bounds.height / data->contentHeight;
-                    float scrollbarHeight = component->bounds.height * scrollRatio;
-                    float scrollbarY = component->bounds.y + (data->scrollPosition / data->contentHeight) * component->bounds.height;
-                    
-                    // Ensure scrollbar doesn't go out of bounds
-                    if (scrollbarY + scrollbarHeight > component->bounds.y + component->bounds.height) {
-                        scrollbarY = component->bounds.y + component->bounds.height - scrollbarHeight;
-                    }
-                    
-                    Rectangle scrollbar = {
-                        component->bounds.x + component->bounds.width - data->scrollbarWidth,
-                        scrollbarY,
-                        data->scrollbarWidth,
-                        scrollbarHeight
-                    };
-                    DrawRectangleRec(scrollbar, data->scrollbarColor);
-                    
-                    // Handle scrolling with mouse wheel
-                    if (IsComponentHovered(component)) {
-                        float wheel = GetMouseWheelMove();
+            // Measure through the scratch buffer, which AddPlacedWord sized for this word
+            if (!AddPlacedWord(layout, word)) return;
+            RayDialPlacedWord* placed = &layout->words[layout->wordCount - 1];
+            float width = MeasureTextEx(GetFontDefault(), GetPlacedWordText(layout, placed, -1), placed->fontSize, 1.0f).x;
+            
+            float gap = (pendingSpace && x > 0.0f) ? spaceWidth : 0.0f;
+            if (x > 0.0f && x + gap + width > layout->maxWidth) {
+                x = 0.0f;
+                y += layout->lineHeight;
+                gap = 0.0f;
+            }
+            placed->x = x + gap;
+            placed->y = y;
+            x = placed->x + width;
+            pendingSpace = false;
+        }
+    }
+}
+
+static struct RayDialStyledLayout* UpdateStyledLayout(RayDialPortraitDialogueData* data, float maxWidth) {
+    if (!data->styledLayout) {
+        data->styledLayout = (struct RayDialStyledLayout*)calloc(1, sizeof(struct RayDialStyledLayout));
+        if (!data->styledLayout) return NULL;
+        data->styledLayout->dirty = true;
+    }
+    
+    struct RayDialStyledLayout* layout = data->styledLayout;
+    if (layout->dirty || layout->segments != data->styledText || layout->maxWidth != maxWidth ||
+        layout->baseFontSize != (float)data->fontSize) {
+        layout->segments = data->styledText;
+        layout->maxWidth = maxWidth;
+        layout->baseFontSize = (float)data->fontSize;
+        layout->dirty = false;
+        BuildStyledLayout(layout, data->styledText);
+    }
+    return layout;
+}
+
+static void FreeStyledLayout(struct RayDialStyledLayout* layout) {
+    if (!layout) return;
+    free(layout->words);
+    free(layout->scratch);
+    free(layout);
+}
+
+// Last placed word starting at or before a character index (binary search)
+static int FindPlacedWord(const struct RayDialStyledLayout* layout, int glyph) {
+    int low = 0;
+    int high = layout->wordCount - 1;
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (layout->words[mid].glyphStart <= glyph) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+// Draw the placed words inside the text area, up to the reveal limit, and return
+// how many were drawn. Words are ordered top to bottom, so the first visible one is
+// found by binary search.
+static int DrawStyledLayout(struct RayDialStyledLayout* layout, Rectangle textArea, Color defaultColor, int revealLimit, bool followReveal) {
+    if (layout->wordCount == 0) return 0;
+    
+    // While revealing, scroll whole lines so the word being typed stays in view
+    float scroll = 0.0f;
+    if (followReveal && revealLimit > 0) {
+        const RayDialPlacedWord* typing = &layout->words[FindPlacedWord(layout, revealLimit - 1)];
+        int fullLines = (int)(textArea.height / layout->lineHeight);
+        if (fullLines < 1) fullLines = 1;
+        int typingLine = (int)(typing->y / layout->lineHeight + 0.5f);
+        if (typingLine >= fullLines) scroll = (typingLine - fullLines + 1) * layout->lineHeight;
+    }
+    
+    int low = 0;
+    int high = layout->wordCount;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (layout->words[mid].y + layout->lineHeight <= scroll) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    int i = low;
+    for (; i < layout->wordCount; i++) {
+        const RayDialPlacedWord* word = &layout->words[i];
+        if (word->glyphStart >= revealLimit || word->y - scroll >= textArea.height) break;
+        
+        int maxGlyphs = revealLimit - word->glyphStart < word->glyphCount ? revealLimit - word->glyphStart : -1;
+        DrawTextEx(GetFontDefault(), GetPlacedWordText(layout, word, maxGlyphs),
+                   (Vector2){ textArea.x + word->x, textArea.y + word->y - scroll },
+                   word->fontSize, 1.0f, word->defaultColor ? defaultColor : word->color);
+    }
+    return i - low;
+}
+
+// Line index for a wrapped label, rebuilt only when the text, width or font size
+// changes. Words are measured the way MeasureText measures a whole line, so the
+// wrapping matches what the label drew before it cached anything.
+static RayDialTextLayout* UpdateLabelLayout(RayDialComponent* component) {
+    RayDialLabelData* data = (RayDialLabelData*)component->data;
+    if (!data->layout) {
+        data->layout = (RayDialTextLayout*)calloc(1, sizeof(RayDialTextLayout));
+        if (!data->layout) return NULL;
+    }
+    
+    // Unwrapped labels only get a layout while a typewriter runs; they break at newlines only
+    float maxWidth = data->wrapText ? component->bounds.width - (data->scrollable ? data->scrollbarWidth + 5 : 0) : FLT_MAX;
+    float measureSize = data->fontSize < 10 ? 10.0f : (float)data->fontSize;
+    if (UpdateTextLayout(data->layout, data->text, maxWidth, data->fontSize, measureSize / 10.0f)) {
+        int lines = data->layout->lineCount > 0 ? data->layout->lineCount : 1;
+        data->contentHeight = lines * data->fontSize * 1.5f;
+        data->typewriter.source = NULL;     // The text may have changed under the reveal
+    }
+    return data->layout;
+}
+
+// Bring the prefix sums of row heights up to date. rowOffsets[i] is the top of
+// row i relative to the content origin and rowOffsets[rowCount] is the content height.
+// Only rows from the first changed one onwards are recomputed.
+static void UpdateScrollAreaLayout(RayDialScrollAreaData* data) {
+    if (data->firstDirtyRow >= data->rowCount + 1 || !data->rowOffsets) return;
+    
+    int i = data->firstDirtyRow;
+    if (i == 0) {
+        data->rowOffsets[0] = 0.0f;
+        i = 1;
+    }
+    for (; i <= data->rowCount; i++) {
+        data->rowOffsets[i] = data->rowOffsets[i - 1] + data->rows[i - 1]->bounds.height + data->rowSpacing;
+    }
+    data->firstDirtyRow = data->rowCount + 1;
+    
+    if (data->rowCount > 0) {
+        data->contentHeight = data->rowOffsets[data->rowCount] - data->rowSpacing;
+    }
+}
+
+static float GetMaxScroll(RayDialComponent* component) {
+    RayDialScrollAreaData* data = (RayDialScrollAreaData*)component->data;
+    return fmaxf(0.0f, data->contentHeight - component->bounds.height);
+}
+
+// Find the rows intersecting the viewport: a binary search for the first one,
+// then a walk that stops at the bottom edge, so the cost is O(log n + visible)
+static void FindVisibleRows(RayDialComponent* component) {
+    RayDialScrollAreaData* data = (RayDialScrollAreaData*)component->data;
+    UpdateScrollAreaLayout(data);
+    
+    float top = data->scrollPosition;
+    float bottom = top + component->bounds.height;
+    
+    int low = 0;
+    int high = data->rowCount;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (data->rowOffsets[mid] + data->rows[mid]->bounds.height <= top) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    int last = low;
+    while (last < data->rowCount && data->rowOffsets[last] < bottom) last++;
+    
+    data->firstVisibleRow = low;
+    data->visibleRowCount = last - low;
+}
+
+// Move a row (and any components chained after it) to its place in the viewport
+static void PlaceScrollAreaRow(RayDialComponent* component, int index) {
+    RayDialScrollAreaData* data = (RayDialScrollAreaData*)component->data;
+    RayDialComponent* row = data->rows[index];
+    
+    float dx = component->bounds.x - row->bounds.x;
+    float dy = component->bounds.y + data->rowOffsets[index] - data->scrollPosition - row->bounds.y;
+    if (dx == 0.0f && dy == 0.0f) return;
+    
+    for (RayDialComponent* part = row; part; part = part->next) {
+        part->bounds.x += dx;
+        part->bounds.y += dy;
+    }
+}
+
+static void UpdateScrollArea(RayDialComponent* component) {
+    RayDialScrollAreaData* data = (RayDialScrollAreaData*)component->data;
+    UpdateScrollAreaLayout(data);
+    
+    if (IsComponentHovered(component)) {
+        data->scrollTarget -= GetInputMouseWheelMove() * RAYDIAL_SCROLL_LINE_STEP;
+        
+        if (IsInputKeyPressed(KEY_UP) || IsInputKeyPressedRepeat(KEY_UP)) data->scrollTarget -= RAYDIAL_SCROLL_LINE_STEP;
+        if (IsInputKeyPressed(KEY_DOWN) || IsInputKeyPressedRepeat(KEY_DOWN)) data->scrollTarget += RAYDIAL_SCROLL_LINE_STEP;
+        if (IsInputKeyPressed(KEY_PAGE_UP)) data->scrollTarget -= component->bounds.height;
+        if (IsInputKeyPressed(KEY_PAGE_DOWN)) data->scrollTarget += component->bounds.height;
+        if (IsInputKeyPressed(KEY_HOME)) data->scrollTarget = 0.0f;
+        if (IsInputKeyPressed(KEY_END)) data->scrollTarget = GetMaxScroll(component);
+    }
+    
+    float maxScroll = GetMaxScroll(component);
+    data->scrollTarget = fminf(fmaxf(data->scrollTarget, 0.0f), maxScroll);
+    
+    // Ease towards the target so wheel and key steps glide instead of jumping
+    float distance = data->scrollTarget - data->scrollPosition;
+    if (fabsf(distance) < 0.5f) {
+        data->scrollPosition = data->scrollTarget;
+    } else {
+        data->scrollPosition += distance * fminf(1.0f, GetInputFrameTime() * RAYDIAL_SCROLL_SMOOTHING);
+    }
+    
+    // Only rows in view receive input
+    FindVisibleRows(component);
+    for (int i = data->firstVisibleRow; i < data->firstVisibleRow + data->visibleRowCount; i++) {
+        PlaceScrollAreaRow(component, i);
+        UpdateComponent(data->rows[i]);
+    }
+}
+
+static void DrawScrollArea(RayDialComponent* component) {
+    RayDialScrollAreaData* data = (RayDialScrollAreaData*)component->data;
+    Rectangle bounds = component->bounds;
+    
+    if (data->backgroundColor.a > 0) {
+        DrawRectangleRec(bounds, data->backgroundColor);
+    }
+    
+    FindVisibleRows(component);
+    
+    BeginScissorMode(bounds.x, bounds.y, bounds.width, bounds.height);
+    for (int i = data->firstVisibleRow; i < data->firstVisibleRow + data->visibleRowCount; i++) {
+        PlaceScrollAreaRow(component, i);
+        DrawComponent(data->rows[i]);
+    }
+    EndScissorMode();
+    
+    // Scrollbar, drawn the same way as scrollable labels
+    if (data->contentHeight > bounds.height) {
+        Rectangle scrollbarBg = {
+            bounds.x + bounds.width - data->scrollbarWidth,
+            bounds.y,
+            data->scrollbarWidth,
+            bounds.height
+        };
+        DrawRectangleRec(scrollbarBg, ColorAlpha(data->scrollbarColor, 0.2f));
+        
+        float scrollbarHeight = fmaxf(bounds.height * (bounds.height / data->contentHeight), (float)data->scrollbarWidth);
+        float scrollbarY = bounds.y + (data->scrollPosition / GetMaxScroll(component)) * (bounds.height - scrollbarHeight);
+        Rectangle scrollbar = {
+            bounds.x + bounds.width - data->scrollbarWidth,
+            scrollbarY,
+            data->scrollbarWidth,
+            scrollbarHeight
+        };
+        DrawRectangleRec(scrollbar, data->scrollbarColor);
+    }
+}
+
+// History view. Every line of the backlog is a fixed number of rows, so an entry's
+// position follows from the row count the history keeps, and only entries in view
+// are ever read.
+static float GetHistoryEntryTop(const RayDialHistoryViewData* data, const RayDialHistoryEntry* entry) {
+    return (entry->firstLine - data->originLine) * data->fontSize * 1.5f;
+}
+
+static int GetHistoryEntryRows(const RayDialHistoryEntry* entry) {
+    return entry->lineCount + (entry->speaker ? 1 : 0);
+}
+
+static float GetHistoryContentHeight(const RayDialHistoryViewData* data) {
+    int count = GetDialogueHistoryCount(data->history);
+    if (count == 0) return 0.0f;
+    const RayDialHistoryEntry* last = GetDialogueHistoryEntry(data->history, count - 1);
+    return GetHistoryEntryTop(data, last) + GetHistoryEntryRows(last) * data->fontSize * 1.5f;
+}
+
+static float GetHistoryMaxScroll(RayDialComponent* component) {
+    RayDialHistoryViewData* data = (RayDialHistoryViewData*)component->data;
+    return fmaxf(0.0f, GetHistoryContentHeight(data) - component->bounds.height);
+}
+
+// Keep the view on the same lines when the oldest ones are dropped
+static void SyncHistoryViewOrigin(RayDialHistoryViewData* data) {
+    const RayDialHistoryEntry* oldest = GetDialogueHistoryEntry(data->history, 0);
+    long long origin = oldest ? oldest->firstLine : 0;
+    if (origin == data->originLine) return;
+    
+    float shift = (origin - data->originLine) * data->fontSize * 1.5f;
+    data->scrollPosition = fmaxf(0.0f, data->scrollPosition - shift);
+    data->scrollTarget = fmaxf(0.0f, data->scrollTarget - shift);
+    data->originLine = origin;
+}
+
+// Binary search for the first entry reaching below the top edge, then a walk to the bottom
+static void FindVisibleHistoryEntries(RayDialComponent* component) {
+    RayDialHistoryViewData* data = (RayDialHistoryViewData*)component->data;
+    int count = GetDialogueHistoryCount(data->history);
+    float top = data->scrollPosition;
+    float bottom = top + component->bounds.height;
+    float lineHeight = data->fontSize * 1.5f;
+    
+    int low = 0;
+    int high = count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        const RayDialHistoryEntry* entry = GetDialogueHistoryEntry(data->history, mid);
+        if (GetHistoryEntryTop(data, entry) + GetHistoryEntryRows(entry) * lineHeight <= top) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    int last = low;
+    while (last < count && GetHistoryEntryTop(data, GetDialogueHistoryEntry(data->history, last)) < bottom) last++;
+    
+    data->firstVisibleEntry = low;
+    data->visibleEntryCount = last - low;
+}
+
+static void UpdateHistoryView(RayDialComponent* component) {
+    RayDialHistoryViewData* data = (RayDialHistoryViewData*)component->data;
+    SyncHistoryViewOrigin(data);
+    
+    float maxScroll = GetHistoryMaxScroll(component);
+    if (data->followEnd) data->scrollTarget = maxScroll;
+    
+    if (IsComponentHovered(component)) {
+        data->scrollTarget -= GetInputMouseWheelMove() * RAYDIAL_SCROLL_LINE_STEP;
+        
+        if (IsInputKeyPressed(KEY_UP) || IsInputKeyPressedRepeat(KEY_UP)) data->scrollTarget -= RAYDIAL_SCROLL_LINE_STEP;
+        if (IsInputKeyPressed(KEY_DOWN) || IsInputKeyPressedRepeat(KEY_DOWN)) data->scrollTarget += RAYDIAL_SCROLL_LINE_STEP;
+        if (IsInputKeyPressed(KEY_PAGE_UP)) data->scrollTarget -= component->bounds.height;
+        if (IsInputKeyPressed(KEY_PAGE_DOWN)) data->scrollTarget += component->bounds.height;
+        if (IsInputKeyPressed(KEY_HOME)) data->scrollTarget = 0.0f;
+        if (IsInputKeyPressed(KEY_END)) data->scrollTarget = maxScroll;
+    }
+    
+    data->scrollTarget = fminf(fmaxf(data->scrollTarget, 0.0f), maxScroll);
+    data->followEnd = data->scrollTarget >= maxScroll - 0.5f;
+    
+    float distance = data->scrollTarget - data->scrollPosition;
+    if (fabsf(distance) < 0.5f) {
+        data->scrollPosition = data->scrollTarget;
+    } else {
+        data->scrollPosition += distance * fminf(1.0f, GetInputFrameTime() * RAYDIAL_SCROLL_SMOOTHING);
+    }
+    
+    FindVisibleHistoryEntries(component);
+}
+
+// Draw up to maxRows lines of text glyph by glyph, straight from the history's copy.
+// Glyphs past the right edge and rows past the bottom are skipped.
+static void DrawHistoryText(const char* text, Vector2 position, int maxRows, Rectangle clip,
+                            float fontSize, Color color) {
+    Font font = GetFontDefault();
+    float scale = font.baseSize > 0 ? fontSize / font.baseSize : 1.0f;
+    float spacing = fontSize / 10.0f;
+    float lineHeight = fontSize * 1.5f;
+    float x = position.x;
+    int row = 0;
+    
+    while (*text && position.y < clip.y + clip.height) {
+        int size = 0;
+        int codepoint = GetCodepointNext(text, &size);
+        text += size > 0 ? size : 1;
+        
+        if (codepoint == '\n') {
+            if (++row >= maxRows) break;
+            x = position.x;
+            position.y += lineHeight;
+            continue;
+        }
+        if (x > clip.x + clip.width) continue;
+        
+        if (codepoint != ' ' && codepoint != '\t') {
+            DrawTextCodepoint(font, codepoint, (Vector2){ x, position.y }, fontSize, color);
+        }
+        int index = GetGlyphIndex(font, codepoint);
+        float advance = 0.0f;
+        if (font.glyphs && font.glyphs[index].advanceX > 0) {
+            advance = (float)font.glyphs[index].advanceX;
+        } else if (font.recs) {
+            advance = font.recs[index].width;
+        }
+        x += advance * scale + spacing;
+    }
+}
+
+static const char* ResolveHistoryText(const RayDialHistoryViewData* data, const char* text, bool isKey) {
+    return isKey && data->i18n ? GetLocalizedText(data->i18n, text) : text;
+}
+
+static void DrawHistoryView(RayDialComponent* component) {
+    RayDialHistoryViewData* data = (RayDialHistoryViewData*)component->data;
+    Rectangle bounds = component->bounds;
+    float lineHeight = data->fontSize * 1.5f;
+    
+    if (data->backgroundColor.a > 0) {
+        DrawRectangleRec(bounds, data->backgroundColor);
+    }
+    
+    SyncHistoryViewOrigin(data);
+    FindVisibleHistoryEntries(component);
+    
+    Rectangle clip = { bounds.x, bounds.y, bounds.width - data->scrollbarWidth, bounds.height };
+    BeginScissorMode(bounds.x, bounds.y, bounds.width, bounds.height);
+    for (int i = data->firstVisibleEntry; i < data->firstVisibleEntry + data->visibleEntryCount; i++) {
+        const RayDialHistoryEntry* entry = GetDialogueHistoryEntry(data->history, i);
+        Vector2 position = { bounds.x, bounds.y + GetHistoryEntryTop(data, entry) - data->scrollPosition };
+        
+        if (entry->speaker) {
+            DrawHistoryText(ResolveHistoryText(data, entry->speaker, entry->speakerIsKey), position, 1, clip,
+                            data->fontSize, data->speakerColor);
+            position.y += lineHeight;
+        }
+        DrawHistoryText(ResolveHistoryText(data, entry->text, entry->textIsKey), position, entry->lineCount, clip,
+                        data->fontSize, data->textColor);
+    }
+    EndScissorMode();
+    
+    float contentHeight = GetHistoryContentHeight(data);
+    if (contentHeight > bounds.height) {
+        Rectangle scrollbarBg = {
+            bounds.x + bounds.width - data->scrollbarWidth,
+            bounds.y,
+            data->scrollbarWidth,
+            bounds.height
+        };
+        DrawRectangleRec(scrollbarBg, ColorAlpha(data->scrollbarColor, 0.2f));
+        
+        float scrollbarHeight = fmaxf(bounds.height * (bounds.height / contentHeight), (float)data->scrollbarWidth);
+        float scrollbarY = bounds.y + fminf(data->scrollPosition / GetHistoryMaxScroll(component), 1.0f) * (bounds.height - scrollbarHeight);
+        Rectangle scrollbar = {
+            bounds.x + bounds.width - data->scrollbarWidth,
+            scrollbarY,
+            data->scrollbarWidth,
+            scrollbarHeight
+        };
+        DrawRectangleRec(scrollbar, data->scrollbarColor);
+    }
+}
+
+// Rebuild the textbox glyph layout if the text or its appearance changed. Costs one
+// pass over the text per edited frame; caret and selection lookups are then O(log n).
+static void UpdateTextboxLayout(RayDialTextboxData* data) {
+    RayDialTextboxState* state = data->state;
+    RayDialTextEditor* editor = &state->editor;
+    if (state->layoutRevision == editor->revision && state->layoutFontSize == data->fontSize &&
+        state->layoutMasked == data->isPassword) {
+        return;
+    }
+    
+    int count = editor->characterCount;
+    if (count + 1 > state->glyphCapacity) {
+        int capacity = state->glyphCapacity ? state->glyphCapacity : 32;
+        while (capacity < count + 1) capacity *= 2;
+        int* bytes = (int*)realloc(state->glyphBytes, capacity * sizeof(int));
+        if (!bytes) return;
+        state->glyphBytes = bytes;
+        float* xs = (float*)realloc(state->glyphX, capacity * sizeof(float));
+        if (!xs) return;
+        state->glyphX = xs;
+        state->glyphCapacity = capacity;
+    }
+    if (data->isPassword && count + 1 > state->maskCapacity) {
+        int capacity = state->maskCapacity ? state->maskCapacity : 32;
+        while (capacity < count + 1) capacity *= 2;
+        char* mask = (char*)realloc(state->mask, capacity);
+        if (!mask) return;
+        memset(mask + state->maskCapacity, '*', capacity - state->maskCapacity);
+        state->mask = mask;
+        state->maskCapacity = capacity;
+    }
+    
+    // Same metrics DrawText uses: glyph widths plus fontSize/10 spacing between glyphs
+    int fontSize = data->fontSize < 10 ? 10 : data->fontSize;
+    float spacing = (float)(fontSize / 10);
+    float maskWidth = (float)MeasureText("*", data->fontSize) + spacing;
+    
+    int length = TextEditorLength(editor);
+    int position = 0;
+    float x = 0.0f;
+    int index = 0;
+    while (position < length && index < count) {
+        state->glyphBytes[index] = position;
+        state->glyphX[index] = x;
+        
+        int next = TextEditorNextBoundary(editor, position);
+        if (data->isPassword) {
+            x += maskWidth;
+        } else {
+            char glyph[8] = { 0 };
+            for (int i = position; i < next && i - position < 7; i++) glyph[i - position] = TextEditorByteAt(editor, i);
+            x += (float)MeasureText(glyph, data->fontSize) + spacing;
+        }
+        position = next;
+        index++;
+    }
+    state->glyphBytes[index] = length;
+    state->glyphX[index] = x;
+    state->glyphCount = index;
+    
+    state->layoutRevision = editor->revision;
+    state->layoutFontSize = data->fontSize;
+    state->layoutMasked = data->isPassword;
+}
+
+// Character index of a byte offset (offsets always sit on character boundaries)
+static int TextboxCharacterAt(const RayDialTextboxState* state, int byteOffset) {
+    int low = 0;
+    int high = state->glyphCount;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (state->glyphBytes[mid] < byteOffset) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Character boundary closest to an x offset from the start of the text
+static int TextboxBoundaryAt(const RayDialTextboxState* state, float x) {
+    int low = 0;
+    int high = state->glyphCount;
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (state->glyphX[mid] <= x) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    if (low < state->glyphCount && x - state->glyphX[low] > state->glyphX[low + 1] - x) low++;
+    return low;
+}
+
+static int TextboxHitTest(RayDialComponent* component, float mouseX) {
+    RayDialTextboxData* data = (RayDialTextboxData*)component->data;
+    UpdateTextboxLayout(data);
+    
+    float x = mouseX - component->bounds.x - RAYDIAL_TEXTBOX_PADDING + data->scrollOffset;
+    int index = TextboxBoundaryAt(data->state, x);
+    return data->state->glyphBytes[index];
+}
+
+// Scroll horizontally so the caret stays inside the box
+static void ScrollTextboxToCaret(RayDialComponent* component) {
+    RayDialTextboxData* data = (RayDialTextboxData*)component->data;
+    RayDialTextboxState* state = data->state;
+    UpdateTextboxLayout(data);
+    
+    float caretX = state->glyphX[TextboxCharacterAt(state, state->editor.cursor)];
+    float visibleWidth = component->bounds.width - 2 * RAYDIAL_TEXTBOX_PADDING;
+    if (caretX - data->scrollOffset > visibleWidth) {
+        data->scrollOffset = caretX - visibleWidth;
+    } else if (caretX < data->scrollOffset) {
+        data->scrollOffset = caretX;
+    }
+    
+    // Don't leave empty space on the right once text is deleted
+    float maxOffset = fmaxf(0.0f, state->glyphX[state->glyphCount] - visibleWidth);
+    if (data->scrollOffset > maxOffset) data->scrollOffset = maxOffset;
+}
+
+static bool IsTextboxKeyPressed(int key) {
+    return IsInputKeyPressed(key) || IsInputKeyPressedRepeat(key);
+}
+
+static void CopyTextboxSelection(RayDialTextboxData* data) {
+    // Copying out of a password box would defeat the mask
+    if (data->isPassword) return;
+    
+    RayDialTextEditor* editor = &data->state->editor;
+    int length = TextEditorCopySelection(editor, NULL, 0);
+    if (length == 0) return;
+    
+    char* selection = (char*)malloc(length + 1);
+    if (!selection) return;
+    TextEditorCopySelection(editor, selection, length + 1);
+    SetInputClipboardText(selection);
+    free(selection);
+}
+
+static void UpdateTextbox(RayDialComponent* component) {
+    RayDialTextboxData* data = (RayDialTextboxData*)component->data;
+    RayDialTextboxState* state = data->state;
+    RayDialTextEditor* editor = &state->editor;
+    bool shift = IsInputKeyDown(KEY_LEFT_SHIFT) || IsInputKeyDown(KEY_RIGHT_SHIFT);
+    bool control = IsInputKeyDown(KEY_LEFT_CONTROL) || IsInputKeyDown(KEY_RIGHT_CONTROL);
+    
+    // Clicking inside focuses and places the caret; clicking elsewhere blurs
+    Vector2 mouse = GetInputMousePosition();
+    if (IsInputMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+        data->hasFocus = CheckCollisionPointRec(mouse, component->bounds);
+        state->selecting = data->hasFocus;
+        if (data->hasFocus) {
+            TextEditorSetCursor(editor, TextboxHitTest(component, mouse.x), shift);
+        }
+    } else if (state->selecting) {
+        if (IsInputMouseButtonDown(MOUSE_LEFT_BUTTON)) {
+            TextEditorSetCursor(editor, TextboxHitTest(component, mouse.x), true);
+        } else {
+            state->selecting = false;
+        }
+    }
+    
+    if (!data->hasFocus) return;
+    
+    // Typed characters arrive as codepoints and are stored as UTF-8
+    int codepoint = GetInputCharPressed();
+    while (codepoint > 0) {
+        if (codepoint >= 32) {
+            int size = 0;
+            const char* utf8 = CodepointToUTF8(codepoint, &size);
+            TextEditorInsert(editor, utf8, size, data->maxLength);
+        }
+        codepoint = GetInputCharPressed();
+    }
+    
+    if (IsTextboxKeyPressed(KEY_BACKSPACE)) TextEditorDelete(editor, false);
+    if (IsTextboxKeyPressed(KEY_DELETE)) TextEditorDelete(editor, true);
+    
+    if (IsTextboxKeyPressed(KEY_LEFT)) {
+        int start = editor->cursor < editor->anchor ? editor->cursor : editor->anchor;
+        if (TextEditorHasSelection(editor) && !shift) {
+            TextEditorSetCursor(editor, start, false);
+        } else {
+            TextEditorSetCursor(editor, TextEditorPreviousBoundary(editor, editor->cursor), shift);
+        }
+    }
+    if (IsTextboxKeyPressed(KEY_RIGHT)) {
+        int end = editor->cursor > editor->anchor ? editor->cursor : editor->anchor;
+        if (TextEditorHasSelection(editor) && !shift) {
+            TextEditorSetCursor(editor, end, false);
+        } else {
+            TextEditorSetCursor(editor, TextEditorNextBoundary(editor, editor->cursor), shift);
+        }
+    }
+    if (IsInputKeyPressed(KEY_HOME)) TextEditorSetCursor(editor, 0, shift);
+    if (IsInputKeyPressed(KEY_END)) TextEditorSetCursor(editor, TextEditorLength(editor), shift);
+    
+    if (control) {
+        if (IsInputKeyPressed(KEY_A)) {
+            TextEditorSetCursor(editor, 0, false);
+            TextEditorSetCursor(editor, TextEditorLength(editor), true);
+        }
+        if (IsInputKeyPressed(KEY_C)) CopyTextboxSelection(data);
+        if (IsInputKeyPressed(KEY_X) && !data->isPassword) {
+            CopyTextboxSelection(data);
+            TextEditorDelete(editor, false);
+        }
+        if (IsInputKeyPressed(KEY_V)) {
+            const char* clipboard = GetInputClipboardText();
+            if (clipboard) {
+                // Single-line box: paste up to the first line break
+                int length = (int)strcspn(clipboard, "\r\n");
+                TextEditorInsert(editor, clipboard, length, data->maxLength);
+            }
+        }
+    }
+    
+    SyncTextboxText(data);
+    
+    // Enter submits through the component callback
+    if (IsInputKeyPressed(KEY_ENTER) && component->onClick) {
+        component->onClick(component->userData);
+    }
+    
+    ScrollTextboxToCaret(component);
+}
+
+static void DrawTextbox(RayDialComponent* component) {
+    RayDialTextboxData* data = (RayDialTextboxData*)component->data;
+    RayDialTextboxState* state = data->state;
+    RayDialTextEditor* editor = &state->editor;
+    Rectangle bounds = component->bounds;
+    
+    DrawRectangleRec(bounds, data->backgroundColor);
+    DrawRectangleLinesEx(bounds, 1, data->hasFocus ? data->focusColor : data->borderColor);
+    
+    UpdateTextboxLayout(data);
+    
+    BeginScissorMode(bounds.x + 1, bounds.y + 1, bounds.width - 2, bounds.height - 2);
+    
+    float x = bounds.x + RAYDIAL_TEXTBOX_PADDING - data->scrollOffset;
+    float y = bounds.y + (bounds.height - data->fontSize) / 2;
+    
+    // Selection highlight sits behind the text
+    if (data->hasFocus && TextEditorHasSelection(editor)) {
+        float from = state->glyphX[TextboxCharacterAt(state, editor->cursor)];
+        float to = state->glyphX[TextboxCharacterAt(state, editor->anchor)];
+        DrawRectangle((int)(x + fminf(from, to)), (int)y, (int)fabsf(to - from), data->fontSize, data->selectionColor);
+    }
+    
+    if (data->isPassword) {
+        if (state->glyphCount > 0 && state->maskCapacity > state->glyphCount) {
+            // Terminate the reusable mask in place instead of building a string each frame
+            state->mask[state->glyphCount] = '\0';
+            DrawText(state->mask, (int)x, (int)y, data->fontSize, data->textColor);
+            state->mask[state->glyphCount] = '*';
+        }
+    } else {
+        // Both sides of the gap are terminated in place, so no copy is needed
+        float gapX = state->glyphX[TextboxCharacterAt(state, editor->gapStart)];
+        DrawText(TextEditorBeforeGap(editor), (int)x, (int)y, data->fontSize, data->textColor);
+        DrawText(TextEditorAfterGap(editor), (int)(x + gapX), (int)y, data->fontSize, data->textColor);
+    }
+    
+    // Blinking caret
+    if (data->hasFocus && fmod(GetInputTime(), 1.0) < 0.5) {
+        float caretX = state->glyphX[TextboxCharacterAt(state, editor->cursor)];
+        DrawRectangle((int)(x + caretX), (int)y, 2, data->fontSize, data->textColor);
+    }
+    
+    EndScissorMode();
+}
+
+static void FormatLabelVariables(RayDialLabelData* data);
+
+// Re-resolve localized strings once the translations they came from have changed.
+// Labels bound to variables are reformatted after a variable they show changed.
+// Reloaded tables are only kept alive for a short grace period, so this must run
+// before any borrowed localized pointer is used.
+static void RefreshLocalizedComponent(RayDialComponent* component) {
+    switch (component->type) {
+        case RAYDIAL_BUTTON: {
+            RayDialButtonData* data = (RayDialButtonData*)component->data;
+            if (data->textKey && data->i18nGeneration != GetI18NGeneration(data->i18n)) {
+                SetLocalizedButtonText(component, data->textKey, data->i18n);
+            }
+            break;
+        }
+        case RAYDIAL_LABEL: {
+            RayDialLabelData* data = (RayDialLabelData*)component->data;
+            if (data->textKey && data->i18nGeneration != GetI18NGeneration(data->i18n)) {
+                // A reload swaps the text under a running reveal rather than restarting it
+                RayDialTypewriter typewriter = data->typewriter;
+                SetLocalizedLabelText(component, data->textKey, data->i18n);
+                KeepTypewriterReveal(&data->typewriter, &typewriter);
+            }
+            if (data->variableText && VariableTextChangedSince(data->variableText, data->variables, data->variableVersion)) {
+                FormatLabelVariables(data);
+            }
+            break;
+        }
+        case RAYDIAL_PORTRAIT_DIALOGUE: {
+            RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
+            if (!data->i18n || data->i18nGeneration == GetI18NGeneration(data->i18n)) break;
+            
+            RayDialI18N* i18n = data->i18n;
+            RayDialTypewriter typewriter = data->typewriter;
+            if (data->speakerNameKey) {
+                SetLocalizedPortraitDialogueSpeaker(component, data->speakerNameKey, i18n);
+            }
+            if (data->dialogueTextKey) {
+                if (data->dialogueKeyStyled) {
+                    SetLocalizedPortraitDialogueStyledText(component, data->dialogueTextKey, i18n);
+                } else {
+                    SetLocalizedPortraitDialogueText(component, data->dialogueTextKey, i18n);
+                }
+            }
+            KeepTypewriterReveal(&data->typewriter, &typewriter);
+            data->i18nGeneration = GetI18NGeneration(i18n);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void UpdateComponent(RayDialComponent* component) {
+    if (!component || !component->visible || !component->enabled) return;
+    
+    RefreshLocalizedComponent(component);
+    
+    switch (component->type) {
+        case RAYDIAL_BUTTON: {
+            // Only trigger onClick if component is actually clicked this frame
+            if (IsComponentClicked(component) && component->onClick) {
+                InvokeCallback(component->onClick, component->userData);
+            }
+            break;
+        }
+        case RAYDIAL_LABEL: {
+            RayDialLabelData* data = (RayDialLabelData*)component->data;
+            
+            // Handle keyboard scrolling if this component is hovered
+            if (data->scrollable && data->contentHeight > 0 && IsComponentHovered(component)) {
+                float scrollSpeed = 10.0f;
+                
+                // Up/Down arrow keys for scrolling
+                if (IsInputKeyDown(KEY_UP)) {
+                    data->scrollPosition -= scrollSpeed;
+                } else if (IsInputKeyDown(KEY_DOWN)) {
+                    data->scrollPosition += scrollSpeed;
+                } else if (IsInputKeyDown(KEY_PAGE_UP)) {
+                    data->scrollPosition -= component->bounds.height / 2;
+                } else if (IsInputKeyDown(KEY_PAGE_DOWN)) {
+                    data->scrollPosition += component->bounds.height / 2;
+                }
+                
+                // Clamp scroll position
+                if (data->scrollPosition < 0) {
+                    data->scrollPosition = 0;
+                } else if (data->scrollPosition > fmaxf(0, data->contentHeight - component->bounds.height)) {
+                    data->scrollPosition = fmaxf(0, data->contentHeight - component->bounds.height);
+                }
+            }
+            
+            UpdateTypewriter(&data->typewriter, data->text);
+            break;
+        }
+        case RAYDIAL_TEXTBOX: {
+            // Typing consumes raylib's input queue, which only the main thread may do
+            if (deferredEvents) {
+                DeferEvent((RayDialDeferredEvent){ .kind = RAYDIAL_DEFERRED_TEXTBOX, .component = component });
+            } else {
+                UpdateTextbox(component);
+            }
+            break;
+        }
+        case RAYDIAL_SCROLLAREA: {
+            UpdateScrollArea(component);
+            break;
+        }
+        case RAYDIAL_HISTORY_VIEW: {
+            UpdateHistoryView(component);
+            break;
+        }
+        case RAYDIAL_PORTRAIT_DIALOGUE: {
+            RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
+            UpdateTypewriter(&data->typewriter, data->dialogueText);
+            UpdatePortraitFlipbook(data);
+            break;
+        }
+        default:
+            break;
+    }
+    
+    // Update child components
+    RayDialComponent* child = component->next;
+    while (child) {
+        UpdateComponent(child);
+        child = child->next;
+    }
+}
+
+// Nine-slice frames. The 4x4 grid of screen and texture coordinates is only
+// rebuilt when the bounds or the slice change; drawing emits the nine quads in
+// a single rlBegin block on one texture.
+static void SetFrameSlice(RayDialFrame* frame, RayDialNineSlice slice) {
+    frame->slice = slice;
+    frame->enabled = slice.region.texture.id != 0;
+    frame->dirty = true;
+}
+
+static void BuildFrameGrid(RayDialFrame* frame, Rectangle bounds) {
+    const RayDialNineSlice* slice = &frame->slice;
+    Rectangle source = slice->region.source;
+    float textureWidth = (float)slice->region.texture.width;
+    float textureHeight = (float)slice->region.texture.height;
+    
+    // Borders shrink together when the bounds are smaller than both of them
+    float left = slice->left;
+    float right = slice->right;
+    float top = slice->top;
+    float bottom = slice->bottom;
+    float scaleX = left + right > bounds.width && left + right > 0 ? bounds.width / (left + right) : 1.0f;
+    float scaleY = top + bottom > bounds.height && top + bottom > 0 ? bounds.height / (top + bottom) : 1.0f;
+    
+    frame->x[0] = bounds.x;
+    frame->x[1] = bounds.x + left * scaleX;
+    frame->x[2] = bounds.x + bounds.width - right * scaleX;
+    frame->x[3] = bounds.x + bounds.width;
+    frame->y[0] = bounds.y;
+    frame->y[1] = bounds.y + top * scaleY;
+    frame->y[2] = bounds.y + bounds.height - bottom * scaleY;
+    frame->y[3] = bounds.y + bounds.height;
+    
+    frame->u[0] = source.x / textureWidth;
+    frame->u[1] = (source.x + left) / textureWidth;
+    frame->u[2] = (source.x + source.width - right) / textureWidth;
+    frame->u[3] = (source.x + source.width) / textureWidth;
+    frame->v[0] = source.y / textureHeight;
+    frame->v[1] = (source.y + top) / textureHeight;
+    frame->v[2] = (source.y + source.height - bottom) / textureHeight;
+    frame->v[3] = (source.y + source.height) / textureHeight;
+    
+    frame->bounds = bounds;
+    frame->dirty = false;
+}
+
+static void DrawNineSliceFrame(RayDialFrame* frame, Rectangle bounds) {
+    if (frame->dirty || frame->bounds.x != bounds.x || frame->bounds.y != bounds.y ||
+        frame->bounds.width != bounds.width || frame->bounds.height != bounds.height) {
+        BuildFrameGrid(frame, bounds);
+    }
+    
+    Color tint = frame->slice.tint;
+    rlCheckRenderBatchLimit(9 * 4);
+    rlSetTexture(frame->slice.region.texture.id);
+    rlBegin(RL_QUADS);
+    rlColor4ub(tint.r, tint.g, tint.b, tint.a);
+    for (int row = 0; row < 3; row++) {
+        for (int column = 0; column < 3; column++) {
+            // Counter-clockwise from the top left, like raylib's own quads
+            rlTexCoord2f(frame->u[column], frame->v[row]);
+            rlVertex2f(frame->x[column], frame->y[row]);
+            rlTexCoord2f(frame->u[column], frame->v[row + 1]);
+            rlVertex2f(frame->x[column], frame->y[row + 1]);
+            rlTexCoord2f(frame->u[column + 1], frame->v[row + 1]);
+            rlVertex2f(frame->x[column + 1], frame->y[row + 1]);
+            rlTexCoord2f(frame->u[column + 1], frame->v[row]);
+            rlVertex2f(frame->x[column + 1], frame->y[row]);
+        }
+    }
+    rlEnd();
+    rlSetTexture(0);
+}
+
+void DrawComponent(RayDialComponent* component) {
+    if (!component || !component->visible) return;
+    
+    RefreshLocalizedComponent(component);
+    
+    switch (component->type) {
+        case RAYDIAL_BUTTON: {
+            RayDialButtonData* data = (RayDialButtonData*)component->data;
+            bool isHovered = IsComponentHovered(component);
+            
+            // Draw button background
+            DrawRectangleRec(component->bounds, 
+                isHovered ? data->hoverColor : data->backgroundColor);
+            
+            // Draw button text
+            int textWidth = MeasureText(data->text, data->fontSize);
+            int textX = component->bounds.x + (component->bounds.width - textWidth) / 2;
+            int textY = component->bounds.y + (component->bounds.height - data->fontSize) / 2;
+            DrawText(data->text, textX, textY, data->fontSize, data->textColor);
+            break;
+        }
+        case RAYDIAL_LABEL: {
+            RayDialLabelData* data = (RayDialLabelData*)component->data;
+            
+            // Define scissor rectangle for clipping text to bounds
+            Rectangle scissorRect = component->bounds;
+            BeginScissorMode(scissorRect.x, scissorRect.y, scissorRect.width, scissorRect.height);
+            
+            // Get text properties
+            int fontSize = data->fontSize;
+            float lineHeight = fontSize * 1.5f;
+            
+            // Draw text based on wrapping setting (a running typewriter also needs the line layout)
+            if (data->wrapText || data->typewriter.enabled) {
+                RayDialTextLayout* layout = UpdateLabelLayout(component);
+                if (!layout) {
+                    EndScissorMode();
+                    break;
+                }
+                
+                // Every line has the same height, so the visible band maps straight
+                // to a range of the line index and only those lines are touched
+                int firstLine = 0;
+                int lineCount = GetLabelVisibleLines(component, &firstLine);
+                Vector2 position = { component->bounds.x, component->bounds.y - data->scrollPosition + firstLine * lineHeight };
+                DrawTextLayoutLines(layout, firstLine, lineCount, position, lineHeight, fontSize, 1.0f,
+                                    data->textColor, GetRevealLimit(&data->typewriter));
+                
+                // Draw scrollbar if content exceeds bounds
+                if (data->wrapText && data->scrollable && data->contentHeight > component->bounds.height) {
+                    Rectangle scrollbarBg = {
+                        component->bounds.x + component->bounds.width - data->scrollbarWidth,
+                        component->bounds.y,
+                        data->scrollbarWidth,
+                        component->bounds.height
+                    };
+                    DrawRectangleRec(scrollbarBg, ColorAlpha(data->scrollbarColor, 0.2f));
+                    
+                    // Calculate scrollbar height and position
+                    float scrollRatio = component->bounds.height / data->contentHeight;
+                    float scrollbarHeight = component->bounds.height * scrollRatio;
+                    float scrollbarY = component->bounds.y + (data->scrollPosition / data->contentHeight) * component->bounds.height;
+                    
+                    // Ensure scrollbar doesn't go out of bounds
+                    if (scrollbarY + scrollbarHeight > component->bounds.y + component->bounds.height) {
+                        scrollbarY = component->bounds.y + component->bounds.height - scrollbarHeight;
+                    }
+                    
+                    Rectangle scrollbar = {
+                        component->bounds.x + component->bounds.width - data->scrollbarWidth,
+                        scrollbarY,
+                        data->scrollbarWidth,
+                        scrollbarHeight
+                    };
+                    DrawRectangleRec(scrollbar, data->scrollbarColor);
+                    
+                    // Handle scrolling with mouse wheel
+                    if (IsComponentHovered(component)) {
+                        float wheel = GetInputMouseWheelMove();
                         if (wheel != 0) {
                             data->scrollPosition -= wheel * 20;
                             
@@ -667,8 +1980,6 @@ void DrawComponent(RayDialComponent* component) {
                         }
                     }
                 }
-                
-                free(textCopy);
             } else {
                 // Draw non-wrapped text
                 DrawTextEx(GetFontDefault(), data->text, 
@@ -685,6 +1996,11 @@ void DrawComponent(RayDialComponent* component) {
         case RAYDIAL_PANEL: {
             RayDialPanelData* data = (RayDialPanelData*)component->data;
             
+            if (data->frame.enabled) {
+                DrawNineSliceFrame(&data->frame, component->bounds);
+                break;
+            }
+            
             // Draw panel background
             DrawRectangleRec(component->bounds, data->backgroundColor);
             
@@ -692,6 +2008,18 @@ void DrawComponent(RayDialComponent* component) {
             DrawRectangleLinesEx(component->bounds, data->borderWidth, data->borderColor);
             break;
         }
+        case RAYDIAL_TEXTBOX: {
+            DrawTextbox(component);
+            break;
+        }
+        case RAYDIAL_SCROLLAREA: {
+            DrawScrollArea(component);
+            break;
+        }
+        case RAYDIAL_HISTORY_VIEW: {
+            DrawHistoryView(component);
+            break;
+        }
         case RAYDIAL_PORTRAIT_DIALOGUE: {
             RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
             
@@ -710,15 +2038,30 @@ void DrawComponent(RayDialComponent* component) {
             Rectangle dialogueBox = component->bounds;
             
             // Draw dialogue box background
-            DrawRectangleRec(dialogueBox, data->dialogueBoxColor);
-            DrawRectangleLinesEx(dialogueBox, 2, DARKGRAY);
+            if (data->boxFrame.enabled) {
+                DrawNineSliceFrame(&data->boxFrame, dialogueBox);
+            } else {
+                DrawRectangleRec(dialogueBox, data->dialogueBoxColor);
+                DrawRectangleLinesEx(dialogueBox, 2, DARKGRAY);
+            }
             
             // Draw portrait (either color or texture)
             Rectangle portraitRect = { portraitX, portraitY, portraitSize, portraitSize };
-            if (data->useTexture) {
+            // A cached texture shows the placeholder color until its upload has happened
+            Texture2D portraitTexture = data->textureHandle ? GetHandleTexture(data->textureHandle) : data->portraitTexture;
+            Rectangle portraitSource = { 0, 0, portraitTexture.width, portraitTexture.height };
+            if (data->flipbook.frameCount > 0) {
+                const RayDialAtlasRegion* frame = &data->flipbook.frames[data->flipbook.currentFrame];
+                portraitTexture = frame->texture;
+                portraitSource = frame->source;
+            } else if (data->useAtlasRegion) {
+                portraitTexture = data->atlasRegion.texture;
+                portraitSource = data->atlasRegion.source;
+            }
+            if (data->useTexture && portraitTexture.id != 0) {
                 DrawTexturePro(
-                    data->portraitTexture,
-                    (Rectangle){ 0, 0, data->portraitTexture.width, data->portraitTexture.height },
+                    portraitTexture,
+                    portraitSource,
                     portraitRect,
                     (Vector2){ 0, 0 },
                     0.0f,
@@ -744,8 +2087,12 @@ void DrawComponent(RayDialComponent* component) {
                     };
                 }
                 
-                DrawRectangleRec(nameTagRect, data->nameTagColor);
-                DrawRectangleLinesEx(nameTagRect, 2, DARKGRAY);
+                if (data->nameTagFrame.enabled) {
+                    DrawNineSliceFrame(&data->nameTagFrame, nameTagRect);
+                } else {
+                    DrawRectangleRec(nameTagRect, data->nameTagColor);
+                    DrawRectangleLinesEx(nameTagRect, 2, DARKGRAY);
+                }
                 
                 // Draw speaker name
                 int nameWidth = MeasureText(data->speakerName, data->nameFontSize);
@@ -770,233 +2117,41 @@ void DrawComponent(RayDialComponent* component) {
                 BeginScissorMode(textArea.x, textArea.y, textArea.width, textArea.height);
                 
                 if (data->useStyledText && data->styledText) {
-                    // --- Draw Styled Text Segments (Corrected Implementation) --- 
-                    float currentX = textArea.x;
-                    float currentY = textArea.y;
-                    float baseFontSize = (float)data->fontSize;
-                    float lineHeight = baseFontSize * 1.5f;
-                    float spaceWidth = MeasureTextEx(GetFontDefault(), " ", baseFontSize, 1.0f).x; // Use default font for measurements
-                    float maxWidth = textArea.width;
-
-                    #define MAX_WORD_BUFFER_LIB 128 // Max chars for a single word buffer
-                    char wordBuffer[MAX_WORD_BUFFER_LIB];
-                    
-                    RayDialTextSegment* segment = data->styledText;
-                    while (segment) {
-                        // Determine style for this segment
-                        Color segmentColor = data->textColor; // Default from component data
-                        float segmentFontSize = baseFontSize; // Default from component data
-                        // TODO: Add bold/italic handling if GetFontDefault() variants are available or custom fonts are passed
-
-                        RayDialTextStyle* style = segment->styles;
-                        while (style) {
-                            if (style->type == RAYDIAL_TEXT_COLORED) {
-                                segmentColor = style->value.color;
-                            } else if (style->type == RAYDIAL_TEXT_SIZED) {
-                                segmentFontSize = style->value.fontSize;
-                            }
-                            // Add cases for bold/italic here if implemented
-                            style = style->next;
-                        }
-
-                        // Word wrapping logic adapted from example 7
-                        const char* textPtr = segment->text;
-                        while (textPtr && *textPtr) {
-                            // Handle explicit newlines first
-                            if (*textPtr == '\n') {
-                                currentX = textArea.x;
-                                currentY += lineHeight;
-                                textPtr++;
-                                continue; // Move to next character
-                            }
-
-                            // Find the next word or end of segment/newline
-                            const char* wordStart = textPtr;
-                            const char* wordEnd = wordStart;
-                            while (*wordEnd && *wordEnd != ' ' && *wordEnd != '\n') {
-                                wordEnd++;
-                            }
-                            
-                            int wordLen = wordEnd - wordStart;
-                            if (wordLen <= 0) { 
-                                if (*textPtr == ' ') { // Handle space separately
-                                   wordLen = 1;
-                                   wordEnd = textPtr + 1;
-                                } else {
-                                   break; // End of segment or unexpected state
-                                }
-                            }
-                            if (wordLen >= MAX_WORD_BUFFER_LIB) wordLen = MAX_WORD_BUFFER_LIB - 1; 
-
-                            // Copy word to buffer
-                            strncpy(wordBuffer, wordStart, wordLen);
-                            wordBuffer[wordLen] = '\0';
-
-                            // Measure the word with its style using the default font
-                            Vector2 wordSize = MeasureTextEx(GetFontDefault(), wordBuffer, segmentFontSize, 1.0f);
-
-                            // Check if word fits on the current line
-                            // Add space width if the current line isn't empty (currentX > textArea.x)
-                            float effectiveWordWidth = wordSize.x + (currentX > textArea.x ? spaceWidth : 0);
-
-                            if (currentX > textArea.x && currentX + wordSize.x > textArea.x + maxWidth) {
-                                // Doesn't fit, move to the next line
-                                currentX = textArea.x;
-                                currentY += lineHeight;
-                                // Recheck vertical bounds after line break
-                                if (currentY >= textArea.y + textArea.height) break; 
-                            }
-
-                            // Add space if not the first word on the line
-                            if (currentX > textArea.x) {
-                                currentX += spaceWidth;
-                            }
-
-                            // Draw the word if within vertical bounds
-                            if (currentY + segmentFontSize > textArea.y && currentY < textArea.y + textArea.height) {
-                                DrawTextEx(GetFontDefault(), wordBuffer, 
-                                           (Vector2){currentX, currentY}, 
-                                           segmentFontSize, 1.0f, segmentColor);
-                            }
-
-                            currentX += wordSize.x; // Advance position
-                            textPtr = wordEnd; // Move pointer to start of next word/char
-                            
-                            // Skip trailing space if we copied one
-                            if (*textPtr == ' ') textPtr++;
+                    // Styled runs are parsed once when the text is set and placed once
+                    // per width, so a frame only draws the words in view
+                    struct RayDialStyledLayout* layout = UpdateStyledLayout(data, textArea.width);
+                    data->styledWordsDrawn = layout ? DrawStyledLayout(layout, textArea, data->textColor, GetRevealLimit(&data->typewriter), data->typewriter.enabled) : 0;
+                } else if (data->wrapText || data->typewriter.enabled) {
+                    // Word-wrapped text from the cached line layout (unwrapped text only
+                    // comes here for a typewriter reveal and breaks at newlines only)
+                    if (!data->layout) {
+                        data->layout = (RayDialTextLayout*)calloc(1, sizeof(RayDialTextLayout));
+                        if (!data->layout) {
+                            EndScissorMode();
+                            break;
                         }
-                        
-                        // Check vertical bounds after processing segment
-                        if (currentY >= textArea.y + textArea.height) break;
-
-                        segment = segment->next; // Next segment
                     }
-                } else if (data->wrapText) {
-                    // Word-wrapped text using DrawTextEx with manual wrapping (Existing Plain Text Logic)
-                    const char* text = data->dialogueText;
+                    
                     float fontSize = (float)data->fontSize;
                     float spacing = fontSize * 0.1f;
-                    float textPosY = textArea.y;
-                    float textWidth = textArea.width;
-                    
-                    // Create a working copy of the text for tokenization
-                    char* textCopy = malloc(strlen(text) + 1);
-                    if (!textCopy) {
-                        EndScissorMode();
-                        break;
+                    float lineHeight = fontSize * 1.5f;
+                    if (UpdateTextLayout(data->layout, data->dialogueText, data->wrapText ? textArea.width : FLT_MAX, fontSize, spacing)) {
+                        data->typewriter.source = NULL;
                     }
-                    strcpy(textCopy, text);
-                    
-                    // Use a simple approach to handle newlines in text
-                    char* saveptr = textCopy;
-                    char* line = NULL;
-                    char* nextLine = strchr(saveptr, '\n');
                     
-                    while (saveptr && *saveptr) {
-                        // Extract the current line
-                        if (nextLine) {
-                            *nextLine = '\0';
-                            line = saveptr;
-                            saveptr = nextLine + 1;
-                            nextLine = strchr(saveptr, '\n');
-                        } else {
-                            line = saveptr;
-                            saveptr = NULL;
-                        }
-                        
-                        // Calculate width of the line
-                        Vector2 textSize = MeasureTextEx(GetFontDefault(), line, fontSize, spacing);
-                        
-                        if (textSize.x <= textWidth) {
-                            // Line fits, just draw it
-                            DrawTextEx(
-                                GetFontDefault(),
-                                line,
-                                (Vector2){ textArea.x, textPosY },
-                                fontSize,
-                                spacing,
-                                data->textColor
-                            );
-                            textPosY += textSize.y * 1.5f;
-                        } else {
-                            // Line doesn't fit, need to wrap
-                            int start = 0;
-                            int end = 0;
-                            int lastSpace = 0;
-                            
-                            while (line[end]) {
-                                if (line[end] == ' ') {
-                                    lastSpace = end;
-                                }
-                                
-                                // Check if current subset fits
-                                char temp[1024] = {0};
-                                strncpy(temp, line + start, end - start + 1);
-                                temp[end - start + 1] = '\0';
-                                
-                                textSize = MeasureTextEx(GetFontDefault(), temp, fontSize, spacing);
-                                
-                                if (textSize.x > textWidth) {
-                                    // This subset is too long, cut at last space
-                                    if (lastSpace > start) {
-                                        // Draw up to last space
-                                        strncpy(temp, line + start, lastSpace - start);
-                                        temp[lastSpace - start] = '\0';
-                                        
-                                        DrawTextEx(
-                                            GetFontDefault(),
-                                            temp,
-                                            (Vector2){ textArea.x, textPosY },
-                                            fontSize,
-                                            spacing,
-                                            data->textColor
-                                        );
-                                        
-                                        textPosY += textSize.y * 1.5f;
-                                        start = lastSpace + 1;
-                                        end = start;
-                                    } else {
-                                        // No space found, force break
-                                        strncpy(temp, line + start, end - start);
-                                        temp[end - start] = '\0';
-                                        
-                                        DrawTextEx(
-                                            GetFontDefault(),
-                                            temp,
-                                            (Vector2){ textArea.x, textPosY },
-                                            fontSize,
-                                            spacing,
-                                            data->textColor
-                                        );
-                                        
-                                        textPosY += textSize.y * 1.5f;
-                                        start = end;
-                                    }
-                                } else {
-                                    end++;
-                                }
-                                
-                                // If we reached end of string
-                                if (!line[end] && start < end) {
-                                    strncpy(temp, line + start, end - start);
-                                    temp[end - start] = '\0';
-                                    
-                                    DrawTextEx(
-                                        GetFontDefault(),
-                                        temp,
-                                        (Vector2){ textArea.x, textPosY },
-                                        fontSize,
-                                        spacing,
-                                        data->textColor
-                                    );
-                                    
-                                    textPosY += textSize.y * 1.5f;
-                                }
-                            }
-                        }
+                    // While revealing, scroll up so the line being typed stays in the box
+                    int visibleLines = (int)ceilf(textArea.height / lineHeight);
+                    int revealLimit = GetRevealLimit(&data->typewriter);
+                    int firstLine = 0;
+                    if (data->typewriter.enabled) {
+                        int typingLine = FindTextLayoutLine(data->layout, revealLimit > 0 ? revealLimit - 1 : 0);
+                        int fullLines = (int)(textArea.height / lineHeight);
+                        if (fullLines < 1) fullLines = 1;
+                        if (typingLine >= fullLines) firstLine = typingLine - fullLines + 1;
                     }
                     
-                    free(textCopy);
+                    DrawTextLayoutLines(data->layout, firstLine, visibleLines, (Vector2){ textArea.x, textArea.y },
+                                        lineHeight, fontSize, spacing, data->textColor, revealLimit);
                 } else {
                     // Regular text
                     DrawText(
@@ -1042,23 +2197,54 @@ void FreeComponent(RayDialComponent* component) {
             case RAYDIAL_BUTTON:
                 free(component->data);
                 break;
-            case RAYDIAL_LABEL:
-                free(component->data);
+            case RAYDIAL_LABEL: {
+                RayDialLabelData* data = (RayDialLabelData*)component->data;
+                if (data->formatBuffer) free(data->formatBuffer);
+                FreeVariableText(data->variableText);
+                if (data->layout) {
+                    FreeTextLayout(data->layout);
+                    free(data->layout);
+                }
+                free(data);
                 break;
+            }
             case RAYDIAL_TEXTBOX: {
                 RayDialTextboxData* data = (RayDialTextboxData*)component->data;
-                if (data->text) free(data->text);
+                if (data->state) {
+                    FreeTextEditor(&data->state->editor);
+                    free(data->state->glyphBytes);
+                    free(data->state->glyphX);
+                    free(data->state->mask);
+                    free(data->state);
+                }
                 free(data);
                 break;
             }
             case RAYDIAL_PANEL:
                 free(component->data);
                 break;
+            case RAYDIAL_SCROLLAREA: {
+                RayDialScrollAreaData* data = (RayDialScrollAreaData*)component->data;
+                for (int i = 0; i < data->rowCount; i++) {
+                    FreeComponent(data->rows[i]);
+                }
+                free(data->rows);
+                free(data->rowOffsets);
+                free(data);
+                break;
+            }
             case RAYDIAL_PORTRAIT_DIALOGUE: {
                 RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
                 if (data->speakerName) free((void*)data->speakerName);
                 if (data->dialogueText) free((void*)data->dialogueText);
-                if (data->styledText) FreeStyledText(data->styledText);
+                ClearPortraitStyledText(data);
+                if (data->layout) {
+                    FreeTextLayout(data->layout);
+                    free(data->layout);
+                }
+                FreeStyledLayout(data->styledLayout);
+                ReleaseTexture(data->textureHandle);
+                free(data->flipbook.frames);
                 free(data);
                 break;
             }
@@ -1083,6 +2269,12 @@ RayDialNode* CreateDialogueNode(const char* id, const char* text) {
     node->onEnter = NULL;
     node->onExit = NULL;
     node->userData = NULL;
+    node->choiceConditions = NULL;
+    node->visibleChoices = NULL;
+    node->visibleChoiceCount = 0;
+    node->visibleVersion = 0;
+    node->visibleVariables = NULL;
+    node->script = NULL;
     return node;
 }
 
@@ -1091,7 +2283,114 @@ void AddChoice(RayDialNode* node, RayDialNode* choice) {
     
     node->choices = (RayDialNode**)realloc(node->choices, 
         sizeof(RayDialNode*) * (node->choiceCount + 1));
+    if (node->choiceConditions) {
+        node->choiceConditions = (RayDialCondition**)realloc(node->choiceConditions,
+            sizeof(RayDialCondition*) * (node->choiceCount + 1));
+        node->choiceConditions[node->choiceCount] = NULL;
+    }
     node->choices[node->choiceCount++] = choice;
+    
+    // The visible list is sized for the choices, so it is rebuilt on next use
+    free(node->visibleChoices);
+    node->visibleChoices = NULL;
+    node->visibleVersion = 0;
+}
+
+// Add a choice shown only while condition holds, e.g. "gold >= 50 && !hasSword".
+// The expression is compiled once against the variable store.
+bool AddConditionalChoice(RayDialNode* node, RayDialNode* choice, RayDialVariables* variables, const char* condition) {
+    if (!node || !choice || !variables || !condition) return false;
+    
+    char error[128];
+    RayDialCondition* compiled = CompileCondition(variables, condition, error, sizeof(error));
+    if (!compiled) {
+        TraceLog(LOG_WARNING, "RAYDIAL: Choice condition \"%s\": %s", condition, error);
+        return false;
+    }
+    
+    if (!node->choiceConditions) {
+        node->choiceConditions = (RayDialCondition**)calloc(node->choiceCount + 1, sizeof(RayDialCondition*));
+        if (!node->choiceConditions) {
+            FreeCondition(compiled);
+            return false;
+        }
+    }
+    AddChoice(node, choice);
+    node->choiceConditions[node->choiceCount - 1] = compiled;
+    return true;
+}
+
+// Choices whose conditions hold. Conditions only run again after a variable one of
+// them reads changed; otherwise the list from the last call is returned as is.
+RayDialNode** GetVisibleChoices(RayDialNode* node, const RayDialVariables* variables, int* count) {
+    if (count) *count = 0;
+    if (!node) return NULL;
+    
+    // Without conditions every choice is visible
+    if (!node->choiceConditions) {
+        if (count) *count = node->choiceCount;
+        return node->choices;
+    }
+    
+    bool stale = node->visibleVersion == 0 || node->visibleVariables != variables;
+    for (int i = 0; i < node->choiceCount && !stale; i++) {
+        stale = ConditionChangedSince(node->choiceConditions[i], variables, node->visibleVersion);
+    }
+    
+    if (stale) {
+        if (!node->visibleChoices) {
+            node->visibleChoices = (RayDialNode**)malloc(sizeof(RayDialNode*) * node->choiceCount);
+            if (!node->visibleChoices) return NULL;
+        }
+        
+        node->visibleChoiceCount = 0;
+        for (int i = 0; i < node->choiceCount; i++) {
+            if (EvaluateCondition(node->choiceConditions[i], variables)) {
+                node->visibleChoices[node->visibleChoiceCount++] = node->choices[i];
+            }
+        }
+        node->visibleVariables = variables;
+    }
+    node->visibleVersion = GetVariableStoreVersion(variables);
+    
+    if (count) *count = node->visibleChoiceCount;
+    return node->visibleChoices;
+}
+
+// Attach a script run each time the dialogue enters the node (see raydial_script.h).
+// Replaces any previous script; NULL source removes it.
+bool SetNodeScript(RayDialNode* node, RayDialScriptHost* host, const char* source) {
+    if (!node) return false;
+    
+    RayDialScript* script = NULL;
+    if (source) {
+        char error[128];
+        script = CompileScript(host, source, error, sizeof(error));
+        if (!script) {
+            TraceLog(LOG_WARNING, "RAYDIAL: Script of node '%s': %s", node->id, error);
+            return false;
+        }
+    }
+    FreeScript(node->script);
+    node->script = script;
+    return true;
+}
+
+// Free a node and what it owns (choice list, conditions and script). Choice nodes and
+// components are shared in a graph, so they are left to the caller.
+void FreeDialogueNode(RayDialNode* node) {
+    if (!node) return;
+    
+    if (node->choiceConditions) {
+        for (int i = 0; i < node->choiceCount; i++) {
+            FreeCondition(node->choiceConditions[i]);
+        }
+        free(node->choiceConditions);
+    }
+    free(node->choices);
+    free(node->visibleChoices);
+    FreeScript(node->script);
+    free(node);
 }
 
 void SetNodeCallbacks(RayDialNode* node, RayDialCallback onEnter, 
@@ -1110,18 +2409,108 @@ RayDialManager* CreateDialogueManager(RayDialNode* rootNode) {
     manager->currentNode = rootNode;
     manager->isActive = true;
     manager->userData = NULL;
+    manager->graph = NULL;
+    manager->chapters = NULL;
+    manager->history = NULL;
+    manager->deferred = NULL;
+    manager->onTransition = NULL;
+    manager->transitionUserData = NULL;
+    return manager;
+}
+
+// Manager over a compiled graph, starting at its first node
+RayDialManager* CreateDialogueManagerFromGraph(RayDialGraph* graph) {
+    if (!graph) return NULL;
+    
+    RayDialManager* manager = CreateDialogueManager(GetGraphNode(graph, 0));
+    if (manager) manager->graph = graph;
+    return manager;
+}
+
+// Manager over a chapter set, starting at "chapter" or "chapter/node"
+RayDialManager* CreateDialogueManagerFromChapters(RayDialChapterSet* chapters, const char* id) {
+    RayDialNode* start = EnterChapterNode(chapters, id);
+    if (!start) return NULL;
+    
+    RayDialManager* manager = CreateDialogueManager(start);
+    if (manager) {
+        manager->chapters = chapters;
+        manager->graph = GetCurrentChapterGraph(chapters);
+    }
     return manager;
 }
 
+// Bring translations and variable-bound text up to date ahead of the component update,
+// so that update only reads the shared i18n manager and variable store
+static void RefreshComponentTree(RayDialComponent* component) {
+    for (; component; component = component->next) {
+        if (!component->visible || !component->enabled) continue;
+        RefreshLocalizedComponent(component);
+        if (component->type == RAYDIAL_SCROLLAREA) {
+            RayDialScrollAreaData* data = (RayDialScrollAreaData*)component->data;
+            for (int i = 0; i < data->rowCount; i++) RefreshComponentTree(data->rows[i]);
+        }
+    }
+}
+
 void UpdateDialogueManager(RayDialManager* manager) {
     if (!manager || !manager->isActive || !manager->currentNode) return;
     
+    // Chapters finish loading and get evicted here, between transitions
+    if (manager->chapters) UpdateChapterSet(manager->chapters);
+    
     // Update current node's components
     if (manager->currentNode->components) {
         UpdateComponent(manager->currentNode->components);
     }
 }
 
+// Main-thread half before a parallel update: chapter loads and everything that
+// writes to state shared with other managers
+void BeginDialogueManagerUpdate(RayDialManager* manager) {
+    if (!manager || !manager->isActive || !manager->currentNode) return;
+    
+    if (manager->chapters) UpdateChapterSet(manager->chapters);
+    RefreshComponentTree(manager->currentNode->components);
+    
+    if (!manager->deferred) {
+        manager->deferred = (struct RayDialDeferredEvents*)calloc(1, sizeof(struct RayDialDeferredEvents));
+    }
+}
+
+// The component update, safe on a worker thread between Begin and End as long as no
+// other manager updating at the same time shares its nodes. Callbacks are queued.
+void RunDialogueManagerUpdate(RayDialManager* manager) {
+    if (!manager || !manager->isActive || !manager->currentNode || !manager->deferred) return;
+    
+    struct RayDialDeferredEvents* previous = deferredEvents;
+    deferredEvents = manager->deferred;
+    UpdateComponent(manager->currentNode->components);
+    deferredEvents = previous;
+}
+
+// Main-thread half after a parallel update: replay the queued callbacks in order
+void EndDialogueManagerUpdate(RayDialManager* manager) {
+    if (!manager || !manager->deferred) return;
+    
+    struct RayDialDeferredEvents* queue = manager->deferred;
+    for (int i = 0; i < queue->count; i++) {
+        RayDialDeferredEvent* event = &queue->events[i];
+        switch (event->kind) {
+            case RAYDIAL_DEFERRED_CALLBACK:
+                event->callback(event->userData);
+                break;
+            case RAYDIAL_DEFERRED_REVEAL:
+                event->reveal(event->codepoint, event->userData);
+                break;
+            case RAYDIAL_DEFERRED_TEXTBOX:
+                UpdateTextbox(event->component);
+                break;
+        }
+    }
+    queue->count = 0;
+}
+
 void DrawDialogueManager(RayDialManager* manager) {
     if (!manager || !manager->isActive || !manager->currentNode) return;
     
@@ -1134,6 +2523,11 @@ void DrawDialogueManager(RayDialManager* manager) {
 void FreeDialogueManager(RayDialManager* manager) {
     if (!manager) return;
     
+    if (manager->deferred) {
+        free(manager->deferred->events);
+        free(manager->deferred);
+    }
+    
     // Free all nodes (you might want to implement a more sophisticated cleanup)
     free(manager);
 }
@@ -1156,51 +2550,202 @@ static RayDialNode* FindNodeById(RayDialNode* node, const char* id) {
     return NULL;
 }
 
-void TransitionToNode(RayDialManager* manager, const char* nodeId) {
-    if (!manager || !nodeId) return;
+// Pre-order position of target in the tree under node, counting from *counter
+static int FindTreeNodeIndex(const RayDialNode* node, const RayDialNode* target, int* counter) {
+    if (!node) return -1;
+    if (node == target) return *counter;
+    (*counter)++;
+    for (int i = 0; i < node->choiceCount; i++) {
+        int index = FindTreeNodeIndex(node->choices[i], target, counter);
+        if (index >= 0) return index;
+    }
+    return -1;
+}
+
+static RayDialNode* GetTreeNodeAt(RayDialNode* node, int index, int* counter) {
+    if (!node) return NULL;
+    if ((*counter)++ == index) return node;
+    for (int i = 0; i < node->choiceCount; i++) {
+        RayDialNode* found = GetTreeNodeAt(node->choices[i], index, counter);
+        if (found) return found;
+    }
+    return NULL;
+}
+
+// Index of a node: its graph index, or its pre-order position in a tree built with
+// CreateDialogueNode. -1 for nodes the manager can't reach.
+int GetManagerNodeIndex(const RayDialManager* manager, const RayDialNode* node) {
+    if (!manager || !node) return -1;
+    if (manager->graph) {
+        int index = FindGraphNodeIndex(manager->graph, node->id);
+        return GetGraphNode(manager->graph, index) == node ? index : -1;
+    }
+    int counter = 0;
+    return FindTreeNodeIndex(manager->rootNode, node, &counter);
+}
+
+RayDialNode* GetManagerNode(RayDialManager* manager, int index) {
+    if (!manager || index < 0) return NULL;
+    if (manager->graph) return GetGraphNode(manager->graph, index);
+    int counter = 0;
+    return GetTreeNodeAt(manager->rootNode, index, &counter);
+}
+
+static int GetManagerChapterIndex(const RayDialManager* manager) {
+    return manager->chapters ? GetCurrentChapterIndex(manager->chapters) : -1;
+}
+
+// Lines and visited nodes are recorded into history from now on; NULL stops recording
+void SetDialogueHistory(RayDialManager* manager, RayDialHistory* history) {
+    if (manager) manager->history = history;
+}
+
+// Observe every node the manager enters, including nodes scripts only pass through
+void SetDialogueTransitionCallback(RayDialManager* manager, RayDialTransitionCallback onTransition, void* userData) {
+    if (!manager) return;
+    manager->onTransition = onTransition;
+    manager->transitionUserData = userData;
+}
+
+bool HasVisitedNode(const RayDialManager* manager, const RayDialNode* node) {
+    if (!manager || !manager->history) return false;
+    return IsNodeVisited(manager->history, GetManagerChapterIndex(manager), GetManagerNodeIndex(manager, node));
+}
+
+// The line a node shows: its first portrait dialogue, else the node text. Localized
+// portraits are recorded by key so the backlog follows language changes.
+static void RecordNodeLine(RayDialManager* manager, RayDialNode* node, int nodeIndex) {
+    RayDialHistoryEntry entry = { .chapter = GetManagerChapterIndex(manager), .nodeIndex = nodeIndex, .text = node->text };
     
-    // Call exit callback for current node
-    if (manager->currentNode && manager->currentNode->onExit) {
-        manager->currentNode->onExit(manager->currentNode->userData);
+    for (RayDialComponent* component = node->components; component; component = component->next) {
+        if (component->type != RAYDIAL_PORTRAIT_DIALOGUE) continue;
+        
+        RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
+        entry.textIsKey = data->dialogueTextKey != NULL;
+        entry.text = entry.textIsKey ? data->dialogueTextKey : data->dialogueText;
+        entry.speakerIsKey = data->speakerNameKey != NULL;
+        entry.speaker = entry.speakerIsKey ? data->speakerNameKey : data->speakerName;
+        
+        // Rows follow the text as shown now, not the key
+        if (entry.textIsKey && data->dialogueText) {
+            entry.lineCount = 1;
+            for (const char* c = data->dialogueText; *c; c++) {
+                if (*c == '\n') entry.lineCount++;
+            }
+        }
+        break;
     }
     
-    // Find the target node
-    RayDialNode* targetNode = NULL;
-    if (strcmp(nodeId, "root") == 0) {
-        targetNode = manager->rootNode;
+    if (entry.text) RecordDialogueEntry(manager->history, &entry);
+}
+
+// Node for an id: "chapter/node" through the chapter set, others through the graph
+// index when there is one, else by walking the tree from the root. Unknown ids fall
+// back to the root.
+static RayDialNode* ResolveNodeId(RayDialManager* manager, const char* nodeId) {
+    if (strcmp(nodeId, "root") == 0) return manager->rootNode;
+    
+    RayDialNode* targetNode;
+    if (manager->chapters && strchr(nodeId, '/')) {
+        targetNode = EnterChapterNode(manager->chapters, nodeId);
+    } else if (manager->graph) {
+        targetNode = GetGraphNode(manager->graph, FindGraphNodeIndex(manager->graph, nodeId));
     } else {
-        // Start search from root node
         targetNode = FindNodeById(manager->rootNode, nodeId);
     }
-    
-    // Set the new current node (fallback to root if target not found)
-    if (targetNode) {
-        manager->currentNode = targetNode;
-    } else {
+    if (!targetNode) {
         printf("Warning: Node with ID '%s' not found, returning to root.\n", nodeId);
-        manager->currentNode = manager->rootNode;
+        targetNode = manager->rootNode;
+    }
+    return targetNode;
+}
+
+// Leave the current node for target, running callbacks and the node script. A
+// script may move on with goto; the hop limit stops scripts that cycle.
+static void EnterNode(RayDialManager* manager, RayDialNode* targetNode) {
+    for (int hop = 0; hop < RAYDIAL_MAX_SCRIPT_HOPS; hop++) {
+        // A choice into another chapter stands in for a node there; the root follows
+        // the current chapter so fallbacks stay inside resident memory
+        if (manager->chapters) {
+            RayDialNode* linked = FollowChapterLink(manager->chapters, targetNode);
+            if (linked) targetNode = linked;
+            manager->graph = GetCurrentChapterGraph(manager->chapters);
+            manager->rootNode = GetGraphNode(manager->graph, 0);
+            if (!linked) targetNode = manager->rootNode;
+        }
+        
+        // Call exit callback for current node
+        if (manager->currentNode && manager->currentNode->onExit) {
+            manager->currentNode->onExit(manager->currentNode->userData);
+        }
+        
+        manager->currentNode = targetNode;
+        
+        // Every node passed through counts as visited; only the one the player stops at has a line
+        int nodeIndex = -1;
+        if (manager->history && manager->currentNode) {
+            nodeIndex = GetManagerNodeIndex(manager, manager->currentNode);
+            MarkNodeVisited(manager->history, GetManagerChapterIndex(manager), nodeIndex);
+        }
+        
+        if (manager->onTransition && manager->currentNode) {
+            manager->onTransition(manager->currentNode, manager->transitionUserData);
+        }
+        
+        // Call enter callback for new node
+        if (manager->currentNode && manager->currentNode->onEnter) {
+            manager->currentNode->onEnter(manager->currentNode->userData);
+        }
+        
+        const char* nextId = manager->currentNode ? RunScript(manager->currentNode->script) : NULL;
+        if (!nextId) {
+            if (manager->history && manager->currentNode) RecordNodeLine(manager, manager->currentNode, nodeIndex);
+            return;
+        }
+        targetNode = ResolveNodeId(manager, nextId);
     }
     
-    // Call enter callback for new node
-    if (manager->currentNode && manager->currentNode->onEnter) {
-        manager->currentNode->onEnter(manager->currentNode->userData);
+    TraceLog(LOG_WARNING, "RAYDIAL: Node scripts jumped %d times in a row, stopping at '%s'",
+             RAYDIAL_MAX_SCRIPT_HOPS, manager->currentNode->id);
+}
+
+void TransitionToNode(RayDialManager* manager, const char* nodeId) {
+    if (!manager || !nodeId) return;
+    EnterNode(manager, ResolveNodeId(manager, nodeId));
+}
+
+// Transition to a node of the manager's graph by index, with no id lookup
+void TransitionToNodeIndex(RayDialManager* manager, int index) {
+    if (!manager) return;
+    
+    RayDialNode* targetNode = GetGraphNode(manager->graph, index);
+    if (!targetNode) {
+        TraceLog(LOG_WARNING, "RAYDIAL: Graph node index %d out of range", index);
+        return;
     }
+    EnterNode(manager, targetNode);
 }
 
 // Utility functions
+// Track the last component that was clicked to prevent multiple triggers. Per
+// thread, since managers may be hit-tested on workers in parallel.
+static _Thread_local RayDialComponent* lastClickedComponent = NULL;
+static _Thread_local int lastClickTime = -1;
+
+void ResetClickTracking(void) {
+    lastClickedComponent = NULL;
+    lastClickTime = -1;
+}
+
 bool IsComponentClicked(RayDialComponent* component) {
     if (!component || !component->enabled) return false;
     
-    // Track the last component that was clicked to prevent multiple triggers
-    static RayDialComponent* lastClickedComponent = NULL;
-    static int lastClickTime = -1;
-    
     // Get current time to track unique clicks (in milliseconds)
-    int currentTime = (int)(GetTime() * 1000.0f);
+    int currentTime = (int)(GetInputTime() * 1000.0f);
     
-    Vector2 mousePos = GetMousePosition();
+    Vector2 mousePos = GetInputMousePosition();
     bool collision = CheckCollisionPointRec(mousePos, component->bounds);
-    bool clicked = collision && IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+    bool clicked = collision && IsInputMouseButtonPressed(MOUSE_LEFT_BUTTON);
     
     if (clicked) {
         // If this is the same component clicked in rapid succession (within 100ms), ignore it
@@ -1215,7 +2760,7 @@ bool IsComponentClicked(RayDialComponent* component) {
     }
     
     // If mouse button is released, reset the last clicked component
-    if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
+    if (IsInputMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
         lastClickedComponent = NULL;
     }
     
@@ -1225,7 +2770,7 @@ bool IsComponentClicked(RayDialComponent* component) {
 bool IsComponentHovered(RayDialComponent* component) {
     if (!component || !component->enabled) return false;
     
-        Vector2 mousePos = GetMousePosition();
+        Vector2 mousePos = GetInputMousePosition();
     return CheckCollisionPointRec(mousePos, component->bounds);
 }
 
@@ -1241,12 +2786,21 @@ void SetComponentVisible(RayDialComponent* component, bool visible) {
     }
 }
 
+// Draw the panel from a nine-slice frame instead of its flat colors
+void SetPanelNineSlice(RayDialComponent* component, RayDialNineSlice slice) {
+    if (!component || component->type != RAYDIAL_PANEL) return;
+    SetFrameSlice(&((RayDialPanelData*)component->data)->frame, slice);
+}
+
 // Implementation of portrait dialogue utility functions
 void SetPortraitDialogueText(RayDialComponent* component, const char* dialogueText) {
     if (!component || component->type != RAYDIAL_PORTRAIT_DIALOGUE || !dialogueText) return;
     
     RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
     
+    // Explicit text replaces any localized binding
+    data->dialogueTextKey = NULL;
+    
     // Free existing text
     if (data->dialogueText) {
         free((void*)data->dialogueText);
@@ -1260,6 +2814,7 @@ void SetPortraitDialogueText(RayDialComponent* component, const char* dialogueTe
         strcpy(textCopy, dialogueText);
         data->dialogueText = textCopy;
     }
+    PortraitDialogueTextChanged(data);
 }
 
 void SetPortraitDialogueSpeaker(RayDialComponent* component, const char* speakerName) {
@@ -1267,6 +2822,9 @@ void SetPortraitDialogueSpeaker(RayDialComponent* component, const char* speaker
     
     RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
     
+    // Explicit name replaces any localized binding
+    data->speakerNameKey = NULL;
+    
     // Free existing speaker name
     if (data->speakerName) {
         free((void*)data->speakerName);
@@ -1290,6 +2848,10 @@ void SetPortraitDialogueColor(RayDialComponent* component, Color portraitColor)
     RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
     data->portraitColor = portraitColor;
     data->useTexture = false;
+    data->useAtlasRegion = false;
+    ClearPortraitDialogueFlipbook(component);
+    ReleaseTexture(data->textureHandle);
+    data->textureHandle = NULL;
 }
 
 void SetPortraitDialogueTexture(RayDialComponent* component, Texture2D portraitTexture) {
@@ -1298,6 +2860,83 @@ void SetPortraitDialogueTexture(RayDialComponent* component, Texture2D portraitT
     RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
     data->portraitTexture = portraitTexture;
     data->useTexture = true;
+    data->useAtlasRegion = false;
+    ClearPortraitDialogueFlipbook(component);
+    ReleaseTexture(data->textureHandle);
+    data->textureHandle = NULL;
+}
+
+// Show one image of a packed atlas. Portraits drawn from the same atlas page share
+// a texture, so raylib keeps them in one draw batch.
+void SetPortraitDialogueAtlasRegion(RayDialComponent* component, RayDialAtlasRegion region) {
+    if (!component || component->type != RAYDIAL_PORTRAIT_DIALOGUE) return;
+    
+    RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
+    data->atlasRegion = region;
+    data->useAtlasRegion = true;
+    data->useTexture = true;
+    ClearPortraitDialogueFlipbook(component);
+    ReleaseTexture(data->textureHandle);
+    data->textureHandle = NULL;
+}
+
+// Animate the portrait through atlas regions at a fixed rate. The frames are
+// copied, so picking the current one is an index and never loads anything.
+bool SetPortraitDialogueFlipbook(RayDialComponent* component, const RayDialAtlasRegion* frames, int frameCount,
+                                 float framesPerSecond, RayDialFlipbookMode mode) {
+    if (!component || component->type != RAYDIAL_PORTRAIT_DIALOGUE) return false;
+    if (!frames || frameCount <= 0 || framesPerSecond <= 0.0f) return false;
+    
+    RayDialAtlasRegion* copy = (RayDialAtlasRegion*)malloc(frameCount * sizeof(RayDialAtlasRegion));
+    if (!copy) return false;
+    memcpy(copy, frames, frameCount * sizeof(RayDialAtlasRegion));
+    
+    RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
+    ClearPortraitDialogueFlipbook(component);
+    data->flipbook.frames = copy;
+    data->flipbook.frameCount = frameCount;
+    data->flipbook.framesPerSecond = framesPerSecond;
+    data->flipbook.mode = mode;
+    data->useTexture = true;
+    ReleaseTexture(data->textureHandle);
+    data->textureHandle = NULL;
+    return true;
+}
+
+// Stop the animation; the portrait falls back to its static image
+void ClearPortraitDialogueFlipbook(RayDialComponent* component) {
+    if (!component || component->type != RAYDIAL_PORTRAIT_DIALOGUE) return;
+    
+    RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
+    free(data->flipbook.frames);
+    memset(&data->flipbook, 0, sizeof(RayDialFlipbook));
+}
+
+void SetPortraitDialogueBoxNineSlice(RayDialComponent* component, RayDialNineSlice slice) {
+    if (!component || component->type != RAYDIAL_PORTRAIT_DIALOGUE) return;
+    SetFrameSlice(&((RayDialPortraitDialogueData*)component->data)->boxFrame, slice);
+}
+
+void SetPortraitDialogueNameTagNineSlice(RayDialComponent* component, RayDialNineSlice slice) {
+    if (!component || component->type != RAYDIAL_PORTRAIT_DIALOGUE) return;
+    SetFrameSlice(&((RayDialPortraitDialogueData*)component->data)->nameTagFrame, slice);
+}
+
+// Show a cached texture, loading it in the background if no component has asked
+// for it yet. The portrait color is drawn until it is ready. The texture is scaled
+// down for the current portraitSize, so set that first.
+void SetPortraitDialogueTexturePath(RayDialComponent* component, RayDialTextureCache* cache, const char* path) {
+    if (!component || !cache || !path || component->type != RAYDIAL_PORTRAIT_DIALOGUE) return;
+    
+    RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
+    
+    // Acquire before releasing so switching to the same path never drops the texture
+    RayDialTextureHandle* handle = AcquireTextureSized(cache, path, data->portraitSize);
+    ReleaseTexture(data->textureHandle);
+    data->textureHandle = handle;
+    data->useTexture = handle != NULL;
+    data->useAtlasRegion = false;
+    ClearPortraitDialogueFlipbook(component);
 }
 
 void SetPortraitDialoguePosition(RayDialComponent* component, bool showOnRight) {
@@ -1313,11 +2952,11 @@ void SetPortraitDialogueStyledText(RayDialComponent* component, const char* form
     
     RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
     
+    // Explicit text replaces any localized binding
+    data->dialogueTextKey = NULL;
+    
     // Free existing styled text
-    if (data->styledText) {
-        FreeStyledText(data->styledText);
-        data->styledText = NULL;
-    }
+    ClearPortraitStyledText(data);
     
     // Free existing plain text
     if (data->dialogueText) {
@@ -1328,23 +2967,18 @@ void SetPortraitDialogueStyledText(RayDialComponent* component, const char* form
     // Parse and set styled text
     data->styledText = ParseStyledText(formattedText, data->textColor, (float)data->fontSize);
     
-    // Create a plain text version for fallback
-    char* plainText = (char*)malloc(strlen(formattedText) + 1);
+    // Plain version: the segment text joined, exactly the characters that are drawn
+    size_t plainLength = 0;
+    for (RayDialTextSegment* segment = data->styledText; segment; segment = segment->next) {
+        plainLength += strlen(segment->text);
+    }
+    char* plainText = (char*)malloc(plainLength + 1);
     if (plainText) {
-        // Simple conversion: just strip out tags
-        const char* src = formattedText;
         char* dst = plainText;
-        
-        bool inTag = false;
-        while (*src) {
-            if (*src == '[') {
-                inTag = true;
-            } else if (*src == ']') {
-                inTag = false;
-            } else if (!inTag) {
-                *dst++ = *src;
-            }
-            src++;
+        for (RayDialTextSegment* segment = data->styledText; segment; segment = segment->next) {
+            size_t length = strlen(segment->text);
+            memcpy(dst, segment->text, length);
+            dst += length;
         }
         *dst = '\0';
         
@@ -1353,27 +2987,350 @@ void SetPortraitDialogueStyledText(RayDialComponent* component, const char* form
     
     // Enable styled text rendering
     data->useStyledText = true;
+    PortraitDialogueTextChanged(data);
+}
+
+// Label functions
+
+static void UnbindLabelVariables(RayDialLabelData* data) {
+    FreeVariableText(data->variableText);
+    data->variableText = NULL;
+    data->variables = NULL;
+}
+
+// Format the bound template into the label's buffer, growing it like
+// SetLocalizedLabelFormat does
+static void FormatLabelVariables(RayDialLabelData* data) {
+    int length = FormatVariableText(data->variableText, data->variables, data->formatBuffer, data->formatBufferSize);
+    
+    if (length >= data->formatBufferSize) {
+        int size = data->formatBufferSize ? data->formatBufferSize : 64;
+        while (size <= length) size *= 2;
+        
+        char* buffer = (char*)realloc(data->formatBuffer, size);
+        if (!buffer) return;
+        data->formatBuffer = buffer;
+        data->formatBufferSize = size;
+        FormatVariableText(data->variableText, data->variables, data->formatBuffer, data->formatBufferSize);
+    }
+    
+    data->text = data->formatBuffer;
+    data->variableVersion = GetVariableStoreVersion(data->variables);
+    if (data->layout) InvalidateTextLayout(data->layout);
+    // Live values keep a running reveal going; only the character count is re-read
+    data->typewriter.source = NULL;
+}
+
+// Replace a label's text. Use this rather than assigning data->text so a wrapped
+// label knows to rebuild its line index.
+void SetLabelText(RayDialComponent* component, const char* text) {
+    if (!component || component->type != RAYDIAL_LABEL) return;
+    
+    RayDialLabelData* data = (RayDialLabelData*)component->data;
+    data->text = text;
+    data->textKey = NULL;
+    UnbindLabelVariables(data);
+    if (data->layout) InvalidateTextLayout(data->layout);
+    RestartTypewriter(&data->typewriter);
+}
+
+// The label's buffer was rewritten in place: lay it out again on the next update and
+// let a running typewriter carry on over the new text
+void MarkLabelTextChanged(RayDialComponent* component) {
+    if (!component || component->type != RAYDIAL_LABEL) return;
+    
+    RayDialLabelData* data = (RayDialLabelData*)component->data;
+    if (data->layout) InvalidateTextLayout(data->layout);
+    data->typewriter.source = NULL;
+}
+
+// Show a template such as "Gold: {gold}" that follows the store. The text is
+// formatted now and again only after a variable it shows changed.
+bool BindLabelToVariables(RayDialComponent* component, RayDialVariables* variables, const char* format) {
+    if (!component || !variables || !format || component->type != RAYDIAL_LABEL) return false;
+    
+    RayDialVariableText* text = CompileVariableText(variables, format);
+    if (!text) return false;
+    
+    RayDialLabelData* data = (RayDialLabelData*)component->data;
+    UnbindLabelVariables(data);
+    data->variables = variables;
+    data->variableText = text;
+    data->textKey = NULL;
+    FormatLabelVariables(data);
+    RestartTypewriter(&data->typewriter);
+    return true;
+}
+
+// Height of the wrapped text. Uses the cached line index, so it is only expensive
+// the first time after the text, width or font size changed.
+float GetLabelContentHeight(RayDialComponent* component) {
+    if (!component || component->type != RAYDIAL_LABEL) return 0.0f;
+    
+    RayDialLabelData* data = (RayDialLabelData*)component->data;
+    if (data->wrapText || data->typewriter.enabled) UpdateLabelLayout(component);
+    return data->contentHeight;
+}
+
+// Wrapped lines intersecting the label at its current scroll position
+int GetLabelVisibleLines(RayDialComponent* component, int* firstLine) {
+    if (firstLine) *firstLine = 0;
+    if (!component || component->type != RAYDIAL_LABEL) return 0;
+    
+    RayDialLabelData* data = (RayDialLabelData*)component->data;
+    if (!data->wrapText && !data->typewriter.enabled) return 0;
+    RayDialTextLayout* layout = UpdateLabelLayout(component);
+    if (!layout || layout->lineCount == 0) return 0;
+    
+    float lineHeight = data->fontSize * 1.5f;
+    int first = (int)floorf(data->scrollPosition / lineHeight);
+    int last = (int)ceilf((data->scrollPosition + component->bounds.height) / lineHeight);
+    if (first < 0) first = 0;
+    if (last > layout->lineCount) last = layout->lineCount;
+    if (last <= first) return 0;
+    
+    if (firstLine) *firstLine = first;
+    return last - first;
+}
+
+// Typewriter functions
+
+// Reveal the text of a label or portrait dialogue from the start at a fixed rate.
+// Progress follows frame time, so the speed is the same at any frame rate.
+void StartTypewriter(RayDialComponent* component, float charactersPerSecond) {
+    if (!component) return;
+    RayDialTypewriter* typewriter = GetComponentTypewriter(component);
+    if (!typewriter) return;
+    
+    typewriter->enabled = true;
+    typewriter->charactersPerSecond = charactersPerSecond;
+    RestartTypewriter(typewriter);
+}
+
+// Call onReveal with each character as it appears
+void SetTypewriterCallback(RayDialComponent* component, RayDialRevealCallback onReveal, void* userData) {
+    if (!component) return;
+    RayDialTypewriter* typewriter = GetComponentTypewriter(component);
+    if (!typewriter) return;
+    
+    typewriter->onReveal = onReveal;
+    typewriter->revealUserData = userData;
+}
+
+// Show the rest of the text at once, without calling the reveal callback
+void SkipTypewriter(RayDialComponent* component) {
+    if (!component) return;
+    RayDialTypewriter* typewriter = GetComponentTypewriter(component);
+    if (!typewriter || !typewriter->enabled) return;
+    
+    typewriter->revealedGlyphs = INT_MAX;
+    SyncTypewriter(typewriter, GetTypewriterText(component));
+    typewriter->progress = (float)typewriter->revealedGlyphs;
+}
+
+// True once the whole text is shown (always true without a running typewriter)
+bool IsTypewriterFinished(RayDialComponent* component) {
+    if (!component) return true;
+    RayDialTypewriter* typewriter = GetComponentTypewriter(component);
+    if (!typewriter || !typewriter->enabled) return true;
+    
+    const char* text = GetTypewriterText(component);
+    if (typewriter->source != text) SyncTypewriter(typewriter, text);
+    return typewriter->revealedGlyphs >= typewriter->totalGlyphs;
+}
+
+// Scroll area functions
+
+// Append a row. Rows are stacked top to bottom and only those in view are
+// updated and drawn; components chained after a row with AddComponent move with it.
+// The scroll area takes ownership of the row.
+void AddScrollAreaRow(RayDialComponent* scrollArea, RayDialComponent* row) {
+    if (!scrollArea || !row || scrollArea->type != RAYDIAL_SCROLLAREA) return;
+    
+    RayDialScrollAreaData* data = (RayDialScrollAreaData*)scrollArea->data;
+    if (data->rowCount + 1 >= data->rowCapacity) {
+        int capacity = data->rowCapacity ? data->rowCapacity * 2 : 64;
+        RayDialComponent** rows = (RayDialComponent**)realloc(data->rows, capacity * sizeof(RayDialComponent*));
+        if (!rows) return;
+        data->rows = rows;
+        float* offsets = (float*)realloc(data->rowOffsets, (capacity + 1) * sizeof(float));
+        if (!offsets) return;
+        data->rowOffsets = offsets;
+        data->rowCapacity = capacity;
+    }
+    
+    data->rows[data->rowCount] = row;
+    if (data->firstDirtyRow > data->rowCount) data->firstDirtyRow = data->rowCount;
+    data->rowCount++;
+}
+
+// Change a row's height; rows below it are re-laid out on the next frame
+void SetScrollAreaRowHeight(RayDialComponent* scrollArea, int index, float height) {
+    if (!scrollArea || scrollArea->type != RAYDIAL_SCROLLAREA) return;
+    
+    RayDialScrollAreaData* data = (RayDialScrollAreaData*)scrollArea->data;
+    if (index < 0 || index >= data->rowCount) return;
+    
+    data->rows[index]->bounds.height = height;
+    if (data->firstDirtyRow > index + 1) data->firstDirtyRow = index + 1;
+}
+
+// Scroll so a row's top edge is at the top of the view
+void ScrollToScrollAreaRow(RayDialComponent* scrollArea, int index, bool smooth) {
+    if (!scrollArea || scrollArea->type != RAYDIAL_SCROLLAREA) return;
+    
+    RayDialScrollAreaData* data = (RayDialScrollAreaData*)scrollArea->data;
+    if (index < 0 || index >= data->rowCount) return;
+    
+    UpdateScrollAreaLayout(data);
+    data->scrollTarget = fminf(data->rowOffsets[index], GetMaxScroll(scrollArea));
+    if (!smooth) data->scrollPosition = data->scrollTarget;
+}
+
+// Rows currently in view (as of the last update or draw)
+int GetScrollAreaVisibleRows(RayDialComponent* scrollArea, int* firstRow) {
+    if (!scrollArea || scrollArea->type != RAYDIAL_SCROLLAREA) return 0;
+    
+    RayDialScrollAreaData* data = (RayDialScrollAreaData*)scrollArea->data;
+    if (firstRow) *firstRow = data->firstVisibleRow;
+    return data->visibleRowCount;
+}
+
+// Use i18n to resolve lines recorded as translation keys
+void SetHistoryViewI18N(RayDialComponent* historyView, RayDialI18N* i18n) {
+    if (!historyView || historyView->type != RAYDIAL_HISTORY_VIEW) return;
+    ((RayDialHistoryViewData*)historyView->data)->i18n = i18n;
+}
+
+// Scroll to the newest line and follow the lines recorded after it
+void ScrollHistoryViewToEnd(RayDialComponent* historyView, bool smooth) {
+    if (!historyView || historyView->type != RAYDIAL_HISTORY_VIEW) return;
+    
+    RayDialHistoryViewData* data = (RayDialHistoryViewData*)historyView->data;
+    SyncHistoryViewOrigin(data);
+    data->scrollTarget = GetHistoryMaxScroll(historyView);
+    data->followEnd = true;
+    if (!smooth) data->scrollPosition = data->scrollTarget;
+}
+
+// History entries currently in view (as of the last update or draw)
+int GetHistoryViewVisibleEntries(RayDialComponent* historyView, int* firstEntry) {
+    if (!historyView || historyView->type != RAYDIAL_HISTORY_VIEW) return 0;
+    
+    RayDialHistoryViewData* data = (RayDialHistoryViewData*)historyView->data;
+    if (firstEntry) *firstEntry = data->firstVisibleEntry;
+    return data->visibleEntryCount;
+}
+
+// Textbox editing functions
+
+// Current text as one string, the same pointer as data->text; valid until the next edit
+const char* GetTextboxText(RayDialComponent* component) {
+    if (!component || component->type != RAYDIAL_TEXTBOX) return NULL;
+    
+    RayDialTextboxData* data = (RayDialTextboxData*)component->data;
+    SyncTextboxText(data);
+    return data->text;
+}
+
+void SetTextboxText(RayDialComponent* component, const char* text) {
+    if (!component || component->type != RAYDIAL_TEXTBOX) return;
+    
+    RayDialTextboxData* data = (RayDialTextboxData*)component->data;
+    TextEditorSetText(&data->state->editor, text, data->maxLength);
+    TextEditorSetCursor(&data->state->editor, TextEditorLength(&data->state->editor), false);
+    SyncTextboxText(data);
+    data->scrollOffset = 0.0f;
+}
+
+// Insert UTF-8 text at the caret, replacing the selection
+void InsertTextboxText(RayDialComponent* component, const char* text) {
+    if (!component || component->type != RAYDIAL_TEXTBOX || !text) return;
+    
+    RayDialTextboxData* data = (RayDialTextboxData*)component->data;
+    TextEditorInsert(&data->state->editor, text, (int)strlen(text), data->maxLength);
+    SyncTextboxText(data);
+}
+
+// Delete the selection, or one character before or after the caret
+void DeleteTextboxText(RayDialComponent* component, bool forward) {
+    if (!component || component->type != RAYDIAL_TEXTBOX) return;
+    
+    RayDialTextboxData* data = (RayDialTextboxData*)component->data;
+    TextEditorDelete(&data->state->editor, forward);
+    SyncTextboxText(data);
+}
+
+// Move the caret to a character index; extendSelection keeps the selection anchor
+void SetTextboxCursor(RayDialComponent* component, int characterIndex, bool extendSelection) {
+    if (!component || component->type != RAYDIAL_TEXTBOX) return;
+    
+    RayDialTextboxData* data = (RayDialTextboxData*)component->data;
+    UpdateTextboxLayout(data);
+    
+    RayDialTextboxState* state = data->state;
+    if (characterIndex < 0) characterIndex = 0;
+    if (characterIndex > state->glyphCount) characterIndex = state->glyphCount;
+    TextEditorSetCursor(&state->editor, state->glyphBytes[characterIndex], extendSelection);
+}
+
+// Caret position as a character index
+int GetTextboxCursor(RayDialComponent* component) {
+    if (!component || component->type != RAYDIAL_TEXTBOX) return 0;
+    
+    RayDialTextboxData* data = (RayDialTextboxData*)component->data;
+    UpdateTextboxLayout(data);
+    return TextboxCharacterAt(data->state, data->state->editor.cursor);
+}
+
+// Character index of the caret position closest to a screen x coordinate
+int GetTextboxIndexAt(RayDialComponent* component, float x) {
+    if (!component || component->type != RAYDIAL_TEXTBOX) return 0;
+    
+    RayDialTextboxData* data = (RayDialTextboxData*)component->data;
+    return TextboxCharacterAt(data->state, TextboxHitTest(component, x));
+}
+
+void SetTextboxFocus(RayDialComponent* component, bool focused) {
+    if (!component || component->type != RAYDIAL_TEXTBOX) return;
+    ((RayDialTextboxData*)component->data)->hasFocus = focused;
 }
 
 // Localized component creation and text setting functions
 
 // Create a button with localized text
 RayDialComponent* CreateLocalizedButton(Rectangle bounds, const char* textKey, RayDialCallback onClick, void* userData, RayDialI18N* i18n) {
-    const char* localizedText = GetLocalizedText(i18n, textKey);
-    return CreateButton(bounds, localizedText, onClick, userData);
+    RayDialComponent* component = CreateButton(bounds, GetLocalizedText(i18n, textKey), onClick, userData);
+    if (i18n && textKey) {
+        SetLocalizedButtonText(component, textKey, i18n);
+    }
+    return component;
 }
 
 // Create a label with localized text
 RayDialComponent* CreateLocalizedLabel(Rectangle bounds, const char* textKey, bool wrapText, RayDialI18N* i18n) {
-    const char* localizedText = GetLocalizedText(i18n, textKey);
-    return CreateLabel(bounds, localizedText, wrapText);
+    RayDialComponent* component = CreateLabel(bounds, GetLocalizedText(i18n, textKey), wrapText);
+    if (i18n && textKey) {
+        SetLocalizedLabelText(component, textKey, i18n);
+    }
+    return component;
 }
 
 // Create a portrait dialogue with localized text
 RayDialComponent* CreateLocalizedPortraitDialogue(Rectangle bounds, const char* speakerNameKey, const char* dialogueTextKey, Color portraitColor, RayDialI18N* i18n) {
     const char* localizedSpeakerName = GetLocalizedText(i18n, speakerNameKey);
     const char* localizedDialogueText = GetLocalizedText(i18n, dialogueTextKey);
-    return CreatePortraitDialogue(bounds, localizedSpeakerName, localizedDialogueText, portraitColor);
+    RayDialComponent* component = CreatePortraitDialogue(bounds, localizedSpeakerName, localizedDialogueText, portraitColor);
+    
+    // Remember the keys so the component follows reloads and language switches
+    RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
+    if (i18n) {
+        data->speakerNameKey = speakerNameKey;
+        data->dialogueTextKey = dialogueTextKey;
+        data->i18n = i18n;
+        data->i18nGeneration = GetI18NGeneration(i18n);
+    }
+    return component;
 }
 
 // Set localized text for a button
@@ -1383,6 +3340,9 @@ void SetLocalizedButtonText(RayDialComponent* component, const char* textKey, Ra
     RayDialButtonData* data = (RayDialButtonData*)component->data;
     const char* localizedText = GetLocalizedText(i18n, textKey);
     data->text = localizedText;
+    data->textKey = textKey;
+    data->i18n = i18n;
+    data->i18nGeneration = GetI18NGeneration(i18n);
 }
 
 // Set localized text for a label
@@ -1392,6 +3352,44 @@ void SetLocalizedLabelText(RayDialComponent* component, const char* textKey, Ray
     RayDialLabelData* data = (RayDialLabelData*)component->data;
     const char* localizedText = GetLocalizedText(i18n, textKey);
     data->text = localizedText;
+    data->textKey = textKey;
+    data->i18n = i18n;
+    data->i18nGeneration = GetI18NGeneration(i18n);
+    UnbindLabelVariables(data);
+    
+    // A reloaded table can hand back a string at a recycled address
+    if (data->layout) InvalidateTextLayout(data->layout);
+    RestartTypewriter(&data->typewriter);
+}
+
+// Format a translation with arguments into the label's own buffer. Meant to be
+// called every frame with live values: the buffer only grows when the text
+// gets longer, so steady-state calls neither parse nor allocate.
+void SetLocalizedLabelFormat(RayDialComponent* component, const char* textKey, RayDialI18N* i18n, const RayDialFormatArg* args, int argCount) {
+    if (!component || !textKey || !i18n || component->type != RAYDIAL_LABEL) return;
+    
+    RayDialLabelData* data = (RayDialLabelData*)component->data;
+    int length = FormatLocalizedText(i18n, textKey, data->formatBuffer, data->formatBufferSize, args, argCount);
+    
+    if (length >= data->formatBufferSize) {
+        int size = data->formatBufferSize ? data->formatBufferSize : 64;
+        while (size <= length) size *= 2;
+        
+        char* buffer = (char*)realloc(data->formatBuffer, size);
+        if (!buffer) return;
+        data->formatBuffer = buffer;
+        data->formatBufferSize = size;
+        FormatLocalizedText(i18n, textKey, data->formatBuffer, data->formatBufferSize, args, argCount);
+    }
+    
+    // The arguments are not retained, so there is no key binding to refresh;
+    // the next call picks up reloaded translations
+    data->text = data->formatBuffer;
+    data->textKey = NULL;
+    UnbindLabelVariables(data);
+    if (data->layout) InvalidateTextLayout(data->layout);
+    // Live values keep a running reveal going; only the character count is re-read
+    data->typewriter.source = NULL;
 }
 
 // Set localized dialogue text for a portrait dialogue
@@ -1416,12 +3414,14 @@ void SetLocalizedPortraitDialogueText(RayDialComponent* component, const char* d
     }
     
     // Reset styled text when changing regular text
-    if (data->styledText) {
-        FreeStyledText(data->styledText);
-        data->styledText = NULL;
-    }
+    ClearPortraitStyledText(data);
     
     data->useStyledText = false;
+    PortraitDialogueTextChanged(data);
+    data->dialogueTextKey = dialogueTextKey;
+    data->dialogueKeyStyled = false;
+    data->i18n = i18n;
+    data->i18nGeneration = GetI18NGeneration(i18n);
 }
 
 // Set localized speaker name for a portrait dialogue
@@ -1444,6 +3444,10 @@ void SetLocalizedPortraitDialogueSpeaker(RayDialComponent* component, const char
         strcpy(nameCopy, localizedSpeakerName);
         data->speakerName = nameCopy;
     }
+    
+    data->speakerNameKey = speakerNameKey;
+    data->i18n = i18n;
+    data->i18nGeneration = GetI18NGeneration(i18n);
 }
 
 // Set localized styled text for a portrait dialogue
@@ -1452,11 +3456,11 @@ void SetLocalizedPortraitDialogueStyledText(RayDialComponent* component, const c
     
     RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)component->data;
     
+    // Acquire before releasing so an unchanged text is never re-parsed
+    RayDialStyledText* styledText = AcquireLocalizedStyledText(i18n, formattedTextKey, data->textColor, (float)data->fontSize);
+    
     // Free existing styled text if any
-    if (data->styledText) {
-        FreeStyledText(data->styledText);
-        data->styledText = NULL;
-    }
+    ClearPortraitStyledText(data);
     
     // Free existing plain text if any
     if (data->dialogueText) {
@@ -1464,26 +3468,24 @@ void SetLocalizedPortraitDialogueStyledText(RayDialComponent* component, const c
         data->dialogueText = NULL;
     }
     
-    // Get localized and styled text
-    RayDialTextSegment* styledText = GetLocalizedStyledText(i18n, formattedTextKey, data->textColor, (float)data->fontSize);
     if (styledText) {
-        data->styledText = styledText;
+        // The cached runs are shared and read-only; the portrait only draws them
+        data->sharedStyledText = styledText;
+        data->styledText = (RayDialTextSegment*)GetStyledTextSegments(styledText);
         data->useStyledText = true;
         
-        // Also set a plain text version for accessibility or fallback
-        const char* localizedText = GetLocalizedText(i18n, formattedTextKey);
-        if (localizedText) {
-            size_t len = strlen(localizedText) + 1;
-            char* textCopy = (char*)malloc(len);
-            if (textCopy) {
-                strcpy(textCopy, localizedText);
-                data->dialogueText = textCopy;
-            }
-        }
+        // Plain version with the tags stripped, for accessibility or fallback
+        data->dialogueText = strdup(GetStyledTextPlain(styledText));
     } else {
         // Fallback to plain text if parsing fails
         const char* localizedText = GetLocalizedText(i18n, formattedTextKey);
         SetPortraitDialogueText(component, localizedText);
         data->useStyledText = false;
     }
-}
\ No newline at end of file
+    PortraitDialogueTextChanged(data);
+    
+    data->dialogueTextKey = formattedTextKey;
+    data->dialogueKeyStyled = true;
+    data->i18n = i18n;
+    data->i18nGeneration = GetI18NGeneration(i18n);
+}
@@ -0,0 +1,305 @@
+#include "raydial_context.h"
+#include "raydial_i18n.h"
+#include "raydial_textures.h"
+#include "raydial_worker.h"
+#include <stdlib.h>
+#include <math.h>
+
+typedef struct {
+    RayDialManager* manager;
+    int priority;
+    double budget;
+    unsigned int sequence;                  // Order of addition, breaks priority ties
+    int deferredFrames;
+    bool updated;
+    double lastCost;
+} RayDialContextEntry;
+
+struct RayDialContext {
+    RayDialI18N* i18n;
+    RayDialTextureCache* textures;
+    RayDialContextEntry* entries;           // Sorted by priority, highest first
+    int* schedule;                          // Update order of the last pass (entry indices)
+    int count;
+    int capacity;
+    unsigned int nextSequence;
+    double frameBudget;                     // 0 for no limit
+    double textureBudget;
+    RayDialWorkerPool* workers;             // Runs manager updates in parallel when set
+    int workerCount;
+    int* running;                           // Entries updating in the current parallel pass
+    int runningCount;
+    struct RayDialContextJob* jobs;         // One per worker thread
+};
+
+// A worker's share of a parallel pass: every workerCount-th running manager
+typedef struct RayDialContextJob {
+    RayDialContext* context;
+    int first;
+} RayDialContextJob;
+
+RayDialContext* CreateDialogueContext(RayDialI18N* i18n, RayDialTextureCache* textures) {
+    RayDialContext* context = (RayDialContext*)calloc(1, sizeof(RayDialContext));
+    if (!context) return NULL;
+    context->i18n = i18n;
+    context->textures = textures;
+    context->textureBudget = 0.002;
+    return context;
+}
+
+void FreeDialogueContext(RayDialContext* context) {
+    if (!context) return;
+    for (int i = 0; i < context->count; i++) {
+        FreeDialogueManager(context->entries[i].manager);
+    }
+    FreeWorkerPool(context->workers);
+    free(context->jobs);
+    free(context->running);
+    free(context->entries);
+    free(context->schedule);
+    free(context);
+}
+
+RayDialI18N* GetDialogueContextI18N(const RayDialContext* context) {
+    return context ? context->i18n : NULL;
+}
+
+RayDialTextureCache* GetDialogueContextTextures(const RayDialContext* context) {
+    return context ? context->textures : NULL;
+}
+
+static bool EntryBefore(const RayDialContextEntry* a, const RayDialContextEntry* b) {
+    if (a->priority != b->priority) return a->priority > b->priority;
+    return a->sequence < b->sequence;
+}
+
+// Restore priority order after one entry changed; entries move by at most the
+// distance their priority changed, so this is an insertion step, not a full sort
+static void SortContextEntry(RayDialContext* context, int index) {
+    RayDialContextEntry entry = context->entries[index];
+    while (index > 0 && EntryBefore(&entry, &context->entries[index - 1])) {
+        context->entries[index] = context->entries[index - 1];
+        index--;
+    }
+    while (index < context->count - 1 && EntryBefore(&context->entries[index + 1], &entry)) {
+        context->entries[index] = context->entries[index + 1];
+        index++;
+    }
+    context->entries[index] = entry;
+}
+
+static int FindContextEntry(const RayDialContext* context, const RayDialManager* manager) {
+    if (!context || !manager) return -1;
+    for (int i = 0; i < context->count; i++) {
+        if (context->entries[i].manager == manager) return i;
+    }
+    return -1;
+}
+
+bool AddDialogueManager(RayDialContext* context, RayDialManager* manager, int priority, double budgetSeconds) {
+    if (!context || !manager || FindContextEntry(context, manager) >= 0) return false;
+
+    if (context->count == context->capacity) {
+        int capacity = context->capacity ? context->capacity * 2 : 8;
+        RayDialContextEntry* entries = (RayDialContextEntry*)realloc(context->entries, capacity * sizeof(RayDialContextEntry));
+        if (!entries) return false;
+        context->entries = entries;
+        int* schedule = (int*)realloc(context->schedule, capacity * sizeof(int));
+        if (!schedule) return false;
+        context->schedule = schedule;
+        int* running = (int*)realloc(context->running, capacity * sizeof(int));
+        if (!running) return false;
+        context->running = running;
+        context->capacity = capacity;
+    }
+
+    context->entries[context->count] = (RayDialContextEntry){
+        .manager = manager,
+        .priority = priority,
+        .budget = fmax(budgetSeconds, 0.0),
+        .sequence = context->nextSequence++
+    };
+    context->count++;
+    SortContextEntry(context, context->count - 1);
+    return true;
+}
+
+void RemoveDialogueManager(RayDialContext* context, RayDialManager* manager) {
+    int index = FindContextEntry(context, manager);
+    if (index < 0) return;
+    for (int i = index; i < context->count - 1; i++) {
+        context->entries[i] = context->entries[i + 1];
+    }
+    context->count--;
+}
+
+void SetDialogueManagerPriority(RayDialContext* context, RayDialManager* manager, int priority) {
+    int index = FindContextEntry(context, manager);
+    if (index < 0) return;
+    context->entries[index].priority = priority;
+    SortContextEntry(context, index);
+}
+
+void SetDialogueManagerBudget(RayDialContext* context, RayDialManager* manager, double budgetSeconds) {
+    int index = FindContextEntry(context, manager);
+    if (index >= 0) context->entries[index].budget = fmax(budgetSeconds, 0.0);
+}
+
+void SetDialogueContextBudget(RayDialContext* context, double frameSeconds, double textureSeconds) {
+    if (!context) return;
+    context->frameBudget = fmax(frameSeconds, 0.0);
+    context->textureBudget = fmax(textureSeconds, 0.0);
+}
+
+bool SetDialogueContextWorkers(RayDialContext* context, int threadCount) {
+    if (!context) return false;
+    FreeWorkerPool(context->workers);
+    free(context->jobs);
+    context->workers = NULL;
+    context->jobs = NULL;
+    context->workerCount = 0;
+    if (threadCount <= 0) return true;
+    
+    context->workers = CreateWorkerPool(threadCount);
+    context->jobs = (RayDialContextJob*)malloc(threadCount * sizeof(RayDialContextJob));
+    if (!context->workers || !context->jobs) {
+        FreeWorkerPool(context->workers);
+        free(context->jobs);
+        context->workers = NULL;
+        context->jobs = NULL;
+        TraceLog(LOG_WARNING, "RAYDIAL: Failed to start %d dialogue update threads, updating on the main thread", threadCount);
+        return false;
+    }
+    context->workerCount = threadCount;
+    return true;
+}
+
+int GetDialogueContextManagerCount(const RayDialContext* context) {
+    return context ? context->count : 0;
+}
+
+RayDialManager* GetDialogueContextManager(const RayDialContext* context, int index) {
+    if (!context || index < 0 || index >= context->count) return NULL;
+    return context->entries[index].manager;
+}
+
+bool GetDialogueManagerStats(const RayDialContext* context, const RayDialManager* manager, RayDialManagerStats* stats) {
+    int index = FindContextEntry(context, manager);
+    if (index < 0 || !stats) return false;
+    const RayDialContextEntry* entry = &context->entries[index];
+    stats->priority = entry->priority;
+    stats->budgetSeconds = entry->budget;
+    stats->updated = entry->updated;
+    stats->deferredFrames = entry->deferredFrames;
+    stats->lastUpdateSeconds = entry->lastCost;
+    return true;
+}
+
+// Update order: priority raised by the frames a manager has waited. Entries are
+// kept in priority order, so only deferred managers move and insertion sort is cheap.
+static void ScheduleContextUpdates(RayDialContext* context) {
+    for (int i = 0; i < context->count; i++) context->schedule[i] = i;
+    for (int i = 1; i < context->count; i++) {
+        int index = context->schedule[i];
+        const RayDialContextEntry* entry = &context->entries[index];
+        long long key = (long long)entry->priority + entry->deferredFrames;
+        int j = i;
+        while (j > 0) {
+            const RayDialContextEntry* previous = &context->entries[context->schedule[j - 1]];
+            long long previousKey = (long long)previous->priority + previous->deferredFrames;
+            if (previousKey >= key) break;
+            context->schedule[j] = context->schedule[j - 1];
+            j--;
+        }
+        context->schedule[j] = index;
+    }
+}
+
+// Managers are dealt out round-robin so costly neighbours in priority order spread
+// across threads, and each thread takes one job per pass rather than one per manager
+static void RunContextJob(void* arg) {
+    RayDialContextJob* job = (RayDialContextJob*)arg;
+    RayDialContext* context = job->context;
+    for (int i = job->first; i < context->runningCount; i += context->workerCount) {
+        RayDialContextEntry* entry = &context->entries[context->running[i]];
+        double start = GetTime();
+        RunDialogueManagerUpdate(entry->manager);
+        entry->lastCost = GetTime() - start;
+    }
+}
+
+// Admission rule shared by both passes. A manager's time is only known after it
+// runs, so it is admitted on its budget or the time its previous update took,
+// whichever is longer. Marks the entry updated or deferred and returns its charge.
+static bool AdmitContextEntry(const RayDialContext* context, RayDialContextEntry* entry, int position,
+                              double spent, double* charge) {
+    *charge = fmax(entry->budget, entry->lastCost);
+    entry->updated = position == 0 || context->frameBudget <= 0.0 || entry->budget <= 0.0 ||
+                     spent + *charge <= context->frameBudget;
+    if (entry->updated) {
+        entry->deferredFrames = 0;
+    } else {
+        entry->deferredFrames++;
+    }
+    return entry->updated;
+}
+
+static void UpdateContextInParallel(RayDialContext* context) {
+    double spent = 0.0;
+    context->runningCount = 0;
+    for (int i = 0; i < context->count; i++) {
+        RayDialContextEntry* entry = &context->entries[context->schedule[i]];
+        double charge;
+        if (!AdmitContextEntry(context, entry, i, spent, &charge)) continue;
+        spent += charge;
+        BeginDialogueManagerUpdate(entry->manager);
+        context->running[context->runningCount++] = context->schedule[i];
+    }
+
+    // Between Begin and End nothing on the main thread touches the managers, the
+    // variable stores or the caches, so the workers only ever read shared state
+    for (int i = 0; i < context->workerCount && i < context->runningCount; i++) {
+        context->jobs[i] = (RayDialContextJob){ context, i };
+        if (!SubmitWorkerJob(context->workers, RunContextJob, &context->jobs[i])) RunContextJob(&context->jobs[i]);
+    }
+    WaitWorkerPool(context->workers);
+
+    for (int i = 0; i < context->runningCount; i++) {
+        EndDialogueManagerUpdate(context->entries[context->running[i]].manager);
+    }
+}
+
+void UpdateDialogueContext(RayDialContext* context) {
+    if (!context) return;
+
+    // Shared caches are pumped once for everyone
+    if (context->i18n) UpdateI18NManager(context->i18n);
+    if (context->textures) UpdateTextureCache(context->textures, context->textureBudget);
+
+    ScheduleContextUpdates(context);
+
+    if (context->workers) {
+        UpdateContextInParallel(context);
+        return;
+    }
+
+    double spent = 0.0;
+    for (int i = 0; i < context->count; i++) {
+        RayDialContextEntry* entry = &context->entries[context->schedule[i]];
+        double charge;
+        if (!AdmitContextEntry(context, entry, i, spent, &charge)) continue;
+
+        // On the main thread the actual time is known right away, and charged if longer
+        double start = GetTime();
+        UpdateDialogueManager(entry->manager);
+        entry->lastCost = GetTime() - start;
+        spent += fmax(charge, entry->lastCost);
+    }
+}
+
+void DrawDialogueContext(RayDialContext* context) {
+    if (!context) return;
+    for (int i = context->count - 1; i >= 0; i--) {
+        DrawDialogueManager(context->entries[i].manager);
+    }
+}
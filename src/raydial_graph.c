@@ -0,0 +1,1227 @@
+#include "raydial_graph.h"
+#include "raydial_worker.h"
+#include "raylib.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <limits.h>
+#include <stdatomic.h>
+
+// Binary layout, all fields little-endian uint32:
+//   header   magic "RDG1", version, nodeCount, edgeCount, stringBytes
+//   nodes    id, text, script, firstEdge, edgeCount, flags    (strings are offsets)
+//   edges    target node index, condition
+//   strings  NUL-terminated, the last byte of the block is 0
+// RAYDIAL_GRAPH_NONE marks an absent string. Node 0 is the root. Choices into other
+// chapters target portal nodes, which come after all the others and have the id
+// "chapter/node", no text, script or choices.
+#define RAYDIAL_GRAPH_VERSION 1
+#define RAYDIAL_GRAPH_HEADER_WORDS 5
+#define RAYDIAL_GRAPH_NODE_WORDS 6
+#define RAYDIAL_GRAPH_EDGE_WORDS 2
+#define RAYDIAL_GRAPH_NONE 0xFFFFFFFFu
+#define RAYDIAL_GRAPH_FLAG_ENTRY 1u
+#define RAYDIAL_GRAPH_FLAG_PORTAL 2u
+#define RAYDIAL_GRAPH_MAX_CYCLE_NAMES 4    // Node ids listed in a cycle warning
+
+static const unsigned char graphMagic[4] = { 'R', 'D', 'G', '1' };
+
+struct RayDialGraph {
+    char* strings;                          // Owned copy of the string block
+    RayDialNode* nodes;
+    int nodeCount;
+    int portalCount;                        // Portal nodes, stored after the nodeCount others
+    RayDialNode** edges;                    // Choice lists of all nodes, back to back
+    RayDialCondition** conditions;          // Parallel to edges; NULL when no edge has one
+    int edgeCount;
+    int* slots;                             // Open-addressed index of node indices by id (-1 empty)
+    int slotCapacity;
+};
+
+// FNV-1a hash of a node id
+static unsigned int HashGraphId(const char* id, int length) {
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char)id[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Index capacity for count ids at under 70% load
+static int GetGraphSlotCapacity(int count) {
+    int capacity = 16;
+    while (count * 10 >= capacity * 7) capacity *= 2;
+    return capacity;
+}
+
+// Compiler
+
+typedef struct {
+    const char* id;                         // Points into the source
+    int idLength;
+    int line;
+    bool entry;
+    char* text;                             // Text lines joined by newlines
+    int textLength;
+    char* script;                           // Script lines joined by newlines
+    int scriptLength;
+    int firstEdge;
+    int edgeCount;
+} RayDialSourceNode;
+
+typedef struct {
+    const char* target;                     // Points into the source
+    int targetLength;
+    const char* condition;                  // NULL for an unconditional choice
+    int conditionLength;
+    int line;
+    bool isGoto;                            // From a script; checked but not written out
+    bool external;                          // Target is "chapter/node", resolved at runtime
+    int resolved;                           // Target node index
+} RayDialSourceEdge;
+
+typedef struct {
+    RayDialSourceNode* nodes;
+    int nodeCount;
+    int nodeCapacity;
+    RayDialSourceEdge* edges;
+    int edgeCount;
+    int edgeCapacity;
+    int* slots;
+    int slotCapacity;
+    RayDialGraphReport report;
+    void* userData;
+    int errorCount;
+    bool outOfMemory;
+} RayDialGraphCompiler;
+
+static void ReportGraph(RayDialGraphCompiler* compiler, bool isError, int line, const char* format, ...) {
+    char message[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    if (isError) compiler->errorCount++;
+    if (compiler->report) {
+        compiler->report(isError, line, message, compiler->userData);
+    } else {
+        TraceLog(isError ? LOG_ERROR : LOG_WARNING, "RAYDIAL: Graph line %d: %s", line, message);
+    }
+}
+
+static bool AppendSourceLine(char** buffer, int* length, const char* line, int lineLength) {
+    int separator = *buffer ? 1 : 0;
+    char* grown = (char*)realloc(*buffer, *length + separator + lineLength + 1);
+    if (!grown) return false;
+    if (separator) grown[(*length)++] = '\n';
+    memcpy(grown + *length, line, lineLength);
+    *length += lineLength;
+    grown[*length] = '\0';
+    *buffer = grown;
+    return true;
+}
+
+static bool AddSourceEdge(RayDialGraphCompiler* compiler, RayDialSourceEdge edge) {
+    if (compiler->edgeCount == compiler->edgeCapacity) {
+        int capacity = compiler->edgeCapacity ? compiler->edgeCapacity * 2 : 64;
+        RayDialSourceEdge* edges = (RayDialSourceEdge*)realloc(compiler->edges, capacity * sizeof(RayDialSourceEdge));
+        if (!edges) return false;
+        compiler->edges = edges;
+        compiler->edgeCapacity = capacity;
+    }
+    compiler->edges[compiler->edgeCount++] = edge;
+    compiler->nodes[compiler->nodeCount - 1].edgeCount++;
+    return true;
+}
+
+static const char* SkipGraphSpaces(const char* text, const char* end) {
+    while (text < end && (*text == ' ' || *text == '\t')) text++;
+    return text;
+}
+
+static const char* TrimGraphEnd(const char* start, const char* end) {
+    while (end > start && isspace((unsigned char)end[-1])) end--;
+    return end;
+}
+
+static const char* SkipGraphWord(const char* text, const char* end) {
+    while (text < end && !isspace((unsigned char)*text)) text++;
+    return text;
+}
+
+// A script line of the form [label:] goto "id" is an edge the compiler checks
+static bool AddScriptGoto(RayDialGraphCompiler* compiler, const char* start, const char* end, int line) {
+    const char* word = SkipGraphSpaces(start, end);
+    const char* wordEnd = SkipGraphWord(word, end);
+    if (wordEnd > word && wordEnd[-1] == ':') {
+        word = SkipGraphSpaces(wordEnd, end);
+        wordEnd = SkipGraphWord(word, end);
+    }
+    if (wordEnd - word != 4 || strncmp(word, "goto", 4) != 0) return true;
+
+    const char* quote = SkipGraphSpaces(wordEnd, end);
+    if (quote >= end || (*quote != '"' && *quote != '\'')) return true;
+    const char* close = memchr(quote + 1, *quote, end - quote - 1);
+    if (!close) return true;
+
+    RayDialSourceEdge edge = { quote + 1, (int)(close - quote - 1), NULL, 0, line, true, false, -1 };
+    return AddSourceEdge(compiler, edge);
+}
+
+static void ParseGraphLine(RayDialGraphCompiler* compiler, const char* start, const char* end, int line) {
+    start = SkipGraphSpaces(start, end);
+    end = TrimGraphEnd(start, end);
+    if (start == end || *start == '#') return;
+
+    const char* keyword = start;
+    const char* keywordEnd = SkipGraphWord(start, end);
+    int keywordLength = (int)(keywordEnd - keyword);
+
+    if (keywordLength == 4 && strncmp(keyword, "node", 4) == 0) {
+        const char* id = SkipGraphSpaces(keywordEnd, end);
+        const char* idEnd = SkipGraphWord(id, end);
+        const char* rest = SkipGraphSpaces(idEnd, end);
+        bool entry = rest < end && end - rest == 5 && strncmp(rest, "entry", 5) == 0;
+        if (id == idEnd) {
+            ReportGraph(compiler, true, line, "Node without an id");
+            return;
+        }
+        if (rest < end && !entry) {
+            ReportGraph(compiler, true, line, "Unexpected '%.*s' after the node id", (int)(end - rest), rest);
+            return;
+        }
+        if (memchr(id, '/', idEnd - id)) {
+            ReportGraph(compiler, true, line, "Node ids can't contain '/', which separates chapter names");
+            return;
+        }
+
+        if (compiler->nodeCount == compiler->nodeCapacity) {
+            int capacity = compiler->nodeCapacity ? compiler->nodeCapacity * 2 : 64;
+            RayDialSourceNode* nodes = (RayDialSourceNode*)realloc(compiler->nodes, capacity * sizeof(RayDialSourceNode));
+            if (!nodes) {
+                compiler->outOfMemory = true;
+                return;
+            }
+            compiler->nodes = nodes;
+            compiler->nodeCapacity = capacity;
+        }
+        RayDialSourceNode* node = &compiler->nodes[compiler->nodeCount++];
+        memset(node, 0, sizeof(RayDialSourceNode));
+        node->id = id;
+        node->idLength = (int)(idEnd - id);
+        node->line = line;
+        node->entry = entry || compiler->nodeCount == 1;
+        node->firstEdge = compiler->edgeCount;
+        return;
+    }
+
+    // Everything else is "directive: value" inside a node
+    const char* colon = memchr(start, ':', end - start);
+    if (!colon) {
+        ReportGraph(compiler, true, line, "Expected 'node <id>' or a directive such as 'text:'");
+        return;
+    }
+    if (compiler->nodeCount == 0) {
+        ReportGraph(compiler, true, line, "Directive before the first node");
+        return;
+    }
+
+    RayDialSourceNode* node = &compiler->nodes[compiler->nodeCount - 1];
+    int nameLength = (int)(colon - start);
+    const char* value = colon + 1;
+    if (value < end && *value == ' ') value++;
+
+    bool stored = true;
+    if (nameLength == 4 && strncmp(start, "text", 4) == 0) {
+        stored = AppendSourceLine(&node->text, &node->textLength, value, (int)(end - value));
+    } else if (nameLength == 6 && strncmp(start, "script", 6) == 0) {
+        stored = AppendSourceLine(&node->script, &node->scriptLength, value, (int)(end - value)) &&
+                 AddScriptGoto(compiler, value, end, line);
+    } else if (nameLength == 6 && strncmp(start, "choice", 6) == 0) {
+        const char* target = SkipGraphSpaces(value, end);
+        const char* targetEnd = SkipGraphWord(target, end);
+        const char* rest = SkipGraphSpaces(targetEnd, end);
+        RayDialSourceEdge edge = { target, (int)(targetEnd - target), NULL, 0, line, false, false, -1 };
+        if (target == targetEnd) {
+            ReportGraph(compiler, true, line, "Choice without a target node");
+            return;
+        }
+        if (rest < end) {
+            if (end - rest < 3 || strncmp(rest, "if", 2) != 0 || !isspace((unsigned char)rest[2])) {
+                ReportGraph(compiler, true, line, "Expected 'if <condition>' after the choice target");
+                return;
+            }
+            edge.condition = SkipGraphSpaces(rest + 2, end);
+            edge.conditionLength = (int)(end - edge.condition);
+        }
+        stored = AddSourceEdge(compiler, edge);
+    } else {
+        ReportGraph(compiler, true, line, "Unknown directive '%.*s'", nameLength, start);
+        return;
+    }
+    if (!stored) compiler->outOfMemory = true;
+}
+
+static int FindSourceNode(const RayDialGraphCompiler* compiler, const char* id, int length) {
+    int mask = compiler->slotCapacity - 1;
+    for (int slot = HashGraphId(id, length) & mask; compiler->slots[slot] >= 0; slot = (slot + 1) & mask) {
+        const RayDialSourceNode* node = &compiler->nodes[compiler->slots[slot]];
+        if (node->idLength == length && strncmp(node->id, id, length) == 0) return compiler->slots[slot];
+    }
+    return -1;
+}
+
+// Index the ids, reporting duplicates, then resolve every edge
+static bool ResolveGraphEdges(RayDialGraphCompiler* compiler) {
+    compiler->slotCapacity = GetGraphSlotCapacity(compiler->nodeCount);
+    compiler->slots = (int*)malloc(compiler->slotCapacity * sizeof(int));
+    if (!compiler->slots) return false;
+    memset(compiler->slots, 0xFF, compiler->slotCapacity * sizeof(int));
+
+    int mask = compiler->slotCapacity - 1;
+    for (int i = 0; i < compiler->nodeCount; i++) {
+        const RayDialSourceNode* node = &compiler->nodes[i];
+        int existing = FindSourceNode(compiler, node->id, node->idLength);
+        if (existing >= 0) {
+            ReportGraph(compiler, true, node->line, "Node '%.*s' is already defined on line %d",
+                        node->idLength, node->id, compiler->nodes[existing].line);
+            continue;
+        }
+        int slot = HashGraphId(node->id, node->idLength) & mask;
+        while (compiler->slots[slot] >= 0) slot = (slot + 1) & mask;
+        compiler->slots[slot] = i;
+    }
+
+    // Conditions are checked for syntax against a scratch store
+    RayDialVariables* scratch = CreateVariableStore();
+    if (!scratch) return false;
+    char error[128];
+    char condition[512];
+
+    for (int i = 0; i < compiler->edgeCount; i++) {
+        RayDialSourceEdge* edge = &compiler->edges[i];
+        const char* slash = memchr(edge->target, '/', edge->targetLength);
+        if (slash) {
+            // Another chapter: only the form can be checked here
+            edge->external = true;
+            const char* last = edge->target + edge->targetLength - 1;
+            if (slash == edge->target || slash == last || memchr(slash + 1, '/', last - slash)) {
+                ReportGraph(compiler, true, edge->line, "Expected 'chapter/node' in '%.*s'", edge->targetLength, edge->target);
+            }
+        } else if ((edge->resolved = FindSourceNode(compiler, edge->target, edge->targetLength)) < 0) {
+            ReportGraph(compiler, true, edge->line, "%s leads to unknown node '%.*s'",
+                        edge->isGoto ? "Script goto" : "Choice", edge->targetLength, edge->target);
+        }
+
+        if (!edge->condition) continue;
+        if (edge->conditionLength >= (int)sizeof(condition)) {
+            ReportGraph(compiler, true, edge->line, "Condition too long");
+            continue;
+        }
+        memcpy(condition, edge->condition, edge->conditionLength);
+        condition[edge->conditionLength] = '\0';
+        RayDialCondition* compiled = CompileCondition(scratch, condition, error, sizeof(error));
+        if (compiled) {
+            FreeCondition(compiled);
+        } else {
+            ReportGraph(compiler, true, edge->line, "Condition: %s", error);
+        }
+    }
+    FreeVariableStore(scratch);
+    return true;
+}
+
+// Mark what the entry nodes reach, following choices and script gotos
+static bool MarkReachableNodes(RayDialGraphCompiler* compiler, bool* reachable) {
+    int* queue = (int*)malloc(compiler->nodeCount * sizeof(int));
+    if (!queue) return false;
+
+    int head = 0;
+    int tail = 0;
+    for (int i = 0; i < compiler->nodeCount; i++) {
+        if (compiler->nodes[i].entry) {
+            reachable[i] = true;
+            queue[tail++] = i;
+        }
+    }
+    while (head < tail) {
+        const RayDialSourceNode* node = &compiler->nodes[queue[head++]];
+        for (int e = node->firstEdge; e < node->firstEdge + node->edgeCount; e++) {
+            int target = compiler->edges[e].resolved;
+            if (target >= 0 && !reachable[target]) {
+                reachable[target] = true;
+                queue[tail++] = target;
+            }
+        }
+    }
+    free(queue);
+    return true;
+}
+
+// Report a strongly connected component that loops with no edge leaving it
+static void CheckGraphComponent(RayDialGraphCompiler* compiler, const int* members, int count, const int* component) {
+    int id = component[members[0]];
+    bool cyclic = count > 1;
+    for (int m = 0; m < count; m++) {
+        const RayDialSourceNode* node = &compiler->nodes[members[m]];
+        for (int e = node->firstEdge; e < node->firstEdge + node->edgeCount; e++) {
+            if (compiler->edges[e].external) return;
+            int target = compiler->edges[e].resolved;
+            if (target < 0) continue;
+            if (component[target] != id) return;
+            if (target == members[m]) cyclic = true;
+        }
+    }
+    if (!cyclic) return;
+
+    // Name the first few members in source order, picking the next lowest index each
+    // time (members come in stack order); the report points at the first of them
+    char names[160] = "";
+    int first = -1;
+    for (int listed = 0, previous = -1; listed < count && listed < RAYDIAL_GRAPH_MAX_CYCLE_NAMES; listed++) {
+        int next = INT_MAX;
+        for (int m = 0; m < count; m++) {
+            if (members[m] > previous && members[m] < next) next = members[m];
+        }
+        if (listed == 0) first = next;
+        previous = next;
+
+        const RayDialSourceNode* node = &compiler->nodes[next];
+        size_t used = strlen(names);
+        snprintf(names + used, sizeof(names) - used, "%s'%.*s'", listed ? ", " : "", node->idLength, node->id);
+    }
+    ReportGraph(compiler, false, compiler->nodes[first].line, "Nodes %s%s loop with no way out",
+                names, count > RAYDIAL_GRAPH_MAX_CYCLE_NAMES ? " and others" : "");
+}
+
+// Tarjan's algorithm without recursion, so deep graphs cannot overflow the stack
+static bool CheckGraphCycles(RayDialGraphCompiler* compiler, const bool* reachable) {
+    int count = compiler->nodeCount;
+    int* order = (int*)malloc(count * sizeof(int));
+    int* low = (int*)malloc(count * sizeof(int));
+    int* component = (int*)malloc(count * sizeof(int));
+    int* stack = (int*)malloc(count * sizeof(int));
+    int* frames = (int*)malloc(count * sizeof(int));
+    int* cursor = (int*)malloc(count * sizeof(int));
+    bool ok = order && low && component && stack && frames && cursor;
+
+    if (ok) {
+        for (int i = 0; i < count; i++) {
+            order[i] = -1;
+            component[i] = -1;
+        }
+
+        int counter = 0;
+        int components = 0;
+        int stackSize = 0;
+        for (int root = 0; root < count; root++) {
+            if (!reachable[root] || order[root] >= 0) continue;
+
+            int depth = 0;
+            frames[depth++] = root;
+            order[root] = low[root] = counter++;
+            cursor[root] = compiler->nodes[root].firstEdge;
+            stack[stackSize++] = root;
+
+            while (depth > 0) {
+                int v = frames[depth - 1];
+                const RayDialSourceNode* node = &compiler->nodes[v];
+                if (cursor[v] < node->firstEdge + node->edgeCount) {
+                    int w = compiler->edges[cursor[v]++].resolved;
+                    if (w < 0) continue;
+                    if (order[w] < 0) {
+                        order[w] = low[w] = counter++;
+                        cursor[w] = compiler->nodes[w].firstEdge;
+                        stack[stackSize++] = w;
+                        frames[depth++] = w;
+                    } else if (component[w] < 0 && order[w] < low[v]) {
+                        low[v] = order[w];
+                    }
+                    continue;
+                }
+
+                depth--;
+                if (depth > 0 && low[v] < low[frames[depth - 1]]) low[frames[depth - 1]] = low[v];
+                if (low[v] != order[v]) continue;
+
+                // v is the root of a component: its members are on top of the stack
+                int start = stackSize;
+                do {
+                    component[stack[--start]] = components;
+                } while (stack[start] != v);
+                components++;
+                CheckGraphComponent(compiler, stack + start, stackSize - start, component);
+                stackSize = start;
+            }
+        }
+    }
+
+    free(order);
+    free(low);
+    free(component);
+    free(stack);
+    free(frames);
+    free(cursor);
+    return ok;
+}
+
+typedef struct {
+    unsigned char* data;
+    int size;
+    int capacity;
+    bool failed;
+} RayDialGraphWriter;
+
+static void WriteGraphBytes(RayDialGraphWriter* writer, const void* bytes, int count) {
+    if (writer->failed || count == 0) return;
+    if (writer->size + count > writer->capacity) {
+        int capacity = writer->capacity ? writer->capacity : 1024;
+        while (capacity < writer->size + count) capacity *= 2;
+        unsigned char* data = (unsigned char*)realloc(writer->data, capacity);
+        if (!data) {
+            writer->failed = true;
+            return;
+        }
+        writer->data = data;
+        writer->capacity = capacity;
+    }
+    memcpy(writer->data + writer->size, bytes, count);
+    writer->size += count;
+}
+
+static void WriteGraphWord(RayDialGraphWriter* writer, uint32_t value) {
+    unsigned char bytes[4] = { value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, value >> 24 };
+    WriteGraphBytes(writer, bytes, 4);
+}
+
+// Append a string to the string block and return its offset
+static uint32_t WriteGraphString(RayDialGraphWriter* strings, const char* text, int length) {
+    uint32_t offset = (uint32_t)strings->size;
+    WriteGraphBytes(strings, text, length);
+    WriteGraphBytes(strings, "", 1);
+    return offset;
+}
+
+// Lay out the reachable nodes with their choices, then one portal node per distinct
+// target in another chapter. Script gotos stay in the scripts.
+static bool WriteGraphBinary(RayDialGraphCompiler* compiler, const bool* reachable, unsigned char** data, int* size) {
+    int* remap = (int*)malloc(compiler->nodeCount * sizeof(int));
+    int* portals = (int*)malloc((compiler->edgeCount ? compiler->edgeCount : 1) * sizeof(int));   // First edge naming each
+    if (!remap || !portals) {
+        free(remap);
+        free(portals);
+        return false;
+    }
+
+    int nodeCount = 0;
+    int edgeCount = 0;
+    for (int i = 0; i < compiler->nodeCount; i++) {
+        remap[i] = reachable[i] ? nodeCount++ : -1;
+    }
+    int portalCount = 0;
+    for (int i = 0; i < compiler->nodeCount; i++) {
+        if (!reachable[i]) continue;
+        const RayDialSourceNode* node = &compiler->nodes[i];
+        for (int e = node->firstEdge; e < node->firstEdge + node->edgeCount; e++) {
+            RayDialSourceEdge* edge = &compiler->edges[e];
+            if (edge->isGoto) continue;
+            edgeCount++;
+            if (!edge->external) continue;
+
+            int p = 0;
+            while (p < portalCount && (compiler->edges[portals[p]].targetLength != edge->targetLength ||
+                                       strncmp(compiler->edges[portals[p]].target, edge->target, edge->targetLength) != 0)) p++;
+            if (p == portalCount) portals[portalCount++] = e;
+            edge->resolved = nodeCount + p;
+        }
+    }
+
+    RayDialGraphWriter header = { 0 };
+    RayDialGraphWriter records = { 0 };
+    RayDialGraphWriter edges = { 0 };
+    RayDialGraphWriter strings = { 0 };
+
+    int edgeIndex = 0;
+    for (int i = 0; i < compiler->nodeCount; i++) {
+        if (!reachable[i]) continue;
+        const RayDialSourceNode* node = &compiler->nodes[i];
+
+        int choices = 0;
+        for (int e = node->firstEdge; e < node->firstEdge + node->edgeCount; e++) {
+            const RayDialSourceEdge* edge = &compiler->edges[e];
+            if (edge->isGoto) continue;
+            WriteGraphWord(&edges, (uint32_t)(edge->external ? edge->resolved : remap[edge->resolved]));
+            WriteGraphWord(&edges, edge->condition ? WriteGraphString(&strings, edge->condition, edge->conditionLength) : RAYDIAL_GRAPH_NONE);
+            choices++;
+        }
+
+        WriteGraphWord(&records, WriteGraphString(&strings, node->id, node->idLength));
+        WriteGraphWord(&records, WriteGraphString(&strings, node->text ? node->text : "", node->textLength));
+        WriteGraphWord(&records, node->script ? WriteGraphString(&strings, node->script, node->scriptLength) : RAYDIAL_GRAPH_NONE);
+        WriteGraphWord(&records, (uint32_t)edgeIndex);
+        WriteGraphWord(&records, (uint32_t)choices);
+        WriteGraphWord(&records, node->entry ? RAYDIAL_GRAPH_FLAG_ENTRY : 0);
+        edgeIndex += choices;
+    }
+    for (int p = 0; p < portalCount; p++) {
+        const RayDialSourceEdge* edge = &compiler->edges[portals[p]];
+        WriteGraphWord(&records, WriteGraphString(&strings, edge->target, edge->targetLength));
+        WriteGraphWord(&records, WriteGraphString(&strings, "", 0));
+        WriteGraphWord(&records, RAYDIAL_GRAPH_NONE);
+        WriteGraphWord(&records, (uint32_t)edgeIndex);
+        WriteGraphWord(&records, 0);
+        WriteGraphWord(&records, RAYDIAL_GRAPH_FLAG_PORTAL);
+    }
+
+    WriteGraphBytes(&header, graphMagic, sizeof(graphMagic));
+    WriteGraphWord(&header, RAYDIAL_GRAPH_VERSION);
+    WriteGraphWord(&header, (uint32_t)(nodeCount + portalCount));
+    WriteGraphWord(&header, (uint32_t)edgeCount);
+    WriteGraphWord(&header, (uint32_t)strings.size);
+    WriteGraphBytes(&header, records.data, records.size);
+    WriteGraphBytes(&header, edges.data, edges.size);
+    WriteGraphBytes(&header, strings.data, strings.size);
+
+    bool ok = !header.failed && !records.failed && !edges.failed && !strings.failed;
+    free(remap);
+    free(portals);
+    free(records.data);
+    free(edges.data);
+    free(strings.data);
+    if (!ok) {
+        free(header.data);
+        return false;
+    }
+    *data = header.data;
+    *size = header.size;
+    return true;
+}
+
+bool CompileDialogueGraph(const char* source, unsigned char** data, int* size, RayDialGraphReport report, void* userData) {
+    if (data) *data = NULL;
+    if (size) *size = 0;
+    if (!source || !data || !size) return false;
+
+    RayDialGraphCompiler compiler = { 0 };
+    compiler.report = report;
+    compiler.userData = userData;
+
+    int line = 1;
+    for (const char* start = source; *start && !compiler.outOfMemory; line++) {
+        const char* end = strchr(start, '\n');
+        if (!end) end = start + strlen(start);
+        ParseGraphLine(&compiler, start, end, line);
+        start = *end ? end + 1 : end;
+    }
+    if (compiler.nodeCount == 0 && !compiler.outOfMemory) {
+        ReportGraph(&compiler, true, line, "The graph has no nodes");
+    }
+
+    bool* reachable = NULL;
+    // References are resolved even after syntax errors so one run reports them all
+    bool ok = !compiler.outOfMemory && compiler.nodeCount > 0 && ResolveGraphEdges(&compiler);
+    if (ok && compiler.errorCount == 0) {
+        reachable = (bool*)calloc(compiler.nodeCount, sizeof(bool));
+        ok = reachable && MarkReachableNodes(&compiler, reachable);
+    }
+    if (ok && compiler.errorCount == 0) {
+        for (int i = 0; i < compiler.nodeCount; i++) {
+            if (!reachable[i]) {
+                ReportGraph(&compiler, false, compiler.nodes[i].line, "Node '%.*s' is unreachable and was removed",
+                            compiler.nodes[i].idLength, compiler.nodes[i].id);
+            }
+        }
+        ok = CheckGraphCycles(&compiler, reachable) && WriteGraphBinary(&compiler, reachable, data, size);
+    }
+    if (!ok && compiler.errorCount == 0) ReportGraph(&compiler, true, 0, "Out of memory");
+
+    for (int i = 0; i < compiler.nodeCount; i++) {
+        free(compiler.nodes[i].text);
+        free(compiler.nodes[i].script);
+    }
+    free(compiler.nodes);
+    free(compiler.edges);
+    free(compiler.slots);
+    free(reachable);
+    return ok && compiler.errorCount == 0;
+}
+
+static char* ReadGraphFile(const char* path, int* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* contents = fileSize >= 0 ? (char*)malloc((size_t)fileSize + 1) : NULL;
+    if (!contents) {
+        fclose(file);
+        return NULL;
+    }
+    size_t length = fread(contents, 1, (size_t)fileSize, file);
+    fclose(file);
+    contents[length] = '\0';
+    if (size) *size = (int)length;
+    return contents;
+}
+
+bool CompileDialogueGraphFile(const char* sourcePath, const char* outputPath, RayDialGraphReport report, void* userData) {
+    if (!sourcePath || !outputPath) return false;
+
+    char* source = ReadGraphFile(sourcePath, NULL);
+    if (!source) {
+        TraceLog(LOG_WARNING, "RAYDIAL: Could not read dialogue graph source %s", sourcePath);
+        return false;
+    }
+
+    unsigned char* data;
+    int size;
+    bool ok = CompileDialogueGraph(source, &data, &size, report, userData);
+    free(source);
+    if (!ok) return false;
+
+    FILE* file = fopen(outputPath, "wb");
+    ok = file && fwrite(data, 1, (size_t)size, file) == (size_t)size;
+    if (file) ok = fclose(file) == 0 && ok;
+    if (!ok) TraceLog(LOG_WARNING, "RAYDIAL: Could not write dialogue graph %s", outputPath);
+    free(data);
+    return ok;
+}
+
+// Loader
+
+static uint32_t ReadGraphWord(const unsigned char* bytes) {
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+// Validate everything an index or offset can reach before any of it is used
+static bool CheckGraphLayout(const unsigned char* data, int size, uint32_t* nodeCount, uint32_t* edgeCount,
+                             uint32_t* stringBytes, uint32_t* portalCount) {
+    const int headerSize = RAYDIAL_GRAPH_HEADER_WORDS * 4;
+    if (size < headerSize || memcmp(data, graphMagic, sizeof(graphMagic)) != 0) return false;
+    if (ReadGraphWord(data + 4) != RAYDIAL_GRAPH_VERSION) return false;
+
+    *nodeCount = ReadGraphWord(data + 8);
+    *edgeCount = ReadGraphWord(data + 12);
+    *stringBytes = ReadGraphWord(data + 16);
+    uint64_t expected = (uint64_t)headerSize + (uint64_t)*nodeCount * RAYDIAL_GRAPH_NODE_WORDS * 4 +
+                        (uint64_t)*edgeCount * RAYDIAL_GRAPH_EDGE_WORDS * 4 + *stringBytes;
+    if (*nodeCount == 0 || *nodeCount > INT32_MAX / 2 || *edgeCount > INT32_MAX / 2 || expected != (uint64_t)size) return false;
+
+    // Every string ends inside the block because the block ends with a NUL
+    if (*stringBytes == 0 || data[size - 1] != '\0') return false;
+
+    const unsigned char* nodes = data + headerSize;
+    const unsigned char* edges = nodes + (size_t)*nodeCount * RAYDIAL_GRAPH_NODE_WORDS * 4;
+    const char* strings = (const char*)edges + (size_t)*edgeCount * RAYDIAL_GRAPH_EDGE_WORDS * 4;
+    *portalCount = 0;
+    for (uint32_t i = 0; i < *nodeCount; i++) {
+        const unsigned char* record = nodes + (size_t)i * RAYDIAL_GRAPH_NODE_WORDS * 4;
+        uint32_t id = ReadGraphWord(record);
+        uint32_t script = ReadGraphWord(record + 8);
+        uint32_t first = ReadGraphWord(record + 12);
+        uint32_t count = ReadGraphWord(record + 16);
+        if (id >= *stringBytes || ReadGraphWord(record + 4) >= *stringBytes) return false;
+        if (script != RAYDIAL_GRAPH_NONE && script >= *stringBytes) return false;
+        if (first > *edgeCount || count > *edgeCount - first) return false;
+
+        // Portals are bare "chapter/node" links after every regular node
+        bool portal = (ReadGraphWord(record + 20) & RAYDIAL_GRAPH_FLAG_PORTAL) != 0;
+        if (portal) {
+            if (i == 0 || count != 0 || script != RAYDIAL_GRAPH_NONE || !strchr(strings + id, '/')) return false;
+            (*portalCount)++;
+        } else if (*portalCount > 0) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < *edgeCount; i++) {
+        const unsigned char* edge = edges + (size_t)i * RAYDIAL_GRAPH_EDGE_WORDS * 4;
+        uint32_t condition = ReadGraphWord(edge + 4);
+        if (ReadGraphWord(edge) >= *nodeCount) return false;
+        if (condition != RAYDIAL_GRAPH_NONE && condition >= *stringBytes) return false;
+    }
+    return true;
+}
+
+// Lay out nodes, choice slices and the id index. Touches nothing but the new graph,
+// so chapters can be built on a worker thread.
+static RayDialGraph* BuildDialogueGraph(const unsigned char* data, int size) {
+    uint32_t nodeCount, edgeCount, stringBytes, portalCount;
+    if (!data || !CheckGraphLayout(data, size, &nodeCount, &edgeCount, &stringBytes, &portalCount)) return NULL;
+
+    RayDialGraph* graph = (RayDialGraph*)calloc(1, sizeof(RayDialGraph));
+    if (!graph) return NULL;
+
+    const unsigned char* records = data + RAYDIAL_GRAPH_HEADER_WORDS * 4;
+    const unsigned char* edgeRecords = records + (size_t)nodeCount * RAYDIAL_GRAPH_NODE_WORDS * 4;
+    const unsigned char* stringBlock = edgeRecords + (size_t)edgeCount * RAYDIAL_GRAPH_EDGE_WORDS * 4;
+
+    graph->nodeCount = (int)(nodeCount - portalCount);
+    graph->portalCount = (int)portalCount;
+    graph->edgeCount = (int)edgeCount;
+    graph->strings = (char*)malloc(stringBytes);
+    graph->nodes = (RayDialNode*)calloc(nodeCount, sizeof(RayDialNode));
+    graph->edges = (RayDialNode**)malloc((edgeCount ? edgeCount : 1) * sizeof(RayDialNode*));
+    graph->slotCapacity = GetGraphSlotCapacity(graph->nodeCount);
+    graph->slots = (int*)malloc(graph->slotCapacity * sizeof(int));
+    if (!graph->strings || !graph->nodes || !graph->edges || !graph->slots) {
+        FreeDialogueGraph(graph);
+        return NULL;
+    }
+    memcpy(graph->strings, stringBlock, stringBytes);
+    memset(graph->slots, 0xFF, graph->slotCapacity * sizeof(int));
+
+    for (uint32_t i = 0; i < edgeCount; i++) {
+        graph->edges[i] = &graph->nodes[ReadGraphWord(edgeRecords + (size_t)i * RAYDIAL_GRAPH_EDGE_WORDS * 4)];
+    }
+
+    // Portals get nodes so choices can point at them, but no index entries
+    int mask = graph->slotCapacity - 1;
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        const unsigned char* record = records + (size_t)i * RAYDIAL_GRAPH_NODE_WORDS * 4;
+        RayDialNode* node = &graph->nodes[i];
+        uint32_t first = ReadGraphWord(record + 12);
+        node->id = graph->strings + ReadGraphWord(record);
+        node->text = graph->strings + ReadGraphWord(record + 4);
+        node->choiceCount = (int)ReadGraphWord(record + 16);
+        node->choices = node->choiceCount ? &graph->edges[first] : NULL;
+        if ((int)i >= graph->nodeCount) continue;
+
+        int length = (int)strlen(node->id);
+        int slot = HashGraphId(node->id, length) & mask;
+        while (graph->slots[slot] >= 0) slot = (slot + 1) & mask;
+        graph->slots[slot] = (int)i;
+    }
+    return graph;
+}
+
+// Compile the conditions and scripts of a built graph. These register names in the
+// variable store and script host, so this runs on the thread that owns them.
+static bool BindDialogueGraph(RayDialGraph* graph, const unsigned char* data, RayDialVariables* variables, RayDialScriptHost* host) {
+    int recordCount = graph->nodeCount + graph->portalCount;
+    const unsigned char* records = data + RAYDIAL_GRAPH_HEADER_WORDS * 4;
+    const unsigned char* edgeRecords = records + (size_t)recordCount * RAYDIAL_GRAPH_NODE_WORDS * 4;
+
+    bool hasConditions = false;
+    for (int i = 0; i < graph->edgeCount && !hasConditions; i++) {
+        hasConditions = ReadGraphWord(edgeRecords + (size_t)i * RAYDIAL_GRAPH_EDGE_WORDS * 4 + 4) != RAYDIAL_GRAPH_NONE;
+    }
+    if (hasConditions) {
+        graph->conditions = (RayDialCondition**)calloc(graph->edgeCount, sizeof(RayDialCondition*));
+        if (!graph->conditions) return false;
+    }
+
+    for (int i = 0; i < graph->edgeCount; i++) {
+        uint32_t condition = ReadGraphWord(edgeRecords + (size_t)i * RAYDIAL_GRAPH_EDGE_WORDS * 4 + 4);
+        if (condition == RAYDIAL_GRAPH_NONE) continue;
+        char error[128];
+        graph->conditions[i] = CompileCondition(variables, graph->strings + condition, error, sizeof(error));
+        if (!graph->conditions[i]) {
+            TraceLog(LOG_WARNING, "RAYDIAL: Graph condition \"%s\": %s", graph->strings + condition,
+                     variables ? error : "no variable store given");
+            return false;
+        }
+    }
+
+    for (int i = 0; i < graph->nodeCount; i++) {
+        const unsigned char* record = records + (size_t)i * RAYDIAL_GRAPH_NODE_WORDS * 4;
+        RayDialNode* node = &graph->nodes[i];
+        uint32_t first = ReadGraphWord(record + 12);
+
+        // Nodes share one condition array; a node with none keeps the fast path
+        for (int c = 0; c < node->choiceCount && graph->conditions && !node->choiceConditions; c++) {
+            if (graph->conditions[first + c]) node->choiceConditions = &graph->conditions[first];
+        }
+
+        uint32_t script = ReadGraphWord(record + 8);
+        if (script != RAYDIAL_GRAPH_NONE) {
+            char error[128];
+            node->script = CompileScript(host, graph->strings + script, error, sizeof(error));
+            if (!node->script) {
+                TraceLog(LOG_WARNING, "RAYDIAL: Script of node '%s': %s", node->id, host ? error : "no script host given");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+RayDialGraph* LoadDialogueGraph(const unsigned char* data, int size, RayDialVariables* variables, RayDialScriptHost* host) {
+    RayDialGraph* graph = BuildDialogueGraph(data, size);
+    if (!graph) {
+        TraceLog(LOG_WARNING, "RAYDIAL: Not a valid compiled dialogue graph");
+        return NULL;
+    }
+    if (!BindDialogueGraph(graph, data, variables, host)) {
+        FreeDialogueGraph(graph);
+        return NULL;
+    }
+    return graph;
+}
+
+RayDialGraph* LoadDialogueGraphFile(const char* path, RayDialVariables* variables, RayDialScriptHost* host) {
+    if (!path) return NULL;
+
+    int size = 0;
+    char* data = ReadGraphFile(path, &size);
+    if (!data) {
+        TraceLog(LOG_WARNING, "RAYDIAL: Could not read dialogue graph %s", path);
+        return NULL;
+    }
+    RayDialGraph* graph = LoadDialogueGraph((const unsigned char*)data, size, variables, host);
+    free(data);
+    return graph;
+}
+
+void FreeDialogueGraph(RayDialGraph* graph) {
+    if (!graph) return;
+
+    if (graph->nodes) {
+        for (int i = 0; i < graph->nodeCount + graph->portalCount; i++) {
+            FreeScript(graph->nodes[i].script);
+            free(graph->nodes[i].visibleChoices);
+        }
+    }
+    if (graph->conditions) {
+        for (int i = 0; i < graph->edgeCount; i++) FreeCondition(graph->conditions[i]);
+    }
+    free(graph->strings);
+    free(graph->nodes);
+    free(graph->edges);
+    free(graph->conditions);
+    free(graph->slots);
+    free(graph);
+}
+
+int GetGraphNodeCount(const RayDialGraph* graph) {
+    return graph ? graph->nodeCount : 0;
+}
+
+RayDialNode* GetGraphNode(const RayDialGraph* graph, int index) {
+    if (!graph || index < 0 || index >= graph->nodeCount) return NULL;
+    return &graph->nodes[index];
+}
+
+int FindGraphNodeIndex(const RayDialGraph* graph, const char* id) {
+    if (!graph || !id) return -1;
+
+    int length = (int)strlen(id);
+    int mask = graph->slotCapacity - 1;
+    for (int slot = HashGraphId(id, length) & mask; graph->slots[slot] >= 0; slot = (slot + 1) & mask) {
+        if (strcmp(graph->nodes[graph->slots[slot]].id, id) == 0) return graph->slots[slot];
+    }
+    return -1;
+}
+
+// Chapter streaming
+
+typedef enum {
+    RAYDIAL_CHAPTER_UNLOADED,
+    RAYDIAL_CHAPTER_LOADING,                // Queued or being built on the worker
+    RAYDIAL_CHAPTER_RESIDENT,
+    RAYDIAL_CHAPTER_FAILED
+} RayDialChapterState;
+
+typedef struct RayDialChapter {
+    RayDialChapterSet* set;
+    char* name;
+    char* path;
+    RayDialChapterState state;              // Only changed on the main thread
+    bool wanted;                            // The current chapter or one it links to
+    RayDialGraph* graph;                    // While resident
+    unsigned char* data;                    // Read by the worker, kept for binding
+    RayDialGraph* built;                    // Built by the worker, not yet bound
+    struct RayDialChapter* nextLoaded;      // Worker-to-main-thread handoff stack
+} RayDialChapter;
+
+struct RayDialChapterSet {
+    RayDialVariables* variables;
+    RayDialScriptHost* host;
+    RayDialWorkerPool* worker;              // Created on the first prefetch
+    RayDialChapter** chapters;              // Stable pointers, jobs hold them
+    int count;
+    int capacity;
+    RayDialChapter* current;
+    _Atomic(RayDialChapter*) loaded;        // Pushed by workers when a build finishes
+};
+
+RayDialChapterSet* CreateChapterSet(RayDialVariables* variables, RayDialScriptHost* host) {
+    RayDialChapterSet* set = (RayDialChapterSet*)calloc(1, sizeof(RayDialChapterSet));
+    if (!set) return NULL;
+    set->variables = variables;
+    set->host = host;
+    atomic_init(&set->loaded, NULL);
+    return set;
+}
+
+static RayDialChapter* FindChapter(const RayDialChapterSet* set, const char* name, int length) {
+    for (int i = 0; i < set->count; i++) {
+        RayDialChapter* chapter = set->chapters[i];
+        if (strncmp(chapter->name, name, length) == 0 && chapter->name[length] == '\0') return chapter;
+    }
+    return NULL;
+}
+
+bool AddChapter(RayDialChapterSet* set, const char* name, const char* path) {
+    if (!set || !name || !path || !*name || strchr(name, '/')) return false;
+    if (FindChapter(set, name, (int)strlen(name))) {
+        TraceLog(LOG_WARNING, "RAYDIAL: Chapter '%s' was already added", name);
+        return false;
+    }
+
+    if (set->count == set->capacity) {
+        int capacity = set->capacity ? set->capacity * 2 : 16;
+        RayDialChapter** chapters = (RayDialChapter**)realloc(set->chapters, capacity * sizeof(RayDialChapter*));
+        if (!chapters) return false;
+        set->chapters = chapters;
+        set->capacity = capacity;
+    }
+    RayDialChapter* chapter = (RayDialChapter*)calloc(1, sizeof(RayDialChapter));
+    if (!chapter) return false;
+    chapter->set = set;
+    chapter->name = strdup(name);
+    chapter->path = strdup(path);
+    if (!chapter->name || !chapter->path) {
+        free(chapter->name);
+        free(chapter->path);
+        free(chapter);
+        return false;
+    }
+    set->chapters[set->count++] = chapter;
+    return true;
+}
+
+// Worker thread entry point: read the file and lay out the graph, nothing more
+static void LoadChapterJob(void* arg) {
+    RayDialChapter* chapter = (RayDialChapter*)arg;
+    int size = 0;
+    chapter->data = (unsigned char*)ReadGraphFile(chapter->path, &size);
+    chapter->built = chapter->data ? BuildDialogueGraph(chapter->data, size) : NULL;
+
+    RayDialChapterSet* set = chapter->set;
+    RayDialChapter* head = atomic_load_explicit(&set->loaded, memory_order_relaxed);
+    do {
+        chapter->nextLoaded = head;
+    } while (!atomic_compare_exchange_weak_explicit(&set->loaded, &head, chapter,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+// Bind a built graph and make it resident, or drop it
+static void FinishChapterLoad(RayDialChapter* chapter) {
+    RayDialChapterSet* set = chapter->set;
+    if (!chapter->built) {
+        TraceLog(LOG_WARNING, "RAYDIAL: Could not load chapter '%s' from %s", chapter->name, chapter->path);
+        chapter->state = RAYDIAL_CHAPTER_FAILED;
+    } else if (chapter->wanted && BindDialogueGraph(chapter->built, chapter->data, set->variables, set->host)) {
+        chapter->graph = chapter->built;
+        chapter->state = RAYDIAL_CHAPTER_RESIDENT;
+    } else {
+        // No longer needed by the time it arrived, or its scripts didn't compile
+        if (chapter->wanted) TraceLog(LOG_WARNING, "RAYDIAL: Could not bind chapter '%s'", chapter->name);
+        FreeDialogueGraph(chapter->built);
+        chapter->state = chapter->wanted ? RAYDIAL_CHAPTER_FAILED : RAYDIAL_CHAPTER_UNLOADED;
+    }
+    free(chapter->data);
+    chapter->data = NULL;
+    chapter->built = NULL;
+}
+
+// Take every chapter the workers finished; returns whether any arrived
+static bool CollectChapterLoads(RayDialChapterSet* set) {
+    RayDialChapter* chapter = atomic_exchange_explicit(&set->loaded, NULL, memory_order_acquire);
+    bool any = chapter != NULL;
+    while (chapter) {
+        RayDialChapter* next = chapter->nextLoaded;
+        FinishChapterLoad(chapter);
+        chapter = next;
+    }
+    return any;
+}
+
+// Point each portal at the text of the node it leads to while that chapter is resident,
+// so choices into other chapters read like any other choice
+static void LinkChapterPortals(RayDialChapterSet* set) {
+    for (int i = 0; i < set->count; i++) {
+        RayDialGraph* graph = set->chapters[i]->graph;
+        if (!graph) continue;
+        for (int p = graph->nodeCount; p < graph->nodeCount + graph->portalCount; p++) {
+            RayDialNode* portal = &graph->nodes[p];
+            const char* slash = strchr(portal->id, '/');
+            RayDialChapter* target = FindChapter(set, portal->id, (int)(slash - portal->id));
+            RayDialNode* node = target ? GetGraphNode(target->graph, FindGraphNodeIndex(target->graph, slash + 1)) : NULL;
+            portal->text = node ? node->text : "";
+        }
+    }
+}
+
+// Load a chapter now, finishing or redoing a prefetch that hasn't arrived yet
+static bool LoadChapterNow(RayDialChapter* chapter) {
+    RayDialChapterSet* set = chapter->set;
+    if (chapter->state == RAYDIAL_CHAPTER_LOADING) {
+        WaitWorkerPool(set->worker);
+        CollectChapterLoads(set);
+    }
+    if (chapter->state != RAYDIAL_CHAPTER_RESIDENT) {
+        int size = 0;
+        chapter->data = (unsigned char*)ReadGraphFile(chapter->path, &size);
+        chapter->built = chapter->data ? BuildDialogueGraph(chapter->data, size) : NULL;
+        FinishChapterLoad(chapter);
+    }
+    LinkChapterPortals(set);
+    return chapter->state == RAYDIAL_CHAPTER_RESIDENT;
+}
+
+// Make chapter current and start loading the chapters its portals lead to. Chapters
+// no longer wanted are evicted by UpdateChapterSet, not here, because the node being
+// left may still be in use.
+static void SetCurrentChapter(RayDialChapterSet* set, RayDialChapter* chapter) {
+    if (set->current == chapter) return;
+    set->current = chapter;
+
+    for (int i = 0; i < set->count; i++) set->chapters[i]->wanted = false;
+    chapter->wanted = true;
+
+    RayDialGraph* graph = chapter->graph;
+    for (int p = graph->nodeCount; p < graph->nodeCount + graph->portalCount; p++) {
+        const char* id = graph->nodes[p].id;
+        RayDialChapter* neighbour = FindChapter(set, id, (int)(strchr(id, '/') - id));
+        if (!neighbour || neighbour->wanted) continue;
+        neighbour->wanted = true;
+        if (neighbour->state != RAYDIAL_CHAPTER_UNLOADED) continue;
+
+        if (!set->worker) set->worker = CreateWorkerPool(1);
+        if (set->worker && SubmitWorkerJob(set->worker, LoadChapterJob, neighbour)) {
+            neighbour->state = RAYDIAL_CHAPTER_LOADING;
+        }
+    }
+}
+
+RayDialNode* EnterChapterNode(RayDialChapterSet* set, const char* id) {
+    if (!set || !id) return NULL;
+
+    const char* slash = strchr(id, '/');
+    int nameLength = slash ? (int)(slash - id) : (int)strlen(id);
+    RayDialChapter* chapter = FindChapter(set, id, nameLength);
+    if (!chapter) {
+        TraceLog(LOG_WARNING, "RAYDIAL: Unknown chapter '%.*s'", nameLength, id);
+        return NULL;
+    }
+
+    chapter->wanted = true;
+    if (!LoadChapterNow(chapter)) return NULL;
+
+    RayDialNode* node = slash ? GetGraphNode(chapter->graph, FindGraphNodeIndex(chapter->graph, slash + 1))
+                              : GetGraphNode(chapter->graph, 0);
+    if (!node) {
+        TraceLog(LOG_WARNING, "RAYDIAL: Chapter '%s' has no node '%s'", chapter->name, slash ? slash + 1 : "");
+        return NULL;
+    }
+    SetCurrentChapter(set, chapter);
+    return node;
+}
+
+RayDialNode* GetChapterNode(RayDialChapterSet* set, const char* name, int index) {
+    if (!set || !name) return NULL;
+
+    RayDialChapter* chapter = FindChapter(set, name, (int)strlen(name));
+    if (!chapter) return NULL;
+
+    // Loading binds only wanted chapters. It is wanted just for the lookup, so unless
+    // entered it goes with the next UpdateChapterSet, or right away on a miss.
+    bool wasUnloaded = chapter->state == RAYDIAL_CHAPTER_UNLOADED;
+    bool wanted = chapter->wanted;
+    chapter->wanted = true;
+    bool loaded = LoadChapterNow(chapter);
+    chapter->wanted = wanted;
+    if (!loaded) return NULL;
+
+    RayDialNode* node = GetGraphNode(chapter->graph, index);
+    if (!node && wasUnloaded && !wanted) {
+        FreeDialogueGraph(chapter->graph);
+        chapter->graph = NULL;
+        chapter->state = RAYDIAL_CHAPTER_UNLOADED;
+        LinkChapterPortals(set);
+    }
+    return node;
+}
+
+RayDialNode* FollowChapterLink(RayDialChapterSet* set, RayDialNode* node) {
+    if (!set || !node) return node;
+
+    for (int i = 0; i < set->count; i++) {
+        RayDialChapter* chapter = set->chapters[i];
+        RayDialGraph* graph = chapter->graph;
+        if (!graph || node < graph->nodes || node >= graph->nodes + graph->nodeCount + graph->portalCount) continue;
+
+        if (node >= graph->nodes + graph->nodeCount) return EnterChapterNode(set, node->id);
+        SetCurrentChapter(set, chapter);
+        return node;
+    }
+    return node;
+}
+
+void UpdateChapterSet(RayDialChapterSet* set) {
+    if (!set) return;
+
+    bool changed = CollectChapterLoads(set);
+    for (int i = 0; i < set->count; i++) {
+        RayDialChapter* chapter = set->chapters[i];
+        if (chapter->state != RAYDIAL_CHAPTER_RESIDENT || chapter->wanted) continue;
+        FreeDialogueGraph(chapter->graph);
+        chapter->graph = NULL;
+        chapter->state = RAYDIAL_CHAPTER_UNLOADED;
+        changed = true;
+    }
+    if (changed) LinkChapterPortals(set);
+}
+
+void WaitChapterSet(RayDialChapterSet* set) {
+    if (set && set->worker) WaitWorkerPool(set->worker);
+}
+
+RayDialGraph* GetCurrentChapterGraph(const RayDialChapterSet* set) {
+    return set && set->current ? set->current->graph : NULL;
+}
+
+const char* GetCurrentChapterName(const RayDialChapterSet* set) {
+    return set && set->current ? set->current->name : NULL;
+}
+
+// Position of the current chapter in the order chapters were added, -1 before any
+int GetCurrentChapterIndex(const RayDialChapterSet* set) {
+    if (!set || !set->current) return -1;
+    for (int i = 0; i < set->count; i++) {
+        if (set->chapters[i] == set->current) return i;
+    }
+    return -1;
+}
+
+bool IsChapterResident(const RayDialChapterSet* set, const char* name) {
+    if (!set || !name) return false;
+    RayDialChapter* chapter = FindChapter(set, name, (int)strlen(name));
+    return chapter && chapter->state == RAYDIAL_CHAPTER_RESIDENT;
+}
+
+void FreeChapterSet(RayDialChapterSet* set) {
+    if (!set) return;
+
+    // Jobs reference their chapters, so let them finish first
+    FreeWorkerPool(set->worker);
+    for (RayDialChapter* chapter = atomic_exchange(&set->loaded, NULL); chapter; chapter = chapter->nextLoaded) {
+        FreeDialogueGraph(chapter->built);
+        free(chapter->data);
+    }
+    for (int i = 0; i < set->count; i++) {
+        FreeDialogueGraph(set->chapters[i]->graph);
+        free(set->chapters[i]->name);
+        free(set->chapters[i]->path);
+        free(set->chapters[i]);
+    }
+    free(set->chapters);
+    free(set);
+}
@@ -0,0 +1,185 @@
+#include "raydial_history_data.h"
+#include <stdlib.h>
+#include <string.h>
+
+RayDialHistory* CreateDialogueHistory(int entryCapacity, int textCapacity) {
+    if (entryCapacity <= 0 || textCapacity <= 1) return NULL;
+
+    RayDialHistory* history = (RayDialHistory*)calloc(1, sizeof(RayDialHistory));
+    if (!history) return NULL;
+    history->entries = (RayDialHistoryEntry*)calloc(entryCapacity, sizeof(RayDialHistoryEntry));
+    history->blocks = (RayDialHistoryBlock*)calloc(entryCapacity, sizeof(RayDialHistoryBlock));
+    history->text = (char*)malloc(textCapacity);
+    if (!history->entries || !history->blocks || !history->text) {
+        FreeDialogueHistory(history);
+        return NULL;
+    }
+    history->entryCapacity = entryCapacity;
+    history->textCapacity = textCapacity;
+    return history;
+}
+
+void FreeDialogueHistory(RayDialHistory* history) {
+    if (!history) return;
+    for (int i = 0; i < history->visitedCount; i++) {
+        free(history->visited[i]);
+    }
+    free(history->visited);
+    free(history->visitedWords);
+    free(history->entries);
+    free(history->blocks);
+    free(history->text);
+    free(history);
+}
+
+void ClearDialogueHistory(RayDialHistory* history) {
+    if (!history) return;
+    history->first = 0;
+    history->count = 0;
+    history->textWrite = 0;
+    history->nextLine = 0;
+    for (int i = 0; i < history->visitedCount; i++) {
+        if (history->visited[i]) memset(history->visited[i], 0, history->visitedWords[i] * sizeof(unsigned int));
+    }
+}
+
+static void DropOldestEntry(RayDialHistory* history) {
+    history->first = (history->first + 1) % history->entryCapacity;
+    history->count--;
+    if (history->count == 0) history->textWrite = 0;
+}
+
+// Byte length of text cut to at most limit bytes without splitting a UTF-8 sequence
+static int ClipText(const char* text, int limit) {
+    int length = (int)strlen(text);
+    if (length <= limit) return length;
+    length = limit;
+    while (length > 0 && ((unsigned char)text[length] & 0xC0) == 0x80) length--;
+    return length;
+}
+
+// Make room for size bytes of strings and return where they go. Strings are laid out
+// in recording order, wrapping to the start of the arena when they don't fit at the
+// end, so the lines in the way are always the oldest ones.
+static int ReserveHistoryText(RayDialHistory* history, int size) {
+    int end = history->textWrite;
+    bool wrapped = end + size > history->textCapacity;
+    int start = wrapped ? 0 : end;
+
+    while (history->count > 0) {
+        const RayDialHistoryBlock* oldest = &history->blocks[history->first];
+        bool skipped = wrapped && oldest->start >= end;
+        bool overlaps = oldest->start < start + size && start < oldest->start + oldest->size;
+        if (!skipped && !overlaps) break;
+        DropOldestEntry(history);
+    }
+    history->textWrite = start + size;
+    return start;
+}
+
+bool RecordDialogueEntry(RayDialHistory* history, const RayDialHistoryEntry* entry) {
+    if (!history || !entry || !entry->text) return false;
+
+    // Each string keeps its NUL; a speaker takes at most half the arena, the text the rest
+    int speakerLength = entry->speaker ? ClipText(entry->speaker, history->textCapacity / 2 - 1) : -1;
+    int textLength = ClipText(entry->text, history->textCapacity - 1 - (speakerLength + 1));
+    int size = textLength + 1 + speakerLength + 1;
+
+    if (history->count == history->entryCapacity) DropOldestEntry(history);
+    int start = ReserveHistoryText(history, size);
+
+    char* text = history->text + start;
+    memcpy(text, entry->text, textLength);
+    text[textLength] = '\0';
+    char* speaker = NULL;
+    if (speakerLength >= 0) {
+        speaker = text + textLength + 1;
+        memcpy(speaker, entry->speaker, speakerLength);
+        speaker[speakerLength] = '\0';
+    }
+
+    int lineCount = entry->lineCount;
+    if (lineCount <= 0) {
+        lineCount = 1;
+        for (const char* c = text; *c; c++) {
+            if (*c == '\n') lineCount++;
+        }
+    }
+
+    int slot = (history->first + history->count) % history->entryCapacity;
+    history->blocks[slot] = (RayDialHistoryBlock){ start, size };
+    history->entries[slot] = (RayDialHistoryEntry){
+        .chapter = entry->chapter,
+        .nodeIndex = entry->nodeIndex,
+        .text = text,
+        .speaker = speaker,
+        .textIsKey = entry->textIsKey,
+        .speakerIsKey = entry->speakerIsKey && speaker,
+        .lineCount = lineCount,
+        .firstLine = history->nextLine
+    };
+    history->count++;
+    history->nextLine += lineCount + (speaker ? 1 : 0);
+    return true;
+}
+
+bool RecordDialogueLine(RayDialHistory* history, const char* text, const char* speaker) {
+    RayDialHistoryEntry entry = { .chapter = -1, .nodeIndex = -1, .text = text, .speaker = speaker };
+    return RecordDialogueEntry(history, &entry);
+}
+
+int GetDialogueHistoryCount(const RayDialHistory* history) {
+    return history ? history->count : 0;
+}
+
+const RayDialHistoryEntry* GetDialogueHistoryEntry(const RayDialHistory* history, int index) {
+    if (!history || index < 0 || index >= history->count) return NULL;
+    return &history->entries[(history->first + index) % history->entryCapacity];
+}
+
+// Visited bits live in one bitset per chapter, plus one for trees and single graphs.
+// Bitsets grow when a higher index is marked and are never shrunk.
+void MarkNodeVisited(RayDialHistory* history, int chapter, int nodeIndex) {
+    if (!history || chapter < -1 || nodeIndex < 0) return;
+
+    int space = chapter + 1;
+    if (space >= history->visitedCount) {
+        int count = space + 1;
+        unsigned int** visited = (unsigned int**)realloc(history->visited, count * sizeof(unsigned int*));
+        if (visited) history->visited = visited;
+        int* words = (int*)realloc(history->visitedWords, count * sizeof(int));
+        if (words) history->visitedWords = words;
+        if (!visited || !words) {
+            TraceLog(LOG_WARNING, "RAYDIAL: Failed to grow visited node sets");
+            return;
+        }
+        for (int i = history->visitedCount; i < count; i++) {
+            history->visited[i] = NULL;
+            history->visitedWords[i] = 0;
+        }
+        history->visitedCount = count;
+    }
+
+    int word = nodeIndex / 32;
+    if (word >= history->visitedWords[space]) {
+        int words = history->visitedWords[space] ? history->visitedWords[space] : 4;
+        while (words <= word) words *= 2;
+        unsigned int* bits = (unsigned int*)realloc(history->visited[space], words * sizeof(unsigned int));
+        if (!bits) {
+            TraceLog(LOG_WARNING, "RAYDIAL: Failed to grow visited node sets");
+            return;
+        }
+        memset(bits + history->visitedWords[space], 0, (words - history->visitedWords[space]) * sizeof(unsigned int));
+        history->visited[space] = bits;
+        history->visitedWords[space] = words;
+    }
+    history->visited[space][word] |= 1u << (nodeIndex % 32);
+}
+
+bool IsNodeVisited(const RayDialHistory* history, int chapter, int nodeIndex) {
+    if (!history || chapter < -1 || nodeIndex < 0) return false;
+    int space = chapter + 1;
+    int word = nodeIndex / 32;
+    if (space >= history->visitedCount || word >= history->visitedWords[space]) return false;
+    return (history->visited[space][word] >> (nodeIndex % 32)) & 1u;
+}
@@ -0,0 +1,30 @@
+#ifndef RAYDIAL_HISTORY_DATA_H
+#define RAYDIAL_HISTORY_DATA_H
+
+#include "raydial_history.h"
+
+// Internal layout of a history, shared with the snapshot writer
+
+typedef struct {
+    int start;                              // Offset of the entry's strings in the text arena
+    int size;                               // Bytes used there, NULs included
+} RayDialHistoryBlock;
+
+struct RayDialHistory {
+    RayDialHistoryEntry* entries;           // Ring of entryCapacity
+    RayDialHistoryBlock* blocks;            // Parallel to entries
+    int entryCapacity;
+    int first;                              // Ring position of the oldest entry
+    int count;
+    char* text;                             // Strings of the entries, allocated in FIFO order
+    int textCapacity;
+    int textWrite;                          // Where the next entry's strings go
+    long long nextLine;                     // firstLine of the next entry
+
+    // Visited bitsets, one per chapter plus one (index 0) for nodes outside chapters
+    unsigned int** visited;
+    int* visitedWords;
+    int visitedCount;
+};
+
+#endif // RAYDIAL_HISTORY_DATA_H
@@ -1,8 +1,878 @@
 #include "raydial_i18n.h"
 #include "raydial.h"
+#include "raydial_worker.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define RAYDIAL_I18N_BLOCK_SIZE 4096       // Minimum size of a table storage block
+#define RAYDIAL_I18N_MIN_SLOTS 16          // Initial hash index capacity (power of two)
+#define RAYDIAL_I18N_MIN_STRINGS 32        // Initial interned string set capacity (power of two)
+#define RAYDIAL_I18N_WATCH_INTERVAL 0.5    // Seconds between modification time checks
+#define RAYDIAL_I18N_GRACE_FRAMES 3        // Frames a replaced table stays alive
+#define RAYDIAL_I18N_MIN_STYLED 16         // Initial styled text cache capacity (power of two)
+#define RAYDIAL_FORMAT_MAX_TOKENS 128      // Tokens a single message format may compile to
+#define RAYDIAL_FORMAT_MAX_DEPTH 4         // Nesting depth of plural/select blocks
+
+// Bump-allocated storage owned by a language's table, released in bulk
+typedef struct RayDialTableBlock {
+    struct RayDialTableBlock* next;
+    size_t capacity;
+    size_t used;
+} RayDialTableBlock;
+
+struct RayDialTranslationTable {
+    RayDialTranslationEntry* head;          // Entries in insertion order
+    RayDialTranslationEntry* tail;
+    int count;
+    RayDialTranslationEntry** slots;        // Open-addressed hash index over the entries
+    int slotCapacity;
+    const char** strings;                   // Interned string set (the language's string pool)
+    int stringCapacity;
+    int stringCount;
+    size_t stringBytes;                     // Bytes of interned string data, terminators included
+    RayDialTableBlock* blocks;              // Entries and interned strings live here
+    unsigned int retireFrame;               // Frame after which a retired table may be freed
+    struct RayDialTranslationTable* nextRetired;
+};
+
+struct RayDialTranslationWatch {
+    RayDialLanguage* language;
+    char* filename;
+    long lastModTime;
+    double nextPollTime;
+    atomic_bool inFlight;                               // A parse job is queued or running
+    _Atomic(RayDialTranslationTable*) pending;          // Parsed table handed over by the worker
+    struct RayDialTranslationWatch* next;
+};
+
+// Message format tokens. A plural/select token is followed by its case tokens,
+// and each case token by its body, so a compiled format is one flat array.
+typedef enum {
+    RAYDIAL_FORMAT_LITERAL,     // Copy text[start, start + length)
+    RAYDIAL_FORMAT_ARGUMENT,    // {name}
+    RAYDIAL_FORMAT_PLURAL,      // {name, plural, ...}; span covers every case
+    RAYDIAL_FORMAT_SELECT,      // {name, select, ...}; span covers every case
+    RAYDIAL_FORMAT_CASE,        // One branch; span covers its body
+    RAYDIAL_FORMAT_NUMBER       // # inside a plural body
+} RayDialFormatTokenType;
+
+typedef struct RayDialFormatToken {
+    unsigned char type;         // RayDialFormatTokenType
+    unsigned char category;     // CASE: RayDialPluralCategory, or RAYDIAL_FORMAT_EXACT/KEYWORD
+    unsigned short length;      // Bytes of literal text, argument name or case keyword
+    unsigned int start;         // Offset into the translated value
+    int span;                   // Tokens owned by a PLURAL/SELECT/CASE token
+    long long exact;            // CASE: value matched by =N selectors
+} RayDialFormatToken;
+
+#define RAYDIAL_FORMAT_EXACT   0xFE   // Case selector "=N"
+#define RAYDIAL_FORMAT_KEYWORD 0xFF   // Select case keyword
+
+struct RayDialMessageFormat {
+    int tokenCount;
+    RayDialFormatToken tokens[];
+};
+
+// Flattened view of a language and its fallback chain, rebuilt when content changes
+struct RayDialFallbackIndex {
+    RayDialTranslationEntry** slots;        // Hash index over the winning entry for every key
+    int slotCapacity;
+    unsigned int version;                   // Manager content version the index was built at
+    RayDialTranslationEntry** fallbackEntries;  // Entries supplied by a fallback language
+    RayDialLanguage** fallbackSources;
+    int fallbackCount;
+    int fallbackCapacity;
+};
+
+// Parsed styled translation shared by every holder until its last release
+struct RayDialStyledText {
+    RayDialTextSegment* segments;           // Parsed runs (read-only once cached)
+    char* plainText;                        // Segment text concatenated, tags removed
+    int refCount;                           // Holders, the cache included while it is listed
+    // Cache key
+    const RayDialLanguage* language;
+    char* key;
+    Color defaultColor;
+    float defaultFontSize;
+    unsigned int hash;
+};
+
+// Styled translations keyed by (language, key, default color, default size)
+struct RayDialStyledTextCache {
+    RayDialStyledText** slots;              // Open-addressed, only ever cleared wholesale
+    int capacity;
+    int count;
+    unsigned int version;                   // Manager content version the cache matches
+    bool parsed;                            // useStyledTextParsing the cache was built with
+};
+
+typedef struct RayDialI18NListener {
+    RayDialI18NCallback callback;
+    void* userData;
+    struct RayDialI18NListener* next;
+} RayDialI18NListener;
+
+// FNV-1a hash of a translation key or pooled string
+static unsigned int HashTranslationKey(const char* key) {
+    unsigned int hash = 2166136261u;
+    while (*key) {
+        hash ^= (unsigned char)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static RayDialTranslationTable* CreateTranslationTable(void) {
+    return (RayDialTranslationTable*)calloc(1, sizeof(RayDialTranslationTable));
+}
+
+static void FreeTranslationTable(RayDialTranslationTable* table) {
+    if (!table) return;
+
+    RayDialTableBlock* block = table->blocks;
+    while (block) {
+        RayDialTableBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+
+    free(table->strings);
+    free(table->slots);
+    free(table);
+}
+
+// Allocate memory that lives exactly as long as the table
+static void* TableAlloc(RayDialTranslationTable* table, size_t size) {
+    size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    RayDialTableBlock* block = table->blocks;
+    if (!block || block->capacity - block->used < size) {
+        size_t capacity = size > RAYDIAL_I18N_BLOCK_SIZE ? size : RAYDIAL_I18N_BLOCK_SIZE;
+        RayDialTableBlock* newBlock = (RayDialTableBlock*)malloc(sizeof(RayDialTableBlock) + capacity);
+        if (!newBlock) return NULL;
+
+        newBlock->capacity = capacity;
+        newBlock->used = 0;
+
+        // Keep the partially used block at the front so small allocations can still fill it
+        if (block && size > RAYDIAL_I18N_BLOCK_SIZE) {
+            newBlock->next = block->next;
+            block->next = newBlock;
+        } else {
+            newBlock->next = block;
+            table->blocks = newBlock;
+        }
+        block = newBlock;
+    }
+
+    void* ptr = (char*)(block + 1) + block->used;
+    block->used += size;
+    return ptr;
+}
+
+static RayDialTranslationEntry* ProbeEntrySlots(RayDialTranslationEntry* const* slots, int capacity, const char* key) {
+    if (!slots) return NULL;
+
+    unsigned int mask = (unsigned int)capacity - 1;
+    unsigned int index = HashTranslationKey(key) & mask;
+    while (slots[index]) {
+        if (strcmp(slots[index]->key, key) == 0) {
+            return slots[index];
+        }
+        index = (index + 1) & mask;
+    }
+    return NULL;
+}
+
+static RayDialTranslationEntry* FindTableEntry(const RayDialTranslationTable* table, const char* key) {
+    if (!table) return NULL;
+    return ProbeEntrySlots(table->slots, table->slotCapacity, key);
+}
+
+static bool GrowTableIndex(RayDialTranslationTable* table) {
+    int capacity = table->slotCapacity ? table->slotCapacity * 2 : RAYDIAL_I18N_MIN_SLOTS;
+    RayDialTranslationEntry** slots = (RayDialTranslationEntry**)calloc(capacity, sizeof(RayDialTranslationEntry*));
+    if (!slots) return false;
+
+    unsigned int mask = (unsigned int)capacity - 1;
+    for (RayDialTranslationEntry* entry = table->head; entry; entry = entry->next) {
+        unsigned int index = HashTranslationKey(entry->key) & mask;
+        while (slots[index]) index = (index + 1) & mask;
+        slots[index] = entry;
+    }
+
+    free(table->slots);
+    table->slots = slots;
+    table->slotCapacity = capacity;
+    return true;
+}
+
+static bool GrowStringSet(RayDialTranslationTable* table) {
+    int capacity = table->stringCapacity ? table->stringCapacity * 2 : RAYDIAL_I18N_MIN_STRINGS;
+    const char** strings = (const char**)calloc(capacity, sizeof(const char*));
+    if (!strings) return false;
+
+    unsigned int mask = (unsigned int)capacity - 1;
+    for (int i = 0; i < table->stringCapacity; i++) {
+        if (!table->strings[i]) continue;
+        unsigned int index = HashTranslationKey(table->strings[i]) & mask;
+        while (strings[index]) index = (index + 1) & mask;
+        strings[index] = table->strings[i];
+    }
+
+    free(table->strings);
+    table->strings = strings;
+    table->stringCapacity = capacity;
+    return true;
+}
+
+// Return the pooled copy of a string, adding it on first use. Identical strings
+// share storage, so reloading unchanged files does not grow the pool.
+static const char* InternString(RayDialTranslationTable* table, const char* str) {
+    unsigned int hash = HashTranslationKey(str);
+
+    if (table->strings) {
+        unsigned int mask = (unsigned int)table->stringCapacity - 1;
+        unsigned int index = hash & mask;
+        while (table->strings[index]) {
+            if (strcmp(table->strings[index], str) == 0) {
+                return table->strings[index];
+            }
+            index = (index + 1) & mask;
+        }
+    }
+
+    if ((table->stringCount + 1) * 2 > table->stringCapacity && !GrowStringSet(table)) {
+        return NULL;
+    }
+
+    size_t size = strlen(str) + 1;
+    char* copy = (char*)TableAlloc(table, size);
+    if (!copy) return NULL;
+    memcpy(copy, str, size);
+
+    unsigned int mask = (unsigned int)table->stringCapacity - 1;
+    unsigned int index = hash & mask;
+    while (table->strings[index]) index = (index + 1) & mask;
+    table->strings[index] = copy;
+    table->stringCount++;
+    table->stringBytes += size;
+
+    return copy;
+}
+
+typedef struct RayDialFormatCompiler {
+    const char* text;
+    const char* pos;
+    RayDialFormatToken* tokens;
+    int count;
+} RayDialFormatCompiler;
+
+static RayDialFormatToken* AddFormatToken(RayDialFormatCompiler* compiler, RayDialFormatTokenType type, const char* start, size_t length) {
+    if (compiler->count >= RAYDIAL_FORMAT_MAX_TOKENS || length > 0xFFFF) return NULL;
+
+    RayDialFormatToken* token = &compiler->tokens[compiler->count++];
+    memset(token, 0, sizeof(RayDialFormatToken));
+    token->type = (unsigned char)type;
+    token->start = (unsigned int)(start - compiler->text);
+    token->length = (unsigned short)length;
+    return token;
+}
+
+static void SkipFormatSpaces(RayDialFormatCompiler* compiler) {
+    while (*compiler->pos == ' ' || *compiler->pos == '\t') compiler->pos++;
+}
+
+static size_t ReadFormatWord(RayDialFormatCompiler* compiler) {
+    const char* start = compiler->pos;
+    while ((*compiler->pos >= 'a' && *compiler->pos <= 'z') || (*compiler->pos >= 'A' && *compiler->pos <= 'Z') ||
+           (*compiler->pos >= '0' && *compiler->pos <= '9') || *compiler->pos == '_') {
+        compiler->pos++;
+    }
+    return (size_t)(compiler->pos - start);
+}
+
+static bool WordEquals(const char* word, size_t length, const char* expected) {
+    return strlen(expected) == length && strncmp(word, expected, length) == 0;
+}
+
+static bool CompileFormatSequence(RayDialFormatCompiler* compiler, int depth, bool inPlural);
+
+// Compile the cases of a plural or select block, up to and including its closing brace
+static bool CompileFormatCases(RayDialFormatCompiler* compiler, int depth, bool plural, bool inPlural) {
+    for (;;) {
+        SkipFormatSpaces(compiler);
+        if (*compiler->pos == '}') {
+            compiler->pos++;
+            return true;
+        }
+
+        const char* selector = compiler->pos;
+        long long exact = 0;
+        unsigned char category;
+        size_t length;
+        if (plural && *compiler->pos == '=') {
+            char* end;
+            exact = strtoll(compiler->pos + 1, &end, 10);
+            if (end == compiler->pos + 1) return false;
+            compiler->pos = end;
+            length = (size_t)(compiler->pos - selector);
+            category = RAYDIAL_FORMAT_EXACT;
+        } else {
+            length = ReadFormatWord(compiler);
+            if (length == 0) return false;
+            category = RAYDIAL_FORMAT_KEYWORD;
+            if (plural) {
+                static const char* names[] = { "zero", "one", "two", "few", "many", "other" };
+                category = 0xFF;
+                for (unsigned char i = 0; i < 6; i++) {
+                    if (WordEquals(selector, length, names[i])) category = i;
+                }
+                if (category == 0xFF) return false;
+            } else if (WordEquals(selector, length, "other")) {
+                category = RAYDIAL_PLURAL_OTHER;
+            }
+        }
+
+        SkipFormatSpaces(compiler);
+        if (*compiler->pos != '{') return false;
+        compiler->pos++;
+
+        RayDialFormatToken* token = AddFormatToken(compiler, RAYDIAL_FORMAT_CASE, selector, length);
+        if (!token) return false;
+        int caseIndex = compiler->count - 1;
+        token->category = category;
+        token->exact = exact;
+
+        if (!CompileFormatSequence(compiler, depth + 1, plural || inPlural)) return false;
+        if (*compiler->pos != '}') return false;
+        compiler->pos++;
+        compiler->tokens[caseIndex].span = compiler->count - caseIndex - 1;
+    }
+}
+
+// Compile "{name}", "{name, number}", "{name, plural, ...}" or "{name, select, ...}"
+// with the opening brace already consumed
+static bool CompileFormatPlaceholder(RayDialFormatCompiler* compiler, int depth, bool inPlural) {
+    SkipFormatSpaces(compiler);
+    const char* name = compiler->pos;
+    size_t nameLength = ReadFormatWord(compiler);
+    if (nameLength == 0) return false;
+    SkipFormatSpaces(compiler);
+
+    if (*compiler->pos == '}') {
+        compiler->pos++;
+        return AddFormatToken(compiler, RAYDIAL_FORMAT_ARGUMENT, name, nameLength) != NULL;
+    }
+    if (*compiler->pos != ',') return false;
+    compiler->pos++;
+    SkipFormatSpaces(compiler);
+
+    const char* kind = compiler->pos;
+    size_t kindLength = ReadFormatWord(compiler);
+    SkipFormatSpaces(compiler);
+
+    if (WordEquals(kind, kindLength, "number")) {
+        if (*compiler->pos != '}') return false;
+        compiler->pos++;
+        return AddFormatToken(compiler, RAYDIAL_FORMAT_ARGUMENT, name, nameLength) != NULL;
+    }
+
+    bool plural = WordEquals(kind, kindLength, "plural");
+    if (!plural && !WordEquals(kind, kindLength, "select")) return false;
+    if (depth >= RAYDIAL_FORMAT_MAX_DEPTH || *compiler->pos != ',') return false;
+    compiler->pos++;
+
+    if (!AddFormatToken(compiler, plural ? RAYDIAL_FORMAT_PLURAL : RAYDIAL_FORMAT_SELECT, name, nameLength)) return false;
+    int blockIndex = compiler->count - 1;
+    if (!CompileFormatCases(compiler, depth, plural, inPlural)) return false;
+    compiler->tokens[blockIndex].span = compiler->count - blockIndex - 1;
+    return true;
+}
+
+// Compile text up to the end of the string or, when nested, the closing brace of a case
+static bool CompileFormatSequence(RayDialFormatCompiler* compiler, int depth, bool inPlural) {
+    for (;;) {
+        const char* start = compiler->pos;
+        while (*compiler->pos && *compiler->pos != '{' && *compiler->pos != '}' && !(inPlural && *compiler->pos == '#')) {
+            compiler->pos++;
+        }
+        if (compiler->pos > start && !AddFormatToken(compiler, RAYDIAL_FORMAT_LITERAL, start, (size_t)(compiler->pos - start))) {
+            return false;
+        }
+
+        switch (*compiler->pos) {
+            case '\0':
+                return depth == 0;
+            case '}':
+                return depth > 0;
+            case '#':
+                if (!AddFormatToken(compiler, RAYDIAL_FORMAT_NUMBER, compiler->pos, 1)) return false;
+                compiler->pos++;
+                break;
+            default:
+                compiler->pos++;
+                if (!CompileFormatPlaceholder(compiler, depth, inPlural)) return false;
+                break;
+        }
+    }
+}
+
+// Precompile a translated value's placeholders into the table's storage. Values
+// without placeholders, and malformed ones, get no format and are copied verbatim.
+static RayDialMessageFormat* CompileMessageFormat(RayDialTranslationTable* table, const char* value) {
+    if (!strchr(value, '{')) return NULL;
+
+    RayDialFormatToken tokens[RAYDIAL_FORMAT_MAX_TOKENS];
+    RayDialFormatCompiler compiler = { value, value, tokens, 0 };
+    if (!CompileFormatSequence(&compiler, 0, false)) return NULL;
+
+    size_t size = sizeof(RayDialMessageFormat) + (size_t)compiler.count * sizeof(RayDialFormatToken);
+    RayDialMessageFormat* format = (RayDialMessageFormat*)TableAlloc(table, size);
+    if (!format) return NULL;
+
+    format->tokenCount = compiler.count;
+    memcpy(format->tokens, tokens, (size_t)compiler.count * sizeof(RayDialFormatToken));
+    return format;
+}
+
+// Insert or update a key. Strings are referenced as given; flags record which of
+// them live in the table's pool.
+static bool SetTableEntry(RayDialTranslationTable* table, const char* key, const char* value, unsigned int flags) {
+    RayDialTranslationEntry* entry = FindTableEntry(table, key);
+    if (entry) {
+        // Formats hold offsets, so the same text keeps its format; the arena can't
+        // take the old one back, and recompiling on every reload would grow it
+        if (entry->value != value && strcmp(entry->value, value) != 0) {
+            entry->format = CompileMessageFormat(table, value);
+        }
+        entry->value = value;
+        entry->flags = (entry->flags & ~RAYDIAL_TRANSLATION_VALUE_OWNED) | (flags & RAYDIAL_TRANSLATION_VALUE_OWNED);
+        return true;
+    }
+
+    // Keep the index at most half full so probes stay short
+    if ((table->count + 1) * 2 > table->slotCapacity && !GrowTableIndex(table)) {
+        return false;
+    }
+
+    entry = (RayDialTranslationEntry*)TableAlloc(table, sizeof(RayDialTranslationEntry));
+    if (!entry) return false;
+
+    entry->key = key;
+    entry->value = value;
+    entry->flags = flags;
+    entry->format = CompileMessageFormat(table, value);
+    entry->next = NULL;
+
+    if (table->tail) {
+        table->tail->next = entry;
+    } else {
+        table->head = entry;
+    }
+    table->tail = entry;
+    table->count++;
+
+    unsigned int mask = (unsigned int)table->slotCapacity - 1;
+    unsigned int index = HashTranslationKey(key) & mask;
+    while (table->slots[index]) index = (index + 1) & mask;
+    table->slots[index] = entry;
+
+    return true;
+}
+
+// Read a key=value file into the table's string pool. The file is read with a
+// single temporary allocation and split in place, so parsing costs no per-line
+// allocations. Touches no shared state, which makes it safe to run on a worker thread.
+static bool ParseTranslationsIntoTable(RayDialTranslationTable* table, const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) return false;
+
+    if (fseek(file, 0, SEEK_END) != 0) {
+        fclose(file);
+        return false;
+    }
+    long fileSize = ftell(file);
+    if (fileSize < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        fclose(file);
+        return false;
+    }
+
+    char* text = (char*)malloc((size_t)fileSize + 1);
+    if (!text) {
+        fclose(file);
+        return false;
+    }
+    size_t length = fread(text, 1, (size_t)fileSize, file);
+    text[length] = '\0';
+    fclose(file);
+
+    char* line = text;
+    while (line < text + length) {
+        char* lineEnd = strchr(line, '\n');
+        char* nextLine = lineEnd ? lineEnd + 1 : text + length;
+        if (lineEnd) *lineEnd = '\0';
+
+        // Remove carriage returns left by CRLF files
+        char* end = line + strlen(line);
+        while (end > line && end[-1] == '\r') *--end = '\0';
+
+        // Skip comments and empty lines
+        char* separator = strchr(line, '=');
+        if (line[0] == '#' || line[0] == '\0' || !separator) {
+            line = nextLine;
+            continue;
+        }
+
+        // Trim whitespace from key
+        *separator = '\0';
+        end = separator;
+        while (end > line && (end[-1] == ' ' || end[-1] == '\t')) *--end = '\0';
+
+        // Trim leading whitespace from value
+        char* value = separator + 1;
+        while (*value == ' ' || *value == '\t') value++;
+
+        const char* key = InternString(table, line);
+        value = (char*)InternString(table, value);
+        if (!key || !value ||
+            !SetTableEntry(table, key, value, RAYDIAL_TRANSLATION_KEY_OWNED | RAYDIAL_TRANSLATION_VALUE_OWNED)) {
+            free(text);
+            return false;
+        }
+
+        line = nextLine;
+    }
+
+    free(text);
+    return true;
+}
+
+static size_t GetTableMemoryUsage(const RayDialTranslationTable* table) {
+    size_t bytes = sizeof(RayDialTranslationTable);
+    for (const RayDialTableBlock* block = table->blocks; block; block = block->next) {
+        bytes += sizeof(RayDialTableBlock) + block->capacity;
+    }
+    bytes += (size_t)table->slotCapacity * sizeof(RayDialTranslationEntry*);
+    bytes += (size_t)table->stringCapacity * sizeof(const char*);
+    return bytes;
+}
+
+static void AccumulateTableStats(const RayDialTranslationTable* table, RayDialI18NStats* stats) {
+    if (!table) return;
+
+    stats->entryCount += table->count;
+    stats->ownedStrings += table->stringCount;
+    stats->stringBytes += table->stringBytes;
+    stats->totalBytes += GetTableMemoryUsage(table);
+
+    for (const RayDialTranslationEntry* entry = table->head; entry; entry = entry->next) {
+        if (!(entry->flags & RAYDIAL_TRANSLATION_KEY_OWNED)) stats->borrowedStrings++;
+        if (!(entry->flags & RAYDIAL_TRANSLATION_VALUE_OWNED)) stats->borrowedStrings++;
+    }
+}
+
+static RayDialLanguage* FindLanguage(RayDialI18N* manager, const char* languageCode) {
+    RayDialLanguage* lang = manager->languages;
+    while (lang) {
+        if (strcmp(lang->languageCode, languageCode) == 0) {
+            return lang;
+        }
+        lang = lang->next;
+    }
+    return NULL;
+}
+
+static void FreeFallbackIndex(RayDialFallbackIndex* index) {
+    if (!index) return;
+
+    free(index->slots);
+    free(index->fallbackEntries);
+    free(index->fallbackSources);
+    free(index);
+}
+
+// Flatten a language and its fallback chain into one hash index so lookups
+// cost a single probe no matter how long the chain is
+static bool BuildFallbackIndex(RayDialI18N* manager, RayDialLanguage* lang) {
+    if (!lang->resolved) {
+        lang->resolved = (RayDialFallbackIndex*)calloc(1, sizeof(RayDialFallbackIndex));
+        if (!lang->resolved) return false;
+    }
+    RayDialFallbackIndex* index = lang->resolved;
+
+    int total = 0;
+    for (RayDialLanguage* step = lang; step; step = step->fallback) {
+        if (step->table) total += step->table->count;
+    }
+
+    int capacity = RAYDIAL_I18N_MIN_SLOTS;
+    while (capacity < total * 2) capacity *= 2;
+
+    if (capacity != index->slotCapacity) {
+        RayDialTranslationEntry** slots = (RayDialTranslationEntry**)calloc(capacity, sizeof(RayDialTranslationEntry*));
+        if (!slots) return false;
+        free(index->slots);
+        index->slots = slots;
+        index->slotCapacity = capacity;
+    } else {
+        memset(index->slots, 0, (size_t)capacity * sizeof(RayDialTranslationEntry*));
+    }
+
+    if (total > index->fallbackCapacity) {
+        RayDialTranslationEntry** entries = (RayDialTranslationEntry**)realloc(index->fallbackEntries, total * sizeof(RayDialTranslationEntry*));
+        if (!entries) return false;
+        index->fallbackEntries = entries;
+        RayDialLanguage** sources = (RayDialLanguage**)realloc(index->fallbackSources, total * sizeof(RayDialLanguage*));
+        if (!sources) return false;
+        index->fallbackSources = sources;
+        index->fallbackCapacity = total;
+    }
+    index->fallbackCount = 0;
+
+    // Earlier languages in the chain win; later ones only fill the gaps
+    unsigned int mask = (unsigned int)capacity - 1;
+    for (RayDialLanguage* step = lang; step; step = step->fallback) {
+        if (!step->table) continue;
+
+        for (RayDialTranslationEntry* entry = step->table->head; entry; entry = entry->next) {
+            unsigned int slot = HashTranslationKey(entry->key) & mask;
+            bool present = false;
+            while (index->slots[slot]) {
+                if (strcmp(index->slots[slot]->key, entry->key) == 0) {
+                    present = true;
+                    break;
+                }
+                slot = (slot + 1) & mask;
+            }
+            if (present) continue;
+
+            index->slots[slot] = entry;
+            if (step != lang) {
+                index->fallbackEntries[index->fallbackCount] = entry;
+                index->fallbackSources[index->fallbackCount] = step;
+                index->fallbackCount++;
+            }
+        }
+    }
+
+    index->version = manager->contentVersion;
+    return true;
+}
+
+// Rebuild every stale fallback index. Runs at load time and from
+// UpdateI18NManager, never from GetLocalizedText, so lookups stay read-only.
+static void ResolveStaleFallbacks(RayDialI18N* manager) {
+    if (manager->resolvedVersion == manager->contentVersion) return;
+
+    bool complete = true;
+    for (RayDialLanguage* lang = manager->languages; lang; lang = lang->next) {
+        if (!lang->fallback) {
+            FreeFallbackIndex(lang->resolved);
+            lang->resolved = NULL;
+        } else if (!lang->resolved || lang->resolved->version != manager->contentVersion) {
+            if (!BuildFallbackIndex(manager, lang)) complete = false;
+        }
+    }
+
+    if (complete) manager->resolvedVersion = manager->contentVersion;
+}
+
+// Record that translation content changed; resolved strings must be refreshed
+static void MarkContentChanged(RayDialI18N* manager) {
+    manager->contentVersion++;
+    manager->generation++;
+}
+
+static void NotifyTranslationsChanged(RayDialI18N* manager) {
+    manager->generation++;
+
+    RayDialI18NListener* listener = manager->listeners;
+    while (listener) {
+        RayDialI18NListener* next = listener->next;
+        listener->callback(listener->userData);
+        listener = next;
+    }
+}
+
+// Keep a replaced table alive for a few frames so strings still held by
+// components stay valid until they re-resolve
+static void RetireTranslationTable(RayDialI18N* manager, RayDialTranslationTable* table) {
+    if (!table) return;
+
+    table->retireFrame = manager->frameCounter + RAYDIAL_I18N_GRACE_FRAMES;
+    table->nextRetired = manager->retiredTables;
+    manager->retiredTables = table;
+}
+
+// Swap in a freshly parsed table and retire the one it replaces
+static void PublishTranslationTable(RayDialI18N* manager, RayDialLanguage* lang, RayDialTranslationTable* table) {
+    RetireTranslationTable(manager, lang->table);
+    lang->table = table;
+    lang->translations = table->head;
+
+    manager->contentVersion++;
+    ResolveStaleFallbacks(manager);
+    NotifyTranslationsChanged(manager);
+}
+
+static void ReleaseRetiredTables(RayDialI18N* manager, bool releaseAll) {
+    RayDialTranslationTable** link = &manager->retiredTables;
+    while (*link) {
+        RayDialTranslationTable* table = *link;
+        if (releaseAll || (int)(manager->frameCounter - table->retireFrame) >= 0) {
+            *link = table->nextRetired;
+            FreeTranslationTable(table);
+        } else {
+            link = &table->nextRetired;
+        }
+    }
+}
+
+// Worker thread entry point: parse the watched file into a brand new table
+static void ReloadTranslationsJob(void* arg) {
+    RayDialTranslationWatch* watch = (RayDialTranslationWatch*)arg;
+
+    RayDialTranslationTable* table = CreateTranslationTable();
+    if (table && !ParseTranslationsIntoTable(table, watch->filename)) {
+        FreeTranslationTable(table);
+        table = NULL;
+    }
+
+    if (table) {
+        RayDialTranslationTable* unclaimed = atomic_exchange_explicit(&watch->pending, table, memory_order_acq_rel);
+        FreeTranslationTable(unclaimed);
+    }
+
+    atomic_store_explicit(&watch->inFlight, false, memory_order_release);
+}
+
+static bool QueueTranslationReload(RayDialI18N* manager, RayDialTranslationWatch* watch) {
+    atomic_store_explicit(&watch->inFlight, true, memory_order_relaxed);
+    if (!SubmitWorkerJob(manager->worker, ReloadTranslationsJob, watch)) {
+        atomic_store_explicit(&watch->inFlight, false, memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+static void FreeTranslationWatch(RayDialTranslationWatch* watch) {
+    FreeTranslationTable(atomic_exchange(&watch->pending, NULL));
+    free(watch->filename);
+    free(watch);
+}
+
+// Release a styled text reference; the last release frees it
+void ReleaseStyledText(RayDialStyledText* styledText) {
+    if (!styledText) return;
+    if (--styledText->refCount > 0) return;
+    
+    FreeStyledText(styledText->segments);
+    free(styledText->plainText);
+    free(styledText->key);
+    free(styledText);
+}
+
+// Take another reference to a styled text
+RayDialStyledText* RetainStyledText(RayDialStyledText* styledText) {
+    if (styledText) styledText->refCount++;
+    return styledText;
+}
+
+const RayDialTextSegment* GetStyledTextSegments(const RayDialStyledText* styledText) {
+    return styledText ? styledText->segments : NULL;
+}
+
+const char* GetStyledTextPlain(const RayDialStyledText* styledText) {
+    return styledText ? styledText->plainText : NULL;
+}
+
+// Drop the cache's references; texts still held elsewhere stay alive
+static void ClearStyledTextCache(RayDialStyledTextCache* cache) {
+    if (!cache) return;
+    
+    for (int i = 0; i < cache->capacity; i++) {
+        if (cache->slots[i]) {
+            ReleaseStyledText(cache->slots[i]);
+            cache->slots[i] = NULL;
+        }
+    }
+    cache->count = 0;
+}
+
+static unsigned int HashStyledKey(const RayDialLanguage* language, const char* key, Color color, float fontSize) {
+    unsigned int hash = HashTranslationKey(key);
+    hash ^= (unsigned int)(uintptr_t)language * 2654435761u;
+    hash ^= ((unsigned int)color.r << 24 | (unsigned int)color.g << 16 | (unsigned int)color.b << 8 | color.a) * 16777619u;
+    hash ^= (unsigned int)(fontSize * 64.0f) * 2246822519u;
+    return hash;
+}
+
+static bool StyledKeyMatches(const RayDialStyledText* text, const RayDialLanguage* language, const char* key, Color color, float fontSize, unsigned int hash) {
+    return text->hash == hash && text->language == language &&
+           text->defaultColor.r == color.r && text->defaultColor.g == color.g &&
+           text->defaultColor.b == color.b && text->defaultColor.a == color.a &&
+           text->defaultFontSize == fontSize && strcmp(text->key, key) == 0;
+}
+
+static bool GrowStyledTextCache(RayDialStyledTextCache* cache) {
+    int capacity = cache->capacity ? cache->capacity * 2 : RAYDIAL_I18N_MIN_STYLED;
+    RayDialStyledText** slots = (RayDialStyledText**)calloc(capacity, sizeof(RayDialStyledText*));
+    if (!slots) return false;
+    
+    unsigned int mask = (unsigned int)capacity - 1;
+    for (int i = 0; i < cache->capacity; i++) {
+        RayDialStyledText* text = cache->slots[i];
+        if (!text) continue;
+        unsigned int index = text->hash & mask;
+        while (slots[index]) index = (index + 1) & mask;
+        slots[index] = text;
+    }
+    
+    free(cache->slots);
+    cache->slots = slots;
+    cache->capacity = capacity;
+    return true;
+}
+
+// Parse a resolved string into a standalone styled text with one reference
+static RayDialStyledText* CreateStyledText(const char* text, bool parse, Color defaultColor, float defaultFontSize) {
+    RayDialStyledText* styled = (RayDialStyledText*)calloc(1, sizeof(RayDialStyledText));
+    if (!styled) return NULL;
+    styled->refCount = 1;
+    
+    if (parse) {
+        styled->segments = ParseStyledText(text, defaultColor, defaultFontSize);
+    } else {
+        // Unparsed text is a single unstyled segment
+        styled->segments = (RayDialTextSegment*)calloc(1, sizeof(RayDialTextSegment));
+        if (styled->segments) styled->segments->text = strdup(text);
+    }
+    
+    // Plain text is what the segments actually render, so unmatched brackets survive
+    size_t length = 0;
+    for (RayDialTextSegment* segment = styled->segments; segment; segment = segment->next) {
+        if (segment->text) length += strlen(segment->text);
+    }
+    styled->plainText = (char*)malloc(length + 1);
+    if (!styled->plainText) {
+        ReleaseStyledText(styled);
+        return NULL;
+    }
+    char* dst = styled->plainText;
+    for (RayDialTextSegment* segment = styled->segments; segment; segment = segment->next) {
+        if (!segment->text) continue;
+        size_t segmentLength = strlen(segment->text);
+        memcpy(dst, segment->text, segmentLength);
+        dst += segmentLength;
+    }
+    *dst = '\0';
+    
+    return styled;
+}
 
 // Create a new localization manager
 RayDialI18N* CreateI18NManager(void) {
@@ -11,6 +881,15 @@ RayDialI18N* CreateI18NManager(void) {
         manager->languages = NULL;
         manager->currentLanguage = NULL;
         manager->useStyledTextParsing = true;
+        manager->generation = 0;
+        manager->frameCounter = 0;
+        manager->watches = NULL;
+        manager->retiredTables = NULL;
+        manager->worker = NULL;
+        manager->listeners = NULL;
+        manager->contentVersion = 0;
+        manager->resolvedVersion = 0;
+        manager->styledCache = NULL;
     }
     return manager;
 }
@@ -19,21 +898,41 @@ RayDialI18N* CreateI18NManager(void) {
 void FreeI18NManager(RayDialI18N* manager) {
     if (!manager) return;
     
-    // Free all languages and their translation entries
+    // Stop the background parser before tearing down what its jobs reference
+    FreeWorkerPool(manager->worker);
+    
+    RayDialTranslationWatch* watch = manager->watches;
+    while (watch) {
+        RayDialTranslationWatch* nextWatch = watch->next;
+        FreeTranslationWatch(watch);
+        watch = nextWatch;
+    }
+    
+    RayDialI18NListener* listener = manager->listeners;
+    while (listener) {
+        RayDialI18NListener* nextListener = listener->next;
+        free(listener);
+        listener = nextListener;
+    }
+    
+    ReleaseRetiredTables(manager, true);
+    
+    // Styled texts still held by components outlive the cache
+    if (manager->styledCache) {
+        ClearStyledTextCache(manager->styledCache);
+        free(manager->styledCache->slots);
+        free(manager->styledCache);
+    }
+    
+    // Free all languages and their translation tables
     RayDialLanguage* lang = manager->languages;
     while (lang) {
         RayDialLanguage* nextLang = lang->next;
         
-        // Free all translations in this language
-        RayDialTranslationEntry* entry = lang->translations;
-        while (entry) {
-            RayDialTranslationEntry* nextEntry = entry->next;
-            
-            // Free the entry itself (but not the strings, as they might be static)
-            free(entry);
-            
-            entry = nextEntry;
-        }
+        // The table's pool holds the entries and every owned string; borrowed
+        // strings passed to AddTranslation are left alone
+        FreeTranslationTable(lang->table);
+        FreeFallbackIndex(lang->resolved);
         
         // Free the language itself (but not the code and name, as they might be static)
         free(lang);
@@ -65,6 +964,10 @@ bool AddLanguage(RayDialI18N* manager, const char* languageCode, const char* lan
     newLang->languageCode = languageCode;
     newLang->languageName = languageName;
     newLang->translations = NULL;
+    newLang->table = NULL;
+    newLang->fallback = NULL;
+    newLang->resolved = NULL;
+    newLang->pluralRule = NULL;
     newLang->next = NULL;
     
     // Add the language to the list
@@ -86,20 +989,109 @@ bool AddLanguage(RayDialI18N* manager, const char* languageCode, const char* lan
     return true;
 }
 
+// Remove a language and release its string pool
+bool RemoveLanguage(RayDialI18N* manager, const char* languageCode) {
+    if (!manager || !languageCode) return false;
+    
+    RayDialLanguage** link = &manager->languages;
+    while (*link && strcmp((*link)->languageCode, languageCode) != 0) {
+        link = &(*link)->next;
+    }
+    
+    RayDialLanguage* lang = *link;
+    if (!lang) return false; // Language not found
+    
+    UnwatchTranslationFile(manager, languageCode);
+    *link = lang->next;
+    
+    // Chains that went through this language skip over it
+    for (RayDialLanguage* other = manager->languages; other; other = other->next) {
+        if (other->fallback == lang) {
+            other->fallback = lang->fallback;
+        }
+    }
+    
+    // Strings may still be held by components; retire the table like a reload would
+    RetireTranslationTable(manager, lang->table);
+    FreeFallbackIndex(lang->resolved);
+    
+    manager->contentVersion++;
+    ResolveStaleFallbacks(manager);
+    
+    if (manager->currentLanguage == lang) {
+        manager->currentLanguage = manager->languages;
+        NotifyTranslationsChanged(manager);
+    }
+    
+    free(lang);
+    return true;
+}
+
 // Set the current language by language code
 bool SetCurrentLanguage(RayDialI18N* manager, const char* languageCode) {
     if (!manager || !languageCode) return false;
     
-    RayDialLanguage* lang = manager->languages;
-    while (lang) {
-        if (strcmp(lang->languageCode, languageCode) == 0) {
-            manager->currentLanguage = lang;
-            return true;
+    RayDialLanguage* lang = FindLanguage(manager, languageCode);
+    if (!lang) return false; // Language not found
+    
+    if (manager->currentLanguage != lang) {
+        ResolveStaleFallbacks(manager);
+        manager->currentLanguage = lang;
+        NotifyTranslationsChanged(manager);
+    }
+    return true;
+}
+
+// Set the language consulted when a key is missing (NULL clears it).
+// Chains such as pt-BR -> pt -> en are built by setting one link at a time.
+bool SetLanguageFallback(RayDialI18N* manager, const char* languageCode, const char* fallbackCode) {
+    if (!manager || !languageCode) return false;
+    
+    RayDialLanguage* lang = FindLanguage(manager, languageCode);
+    if (!lang) return false; // Language not found
+    
+    RayDialLanguage* fallback = NULL;
+    if (fallbackCode) {
+        fallback = FindLanguage(manager, fallbackCode);
+        if (!fallback) return false; // Fallback language not found
+        
+        // Refuse links that would make the chain loop
+        for (RayDialLanguage* step = fallback; step; step = step->fallback) {
+            if (step == lang) return false;
         }
-        lang = lang->next;
     }
     
-    return false; // Language not found
+    lang->fallback = fallback;
+    MarkContentChanged(manager);
+    ResolveStaleFallbacks(manager);
+    return true;
+}
+
+// Precompute fallback resolution for every language. Adding translations one by
+// one only marks the tables stale; call this once setup is done (UpdateI18NManager
+// does it automatically) so lookups never walk the chain.
+void ResolveLanguageFallbacks(RayDialI18N* manager) {
+    if (!manager) return;
+    ResolveStaleFallbacks(manager);
+}
+
+// List the keys of a language that are supplied by a fallback language.
+// Returns the total number of such keys; at most maxKeys are written.
+int GetFallbackReport(RayDialI18N* manager, const char* languageCode, RayDialFallbackKey* keys, int maxKeys) {
+    if (!manager || !languageCode) return 0;
+    
+    RayDialLanguage* lang = FindLanguage(manager, languageCode);
+    if (!lang || !lang->fallback) return 0;
+    
+    ResolveStaleFallbacks(manager);
+    RayDialFallbackIndex* index = lang->resolved;
+    if (!index || index->version != manager->contentVersion) return 0;
+    
+    for (int i = 0; keys && i < index->fallbackCount && i < maxKeys; i++) {
+        keys[i].key = index->fallbackEntries[i]->key;
+        keys[i].languageCode = index->fallbackSources[i]->languageCode;
+    }
+    return index->fallbackCount;
 }
 
 // Get the current language
@@ -120,140 +1112,83 @@ const char* GetCurrentLanguageName(RayDialI18N* manager) {
     return manager->currentLanguage->languageName;
 }
 
-// Add a translation to a language
-bool AddTranslation(RayDialI18N* manager, const char* languageCode, const char* key, const char* value) {
+static bool AddTranslationWithFlags(RayDialI18N* manager, const char* languageCode, const char* key, const char* value, bool copyStrings) {
     if (!manager || !languageCode || !key || !value) return false;
     
     // Find the language
-    RayDialLanguage* lang = manager->languages;
-    while (lang) {
-        if (strcmp(lang->languageCode, languageCode) == 0) {
-            break;
-        }
-        lang = lang->next;
-    }
-    
+    RayDialLanguage* lang = FindLanguage(manager, languageCode);
     if (!lang) return false; // Language not found
     
-    // Check if the key already exists
-    RayDialTranslationEntry* entry = lang->translations;
-    while (entry) {
-        if (strcmp(entry->key, key) == 0) {
-            // Update the value
-            entry->value = value;
-            return true;
-        }
-        entry = entry->next;
+    if (!lang->table) {
+        lang->table = CreateTranslationTable();
+        if (!lang->table) return false;
     }
     
-    // Create a new translation entry
-    RayDialTranslationEntry* newEntry = (RayDialTranslationEntry*)malloc(sizeof(RayDialTranslationEntry));
-    if (!newEntry) return false;
-    
-    newEntry->key = key;
-    newEntry->value = value;
-    newEntry->next = NULL;
-    
-    // Add the entry to the language
-    if (!lang->translations) {
-        lang->translations = newEntry;
-    } else {
-        entry = lang->translations;
-        while (entry->next) {
-            entry = entry->next;
-        }
-        entry->next = newEntry;
+    unsigned int flags = 0;
+    if (copyStrings) {
+        key = InternString(lang->table, key);
+        value = InternString(lang->table, value);
+        if (!key || !value) return false;
+        flags = RAYDIAL_TRANSLATION_KEY_OWNED | RAYDIAL_TRANSLATION_VALUE_OWNED;
     }
     
+    if (!SetTableEntry(lang->table, key, value, flags)) return false;
+    
+    // Fallback indices are rebuilt lazily so bulk setup stays linear
+    lang->translations = lang->table->head;
+    MarkContentChanged(manager);
     return true;
 }
 
+// Add a translation to a language (strings are borrowed and must outlive the manager)
+bool AddTranslation(RayDialI18N* manager, const char* languageCode, const char* key, const char* value) {
+    return AddTranslationWithFlags(manager, languageCode, key, value, false);
+}
+
+// Add a translation whose strings are copied into the language's string pool
+bool AddTranslationCopy(RayDialI18N* manager, const char* languageCode, const char* key, const char* value) {
+    return AddTranslationWithFlags(manager, languageCode, key, value, true);
+}
+
 // Load translations from a file
 bool LoadTranslationsFromFile(RayDialI18N* manager, const char* languageCode, const char* filename) {
     if (!manager || !languageCode || !filename) return false;
     
-    FILE* file = fopen(filename, "r");
-    if (!file) return false;
-    
-    char line[1024];
-    char key[512];
-    char value[512];
-    
     // Find the language
-    RayDialLanguage* lang = NULL;
-    RayDialLanguage* current = manager->languages;
-    while (current) {
-        if (strcmp(current->languageCode, languageCode) == 0) {
-            lang = current;
-            break;
-        }
-        current = current->next;
-    }
+    RayDialLanguage* lang = FindLanguage(manager, languageCode);
+    if (!lang) return false; // Language not found
     
-    if (!lang) {
-        fclose(file);
-        return false; // Language not found
+    if (!lang->table) {
+        lang->table = CreateTranslationTable();
+        if (!lang->table) return false;
     }
     
-    // Read the file line by line
-    while (fgets(line, sizeof(line), file)) {
-        // Skip comments and empty lines
-        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
-        
-        // Parse key=value format
-        char* separator = strchr(line, '=');
-        if (!separator) continue;
-        
-        // Split the line into key and value
-        int keyLength = separator - line;
-        if (keyLength >= sizeof(key)) keyLength = sizeof(key) - 1;
-        
-        strncpy(key, line, keyLength);
-        key[keyLength] = '\0';
-        
-        // Trim whitespace from key
-        char* end = key + keyLength - 1;
-        while (end > key && (*end == ' ' || *end == '\t')) {
-            *end = '\0';
-            end--;
-        }
-        
-        // Get value part
-        separator++; // Move past '='
-        // Trim leading whitespace from value
-        while (*separator == ' ' || *separator == '\t') {
-            separator++;
-        }
-        
-        // Copy value and handle line endings
-        size_t valueLength = strlen(separator);
-        if (valueLength >= sizeof(value)) valueLength = sizeof(value) - 1;
-        
-        strncpy(value, separator, valueLength);
-        value[valueLength] = '\0';
-        
-        // Remove newline character if present
-        end = value + valueLength - 1;
-        while (end >= value && (*end == '\n' || *end == '\r')) {
-            *end = '\0';
-            end--;
-        }
-        
-        // Allocate permanent storage for the key and value
-        char* keyCopy = strdup(key);
-        char* valueCopy = strdup(value);
-        
-        if (keyCopy && valueCopy) {
-            // Add the translation
-            AddTranslation(manager, languageCode, keyCopy, valueCopy);
-        } else {
-            // Memory allocation failed
-            if (keyCopy) free(keyCopy);
-            if (valueCopy) free(valueCopy);
-        }
+    // Entries are merged into the active table; their strings are interned in
+    // the language's pool, so loading the same file again does not grow it
+    bool loaded = ParseTranslationsIntoTable(lang->table, filename);
+    
+    lang->translations = lang->table->head;
+    MarkContentChanged(manager);
+    ResolveStaleFallbacks(manager);
+    return loaded;
+}
+
+// Replace a language's translations with a file, releasing the old pool in bulk
+bool ReloadTranslationsFromFile(RayDialI18N* manager, const char* languageCode, const char* filename) {
+    if (!manager || !languageCode || !filename) return false;
+    
+    RayDialLanguage* lang = FindLanguage(manager, languageCode);
+    if (!lang) return false; // Language not found
+    
+    RayDialTranslationTable* table = CreateTranslationTable();
+    if (!table) return false;
+    
+    if (!ParseTranslationsIntoTable(table, filename)) {
+        FreeTranslationTable(table);
+        return false;
     }
     
-    fclose(file);
+    PublishTranslationTable(manager, lang, table);
     return true;
 }
 
@@ -262,16 +1197,7 @@ bool SaveTranslationsToFile(RayDialI18N* manager, const char* languageCode, cons
     if (!manager || !languageCode || !filename) return false;
     
     // Find the language
-    RayDialLanguage* lang = NULL;
-    RayDialLanguage* current = manager->languages;
-    while (current) {
-        if (strcmp(current->languageCode, languageCode) == 0) {
-            lang = current;
-            break;
-        }
-        current = current->next;
-    }
-    
+    RayDialLanguage* lang = FindLanguage(manager, languageCode);
     if (!lang) return false; // Language not found
     
     FILE* file = fopen(filename, "w");
@@ -292,44 +1218,472 @@ bool SaveTranslationsToFile(RayDialI18N* manager, const char* languageCode, cons
     return true;
 }
 
+// Watch a translation file and reload it in the background whenever it changes
+bool WatchTranslationFile(RayDialI18N* manager, const char* languageCode, const char* filename) {
+    if (!manager || !languageCode || !filename) return false;
+    
+    RayDialLanguage* lang = FindLanguage(manager, languageCode);
+    if (!lang) return false; // Language not found
+    
+    // A language follows at most one file
+    UnwatchTranslationFile(manager, languageCode);
+    
+    if (!manager->worker) {
+        manager->worker = CreateWorkerPool(1);
+        if (!manager->worker) return false;
+    }
+    
+    RayDialTranslationWatch* watch = (RayDialTranslationWatch*)malloc(sizeof(RayDialTranslationWatch));
+    if (!watch) return false;
+    
+    watch->language = lang;
+    watch->filename = strdup(filename);
+    watch->lastModTime = GetFileModTime(filename);
+    watch->nextPollTime = 0.0;
+    atomic_init(&watch->inFlight, false);
+    atomic_init(&watch->pending, NULL);
+    
+    if (!watch->filename) {
+        free(watch);
+        return false;
+    }
+    
+    watch->next = manager->watches;
+    manager->watches = watch;
+    
+    // Initial load goes through the same background path as later reloads
+    QueueTranslationReload(manager, watch);
+    return true;
+}
+
+// Stop watching the file attached to a language
+void UnwatchTranslationFile(RayDialI18N* manager, const char* languageCode) {
+    if (!manager || !languageCode) return;
+    
+    RayDialTranslationWatch** link = &manager->watches;
+    while (*link) {
+        RayDialTranslationWatch* watch = *link;
+        if (strcmp(watch->language->languageCode, languageCode) == 0) {
+            // A running job still references the watch
+            if (atomic_load_explicit(&watch->inFlight, memory_order_acquire)) {
+                WaitWorkerPool(manager->worker);
+            }
+            *link = watch->next;
+            FreeTranslationWatch(watch);
+            return;
+        }
+        link = &watch->next;
+    }
+}
+
+// Per-frame housekeeping: publish finished reloads, poll watched files and
+// release tables whose grace period has expired. Call once per frame.
+void UpdateI18NManager(RayDialI18N* manager) {
+    if (!manager) return;
+    
+    manager->frameCounter++;
+    double now = GetTime();
+    
+    RayDialTranslationWatch* watch = manager->watches;
+    while (watch) {
+        RayDialTranslationTable* table = atomic_exchange_explicit(&watch->pending, NULL, memory_order_acq_rel);
+        if (table) {
+            PublishTranslationTable(manager, watch->language, table);
+        }
+        
+        // Polling is throttled so a frame costs at most one stat per watched file
+        if (now >= watch->nextPollTime && !atomic_load_explicit(&watch->inFlight, memory_order_acquire)) {
+            watch->nextPollTime = now + RAYDIAL_I18N_WATCH_INTERVAL;
+            long modTime = GetFileModTime(watch->filename);
+            if (modTime != watch->lastModTime) {
+                watch->lastModTime = modTime;
+                QueueTranslationReload(manager, watch);
+            }
+        }
+        
+        watch = watch->next;
+    }
+    
+    // Fallback indices must stop referencing retired tables before they are freed
+    ResolveStaleFallbacks(manager);
+    ReleaseRetiredTables(manager, false);
+}
+
+// Register a callback fired after a reload is published or the language changes
+bool AddI18NReloadListener(RayDialI18N* manager, RayDialI18NCallback callback, void* userData) {
+    if (!manager || !callback) return false;
+    
+    RayDialI18NListener* listener = (RayDialI18NListener*)malloc(sizeof(RayDialI18NListener));
+    if (!listener) return false;
+    
+    listener->callback = callback;
+    listener->userData = userData;
+    listener->next = manager->listeners;
+    manager->listeners = listener;
+    return true;
+}
+
+void RemoveI18NReloadListener(RayDialI18N* manager, RayDialI18NCallback callback, void* userData) {
+    if (!manager) return;
+    
+    RayDialI18NListener** link = &manager->listeners;
+    while (*link) {
+        RayDialI18NListener* listener = *link;
+        if (listener->callback == callback && listener->userData == userData) {
+            *link = listener->next;
+            free(listener);
+            return;
+        }
+        link = &listener->next;
+    }
+}
+
+// Strings returned by GetLocalizedText stay valid until the generation changes
+// and a few more frames pass; holders should re-resolve when it differs.
+unsigned int GetI18NGeneration(RayDialI18N* manager) {
+    return manager ? manager->generation : 0;
+}
+
+// Report the memory held by one language's table and string pool
+bool GetLanguageStats(RayDialI18N* manager, const char* languageCode, RayDialI18NStats* stats) {
+    if (!manager || !languageCode || !stats) return false;
+    
+    RayDialLanguage* lang = FindLanguage(manager, languageCode);
+    if (!lang) return false; // Language not found
+    
+    memset(stats, 0, sizeof(RayDialI18NStats));
+    stats->languageCount = 1;
+    AccumulateTableStats(lang->table, stats);
+    return true;
+}
+
+// Report the memory held by every language plus tables awaiting release
+void GetI18NStats(RayDialI18N* manager, RayDialI18NStats* stats) {
+    if (!stats) return;
+    
+    memset(stats, 0, sizeof(RayDialI18NStats));
+    if (!manager) return;
+    
+    for (RayDialLanguage* lang = manager->languages; lang; lang = lang->next) {
+        stats->languageCount++;
+        AccumulateTableStats(lang->table, stats);
+    }
+    
+    for (RayDialTranslationTable* table = manager->retiredTables; table; table = table->nextRetired) {
+        stats->retiredBytes += GetTableMemoryUsage(table);
+    }
+    stats->totalBytes += stats->retiredBytes;
+}
+
 // Get localized text for a key
+static RayDialTranslationEntry* ResolveTranslationEntry(RayDialI18N* manager, const char* key) {
+    RayDialLanguage* lang = manager->currentLanguage;
+    RayDialTranslationEntry* entry = NULL;
+    
+    if (!lang->fallback) {
+        // Look the key up in the current language's hash index
+        entry = FindTableEntry(lang->table, key);
+    } else if (lang->resolved && lang->resolved->version == manager->contentVersion) {
+        // Single probe into the flattened language + fallback index
+        entry = ProbeEntrySlots(lang->resolved->slots, lang->resolved->slotCapacity, key);
+    } else {
+        // Index is stale until the next resolve point; walk the chain without mutating
+        for (RayDialLanguage* step = lang; step && !entry; step = step->fallback) {
+            entry = FindTableEntry(step->table, key);
+        }
+    }
+    return entry;
+}
+
 const char* GetLocalizedText(RayDialI18N* manager, const char* key) {
     if (!manager || !key || !manager->currentLanguage) return key;
     
-    // Search for the key in the current language
-    RayDialTranslationEntry* entry = manager->currentLanguage->translations;
-    while (entry) {
-        if (strcmp(entry->key, key) == 0) {
-            return entry->value;
-        }
-        entry = entry->next;
+    RayDialTranslationEntry* entry = ResolveTranslationEntry(manager, key);
+    if (entry) {
+        return entry->value;
     }
     
     return key; // Return the key if no translation is found
 }
 
-// Get localized styled text for a key
-RayDialTextSegment* GetLocalizedStyledText(RayDialI18N* manager, const char* key, Color defaultColor, float defaultFontSize) {
+// Bounded output for message formatting; counts the full length like snprintf
+typedef struct RayDialFormatWriter {
+    char* buffer;
+    int size;
+    int length;
+} RayDialFormatWriter;
+
+static void WriteFormatBytes(RayDialFormatWriter* writer, const char* text, size_t length) {
+    if (writer->length < writer->size - 1) {
+        size_t room = (size_t)(writer->size - 1 - writer->length);
+        memcpy(writer->buffer + writer->length, text, length < room ? length : room);
+    }
+    writer->length += (int)length;
+}
+
+static void WriteFormatArgument(RayDialFormatWriter* writer, const RayDialFormatArg* arg) {
+    char number[32];
+    int length;
+    switch (arg->type) {
+        case RAYDIAL_FORMAT_INT:
+            length = snprintf(number, sizeof(number), "%lld", arg->value.i);
+            WriteFormatBytes(writer, number, (size_t)length);
+            break;
+        case RAYDIAL_FORMAT_FLOAT:
+            length = snprintf(number, sizeof(number), "%g", arg->value.f);
+            WriteFormatBytes(writer, number, (size_t)length);
+            break;
+        case RAYDIAL_FORMAT_STRING:
+            if (arg->value.s) WriteFormatBytes(writer, arg->value.s, strlen(arg->value.s));
+            break;
+    }
+}
+
+static const RayDialFormatArg* FindFormatArg(const RayDialFormatArg* args, int argCount, const char* name, size_t length) {
+    for (int i = 0; i < argCount; i++) {
+        if (args[i].name && strncmp(args[i].name, name, length) == 0 && args[i].name[length] == '\0') {
+            return &args[i];
+        }
+    }
+    return NULL;
+}
+
+// English-style default: "one" for exactly 1, "other" for everything else
+static RayDialPluralCategory DefaultPluralRule(long long n) {
+    return n == 1 ? RAYDIAL_PLURAL_ONE : RAYDIAL_PLURAL_OTHER;
+}
+
+// Pick the case of a plural/select block; returns the index of its CASE token or -1
+static int SelectFormatCase(const RayDialFormatToken* tokens, int first, int end, const char* text,
+                            const RayDialFormatToken* block, const RayDialFormatArg* arg, RayDialPluralRule rule) {
+    int other = -1;
+    int categoryMatch = -1;
+
+    if (block->type == RAYDIAL_FORMAT_PLURAL) {
+        long long n = 0;
+        bool integral = true;
+        if (arg && arg->type == RAYDIAL_FORMAT_INT) {
+            n = arg->value.i;
+        } else if (arg && arg->type == RAYDIAL_FORMAT_FLOAT) {
+            n = (long long)arg->value.f;
+            integral = (double)n == arg->value.f;
+        }
+        RayDialPluralCategory category = integral ? rule(n) : RAYDIAL_PLURAL_OTHER;
+
+        // Exact matches win over categories, which win over "other"
+        for (int i = first; i < end; i += tokens[i].span + 1) {
+            const RayDialFormatToken* option = &tokens[i];
+            if (option->category == RAYDIAL_FORMAT_EXACT) {
+                if (integral && option->exact == n) return i;
+            } else if (option->category == category && categoryMatch < 0) {
+                categoryMatch = i;
+            } else if (option->category == RAYDIAL_PLURAL_OTHER && other < 0) {
+                other = i;
+            }
+        }
+        return categoryMatch >= 0 ? categoryMatch : other;
+    }
+
+    const char* selected = (arg && arg->type == RAYDIAL_FORMAT_STRING) ? arg->value.s : NULL;
+    for (int i = first; i < end; i += tokens[i].span + 1) {
+        const RayDialFormatToken* option = &tokens[i];
+        if (selected && strncmp(text + option->start, selected, option->length) == 0 && selected[option->length] == '\0') {
+            return i;
+        }
+        if (option->category == RAYDIAL_PLURAL_OTHER && other < 0) other = i;
+    }
+    return other;
+}
+
+static void RenderFormatTokens(RayDialFormatWriter* writer, const RayDialFormatToken* tokens, int first, int end, const char* text,
+                               const RayDialFormatArg* args, int argCount, RayDialPluralRule rule, const RayDialFormatArg* number) {
+    int i = first;
+    while (i < end) {
+        const RayDialFormatToken* token = &tokens[i];
+        switch (token->type) {
+            case RAYDIAL_FORMAT_LITERAL:
+                WriteFormatBytes(writer, text + token->start, token->length);
+                i++;
+                break;
+            case RAYDIAL_FORMAT_ARGUMENT: {
+                const RayDialFormatArg* arg = FindFormatArg(args, argCount, text + token->start, token->length);
+                if (arg) {
+                    WriteFormatArgument(writer, arg);
+                } else {
+                    // Leave unknown placeholders visible so missing arguments are easy to spot
+                    WriteFormatBytes(writer, "{", 1);
+                    WriteFormatBytes(writer, text + token->start, token->length);
+                    WriteFormatBytes(writer, "}", 1);
+                }
+                i++;
+                break;
+            }
+            case RAYDIAL_FORMAT_NUMBER:
+                if (number) WriteFormatArgument(writer, number);
+                i++;
+                break;
+            case RAYDIAL_FORMAT_PLURAL:
+            case RAYDIAL_FORMAT_SELECT: {
+                const RayDialFormatArg* arg = FindFormatArg(args, argCount, text + token->start, token->length);
+                int blockEnd = i + 1 + token->span;
+                int option = SelectFormatCase(tokens, i + 1, blockEnd, text, token, arg, rule);
+                if (option >= 0) {
+                    const RayDialFormatArg* bodyNumber = token->type == RAYDIAL_FORMAT_PLURAL ? arg : number;
+                    RenderFormatTokens(writer, tokens, option + 1, option + 1 + tokens[option].span, text,
+                                       args, argCount, rule, bodyNumber);
+                }
+                i = blockEnd;
+                break;
+            }
+            default:
+                i++;
+                break;
+        }
+    }
+}
+
+// Format a translation with named arguments into a caller-provided buffer.
+// The translation's placeholders were compiled when it was loaded, so this
+// neither parses nor allocates. Returns the full formatted length (like snprintf);
+// the output is truncated, but always terminated, when it does not fit.
+int FormatLocalizedText(RayDialI18N* manager, const char* key, char* buffer, int bufferSize, const RayDialFormatArg* args, int argCount) {
+    if (!buffer || bufferSize <= 0) {
+        buffer = NULL;
+        bufferSize = 0;
+    }
+    if (!key) {
+        if (buffer) buffer[0] = '\0';
+        return 0;
+    }
+    
+    RayDialFormatWriter writer = { buffer, bufferSize, 0 };
+    RayDialTranslationEntry* entry = (manager && manager->currentLanguage) ? ResolveTranslationEntry(manager, key) : NULL;
+    
+    if (!entry) {
+        WriteFormatBytes(&writer, key, strlen(key)); // Missing keys render verbatim
+    } else if (!entry->format) {
+        WriteFormatBytes(&writer, entry->value, strlen(entry->value));
+    } else {
+        RayDialPluralRule rule = manager->currentLanguage->pluralRule ? manager->currentLanguage->pluralRule : DefaultPluralRule;
+        RenderFormatTokens(&writer, entry->format->tokens, 0, entry->format->tokenCount, entry->value,
+                           args, argCount, rule, NULL);
+    }
+    
+    if (buffer) {
+        buffer[writer.length < bufferSize ? writer.length : bufferSize - 1] = '\0';
+    }
+    return writer.length;
+}
+
+// Set the plural rule used by FormatLocalizedText for a language (NULL restores the default)
+bool SetLanguagePluralRule(RayDialI18N* manager, const char* languageCode, RayDialPluralRule rule) {
+    if (!manager || !languageCode) return false;
+    
+    RayDialLanguage* lang = FindLanguage(manager, languageCode);
+    if (!lang) return false;
+    
+    lang->pluralRule = rule;
+    return true;
+}
+
+// Get the parsed styled text for a key, parsing it at most once per
+// (language, default color, default size) until translations change.
+// The result is shared and read-only; release it with ReleaseStyledText.
+RayDialStyledText* AcquireLocalizedStyledText(RayDialI18N* manager, const char* key, Color defaultColor, float defaultFontSize) {
     if (!manager || !key || !manager->currentLanguage) return NULL;
     
-    // First get the localized text
+    if (!manager->styledCache) {
+        manager->styledCache = (RayDialStyledTextCache*)calloc(1, sizeof(RayDialStyledTextCache));
+        if (!manager->styledCache) return NULL;
+        manager->styledCache->version = manager->contentVersion;
+        manager->styledCache->parsed = manager->useStyledTextParsing;
+    }
+    RayDialStyledTextCache* cache = manager->styledCache;
+    
+    // Any reload, added translation or fallback change invalidates every entry
+    if (cache->version != manager->contentVersion || cache->parsed != manager->useStyledTextParsing) {
+        ClearStyledTextCache(cache);
+        cache->version = manager->contentVersion;
+        cache->parsed = manager->useStyledTextParsing;
+    }
+    
+    const RayDialLanguage* language = manager->currentLanguage;
+    unsigned int hash = HashStyledKey(language, key, defaultColor, defaultFontSize);
+    if (cache->capacity) {
+        unsigned int mask = (unsigned int)cache->capacity - 1;
+        unsigned int index = hash & mask;
+        while (cache->slots[index]) {
+            if (StyledKeyMatches(cache->slots[index], language, key, defaultColor, defaultFontSize, hash)) {
+                return RetainStyledText(cache->slots[index]);
+            }
+            index = (index + 1) & mask;
+        }
+    }
+    
+    // Missing keys render verbatim, like GetLocalizedText
     const char* localizedText = GetLocalizedText(manager, key);
+    bool parse = manager->useStyledTextParsing && localizedText != key;
+    RayDialStyledText* styled = CreateStyledText(localizedText, parse, defaultColor, defaultFontSize);
+    if (!styled) return NULL;
     
-    // If we don't want to parse styled text or the text is the same as the key (not found),
-    // return a simple segment with the text
-    if (!manager->useStyledTextParsing || localizedText == key) {
-        RayDialTextSegment* segment = (RayDialTextSegment*)malloc(sizeof(RayDialTextSegment));
-        if (!segment) return NULL;
-        
-        segment->text = strdup(localizedText);
-        segment->styles = NULL;
-        segment->next = NULL;
+    styled->language = language;
+    styled->key = strdup(key);
+    styled->defaultColor = defaultColor;
+    styled->defaultFontSize = defaultFontSize;
+    styled->hash = hash;
+    if (!styled->key) {
+        ReleaseStyledText(styled);
+        return NULL;
+    }
+    
+    // Keep the cache at most half full; an uncached result is still valid
+    if ((cache->count + 1) * 2 > cache->capacity && !GrowStyledTextCache(cache)) {
+        return styled;
+    }
+    unsigned int mask = (unsigned int)cache->capacity - 1;
+    unsigned int index = hash & mask;
+    while (cache->slots[index]) index = (index + 1) & mask;
+    cache->slots[index] = RetainStyledText(styled);
+    cache->count++;
+    
+    return styled;
+}
+
+// Get a private copy of the styled text for a key; free it with FreeStyledText.
+// Copies the cached parse instead of parsing again.
+RayDialTextSegment* GetLocalizedStyledText(RayDialI18N* manager, const char* key, Color defaultColor, float defaultFontSize) {
+    RayDialStyledText* styled = AcquireLocalizedStyledText(manager, key, defaultColor, defaultFontSize);
+    if (!styled) return NULL;
+    
+    RayDialTextSegment* head = NULL;
+    RayDialTextSegment** link = &head;
+    for (RayDialTextSegment* segment = styled->segments; segment; segment = segment->next) {
+        RayDialTextSegment* copy = (RayDialTextSegment*)calloc(1, sizeof(RayDialTextSegment));
+        if (!copy) break;
+        *link = copy;
+        link = &copy->next;
         
-        return segment;
+        copy->text = segment->text ? strdup(segment->text) : NULL;
+        RayDialTextStyle** styleLink = &copy->styles;
+        for (RayDialTextStyle* style = segment->styles; style; style = style->next) {
+            RayDialTextStyle* styleCopy = (RayDialTextStyle*)malloc(sizeof(RayDialTextStyle));
+            if (!styleCopy) break;
+            *styleCopy = *style;
+            styleCopy->next = NULL;
+            *styleLink = styleCopy;
+            styleLink = &styleCopy->next;
+        }
     }
     
-    // Parse the text for styles
-    return ParseStyledText(localizedText, defaultColor, defaultFontSize);
+    ReleaseStyledText(styled);
+    return head;
+}
+
+// Number of styled texts currently cached
+int GetStyledTextCacheCount(RayDialI18N* manager) {
+    if (!manager || !manager->styledCache) return 0;
+    if (manager->styledCache->version != manager->contentVersion) return 0;
+    return manager->styledCache->count;
 }
 
 // Set whether to use styled text parsing
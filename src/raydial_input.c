@@ -0,0 +1,126 @@
+#include "raydial_input.h"
+#include <stddef.h>
+
+// Keys RayDial reads, one bit each in the frame key masks
+static const int inputKeys[] = {
+    KEY_UP, KEY_DOWN, KEY_LEFT, KEY_RIGHT, KEY_PAGE_UP, KEY_PAGE_DOWN, KEY_HOME, KEY_END,
+    KEY_ENTER, KEY_BACKSPACE, KEY_DELETE, KEY_SPACE, KEY_ESCAPE,
+    KEY_A, KEY_C, KEY_V, KEY_X,
+    KEY_LEFT_SHIFT, KEY_RIGHT_SHIFT, KEY_LEFT_CONTROL, KEY_RIGHT_CONTROL
+};
+#define RAYDIAL_INPUT_KEY_COUNT ((int)(sizeof(inputKeys) / sizeof(inputKeys[0])))
+
+// Installed on the main thread between updates; parallel update phases only read it
+static const RayDialInputFrame* inputFrame = NULL;
+static unsigned int inputFrameSerial = 0;       // Bumped with every SetInputFrame
+
+// Characters of the installed frame already handed out. Per thread, so a worker
+// reading typed text never races another; a new frame restarts every thread's count.
+static _Thread_local int inputCharsRead = 0;
+static _Thread_local unsigned int inputCharsSerial = 0;
+
+static unsigned int GetInputKeyBit(int key) {
+    for (int i = 0; i < RAYDIAL_INPUT_KEY_COUNT; i++) {
+        if (inputKeys[i] == key) return 1u << i;
+    }
+    return 0;
+}
+
+bool PressInputKey(RayDialInputFrame* frame, int key) {
+    unsigned int bit = GetInputKeyBit(key);
+    if (!frame || !bit) return false;
+    frame->keysPressed |= bit;
+    frame->keysDown |= bit;
+    return true;
+}
+
+void SetInputFrame(const RayDialInputFrame* frame) {
+    inputFrame = frame;
+    inputFrameSerial++;
+}
+
+const RayDialInputFrame* GetInputFrame(void) {
+    return inputFrame;
+}
+
+void CaptureInputFrame(RayDialInputFrame* frame) {
+    frame->frameTime = GetFrameTime();
+    frame->time = GetTime();
+    frame->mouse = GetMousePosition();
+    frame->wheel = GetMouseWheelMove();
+    frame->mouseButtons = (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) ? RAYDIAL_INPUT_MOUSE_PRESSED : 0) |
+                          (IsMouseButtonDown(MOUSE_LEFT_BUTTON) ? RAYDIAL_INPUT_MOUSE_DOWN : 0) |
+                          (IsMouseButtonReleased(MOUSE_LEFT_BUTTON) ? RAYDIAL_INPUT_MOUSE_RELEASED : 0);
+    frame->keysPressed = 0;
+    frame->keysRepeat = 0;
+    frame->keysDown = 0;
+    for (int i = 0; i < RAYDIAL_INPUT_KEY_COUNT; i++) {
+        if (IsKeyPressed(inputKeys[i])) frame->keysPressed |= 1u << i;
+        if (IsKeyPressedRepeat(inputKeys[i])) frame->keysRepeat |= 1u << i;
+        if (IsKeyDown(inputKeys[i])) frame->keysDown |= 1u << i;
+    }
+    frame->charCount = 0;
+    for (int codepoint = GetCharPressed(); codepoint > 0; codepoint = GetCharPressed()) {
+        if (frame->charCount < RAYDIAL_INPUT_MAX_CHARS) frame->chars[frame->charCount++] = codepoint;
+    }
+}
+
+bool IsInputKeyPressed(int key) {
+    return inputFrame ? (inputFrame->keysPressed & GetInputKeyBit(key)) != 0 : IsKeyPressed(key);
+}
+
+bool IsInputKeyPressedRepeat(int key) {
+    return inputFrame ? (inputFrame->keysRepeat & GetInputKeyBit(key)) != 0 : IsKeyPressedRepeat(key);
+}
+
+bool IsInputKeyDown(int key) {
+    return inputFrame ? (inputFrame->keysDown & GetInputKeyBit(key)) != 0 : IsKeyDown(key);
+}
+
+bool IsInputMouseButtonPressed(int button) {
+    if (!inputFrame) return IsMouseButtonPressed(button);
+    return button == MOUSE_LEFT_BUTTON && (inputFrame->mouseButtons & RAYDIAL_INPUT_MOUSE_PRESSED);
+}
+
+bool IsInputMouseButtonReleased(int button) {
+    if (!inputFrame) return IsMouseButtonReleased(button);
+    return button == MOUSE_LEFT_BUTTON && (inputFrame->mouseButtons & RAYDIAL_INPUT_MOUSE_RELEASED);
+}
+
+bool IsInputMouseButtonDown(int button) {
+    if (!inputFrame) return IsMouseButtonDown(button);
+    return button == MOUSE_LEFT_BUTTON && (inputFrame->mouseButtons & RAYDIAL_INPUT_MOUSE_DOWN);
+}
+
+Vector2 GetInputMousePosition(void) {
+    return inputFrame ? inputFrame->mouse : GetMousePosition();
+}
+
+float GetInputMouseWheelMove(void) {
+    return inputFrame ? inputFrame->wheel : GetMouseWheelMove();
+}
+
+int GetInputCharPressed(void) {
+    if (!inputFrame) return GetCharPressed();
+    if (inputCharsSerial != inputFrameSerial) {
+        inputCharsSerial = inputFrameSerial;
+        inputCharsRead = 0;
+    }
+    return inputCharsRead < inputFrame->charCount ? inputFrame->chars[inputCharsRead++] : 0;
+}
+
+float GetInputFrameTime(void) {
+    return inputFrame ? inputFrame->frameTime : GetFrameTime();
+}
+
+double GetInputTime(void) {
+    return inputFrame ? inputFrame->time : GetTime();
+}
+
+const char* GetInputClipboardText(void) {
+    return inputFrame ? NULL : GetClipboardText();
+}
+
+void SetInputClipboardText(const char* text) {
+    if (!inputFrame) SetClipboardText(text);
+}
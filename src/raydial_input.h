@@ -0,0 +1,39 @@
+#ifndef RAYDIAL_INPUT_H
+#define RAYDIAL_INPUT_H
+
+#include <stdbool.h>
+#include "raydial_replay.h"
+
+// Internal input layer. Components read input through these instead of raylib, so a
+// recorder or replayer can substitute a frame of input for the live devices.
+
+// Use frame as the input until the next call; NULL goes back to the live devices.
+// The frame is borrowed and must stay alive while installed.
+void SetInputFrame(const RayDialInputFrame* frame);
+const RayDialInputFrame* GetInputFrame(void);
+
+// Fill frame from the live devices. Consumes the characters typed this frame.
+void CaptureInputFrame(RayDialInputFrame* frame);
+
+bool IsInputKeyPressed(int key);
+bool IsInputKeyPressedRepeat(int key);
+bool IsInputKeyDown(int key);
+bool IsInputMouseButtonPressed(int button);
+bool IsInputMouseButtonReleased(int button);
+bool IsInputMouseButtonDown(int button);
+Vector2 GetInputMousePosition(void);
+float GetInputMouseWheelMove(void);
+int GetInputCharPressed(void);
+float GetInputFrameTime(void);
+double GetInputTime(void);
+
+// The system clipboard is left alone while a frame is installed: reads come back
+// empty and writes are dropped, so replays don't depend on it
+const char* GetInputClipboardText(void);
+void SetInputClipboardText(const char* text);
+
+// Forget the last click IsComponentClicked debounces against (raydial.c), so a
+// session starts the same whatever the calling thread clicked before
+void ResetClickTracking(void);
+
+#endif // RAYDIAL_INPUT_H
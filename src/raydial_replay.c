@@ -0,0 +1,356 @@
+#include "raydial_replay.h"
+#include "raydial_input.h"
+#include "raydial_graph.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// Layout, multi-byte values little-endian:
+//   header      magic "RDR1", u32 version
+//   'S'         i32 chapter, i32 node index: where the manager started
+//   'F' frame   u8 field mask, then the fields it names, in bit order:
+//                 FRAME_TIME  f32, else the previous frame's
+//                 TIME        f32 change since the previous frame, else frameTime
+//                 MOUSE       f32 x, f32 y, else the previous position
+//                 WHEEL       f32, else 0
+//                 BUTTONS     u8, else 0
+//                 KEYS        u32 pressed, u32 repeat, u32 down, else 0
+//                 CHARS       u8 count, then u32 codepoints, else none
+//   'T'         i32 chapter, i32 node index: a node entered during the frame before
+// Time starts at 0 before the first frame.
+#define RAYDIAL_RECORDING_VERSION 1
+#define RAYDIAL_RECORDING_HEADER_SIZE 8
+
+#define RAYDIAL_FIELD_FRAME_TIME 1u
+#define RAYDIAL_FIELD_TIME 2u
+#define RAYDIAL_FIELD_MOUSE 4u
+#define RAYDIAL_FIELD_WHEEL 8u
+#define RAYDIAL_FIELD_BUTTONS 16u
+#define RAYDIAL_FIELD_KEYS 32u
+#define RAYDIAL_FIELD_CHARS 64u
+
+static const unsigned char recordingMagic[4] = { 'R', 'D', 'R', '1' };
+
+struct RayDialRecorder {
+    RayDialManager* manager;
+    RayDialTransitionCallback previousCallback;     // Chained to and restored on free
+    void* previousUserData;
+    unsigned char* data;
+    int size;
+    int capacity;
+    bool failed;                            // Out of memory; the log stops growing
+    bool started;                           // A frame has been logged
+    RayDialInputFrame frame;                // Input of the current frame, as a replay decodes it
+};
+
+static void AppendRecording(RayDialRecorder* recorder, const void* bytes, int count) {
+    if (recorder->failed) return;
+    if (recorder->size + count > recorder->capacity) {
+        int capacity = recorder->capacity ? recorder->capacity : 256;
+        while (capacity < recorder->size + count) capacity *= 2;
+        unsigned char* data = (unsigned char*)realloc(recorder->data, capacity);
+        if (!data) {
+            TraceLog(LOG_WARNING, "RAYDIAL: Out of memory recording a dialogue session, recording stopped");
+            recorder->failed = true;
+            return;
+        }
+        recorder->data = data;
+        recorder->capacity = capacity;
+    }
+    memcpy(recorder->data + recorder->size, bytes, count);
+    recorder->size += count;
+}
+
+static void AppendRecordingByte(RayDialRecorder* recorder, unsigned char value) {
+    AppendRecording(recorder, &value, 1);
+}
+
+static void AppendRecordingWord(RayDialRecorder* recorder, uint32_t value) {
+    unsigned char bytes[4] = { value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, value >> 24 };
+    AppendRecording(recorder, bytes, 4);
+}
+
+static void AppendRecordingFloat(RayDialRecorder* recorder, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    AppendRecordingWord(recorder, bits);
+}
+
+static int GetCurrentChapter(const RayDialManager* manager) {
+    return manager->chapters ? GetCurrentChapterIndex(manager->chapters) : -1;
+}
+
+static void RecordTransition(RayDialNode* node, void* userData) {
+    RayDialRecorder* recorder = (RayDialRecorder*)userData;
+    AppendRecordingByte(recorder, 'T');
+    AppendRecordingWord(recorder, (uint32_t)GetCurrentChapter(recorder->manager));
+    AppendRecordingWord(recorder, (uint32_t)GetManagerNodeIndex(recorder->manager, node));
+
+    if (recorder->previousCallback) recorder->previousCallback(node, recorder->previousUserData);
+}
+
+RayDialRecorder* CreateDialogueRecorder(RayDialManager* manager) {
+    if (!manager) return NULL;
+
+    RayDialRecorder* recorder = (RayDialRecorder*)calloc(1, sizeof(RayDialRecorder));
+    if (!recorder) return NULL;
+    recorder->manager = manager;
+    recorder->previousCallback = manager->onTransition;
+    recorder->previousUserData = manager->transitionUserData;
+
+    AppendRecording(recorder, recordingMagic, sizeof(recordingMagic));
+    AppendRecordingWord(recorder, RAYDIAL_RECORDING_VERSION);
+    AppendRecordingByte(recorder, 'S');
+    AppendRecordingWord(recorder, (uint32_t)GetCurrentChapter(manager));
+    AppendRecordingWord(recorder, (uint32_t)GetManagerNodeIndex(manager, manager->currentNode));
+    if (recorder->failed) {
+        FreeDialogueRecorder(recorder);
+        return NULL;
+    }
+
+    SetDialogueTransitionCallback(manager, RecordTransition, recorder);
+    ResetClickTracking();
+    return recorder;
+}
+
+void FreeDialogueRecorder(RayDialRecorder* recorder) {
+    if (!recorder) return;
+    if (recorder->manager->onTransition == RecordTransition && recorder->manager->transitionUserData == recorder) {
+        SetDialogueTransitionCallback(recorder->manager, recorder->previousCallback, recorder->previousUserData);
+    }
+    if (GetInputFrame() == &recorder->frame) SetInputFrame(NULL);
+    free(recorder->data);
+    free(recorder);
+}
+
+void RecordDialogueInput(RayDialRecorder* recorder, const RayDialInputFrame* input) {
+    if (!recorder || !input) return;
+
+    // Values are stored as the replay will read them back, and the session runs on those
+    const RayDialInputFrame* previous = &recorder->frame;
+    bool first = !recorder->started;
+    float timeStep = (float)(input->time - previous->time);
+    int charCount = input->charCount < 0 ? 0 : input->charCount;
+    if (charCount > RAYDIAL_INPUT_MAX_CHARS) charCount = RAYDIAL_INPUT_MAX_CHARS;
+
+    unsigned char mask = 0;
+    if (first || input->frameTime != previous->frameTime) mask |= RAYDIAL_FIELD_FRAME_TIME;
+    if (timeStep != input->frameTime) mask |= RAYDIAL_FIELD_TIME;
+    if (first || input->mouse.x != previous->mouse.x || input->mouse.y != previous->mouse.y) mask |= RAYDIAL_FIELD_MOUSE;
+    if (input->wheel != 0.0f) mask |= RAYDIAL_FIELD_WHEEL;
+    if (input->mouseButtons) mask |= RAYDIAL_FIELD_BUTTONS;
+    if (input->keysPressed || input->keysRepeat || input->keysDown) mask |= RAYDIAL_FIELD_KEYS;
+    if (charCount > 0) mask |= RAYDIAL_FIELD_CHARS;
+
+    AppendRecordingByte(recorder, 'F');
+    AppendRecordingByte(recorder, mask);
+    if (mask & RAYDIAL_FIELD_FRAME_TIME) AppendRecordingFloat(recorder, input->frameTime);
+    if (mask & RAYDIAL_FIELD_TIME) AppendRecordingFloat(recorder, timeStep);
+    if (mask & RAYDIAL_FIELD_MOUSE) {
+        AppendRecordingFloat(recorder, input->mouse.x);
+        AppendRecordingFloat(recorder, input->mouse.y);
+    }
+    if (mask & RAYDIAL_FIELD_WHEEL) AppendRecordingFloat(recorder, input->wheel);
+    if (mask & RAYDIAL_FIELD_BUTTONS) AppendRecordingByte(recorder, (unsigned char)input->mouseButtons);
+    if (mask & RAYDIAL_FIELD_KEYS) {
+        AppendRecordingWord(recorder, input->keysPressed);
+        AppendRecordingWord(recorder, input->keysRepeat);
+        AppendRecordingWord(recorder, input->keysDown);
+    }
+    if (mask & RAYDIAL_FIELD_CHARS) {
+        AppendRecordingByte(recorder, (unsigned char)charCount);
+        for (int i = 0; i < charCount; i++) AppendRecordingWord(recorder, (uint32_t)input->chars[i]);
+    }
+
+    double time = previous->time + timeStep;
+    recorder->frame = *input;
+    recorder->frame.time = time;
+    recorder->frame.mouseButtons &= 0xFF;
+    recorder->frame.charCount = charCount;
+    recorder->started = true;
+    SetInputFrame(&recorder->frame);
+}
+
+void RecordDialogueFrame(RayDialRecorder* recorder) {
+    if (!recorder) return;
+    RayDialInputFrame live;
+    CaptureInputFrame(&live);
+    RecordDialogueInput(recorder, &live);
+}
+
+const unsigned char* GetDialogueRecording(const RayDialRecorder* recorder, int* size) {
+    if (size) *size = recorder ? recorder->size : 0;
+    return recorder ? recorder->data : NULL;
+}
+
+bool SaveDialogueRecording(const RayDialRecorder* recorder, const char* fileName) {
+    if (!recorder || !fileName) return false;
+    FILE* file = fopen(fileName, "wb");
+    bool ok = file && fwrite(recorder->data, 1, (size_t)recorder->size, file) == (size_t)recorder->size;
+    if (file) ok = fclose(file) == 0 && ok;
+    if (!ok) TraceLog(LOG_WARNING, "RAYDIAL: Could not write dialogue recording %s", fileName);
+    return ok;
+}
+
+// Replay reader: every read is bounds checked; a failed reader stays failed
+typedef struct {
+    const unsigned char* data;
+    int size;
+    int offset;
+    bool failed;
+} RayDialRecordingReader;
+
+static unsigned char ReadRecordingByte(RayDialRecordingReader* reader) {
+    if (reader->failed || reader->offset >= reader->size) {
+        reader->failed = true;
+        return 0;
+    }
+    return reader->data[reader->offset++];
+}
+
+static uint32_t ReadRecordingWord(RayDialRecordingReader* reader) {
+    if (reader->failed || reader->size - reader->offset < 4) {
+        reader->failed = true;
+        return 0;
+    }
+    const unsigned char* bytes = reader->data + reader->offset;
+    reader->offset += 4;
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+static float ReadRecordingFloat(RayDialRecordingReader* reader) {
+    uint32_t bits = ReadRecordingWord(reader);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Decode a frame over the previous one, which supplies the fields left out
+static void ReadRecordingFrame(RayDialRecordingReader* reader, RayDialInputFrame* frame) {
+    unsigned char mask = ReadRecordingByte(reader);
+    if (mask & ~0x7Fu) reader->failed = true;
+    if (mask & RAYDIAL_FIELD_FRAME_TIME) frame->frameTime = ReadRecordingFloat(reader);
+    float timeStep = (mask & RAYDIAL_FIELD_TIME) ? ReadRecordingFloat(reader) : frame->frameTime;
+    frame->time += timeStep;
+    if (mask & RAYDIAL_FIELD_MOUSE) {
+        frame->mouse.x = ReadRecordingFloat(reader);
+        frame->mouse.y = ReadRecordingFloat(reader);
+    }
+    frame->wheel = (mask & RAYDIAL_FIELD_WHEEL) ? ReadRecordingFloat(reader) : 0.0f;
+    frame->mouseButtons = (mask & RAYDIAL_FIELD_BUTTONS) ? ReadRecordingByte(reader) : 0;
+    frame->keysPressed = 0;
+    frame->keysRepeat = 0;
+    frame->keysDown = 0;
+    if (mask & RAYDIAL_FIELD_KEYS) {
+        frame->keysPressed = ReadRecordingWord(reader);
+        frame->keysRepeat = ReadRecordingWord(reader);
+        frame->keysDown = ReadRecordingWord(reader);
+    }
+    frame->charCount = 0;
+    if (mask & RAYDIAL_FIELD_CHARS) {
+        int count = ReadRecordingByte(reader);
+        if (count > RAYDIAL_INPUT_MAX_CHARS) reader->failed = true;
+        for (int i = 0; i < count && !reader->failed; i++) frame->chars[i] = (int)ReadRecordingWord(reader);
+        frame->charCount = reader->failed ? 0 : count;
+    }
+}
+
+typedef struct {
+    RayDialManager* manager;
+    RayDialRecordingReader* reader;
+    RayDialReplayResult* result;
+    bool mismatch;
+} RayDialReplay;
+
+// The next record must be the transition the manager just made
+static void CheckReplayTransition(RayDialNode* node, void* userData) {
+    RayDialReplay* replay = (RayDialReplay*)userData;
+    if (replay->mismatch) return;
+
+    RayDialRecordingReader* reader = replay->reader;
+    int chapter = GetCurrentChapter(replay->manager);
+    int index = GetManagerNodeIndex(replay->manager, node);
+    int expectedChapter = -1;
+    int expectedNode = -1;
+    if (reader->offset < reader->size && reader->data[reader->offset] == 'T') {
+        reader->offset++;
+        expectedChapter = (int)ReadRecordingWord(reader);
+        expectedNode = (int)ReadRecordingWord(reader);
+    }
+    if (!reader->failed && expectedChapter == chapter && expectedNode == index && expectedNode >= 0) {
+        replay->result->transitions++;
+        return;
+    }
+
+    replay->mismatch = true;
+    replay->result->expectedChapter = expectedChapter;
+    replay->result->expectedNode = expectedNode;
+    replay->result->actualChapter = chapter;
+    replay->result->actualNode = index;
+}
+
+RayDialReplayResult ReplayDialogueRecording(RayDialManager* manager, const unsigned char* data, int size) {
+    RayDialReplayResult result = { false, 0, 0, -1, -1, -1, -1, -1 };
+    if (!manager || !data || size < RAYDIAL_RECORDING_HEADER_SIZE) return result;
+
+    RayDialRecordingReader reader = { data, size, 4, false };
+    if (memcmp(data, recordingMagic, sizeof(recordingMagic)) != 0 ||
+        ReadRecordingWord(&reader) != RAYDIAL_RECORDING_VERSION ||
+        ReadRecordingByte(&reader) != 'S') {
+        TraceLog(LOG_WARNING, "RAYDIAL: Not a dialogue recording");
+        return result;
+    }
+    result.expectedChapter = (int)ReadRecordingWord(&reader);
+    result.expectedNode = (int)ReadRecordingWord(&reader);
+    result.actualChapter = GetCurrentChapter(manager);
+    result.actualNode = GetManagerNodeIndex(manager, manager->currentNode);
+    if (reader.failed || result.expectedChapter != result.actualChapter || result.expectedNode != result.actualNode) {
+        result.failedFrame = 0;
+        return result;
+    }
+    result.expectedChapter = result.expectedNode = result.actualChapter = result.actualNode = -1;
+
+    RayDialReplay replay = { manager, &reader, &result, false };
+    RayDialTransitionCallback previousCallback = manager->onTransition;
+    void* previousUserData = manager->transitionUserData;
+    const RayDialInputFrame* previousInput = GetInputFrame();
+    SetDialogueTransitionCallback(manager, CheckReplayTransition, &replay);
+    ResetClickTracking();
+
+    RayDialInputFrame frame = { 0 };
+    while (!reader.failed && !replay.mismatch && reader.offset < reader.size) {
+        unsigned char tag = ReadRecordingByte(&reader);
+        if (tag == 'F') {
+            ReadRecordingFrame(&reader, &frame);
+            if (reader.failed) break;
+            SetInputFrame(&frame);
+            UpdateDialogueManager(manager);
+            if (!replay.mismatch && reader.offset < reader.size && reader.data[reader.offset] == 'T') {
+                // The recording entered a node this frame that the replay didn't
+                CheckReplayTransition(NULL, &replay);
+                result.actualChapter = result.actualNode = -1;
+            }
+            if (replay.mismatch) result.failedFrame = result.frames;
+            result.frames++;
+        } else if (tag == 'T') {
+            // Entered outside any update, so nothing in the replay can reproduce it
+            reader.offset--;
+            CheckReplayTransition(NULL, &replay);
+            result.actualChapter = result.actualNode = -1;
+            result.failedFrame = result.frames;
+        } else {
+            reader.failed = true;
+        }
+    }
+
+    SetDialogueTransitionCallback(manager, previousCallback, previousUserData);
+    SetInputFrame(previousInput);
+
+    if (reader.failed) {
+        TraceLog(LOG_WARNING, "RAYDIAL: Damaged dialogue recording at byte %d", reader.offset);
+        result.failedFrame = result.frames;
+    }
+    result.passed = !reader.failed && !replay.mismatch;
+    return result;
+}
@@ -0,0 +1,771 @@
+#include "raydial_script.h"
+#include "raydial_value.h"
+#include "raylib.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <stdint.h>
+
+#define RAYDIAL_SCRIPT_MAX_REGISTERS 64
+#define RAYDIAL_SCRIPT_MAX_NATIVES 256
+#define RAYDIAL_SCRIPT_RK_CONSTANT 0x80     // Operand bit: constant index instead of register
+#define RAYDIAL_SCRIPT_MAX_LOOPS 1000000    // Backward jumps a single run may take
+
+// Instructions are 32-bit words: opcode in the low byte, then A, B and C, or A
+// and a 16-bit Bx. "RK" operands name a register, or a constant when
+// RAYDIAL_SCRIPT_RK_CONSTANT is set.
+//   MOVE     r[A] = RK(B)                 LOADK  r[A] = K[Bx]
+//   GETVAR   r[A] = var[Bx]               SETVAR var[Bx] = RK(A)
+//   ADD..MOD r[A] = RK(B) op RK(C)        EQ..LE r[A] = RK(B) cmp RK(C)
+//   NOT      r[A] = !RK(B)                JMP    pc = Bx
+//   JMPIF    if r[A]: pc = Bx             JMPIFNOT
+//   GOTO     return K[Bx]                 EMIT   event K[Bx] with RK(A)
+//   CALL     r[A] = native[B](r[A+1] .. r[A+C])
+#define RAYDIAL_SCRIPT_OPS(X) \
+    X(MOVE) X(LOADK) X(GETVAR) X(SETVAR) \
+    X(ADD) X(SUB) X(MUL) X(DIV) X(MOD) \
+    X(EQ) X(NE) X(LT) X(LE) X(NOT) \
+    X(JMP) X(JMPIF) X(JMPIFNOT) \
+    X(GOTO) X(EMIT) X(CALL) X(END)
+
+typedef enum {
+#define RAYDIAL_SCRIPT_OP_ENUM(name) RAYDIAL_OP_##name,
+    RAYDIAL_SCRIPT_OPS(RAYDIAL_SCRIPT_OP_ENUM)
+#undef RAYDIAL_SCRIPT_OP_ENUM
+    RAYDIAL_OP_COUNT
+} RayDialScriptOp;
+
+// GCC and Clang dispatch through a label table, which gives every handler its own
+// indirect branch; other compilers use the switch
+#if defined(__GNUC__) && !defined(RAYDIAL_SCRIPT_SWITCH_DISPATCH)
+#define RAYDIAL_SCRIPT_COMPUTED_GOTO
+#endif
+
+#define SCRIPT_OP(word) ((word) & 0xFF)
+#define SCRIPT_A(word) (((word) >> 8) & 0xFF)
+#define SCRIPT_B(word) (((word) >> 16) & 0xFF)
+#define SCRIPT_C(word) ((word) >> 24)
+#define SCRIPT_BX(word) ((word) >> 16)
+
+typedef struct {
+    char* name;
+    RayDialScriptNative function;
+    void* userData;
+} RayDialScriptNativeEntry;
+
+struct RayDialScriptHost {
+    RayDialVariables* variables;
+    RayDialScriptNativeEntry* natives;
+    int nativeCount;
+    int nativeCapacity;
+    RayDialScriptEventCallback onEvent;
+    void* eventUserData;
+};
+
+struct RayDialScript {
+    RayDialScriptHost* host;
+    uint32_t* code;
+    int length;
+    RayDialValue* constants;                // Strings are interned in the host's store
+    int constantCount;
+    int registerCount;
+};
+
+RayDialScriptHost* CreateScriptHost(RayDialVariables* variables) {
+    if (!variables) return NULL;
+
+    RayDialScriptHost* host = (RayDialScriptHost*)calloc(1, sizeof(RayDialScriptHost));
+    if (!host) return NULL;
+    host->variables = variables;
+    return host;
+}
+
+void FreeScriptHost(RayDialScriptHost* host) {
+    if (!host) return;
+    for (int i = 0; i < host->nativeCount; i++) free(host->natives[i].name);
+    free(host->natives);
+    free(host);
+}
+
+RayDialVariables* GetScriptHostVariables(const RayDialScriptHost* host) {
+    return host ? host->variables : NULL;
+}
+
+static int FindScriptNative(const RayDialScriptHost* host, const char* name, int length) {
+    for (int i = 0; i < host->nativeCount; i++) {
+        if (strncmp(host->natives[i].name, name, length) == 0 && host->natives[i].name[length] == '\0') return i;
+    }
+    return -1;
+}
+
+bool RegisterScriptNative(RayDialScriptHost* host, const char* name, RayDialScriptNative native, void* userData) {
+    if (!host || !name || !native) return false;
+
+    int index = FindScriptNative(host, name, (int)strlen(name));
+    if (index < 0) {
+        if (host->nativeCount == RAYDIAL_SCRIPT_MAX_NATIVES) return false;
+        if (host->nativeCount == host->nativeCapacity) {
+            int capacity = host->nativeCapacity ? host->nativeCapacity * 2 : 8;
+            RayDialScriptNativeEntry* natives = (RayDialScriptNativeEntry*)realloc(host->natives, capacity * sizeof(RayDialScriptNativeEntry));
+            if (!natives) return false;
+            host->natives = natives;
+            host->nativeCapacity = capacity;
+        }
+        char* copy = (char*)malloc(strlen(name) + 1);
+        if (!copy) return false;
+        strcpy(copy, name);
+        index = host->nativeCount++;
+        host->natives[index].name = copy;
+    }
+    host->natives[index].function = native;
+    host->natives[index].userData = userData;
+    return true;
+}
+
+void SetScriptEventHandler(RayDialScriptHost* host, RayDialScriptEventCallback callback, void* userData) {
+    if (!host) return;
+    host->onEvent = callback;
+    host->eventUserData = userData;
+}
+
+// Assembler: one pass over the lines, emitting words as it goes. Jumps to labels
+// not seen yet are patched once the whole source has been read.
+
+typedef enum {
+    RAYDIAL_OPERAND_REGISTER,
+    RAYDIAL_OPERAND_CONSTANT,
+    RAYDIAL_OPERAND_NAME                    // Variable, label or native
+} RayDialOperandKind;
+
+typedef struct {
+    RayDialOperandKind kind;
+    int index;                              // Register or constant index
+    const char* name;                       // NAME: points into the source
+    int length;
+} RayDialOperand;
+
+typedef struct {
+    const char* name;
+    int length;
+    int position;                           // Code index; for a fixup, the word to patch
+    int line;
+} RayDialScriptLabel;
+
+typedef struct {
+    RayDialScriptHost* host;
+    RayDialScript* script;
+    int codeCapacity;
+    int constantCapacity;
+    RayDialScriptLabel* labels;
+    int labelCount;
+    int labelCapacity;
+    RayDialScriptLabel* fixups;
+    int fixupCount;
+    int fixupCapacity;
+    const char* cursor;
+    int line;
+    char* error;
+    int errorSize;
+    bool failed;
+} RayDialScriptAssembler;
+
+static void ScriptError(RayDialScriptAssembler* assembler, const char* message) {
+    if (assembler->failed) return;
+    assembler->failed = true;
+    if (assembler->error && assembler->errorSize > 0) {
+        snprintf(assembler->error, assembler->errorSize, "line %d: %s", assembler->line, message);
+    }
+}
+
+static bool GrowArray(void** array, int* capacity, int count, int elementSize) {
+    if (count < *capacity) return true;
+    int grown = *capacity ? *capacity * 2 : 16;
+    void* resized = realloc(*array, (size_t)grown * elementSize);
+    if (!resized) return false;
+    *array = resized;
+    *capacity = grown;
+    return true;
+}
+
+static void EmitWord(RayDialScriptAssembler* assembler, RayDialScriptOp op, int a, int b, int c) {
+    RayDialScript* script = assembler->script;
+    // At most UINT16_MAX words, so every position a label can name fits in Bx
+    if (script->length >= UINT16_MAX) {
+        ScriptError(assembler, "Script too long");
+        return;
+    }
+    if (!GrowArray((void**)&script->code, &assembler->codeCapacity, script->length, sizeof(uint32_t))) {
+        ScriptError(assembler, "Out of memory");
+        return;
+    }
+    script->code[script->length++] = (uint32_t)op | (uint32_t)a << 8 | (uint32_t)b << 16 | (uint32_t)c << 24;
+}
+
+static void EmitWordBx(RayDialScriptAssembler* assembler, RayDialScriptOp op, int a, int bx) {
+    EmitWord(assembler, op, a, bx & 0xFF, bx >> 8);
+}
+
+static int AddScriptConstant(RayDialScriptAssembler* assembler, RayDialValue value) {
+    RayDialScript* script = assembler->script;
+    for (int i = 0; i < script->constantCount; i++) {
+        const RayDialValue* existing = &script->constants[i];
+        if (existing->type != value.type) continue;
+        if (value.type == RAYDIAL_VAR_FLOAT ? existing->value.f == value.value.f :
+            value.type == RAYDIAL_VAR_STRING ? existing->value.s == value.value.s :
+            existing->value.i == value.value.i) return i;
+    }
+
+    if (script->constantCount > UINT16_MAX) {
+        ScriptError(assembler, "Too many constants");
+        return -1;
+    }
+    if (!GrowArray((void**)&script->constants, &assembler->constantCapacity, script->constantCount, sizeof(RayDialValue))) {
+        ScriptError(assembler, "Out of memory");
+        return -1;
+    }
+    script->constants[script->constantCount] = value;
+    return script->constantCount++;
+}
+
+static bool IsNameChar(char c) {
+    return isalnum((unsigned char)c) || c == '_' || c == '.';
+}
+
+static void SkipScriptSpaces(RayDialScriptAssembler* assembler) {
+    while (*assembler->cursor == ' ' || *assembler->cursor == '\t' || *assembler->cursor == '\r') assembler->cursor++;
+}
+
+static bool AtLineEnd(RayDialScriptAssembler* assembler) {
+    SkipScriptSpaces(assembler);
+    char c = *assembler->cursor;
+    return c == '\0' || c == '\n' || c == '#';
+}
+
+static bool ParseOperand(RayDialScriptAssembler* assembler, RayDialOperand* operand) {
+    if (assembler->failed) return false;
+    SkipScriptSpaces(assembler);
+    const char* start = assembler->cursor;
+    RayDialValue value = { RAYDIAL_VAR_INT, { 0 } };
+    bool literal = true;
+
+    if (*start == '"' || *start == '\'') {
+        const char* end = strchr(start + 1, *start);
+        const char* newline = strchr(start + 1, '\n');
+        if (!end || (newline && newline < end)) {
+            ScriptError(assembler, "Unterminated string");
+            return false;
+        }
+        value.type = RAYDIAL_VAR_STRING;
+        value.value.s = InternVariableString(assembler->host->variables, start + 1, (int)(end - start - 1));
+        if (!value.value.s) {
+            ScriptError(assembler, "Out of memory");
+            return false;
+        }
+        assembler->cursor = end + 1;
+    } else if (isdigit((unsigned char)*start) || ((*start == '-' || *start == '.') && isdigit((unsigned char)start[1]))) {
+        char* end;
+        long integer = strtol(start, &end, 10);
+        if (*end == '.') {
+            value.type = RAYDIAL_VAR_FLOAT;
+            value.value.f = strtof(start, &end);
+        } else if (integer < INT32_MIN || integer > INT32_MAX) {
+            ScriptError(assembler, "Integer out of range");
+            return false;
+        } else {
+            value.value.i = (int)integer;
+        }
+        assembler->cursor = end;
+    } else if (IsNameChar(*start)) {
+        const char* end = start;
+        while (IsNameChar(*end)) end++;
+        int length = (int)(end - start);
+        assembler->cursor = end;
+
+        if (start[0] == 'r' && length > 1 && length <= 3 && isdigit((unsigned char)start[1]) &&
+            (length == 2 || isdigit((unsigned char)start[2]))) {
+            operand->kind = RAYDIAL_OPERAND_REGISTER;
+            operand->index = atoi(start + 1);
+            if (operand->index >= RAYDIAL_SCRIPT_MAX_REGISTERS) {
+                ScriptError(assembler, "Register out of range (r0-r63)");
+                return false;
+            }
+            if (operand->index >= assembler->script->registerCount) assembler->script->registerCount = operand->index + 1;
+            literal = false;
+        } else if ((length == 4 && strncmp(start, "true", 4) == 0) || (length == 5 && strncmp(start, "false", 5) == 0)) {
+            value.type = RAYDIAL_VAR_BOOL;
+            value.value.i = length == 4;
+        } else {
+            operand->kind = RAYDIAL_OPERAND_NAME;
+            operand->name = start;
+            operand->length = length;
+            literal = false;
+        }
+    } else {
+        ScriptError(assembler, AtLineEnd(assembler) ? "Missing operand" : "Unexpected character");
+        return false;
+    }
+
+    if (literal) {
+        operand->kind = RAYDIAL_OPERAND_CONSTANT;
+        operand->index = AddScriptConstant(assembler, value);
+        if (operand->index < 0) return false;
+    }
+    return true;
+}
+
+// Read one operand, and the comma after it unless it is the last
+static bool ReadOperand(RayDialScriptAssembler* assembler, RayDialOperand* operand, bool last) {
+    if (!ParseOperand(assembler, operand)) return false;
+
+    SkipScriptSpaces(assembler);
+    if (last) {
+        if (!AtLineEnd(assembler)) {
+            ScriptError(assembler, "Too many operands");
+            return false;
+        }
+        return true;
+    }
+    if (*assembler->cursor != ',') {
+        ScriptError(assembler, "Expected ','");
+        return false;
+    }
+    assembler->cursor++;
+    return true;
+}
+
+static bool ExpectRegister(RayDialScriptAssembler* assembler, const RayDialOperand* operand) {
+    if (operand->kind == RAYDIAL_OPERAND_REGISTER) return true;
+    ScriptError(assembler, "Expected a register");
+    return false;
+}
+
+// Encode a register or constant operand as RK
+static int EncodeRK(RayDialScriptAssembler* assembler, const RayDialOperand* operand) {
+    if (operand->kind == RAYDIAL_OPERAND_REGISTER) return operand->index;
+    if (operand->kind == RAYDIAL_OPERAND_CONSTANT && operand->index < RAYDIAL_SCRIPT_RK_CONSTANT) {
+        return RAYDIAL_SCRIPT_RK_CONSTANT | operand->index;
+    }
+    ScriptError(assembler, operand->kind == RAYDIAL_OPERAND_NAME ? "Expected a register or literal" : "Too many constants");
+    return 0;
+}
+
+static int GetOperandVariable(RayDialScriptAssembler* assembler, const RayDialOperand* operand) {
+    char name[128];
+    if (operand->length >= (int)sizeof(name)) {
+        ScriptError(assembler, "Variable name too long");
+        return 0;
+    }
+    memcpy(name, operand->name, operand->length);
+    name[operand->length] = '\0';
+
+    int id = GetVariableId(assembler->host->variables, name);
+    if (id < 0 || id > UINT16_MAX) {
+        ScriptError(assembler, "Too many variables");
+        return 0;
+    }
+    return id;
+}
+
+static void EmitJump(RayDialScriptAssembler* assembler, RayDialScriptOp op, int a, const RayDialOperand* label) {
+    if (label->kind != RAYDIAL_OPERAND_NAME) {
+        ScriptError(assembler, "Expected a label");
+        return;
+    }
+    if (!GrowArray((void**)&assembler->fixups, &assembler->fixupCapacity, assembler->fixupCount, sizeof(RayDialScriptLabel))) {
+        ScriptError(assembler, "Out of memory");
+        return;
+    }
+    assembler->fixups[assembler->fixupCount++] = (RayDialScriptLabel){ label->name, label->length, assembler->script->length, assembler->line };
+    EmitWordBx(assembler, op, a, 0);
+}
+
+// String constant for goto and emit, addressed by Bx
+static int ExpectStringConstant(RayDialScriptAssembler* assembler, const RayDialOperand* operand) {
+    if (operand->kind == RAYDIAL_OPERAND_CONSTANT &&
+        assembler->script->constants[operand->index].type == RAYDIAL_VAR_STRING) return operand->index;
+    ScriptError(assembler, "Expected a string");
+    return 0;
+}
+
+typedef struct {
+    const char* mnemonic;
+    RayDialScriptOp op;
+    bool swap;                              // gt and ge are lt and le with the operands swapped
+} RayDialScriptBinary;
+
+static const RayDialScriptBinary scriptBinaries[] = {
+    { "add", RAYDIAL_OP_ADD, false }, { "sub", RAYDIAL_OP_SUB, false }, { "mul", RAYDIAL_OP_MUL, false },
+    { "div", RAYDIAL_OP_DIV, false }, { "mod", RAYDIAL_OP_MOD, false },
+    { "eq", RAYDIAL_OP_EQ, false }, { "ne", RAYDIAL_OP_NE, false }, { "lt", RAYDIAL_OP_LT, false },
+    { "le", RAYDIAL_OP_LE, false }, { "gt", RAYDIAL_OP_LT, true }, { "ge", RAYDIAL_OP_LE, true },
+};
+
+static void AssembleInstruction(RayDialScriptAssembler* assembler, const char* mnemonic, int length) {
+    RayDialOperand a, b, c;
+#define IS_MNEMONIC(text) (length == (int)sizeof(text) - 1 && strncmp(mnemonic, text, length) == 0)
+
+    for (int i = 0; i < (int)(sizeof(scriptBinaries) / sizeof(scriptBinaries[0])); i++) {
+        const RayDialScriptBinary* binary = &scriptBinaries[i];
+        if ((int)strlen(binary->mnemonic) != length || strncmp(mnemonic, binary->mnemonic, length) != 0) continue;
+        if (!ReadOperand(assembler, &a, false) || !ExpectRegister(assembler, &a)) return;
+        if (!ReadOperand(assembler, &b, false) || !ReadOperand(assembler, &c, true)) return;
+        int x = EncodeRK(assembler, &b);
+        int y = EncodeRK(assembler, &c);
+        EmitWord(assembler, binary->op, a.index, binary->swap ? y : x, binary->swap ? x : y);
+        return;
+    }
+
+    if (IS_MNEMONIC("load")) {
+        if (!ReadOperand(assembler, &a, false) || !ExpectRegister(assembler, &a)) return;
+        if (!ReadOperand(assembler, &b, true)) return;
+        if (b.kind == RAYDIAL_OPERAND_NAME) {
+            EmitWordBx(assembler, RAYDIAL_OP_GETVAR, a.index, GetOperandVariable(assembler, &b));
+        } else if (b.kind == RAYDIAL_OPERAND_CONSTANT && b.index >= RAYDIAL_SCRIPT_RK_CONSTANT) {
+            EmitWordBx(assembler, RAYDIAL_OP_LOADK, a.index, b.index);
+        } else {
+            EmitWord(assembler, RAYDIAL_OP_MOVE, a.index, EncodeRK(assembler, &b), 0);
+        }
+    } else if (IS_MNEMONIC("store")) {
+        if (!ReadOperand(assembler, &a, false) || !ReadOperand(assembler, &b, true)) return;
+        if (a.kind != RAYDIAL_OPERAND_NAME) {
+            ScriptError(assembler, "Expected a variable name");
+            return;
+        }
+        int id = GetOperandVariable(assembler, &a);
+        EmitWordBx(assembler, RAYDIAL_OP_SETVAR, EncodeRK(assembler, &b), id);
+    } else if (IS_MNEMONIC("not")) {
+        if (!ReadOperand(assembler, &a, false) || !ExpectRegister(assembler, &a)) return;
+        if (!ReadOperand(assembler, &b, true)) return;
+        EmitWord(assembler, RAYDIAL_OP_NOT, a.index, EncodeRK(assembler, &b), 0);
+    } else if (IS_MNEMONIC("jump")) {
+        if (!ReadOperand(assembler, &a, true)) return;
+        EmitJump(assembler, RAYDIAL_OP_JMP, 0, &a);
+    } else if (IS_MNEMONIC("jumpif") || IS_MNEMONIC("jumpifnot")) {
+        if (!ReadOperand(assembler, &a, false) || !ExpectRegister(assembler, &a)) return;
+        if (!ReadOperand(assembler, &b, true)) return;
+        EmitJump(assembler, length == 6 ? RAYDIAL_OP_JMPIF : RAYDIAL_OP_JMPIFNOT, a.index, &b);
+    } else if (IS_MNEMONIC("goto")) {
+        if (!ReadOperand(assembler, &a, true)) return;
+        EmitWordBx(assembler, RAYDIAL_OP_GOTO, 0, ExpectStringConstant(assembler, &a));
+    } else if (IS_MNEMONIC("emit")) {
+        // The value is optional and defaults to 0
+        if (!ParseOperand(assembler, &a)) return;
+        int event = ExpectStringConstant(assembler, &a);
+        if (AtLineEnd(assembler)) {
+            b.kind = RAYDIAL_OPERAND_CONSTANT;
+            b.index = AddScriptConstant(assembler, (RayDialValue){ RAYDIAL_VAR_INT, { 0 } });
+            if (b.index < 0) return;
+        } else if (*assembler->cursor != ',') {
+            ScriptError(assembler, "Expected ','");
+            return;
+        } else {
+            assembler->cursor++;
+            if (!ReadOperand(assembler, &b, true)) return;
+        }
+        EmitWordBx(assembler, RAYDIAL_OP_EMIT, EncodeRK(assembler, &b), event);
+    } else if (IS_MNEMONIC("call")) {
+        if (!ReadOperand(assembler, &a, false) || !ExpectRegister(assembler, &a)) return;
+        if (!ReadOperand(assembler, &b, false) || !ReadOperand(assembler, &c, true)) return;
+        if (b.kind != RAYDIAL_OPERAND_NAME) {
+            ScriptError(assembler, "Expected a native name");
+            return;
+        }
+        int native = FindScriptNative(assembler->host, b.name, b.length);
+        if (native < 0) {
+            ScriptError(assembler, "Unknown native");
+            return;
+        }
+        const RayDialValue* count = c.kind == RAYDIAL_OPERAND_CONSTANT ? &assembler->script->constants[c.index] : NULL;
+        if (!count || count->type != RAYDIAL_VAR_INT || count->value.i < 0 || a.index + count->value.i >= RAYDIAL_SCRIPT_MAX_REGISTERS) {
+            ScriptError(assembler, "Expected an argument count that fits the registers");
+            return;
+        }
+        int last = a.index + count->value.i;
+        if (last >= assembler->script->registerCount) assembler->script->registerCount = last + 1;
+        EmitWord(assembler, RAYDIAL_OP_CALL, a.index, native, count->value.i);
+    } else if (IS_MNEMONIC("end")) {
+        if (AtLineEnd(assembler)) {
+            EmitWord(assembler, RAYDIAL_OP_END, 0, 0, 0);
+        } else {
+            ScriptError(assembler, "Too many operands");
+        }
+    } else {
+        ScriptError(assembler, "Unknown instruction");
+    }
+#undef IS_MNEMONIC
+}
+
+static void AssembleLine(RayDialScriptAssembler* assembler) {
+    if (AtLineEnd(assembler)) return;
+
+    const char* start = assembler->cursor;
+    const char* end = start;
+    while (IsNameChar(*end)) end++;
+    if (end == start) {
+        ScriptError(assembler, "Expected an instruction");
+        return;
+    }
+    assembler->cursor = end;
+
+    if (*end == ':') {
+        int length = (int)(end - start);
+        for (int i = 0; i < assembler->labelCount; i++) {
+            if (assembler->labels[i].length == length && strncmp(assembler->labels[i].name, start, length) == 0) {
+                ScriptError(assembler, "Duplicate label");
+                return;
+            }
+        }
+        if (!GrowArray((void**)&assembler->labels, &assembler->labelCapacity, assembler->labelCount, sizeof(RayDialScriptLabel))) {
+            ScriptError(assembler, "Out of memory");
+            return;
+        }
+        assembler->labels[assembler->labelCount++] = (RayDialScriptLabel){ start, length, assembler->script->length, assembler->line };
+        assembler->cursor++;
+        AssembleLine(assembler);
+        return;
+    }
+    AssembleInstruction(assembler, start, (int)(end - start));
+}
+
+static void ResolveScriptLabels(RayDialScriptAssembler* assembler) {
+    for (int i = 0; i < assembler->fixupCount && !assembler->failed; i++) {
+        const RayDialScriptLabel* fixup = &assembler->fixups[i];
+        int target = -1;
+        for (int j = 0; j < assembler->labelCount && target < 0; j++) {
+            const RayDialScriptLabel* label = &assembler->labels[j];
+            if (label->length == fixup->length && strncmp(label->name, fixup->name, fixup->length) == 0) target = label->position;
+        }
+        if (target < 0) {
+            assembler->line = fixup->line;
+            ScriptError(assembler, "Unknown label");
+            return;
+        }
+        assembler->script->code[fixup->position] |= (uint32_t)target << 16;
+    }
+}
+
+RayDialScript* CompileScript(RayDialScriptHost* host, const char* source, char* error, int errorSize) {
+    if (error && errorSize > 0) error[0] = '\0';
+    if (!host || !source) return NULL;
+
+    RayDialScript* script = (RayDialScript*)calloc(1, sizeof(RayDialScript));
+    if (!script) return NULL;
+    script->host = host;
+
+    RayDialScriptAssembler assembler = { 0 };
+    assembler.host = host;
+    assembler.script = script;
+    assembler.cursor = source;
+    assembler.line = 1;
+    assembler.error = error;
+    assembler.errorSize = errorSize;
+
+    while (!assembler.failed) {
+        AssembleLine(&assembler);
+        if (assembler.failed) break;
+
+        // Skip the comment, then move to the next line
+        while (*assembler.cursor && *assembler.cursor != '\n') assembler.cursor++;
+        if (!*assembler.cursor) break;
+        assembler.cursor++;
+        assembler.line++;
+    }
+
+    // Falling off the end finishes the script
+    if (!assembler.failed) EmitWord(&assembler, RAYDIAL_OP_END, 0, 0, 0);
+    ResolveScriptLabels(&assembler);
+
+    free(assembler.labels);
+    free(assembler.fixups);
+    if (assembler.failed) {
+        FreeScript(script);
+        return NULL;
+    }
+    return script;
+}
+
+void FreeScript(RayDialScript* script) {
+    if (!script) return;
+    free(script->code);
+    free(script->constants);
+    free(script);
+}
+
+const char* RunScript(const RayDialScript* script) {
+    if (!script) return NULL;
+
+    RayDialScriptHost* host = script->host;
+    RayDialVariables* variables = host->variables;
+    const uint32_t* code = script->code;
+    const RayDialValue* constants = script->constants;
+    RayDialValue registers[RAYDIAL_SCRIPT_MAX_REGISTERS];
+    for (int i = 0; i < script->registerCount; i++) registers[i] = (RayDialValue){ RAYDIAL_VAR_INT, { 0 } };
+
+    int loops = RAYDIAL_SCRIPT_MAX_LOOPS;
+    int pc = 0;
+    uint32_t word;
+
+#define RK(operand) ((operand) & RAYDIAL_SCRIPT_RK_CONSTANT ? &constants[(operand) & 0x7F] : &registers[operand])
+#define JUMP_TO(target) do { \
+        int destination = (target); \
+        if (destination < pc && --loops < 0) goto exhausted; \
+        pc = destination; \
+    } while (0)
+
+#ifdef RAYDIAL_SCRIPT_COMPUTED_GOTO
+#define RAYDIAL_SCRIPT_OP_LABEL(name) &&op_##name,
+    static const void* dispatch[RAYDIAL_OP_COUNT] = { RAYDIAL_SCRIPT_OPS(RAYDIAL_SCRIPT_OP_LABEL) };
+#undef RAYDIAL_SCRIPT_OP_LABEL
+#define VM_CASE(name) op_##name:
+#define VM_NEXT() do { word = code[pc++]; goto *dispatch[SCRIPT_OP(word)]; } while (0)
+    VM_NEXT();
+    {
+#else
+#define VM_CASE(name) case RAYDIAL_OP_##name:
+#define VM_NEXT() continue
+    for (;;) {
+        word = code[pc++];
+        switch ((RayDialScriptOp)SCRIPT_OP(word)) {
+#endif
+        VM_CASE(MOVE) {
+            registers[SCRIPT_A(word)] = *RK(SCRIPT_B(word));
+            VM_NEXT();
+        }
+        VM_CASE(LOADK) {
+            registers[SCRIPT_A(word)] = constants[SCRIPT_BX(word)];
+            VM_NEXT();
+        }
+        VM_CASE(GETVAR) {
+            registers[SCRIPT_A(word)] = GetVariableValue(variables, SCRIPT_BX(word));
+            VM_NEXT();
+        }
+        VM_CASE(SETVAR) {
+            SetVariableValue(variables, SCRIPT_BX(word), *RK(SCRIPT_A(word)));
+            VM_NEXT();
+        }
+        VM_CASE(ADD) {
+            const RayDialValue* x = RK(SCRIPT_B(word));
+            const RayDialValue* y = RK(SCRIPT_C(word));
+            RayDialValue* result = &registers[SCRIPT_A(word)];
+            if (x->type == RAYDIAL_VAR_INT && y->type == RAYDIAL_VAR_INT) {
+                result->value.i = (int)((unsigned int)x->value.i + (unsigned int)y->value.i);
+                result->type = RAYDIAL_VAR_INT;
+            } else {
+                RayDialValue value = *x;
+                ApplyValueArithmetic('+', &value, y);
+                *result = value;
+            }
+            VM_NEXT();
+        }
+        VM_CASE(SUB) {
+            const RayDialValue* x = RK(SCRIPT_B(word));
+            const RayDialValue* y = RK(SCRIPT_C(word));
+            RayDialValue* result = &registers[SCRIPT_A(word)];
+            if (x->type == RAYDIAL_VAR_INT && y->type == RAYDIAL_VAR_INT) {
+                result->value.i = (int)((unsigned int)x->value.i - (unsigned int)y->value.i);
+                result->type = RAYDIAL_VAR_INT;
+            } else {
+                RayDialValue value = *x;
+                ApplyValueArithmetic('-', &value, y);
+                *result = value;
+            }
+            VM_NEXT();
+        }
+        VM_CASE(MUL) {
+            RayDialValue value = *RK(SCRIPT_B(word));
+            ApplyValueArithmetic('*', &value, RK(SCRIPT_C(word)));
+            registers[SCRIPT_A(word)] = value;
+            VM_NEXT();
+        }
+        VM_CASE(DIV) {
+            RayDialValue value = *RK(SCRIPT_B(word));
+            ApplyValueArithmetic('/', &value, RK(SCRIPT_C(word)));
+            registers[SCRIPT_A(word)] = value;
+            VM_NEXT();
+        }
+        VM_CASE(MOD) {
+            RayDialValue value = *RK(SCRIPT_B(word));
+            ApplyValueArithmetic('%', &value, RK(SCRIPT_C(word)));
+            registers[SCRIPT_A(word)] = value;
+            VM_NEXT();
+        }
+        VM_CASE(EQ) {
+            int order;
+            bool equal = CompareValues(RK(SCRIPT_B(word)), RK(SCRIPT_C(word)), &order) && order == 0;
+            registers[SCRIPT_A(word)] = (RayDialValue){ RAYDIAL_VAR_INT, { equal } };
+            VM_NEXT();
+        }
+        VM_CASE(NE) {
+            int order;
+            bool equal = CompareValues(RK(SCRIPT_B(word)), RK(SCRIPT_C(word)), &order) && order == 0;
+            registers[SCRIPT_A(word)] = (RayDialValue){ RAYDIAL_VAR_INT, { !equal } };
+            VM_NEXT();
+        }
+        VM_CASE(LT) {
+            const RayDialValue* x = RK(SCRIPT_B(word));
+            const RayDialValue* y = RK(SCRIPT_C(word));
+            int order;
+            bool less = x->type == RAYDIAL_VAR_INT && y->type == RAYDIAL_VAR_INT ? x->value.i < y->value.i :
+                        CompareValues(x, y, &order) && order < 0;
+            registers[SCRIPT_A(word)] = (RayDialValue){ RAYDIAL_VAR_INT, { less } };
+            VM_NEXT();
+        }
+        VM_CASE(LE) {
+            const RayDialValue* x = RK(SCRIPT_B(word));
+            const RayDialValue* y = RK(SCRIPT_C(word));
+            int order;
+            bool less = x->type == RAYDIAL_VAR_INT && y->type == RAYDIAL_VAR_INT ? x->value.i <= y->value.i :
+                        CompareValues(x, y, &order) && order <= 0;
+            registers[SCRIPT_A(word)] = (RayDialValue){ RAYDIAL_VAR_INT, { less } };
+            VM_NEXT();
+        }
+        VM_CASE(NOT) {
+            bool truth = IsValueTrue(RK(SCRIPT_B(word)));
+            registers[SCRIPT_A(word)] = (RayDialValue){ RAYDIAL_VAR_INT, { !truth } };
+            VM_NEXT();
+        }
+        VM_CASE(JMP) {
+            JUMP_TO(SCRIPT_BX(word));
+            VM_NEXT();
+        }
+        VM_CASE(JMPIF) {
+            if (IsValueTrue(&registers[SCRIPT_A(word)])) JUMP_TO(SCRIPT_BX(word));
+            VM_NEXT();
+        }
+        VM_CASE(JMPIFNOT) {
+            if (!IsValueTrue(&registers[SCRIPT_A(word)])) JUMP_TO(SCRIPT_BX(word));
+            VM_NEXT();
+        }
+        VM_CASE(GOTO) {
+            return constants[SCRIPT_BX(word)].value.s;
+        }
+        VM_CASE(EMIT) {
+            if (host->onEvent) host->onEvent(constants[SCRIPT_BX(word)].value.s, *RK(SCRIPT_A(word)), host->eventUserData);
+            VM_NEXT();
+        }
+        VM_CASE(CALL) {
+            const RayDialScriptNativeEntry* native = &host->natives[SCRIPT_B(word)];
+            int a = SCRIPT_A(word);
+            registers[a] = native->function(&registers[a + 1], SCRIPT_C(word), native->userData);
+            VM_NEXT();
+        }
+        VM_CASE(END) {
+            return NULL;
+        }
+#ifndef RAYDIAL_SCRIPT_COMPUTED_GOTO
+        default:
+            return NULL;
+        }
+#endif
+    }
+
+exhausted:
+    TraceLog(LOG_WARNING, "RAYDIAL: Script stopped after %d loop iterations", RAYDIAL_SCRIPT_MAX_LOOPS);
+    return NULL;
+
+#undef RK
+#undef JUMP_TO
+#undef VM_CASE
+#undef VM_NEXT
+}
@@ -0,0 +1,421 @@
+#include "raydial_snapshot.h"
+#include "raydial_graph.h"
+#include "raydial_history_data.h"
+#include "raylib.h"
+#include <string.h>
+#include <stdint.h>
+
+// Layout, all words little-endian uint32:
+//   header    magic "RDS1", version, total size, FNV-1a checksum of everything after the header
+//   sections  tag, payload length, payload; unknown tags are skipped
+//   NODE      flags, node index, chapter name length, name and NUL
+//   VARS      count, then per variable: name length, name and NUL, type, and the
+//             value bits, or for a string its length, bytes and NUL
+//   SEEN      bitset count, then per chapter (outside chapters first): word count, words
+//   HIST      count, then per line, oldest first: chapter, node index, flags, row count,
+//             text length, text and NUL, and with a speaker its length, name and NUL
+// SEEN and HIST are written for managers with a history.
+// The node index is into the current graph, or the pre-order position in the tree.
+#define RAYDIAL_SNAPSHOT_VERSION 1
+#define RAYDIAL_SNAPSHOT_HEADER_SIZE 16
+#define RAYDIAL_SNAPSHOT_FLAG_ACTIVE 1u
+#define RAYDIAL_SNAPSHOT_LINE_TEXT_KEY 1u
+#define RAYDIAL_SNAPSHOT_LINE_SPEAKER 2u
+#define RAYDIAL_SNAPSHOT_LINE_SPEAKER_KEY 4u
+
+static const unsigned char snapshotMagic[4] = { 'R', 'D', 'S', '1' };
+static const unsigned char nodeTag[4] = { 'N', 'O', 'D', 'E' };
+static const unsigned char varsTag[4] = { 'V', 'A', 'R', 'S' };
+static const unsigned char seenTag[4] = { 'S', 'E', 'E', 'N' };
+static const unsigned char histTag[4] = { 'H', 'I', 'S', 'T' };
+
+static uint32_t HashSnapshot(const unsigned char* bytes, int length) {
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Writer: counts every byte, stores them only while they fit
+typedef struct {
+    unsigned char* buffer;
+    int capacity;
+    int size;
+} RayDialSnapshotWriter;
+
+static void WriteSnapshotBytes(RayDialSnapshotWriter* writer, const void* bytes, int count) {
+    if (writer->buffer && writer->size + count <= writer->capacity) {
+        memcpy(writer->buffer + writer->size, bytes, count);
+    }
+    writer->size += count;
+}
+
+static void WriteSnapshotWord(RayDialSnapshotWriter* writer, uint32_t value) {
+    unsigned char bytes[4] = { value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, value >> 24 };
+    WriteSnapshotBytes(writer, bytes, 4);
+}
+
+static void WriteSnapshotString(RayDialSnapshotWriter* writer, const char* text) {
+    int length = (int)strlen(text);
+    WriteSnapshotWord(writer, (uint32_t)length);
+    WriteSnapshotBytes(writer, text, length + 1);
+}
+
+// Reader: every read is bounds checked; a failed reader stays failed
+typedef struct {
+    const unsigned char* data;
+    int size;
+    int offset;
+    bool failed;
+} RayDialSnapshotReader;
+
+static uint32_t ReadSnapshotWord(RayDialSnapshotReader* reader) {
+    if (reader->failed || reader->size - reader->offset < 4) {
+        reader->failed = true;
+        return 0;
+    }
+    const unsigned char* bytes = reader->data + reader->offset;
+    reader->offset += 4;
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+// A length-prefixed string, NUL-terminated in place with no NUL inside
+static const char* ReadSnapshotString(RayDialSnapshotReader* reader) {
+    uint32_t length = ReadSnapshotWord(reader);
+    if (reader->failed || length >= (uint32_t)(reader->size - reader->offset)) {
+        reader->failed = true;
+        return NULL;
+    }
+    const char* text = (const char*)reader->data + reader->offset;
+    if (text[length] != '\0' || memchr(text, '\0', length)) {
+        reader->failed = true;
+        return NULL;
+    }
+    reader->offset += (int)length + 1;
+    return text;
+}
+
+typedef struct {
+    const char* name;
+    RayDialValue value;
+} RayDialSnapshotVariable;
+
+static RayDialSnapshotVariable ReadSnapshotVariable(RayDialSnapshotReader* reader) {
+    RayDialSnapshotVariable variable = { 0 };
+    variable.name = ReadSnapshotString(reader);
+    uint32_t type = ReadSnapshotWord(reader);
+    variable.value.type = (RayDialVariableType)type;
+    switch (type) {
+        case RAYDIAL_VAR_INT:
+        case RAYDIAL_VAR_BOOL:
+            variable.value.value.i = (int)ReadSnapshotWord(reader);
+            break;
+        case RAYDIAL_VAR_FLOAT: {
+            uint32_t bits = ReadSnapshotWord(reader);
+            memcpy(&variable.value.value.f, &bits, sizeof(bits));
+            break;
+        }
+        case RAYDIAL_VAR_STRING:
+            variable.value.value.s = ReadSnapshotString(reader);
+            break;
+        default:
+            reader->failed = true;
+            break;
+    }
+    if (variable.name && !*variable.name) reader->failed = true;
+    return variable;
+}
+
+typedef struct {
+    int chapter;
+    int nodeIndex;
+    uint32_t flags;
+    int lineCount;
+    const char* text;
+    const char* speaker;
+} RayDialSnapshotLine;
+
+static RayDialSnapshotLine ReadSnapshotLine(RayDialSnapshotReader* reader) {
+    RayDialSnapshotLine line = { 0 };
+    line.chapter = (int)ReadSnapshotWord(reader);
+    line.nodeIndex = (int)ReadSnapshotWord(reader);
+    line.flags = ReadSnapshotWord(reader);
+    line.lineCount = (int)ReadSnapshotWord(reader);
+    line.text = ReadSnapshotString(reader);
+    if (line.flags & RAYDIAL_SNAPSHOT_LINE_SPEAKER) line.speaker = ReadSnapshotString(reader);
+    if (line.chapter < -1 || line.nodeIndex < -1 || line.lineCount < 1 || line.flags > 7u ||
+        (!(line.flags & RAYDIAL_SNAPSHOT_LINE_SPEAKER) && (line.flags & RAYDIAL_SNAPSHOT_LINE_SPEAKER_KEY))) {
+        reader->failed = true;
+    }
+    return line;
+}
+
+static void WriteSnapshotHistory(RayDialSnapshotWriter* writer, const RayDialHistory* history) {
+    int seenSize = 4;
+    for (int i = 0; i < history->visitedCount; i++) seenSize += 4 + 4 * history->visitedWords[i];
+    WriteSnapshotBytes(writer, seenTag, sizeof(seenTag));
+    WriteSnapshotWord(writer, (uint32_t)seenSize);
+    WriteSnapshotWord(writer, (uint32_t)history->visitedCount);
+    for (int i = 0; i < history->visitedCount; i++) {
+        WriteSnapshotWord(writer, (uint32_t)history->visitedWords[i]);
+        for (int word = 0; word < history->visitedWords[i]; word++) {
+            WriteSnapshotWord(writer, history->visited[i][word]);
+        }
+    }
+
+    int count = GetDialogueHistoryCount(history);
+    int histSize = 4;
+    for (int i = 0; i < count; i++) {
+        const RayDialHistoryEntry* entry = GetDialogueHistoryEntry(history, i);
+        histSize += 16 + 4 + (int)strlen(entry->text) + 1;
+        if (entry->speaker) histSize += 4 + (int)strlen(entry->speaker) + 1;
+    }
+    WriteSnapshotBytes(writer, histTag, sizeof(histTag));
+    WriteSnapshotWord(writer, (uint32_t)histSize);
+    WriteSnapshotWord(writer, (uint32_t)count);
+    for (int i = 0; i < count; i++) {
+        const RayDialHistoryEntry* entry = GetDialogueHistoryEntry(history, i);
+        uint32_t flags = (entry->textIsKey ? RAYDIAL_SNAPSHOT_LINE_TEXT_KEY : 0) |
+                         (entry->speaker ? RAYDIAL_SNAPSHOT_LINE_SPEAKER : 0) |
+                         (entry->speakerIsKey ? RAYDIAL_SNAPSHOT_LINE_SPEAKER_KEY : 0);
+        WriteSnapshotWord(writer, (uint32_t)entry->chapter);
+        WriteSnapshotWord(writer, (uint32_t)entry->nodeIndex);
+        WriteSnapshotWord(writer, flags);
+        WriteSnapshotWord(writer, (uint32_t)entry->lineCount);
+        WriteSnapshotString(writer, entry->text);
+        if (entry->speaker) WriteSnapshotString(writer, entry->speaker);
+    }
+}
+
+// Replace the history with the saved one; bitsets already large enough are reused
+static void RestoreSnapshotHistory(RayDialHistory* history, RayDialSnapshotReader seen, RayDialSnapshotReader lines) {
+    ClearDialogueHistory(history);
+
+    uint32_t spaces = ReadSnapshotWord(&seen);
+    for (uint32_t space = 0; space < spaces; space++) {
+        uint32_t words = ReadSnapshotWord(&seen);
+        for (uint32_t word = 0; word < words; word++) {
+            uint32_t bits = ReadSnapshotWord(&seen);
+            for (int bit = 0; bits; bit++, bits >>= 1) {
+                if (bits & 1u) MarkNodeVisited(history, (int)space - 1, (int)(word * 32) + bit);
+            }
+        }
+    }
+
+    uint32_t count = ReadSnapshotWord(&lines);
+    for (uint32_t i = 0; i < count; i++) {
+        RayDialSnapshotLine line = ReadSnapshotLine(&lines);
+        RayDialHistoryEntry entry = {
+            .chapter = line.chapter,
+            .nodeIndex = line.nodeIndex,
+            .text = line.text,
+            .speaker = line.speaker,
+            .textIsKey = (line.flags & RAYDIAL_SNAPSHOT_LINE_TEXT_KEY) != 0,
+            .speakerIsKey = (line.flags & RAYDIAL_SNAPSHOT_LINE_SPEAKER_KEY) != 0,
+            .lineCount = line.lineCount
+        };
+        RecordDialogueEntry(history, &entry);
+    }
+}
+
+int SaveDialogueSnapshot(const RayDialManager* manager, const RayDialVariables* variables, unsigned char* buffer, int capacity) {
+    if (!manager || capacity < 0) return 0;
+
+    int index = GetManagerNodeIndex(manager, manager->currentNode);
+    if (index < 0) {
+        TraceLog(LOG_WARNING, "RAYDIAL: Snapshot: the current node is not in the manager's graph");
+        return 0;
+    }
+
+    RayDialSnapshotWriter writer = { buffer, capacity, 0 };
+    WriteSnapshotBytes(&writer, snapshotMagic, sizeof(snapshotMagic));
+    WriteSnapshotWord(&writer, RAYDIAL_SNAPSHOT_VERSION);
+    WriteSnapshotWord(&writer, 0);     // Size and checksum are filled in last
+    WriteSnapshotWord(&writer, 0);
+
+    const char* chapter = manager->chapters ? GetCurrentChapterName(manager->chapters) : NULL;
+    if (!chapter) chapter = "";
+    int start = writer.size;
+    WriteSnapshotBytes(&writer, nodeTag, sizeof(nodeTag));
+    WriteSnapshotWord(&writer, (uint32_t)(12 + strlen(chapter) + 1));
+    WriteSnapshotWord(&writer, manager->isActive ? RAYDIAL_SNAPSHOT_FLAG_ACTIVE : 0);
+    WriteSnapshotWord(&writer, (uint32_t)index);
+    WriteSnapshotString(&writer, chapter);
+
+    if (variables) {
+        // The payload length is only known afterwards, so measure it with a counting pass
+        int count = GetVariableCount(variables);
+        RayDialSnapshotWriter measure = { NULL, 0, 0 };
+        for (int pass = 0; pass < 2; pass++) {
+            RayDialSnapshotWriter* target = pass ? &writer : &measure;
+            if (pass) {
+                WriteSnapshotBytes(&writer, varsTag, sizeof(varsTag));
+                WriteSnapshotWord(&writer, (uint32_t)measure.size);
+            }
+            WriteSnapshotWord(target, (uint32_t)count);
+            for (int id = 0; id < count; id++) {
+                RayDialValue value = GetVariableValue(variables, id);
+                WriteSnapshotString(target, GetVariableName(variables, id));
+                WriteSnapshotWord(target, (uint32_t)value.type);
+                if (value.type == RAYDIAL_VAR_STRING) {
+                    WriteSnapshotString(target, value.value.s ? value.value.s : "");
+                } else if (value.type == RAYDIAL_VAR_FLOAT) {
+                    uint32_t bits;
+                    memcpy(&bits, &value.value.f, sizeof(bits));
+                    WriteSnapshotWord(target, bits);
+                } else {
+                    WriteSnapshotWord(target, (uint32_t)value.value.i);
+                }
+            }
+        }
+    }
+
+    if (manager->history) WriteSnapshotHistory(&writer, manager->history);
+
+    if (buffer && writer.size <= capacity) {
+        RayDialSnapshotWriter header = { buffer + 8, 8, 0 };
+        WriteSnapshotWord(&header, (uint32_t)writer.size);
+        WriteSnapshotWord(&header, HashSnapshot(buffer + RAYDIAL_SNAPSHOT_HEADER_SIZE, writer.size - start));
+    }
+    return writer.size;
+}
+
+// Whether the snapshot lists the variable. Snapshots list variables in id order, so
+// when restoring into the store they came from the cursor usually matches at once.
+static bool SnapshotHasVariable(const RayDialSnapshotReader* vars, RayDialSnapshotReader* cursor, const char* name) {
+    if (cursor->offset < cursor->size) {
+        RayDialSnapshotReader next = *cursor;
+        if (strcmp(ReadSnapshotVariable(&next).name, name) == 0) {
+            *cursor = next;
+            return true;
+        }
+    }
+    RayDialSnapshotReader scan = *vars;
+    while (scan.offset < scan.size) {
+        if (strcmp(ReadSnapshotVariable(&scan).name, name) == 0) return true;
+    }
+    return false;
+}
+
+bool RestoreDialogueSnapshot(RayDialManager* manager, RayDialVariables* variables, const unsigned char* data, int size) {
+    if (!manager || !data || size < RAYDIAL_SNAPSHOT_HEADER_SIZE) return false;
+
+    RayDialSnapshotReader reader = { data, size, 4, false };
+    if (memcmp(data, snapshotMagic, sizeof(snapshotMagic)) != 0 ||
+        ReadSnapshotWord(&reader) != RAYDIAL_SNAPSHOT_VERSION ||
+        ReadSnapshotWord(&reader) != (uint32_t)size ||
+        ReadSnapshotWord(&reader) != HashSnapshot(data + RAYDIAL_SNAPSHOT_HEADER_SIZE, size - RAYDIAL_SNAPSHOT_HEADER_SIZE)) {
+        TraceLog(LOG_WARNING, "RAYDIAL: Not a valid dialogue snapshot");
+        return false;
+    }
+
+    // Validate every section before anything changes
+    bool hasNode = false;
+    uint32_t flags = 0;
+    uint32_t index = 0;
+    const char* chapter = NULL;
+    bool hasVars = false;
+    RayDialSnapshotReader vars = { 0 };             // The variable records
+    uint32_t varCount = 0;
+    RayDialSnapshotReader seen = { 0 };             // The SEEN and HIST payloads
+    RayDialSnapshotReader lines = { 0 };
+    bool hasSeen = false;
+    bool hasLines = false;
+    while (!reader.failed && reader.offset < size) {
+        if (size - reader.offset < 8) {
+            reader.failed = true;
+            break;
+        }
+        const unsigned char* tag = data + reader.offset;
+        reader.offset += 4;
+        uint32_t length = ReadSnapshotWord(&reader);
+        if (reader.failed || length > (uint32_t)(size - reader.offset)) {
+            reader.failed = true;
+            break;
+        }
+        RayDialSnapshotReader section = { data, reader.offset + (int)length, reader.offset, false };
+        reader.offset += (int)length;
+
+        if (memcmp(tag, nodeTag, 4) == 0) {
+            flags = ReadSnapshotWord(&section);
+            index = ReadSnapshotWord(&section);
+            chapter = ReadSnapshotString(&section);
+            hasNode = true;
+        } else if (memcmp(tag, varsTag, 4) == 0) {
+            varCount = ReadSnapshotWord(&section);
+            vars = section;
+            hasVars = true;
+            for (uint32_t i = 0; i < varCount && !section.failed; i++) ReadSnapshotVariable(&section);
+            vars.size = section.offset;
+        } else if (memcmp(tag, seenTag, 4) == 0) {
+            seen = section;
+            hasSeen = true;
+            uint32_t spaces = ReadSnapshotWord(&section);
+            for (uint32_t i = 0; i < spaces && !section.failed; i++) {
+                uint32_t words = ReadSnapshotWord(&section);
+                if (words > (uint32_t)(section.size - section.offset) / 4 || words > INT32_MAX / 32) {
+                    section.failed = true;
+                    break;
+                }
+                section.offset += (int)words * 4;
+            }
+            if (spaces > INT32_MAX) section.failed = true;
+        } else if (memcmp(tag, histTag, 4) == 0) {
+            lines = section;
+            hasLines = true;
+            uint32_t count = ReadSnapshotWord(&section);
+            for (uint32_t i = 0; i < count && !section.failed; i++) ReadSnapshotLine(&section);
+        } else {
+            continue;
+        }
+        if (section.failed || section.offset != section.size) reader.failed = true;
+    }
+    if (reader.failed || !hasNode || (*chapter != '\0') != (manager->chapters != NULL)) {
+        TraceLog(LOG_WARNING, "RAYDIAL: Damaged dialogue snapshot, or one for another kind of manager");
+        return false;
+    }
+
+    // Find the node; a chapter may have to load first, but only becomes current below
+    RayDialNode* node = NULL;
+    if (index < INT32_MAX) {
+        node = manager->chapters ? GetChapterNode(manager->chapters, chapter, (int)index) : GetManagerNode(manager, (int)index);
+    }
+    if (!node) {
+        TraceLog(LOG_WARNING, "RAYDIAL: Snapshot node %u is not in this dialogue", index);
+        return false;
+    }
+    RayDialGraph* graph = manager->graph;
+    RayDialNode* root = manager->rootNode;
+    if (manager->chapters) {
+        FollowChapterLink(manager->chapters, node);
+        graph = GetCurrentChapterGraph(manager->chapters);
+        root = GetGraphNode(graph, 0);
+    }
+
+    if (variables && hasVars) {
+        // Variables created after the save didn't exist then, which reads as 0
+        int count = GetVariableCount(variables);
+        RayDialSnapshotReader cursor = vars;
+        for (int id = 0; id < count; id++) {
+            if (!SnapshotHasVariable(&vars, &cursor, GetVariableName(variables, id))) SetVariableInt(variables, id, 0);
+        }
+
+        RayDialSnapshotReader scan = vars;
+        for (uint32_t i = 0; i < varCount; i++) {
+            RayDialSnapshotVariable variable = ReadSnapshotVariable(&scan);
+            int id = FindVariableId(variables, variable.name);
+            if (id < 0) id = GetVariableId(variables, variable.name);
+            SetVariableValue(variables, id, variable.value);
+        }
+    }
+
+    if (manager->history && hasSeen && hasLines) RestoreSnapshotHistory(manager->history, seen, lines);
+
+    manager->graph = graph;
+    manager->rootNode = root;
+    manager->currentNode = node;
+    manager->isActive = (flags & RAYDIAL_SNAPSHOT_FLAG_ACTIVE) != 0;
+    return true;
+}
@@ -0,0 +1,235 @@
+#include "raydial_text_edit.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RAYDIAL_TEXT_EDIT_MIN_CAPACITY 32
+
+static bool IsContinuationByte(char byte) {
+    return ((unsigned char)byte & 0xC0) == 0x80;
+}
+
+static int CountCodepoints(const char* text, int bytes) {
+    int count = 0;
+    for (int i = 0; i < bytes; i++) {
+        if (!IsContinuationByte(text[i])) count++;
+    }
+    return count;
+}
+
+static int GapSize(const RayDialTextEditor* editor) {
+    return editor->gapEnd - editor->gapStart;
+}
+
+// Slide the gap so it starts at a logical position. Only the bytes between the
+// old and new gap position move.
+static void MoveGap(RayDialTextEditor* editor, int position) {
+    if (position < editor->gapStart) {
+        int count = editor->gapStart - position;
+        memmove(editor->buffer + editor->gapEnd - count, editor->buffer + position, count);
+        editor->gapStart -= count;
+        editor->gapEnd -= count;
+    } else if (position > editor->gapStart) {
+        int count = position - editor->gapStart;
+        memmove(editor->buffer + editor->gapStart, editor->buffer + editor->gapEnd, count);
+        editor->gapStart += count;
+        editor->gapEnd += count;
+    }
+
+    // The gap is never empty, so the text before it can always be terminated in place
+    editor->buffer[editor->gapStart] = '\0';
+}
+
+// Make room for at least `bytes` more bytes while keeping one spare gap byte
+static bool ReserveGap(RayDialTextEditor* editor, int bytes) {
+    if (GapSize(editor) > bytes) return true;
+
+    int length = TextEditorLength(editor);
+    int capacity = editor->capacity * 2;
+    if (capacity < length + bytes + 1) capacity = length + bytes + 1 + RAYDIAL_TEXT_EDIT_MIN_CAPACITY;
+
+    char* buffer = (char*)malloc(capacity + 1);
+    if (!buffer) return false;
+
+    int afterLength = editor->capacity - editor->gapEnd;
+    memcpy(buffer, editor->buffer, editor->gapStart);
+    memcpy(buffer + capacity - afterLength, editor->buffer + editor->gapEnd, afterLength);
+    buffer[capacity] = '\0';
+
+    free(editor->buffer);
+    editor->buffer = buffer;
+    editor->gapEnd = capacity - afterLength;
+    editor->capacity = capacity;
+    editor->buffer[editor->gapStart] = '\0';
+    return true;
+}
+
+bool InitTextEditor(RayDialTextEditor* editor, int initialCapacity) {
+    if (initialCapacity < RAYDIAL_TEXT_EDIT_MIN_CAPACITY) initialCapacity = RAYDIAL_TEXT_EDIT_MIN_CAPACITY;
+
+    editor->buffer = (char*)malloc(initialCapacity + 1);
+    if (!editor->buffer) return false;
+
+    editor->capacity = initialCapacity;
+    editor->gapStart = 0;
+    editor->gapEnd = initialCapacity;
+    editor->cursor = 0;
+    editor->anchor = 0;
+    editor->characterCount = 0;
+    editor->revision = 0;
+    editor->buffer[0] = '\0';
+    editor->buffer[initialCapacity] = '\0';
+    return true;
+}
+
+void FreeTextEditor(RayDialTextEditor* editor) {
+    if (!editor) return;
+    free(editor->buffer);
+    editor->buffer = NULL;
+}
+
+int TextEditorLength(const RayDialTextEditor* editor) {
+    return editor->capacity - GapSize(editor);
+}
+
+char TextEditorByteAt(const RayDialTextEditor* editor, int position) {
+    if (position < editor->gapStart) return editor->buffer[position];
+    return editor->buffer[position + GapSize(editor)];
+}
+
+const char* TextEditorBeforeGap(const RayDialTextEditor* editor) {
+    return editor->buffer;
+}
+
+const char* TextEditorAfterGap(const RayDialTextEditor* editor) {
+    return editor->buffer + editor->gapEnd;
+}
+
+const char* TextEditorContents(RayDialTextEditor* editor) {
+    MoveGap(editor, TextEditorLength(editor));
+    return editor->buffer;
+}
+
+int TextEditorPreviousBoundary(const RayDialTextEditor* editor, int position) {
+    if (position <= 0) return 0;
+    position--;
+    while (position > 0 && IsContinuationByte(TextEditorByteAt(editor, position))) position--;
+    return position;
+}
+
+int TextEditorNextBoundary(const RayDialTextEditor* editor, int position) {
+    int length = TextEditorLength(editor);
+    if (position >= length) return length;
+    position++;
+    while (position < length && IsContinuationByte(TextEditorByteAt(editor, position))) position++;
+    return position;
+}
+
+void TextEditorSetCursor(RayDialTextEditor* editor, int position, bool extend) {
+    int length = TextEditorLength(editor);
+    if (position < 0) position = 0;
+    if (position > length) position = length;
+
+    editor->cursor = position;
+    if (!extend) editor->anchor = position;
+}
+
+bool TextEditorHasSelection(const RayDialTextEditor* editor) {
+    return editor->cursor != editor->anchor;
+}
+
+int TextEditorCopySelection(const RayDialTextEditor* editor, char* out, int outSize) {
+    int start = editor->cursor < editor->anchor ? editor->cursor : editor->anchor;
+    int end = editor->cursor < editor->anchor ? editor->anchor : editor->cursor;
+
+    if (out && outSize > 0) {
+        int count = 0;
+        for (int i = start; i < end && count < outSize - 1; i++) {
+            out[count++] = TextEditorByteAt(editor, i);
+        }
+        out[count] = '\0';
+    }
+    return end - start;
+}
+
+// Remove [start, end) from the logical text and leave the caret at start
+static void DeleteRange(RayDialTextEditor* editor, int start, int end) {
+    if (end <= start) return;
+
+    MoveGap(editor, end);
+    editor->characterCount -= CountCodepoints(editor->buffer + start, end - start);
+    editor->gapStart = start;
+    editor->buffer[start] = '\0';
+
+    editor->cursor = start;
+    editor->anchor = start;
+    editor->revision++;
+}
+
+static bool DeleteSelection(RayDialTextEditor* editor) {
+    if (!TextEditorHasSelection(editor)) return false;
+
+    int start = editor->cursor < editor->anchor ? editor->cursor : editor->anchor;
+    int end = editor->cursor < editor->anchor ? editor->anchor : editor->cursor;
+    DeleteRange(editor, start, end);
+    return true;
+}
+
+bool TextEditorInsert(RayDialTextEditor* editor, const char* text, int bytes, int maxCharacters) {
+    if (!text || bytes <= 0) return false;
+
+    bool removed = DeleteSelection(editor);
+
+    // Keep only whole codepoints that fit under the character limit
+    if (maxCharacters > 0) {
+        int room = maxCharacters - editor->characterCount;
+        int accepted = 0;
+        int characters = 0;
+        while (accepted < bytes) {
+            int next = accepted + 1;
+            while (next < bytes && IsContinuationByte(text[next])) next++;
+            if (characters + 1 > room) break;
+            characters++;
+            accepted = next;
+        }
+        bytes = accepted;
+        if (bytes == 0) return removed;
+    }
+
+    if (!ReserveGap(editor, bytes)) return removed;
+
+    MoveGap(editor, editor->cursor);
+    memcpy(editor->buffer + editor->gapStart, text, bytes);
+    editor->gapStart += bytes;
+    editor->buffer[editor->gapStart] = '\0';
+
+    editor->characterCount += CountCodepoints(text, bytes);
+    editor->cursor = editor->gapStart;
+    editor->anchor = editor->cursor;
+    editor->revision++;
+    return true;
+}
+
+bool TextEditorDelete(RayDialTextEditor* editor, bool forward) {
+    if (DeleteSelection(editor)) return true;
+
+    int start = forward ? editor->cursor : TextEditorPreviousBoundary(editor, editor->cursor);
+    int end = forward ? TextEditorNextBoundary(editor, editor->cursor) : editor->cursor;
+    if (start == end) return false;
+
+    DeleteRange(editor, start, end);
+    return true;
+}
+
+bool TextEditorSetText(RayDialTextEditor* editor, const char* text, int maxCharacters) {
+    // Empty the buffer without moving any bytes, then insert at the start
+    editor->gapStart = 0;
+    editor->gapEnd = editor->capacity;
+    editor->buffer[0] = '\0';
+    editor->cursor = 0;
+    editor->anchor = 0;
+    editor->characterCount = 0;
+    editor->revision++;
+
+    if (!text || !*text) return true;
+    return TextEditorInsert(editor, text, (int)strlen(text), maxCharacters);
+}
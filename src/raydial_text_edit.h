@@ -0,0 +1,60 @@
+#ifndef RAYDIAL_TEXT_EDIT_H
+#define RAYDIAL_TEXT_EDIT_H
+
+#include <stdbool.h>
+
+// Internal editing core for RAYDIAL_TEXTBOX: a gap buffer holding UTF-8 text.
+// Positions are byte offsets into the logical text (the gap is invisible to callers).
+// Inserting or deleting at the cursor moves no text, so typing is O(1) amortized;
+// moving the cursor only moves the gap when the next edit happens elsewhere.
+
+typedef struct RayDialTextEditor {
+    char* buffer;           // Text before the gap, the gap, text after the gap, a terminator
+    int capacity;           // Bytes available for text plus gap (buffer holds capacity + 1)
+    int gapStart;
+    int gapEnd;
+    int cursor;             // Caret position
+    int anchor;             // Other end of the selection (equal to cursor when nothing is selected)
+    int characterCount;     // Codepoints in the text
+    int revision;           // Bumped on every change to the text
+} RayDialTextEditor;
+
+bool InitTextEditor(RayDialTextEditor* editor, int initialCapacity);
+void FreeTextEditor(RayDialTextEditor* editor);
+
+// Length of the text in bytes
+int TextEditorLength(const RayDialTextEditor* editor);
+
+// Byte at a logical position
+char TextEditorByteAt(const RayDialTextEditor* editor, int position);
+
+// Text before the gap and after it, each NUL-terminated in place
+const char* TextEditorBeforeGap(const RayDialTextEditor* editor);
+const char* TextEditorAfterGap(const RayDialTextEditor* editor);
+
+// Move the gap to the end and return the whole text as one NUL-terminated string
+const char* TextEditorContents(RayDialTextEditor* editor);
+
+// Codepoint boundaries around a position
+int TextEditorPreviousBoundary(const RayDialTextEditor* editor, int position);
+int TextEditorNextBoundary(const RayDialTextEditor* editor, int position);
+
+// Place the caret; extend keeps the anchor so the selection grows or shrinks
+void TextEditorSetCursor(RayDialTextEditor* editor, int position, bool extend);
+
+bool TextEditorHasSelection(const RayDialTextEditor* editor);
+
+// Copy the selected bytes into out (truncated to outSize); returns the selection length
+int TextEditorCopySelection(const RayDialTextEditor* editor, char* out, int outSize);
+
+// Replace the selection (or insert at the caret). At most maxCharacters codepoints
+// are kept in total when maxCharacters > 0; returns false if nothing was inserted.
+bool TextEditorInsert(RayDialTextEditor* editor, const char* text, int bytes, int maxCharacters);
+
+// Delete the selection, or one codepoint before (backward) or after the caret
+bool TextEditorDelete(RayDialTextEditor* editor, bool forward);
+
+// Replace the whole text
+bool TextEditorSetText(RayDialTextEditor* editor, const char* text, int maxCharacters);
+
+#endif // RAYDIAL_TEXT_EDIT_H
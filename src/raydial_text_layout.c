@@ -0,0 +1,212 @@
+#include "raydial_text_layout.h"
+#include <raylib.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool IsContinuationByte(char byte) {
+    return ((unsigned char)byte & 0xC0) == 0x80;
+}
+
+static int CountGlyphs(const char* text, int start, int end) {
+    int count = 0;
+    for (int i = start; i < end; i++) {
+        if (!IsContinuationByte(text[i])) count++;
+    }
+    return count;
+}
+
+static bool ReserveScratch(RayDialTextLayout* layout, int bytes) {
+    if (bytes + 1 <= layout->scratchCapacity) return true;
+
+    int capacity = layout->scratchCapacity ? layout->scratchCapacity : 128;
+    while (capacity < bytes + 1) capacity *= 2;
+    char* scratch = (char*)realloc(layout->scratch, capacity);
+    if (!scratch) return false;
+
+    layout->scratch = scratch;
+    layout->scratchCapacity = capacity;
+    return true;
+}
+
+// Width of text[start, end) measured the way raylib measures a whole string
+static float MeasureRange(RayDialTextLayout* layout, const char* text, int start, int end) {
+    if (end <= start || !ReserveScratch(layout, end - start)) return 0.0f;
+
+    memcpy(layout->scratch, text + start, end - start);
+    layout->scratch[end - start] = '\0';
+    return MeasureTextEx(GetFontDefault(), layout->scratch, layout->fontSize, layout->spacing).x;
+}
+
+// Glyph index of a byte offset. Lines are added in order, so counting resumes
+// where the previous call stopped and the whole build stays one pass.
+static int GlyphIndexAt(RayDialTextLayout* layout, const char* text, int offset) {
+    layout->countedGlyphs += CountGlyphs(text, layout->countedBytes, offset);
+    layout->countedBytes = offset;
+    return layout->countedGlyphs;
+}
+
+static bool AddLine(RayDialTextLayout* layout, const char* text, int start, int end) {
+    if (layout->lineCount + 1 >= layout->lineCapacity) {
+        int capacity = layout->lineCapacity ? layout->lineCapacity * 2 : 64;
+        int* starts = (int*)realloc(layout->lineStart, capacity * sizeof(int));
+        if (!starts) return false;
+        layout->lineStart = starts;
+        int* ends = (int*)realloc(layout->lineEnd, capacity * sizeof(int));
+        if (!ends) return false;
+        layout->lineEnd = ends;
+        int* glyphs = (int*)realloc(layout->lineGlyphs, (capacity + 1) * sizeof(int));
+        if (!glyphs) return false;
+        layout->lineGlyphs = glyphs;
+        layout->lineCapacity = capacity;
+    }
+
+    int index = layout->lineCount++;
+    layout->lineStart[index] = start;
+    layout->lineEnd[index] = end;
+    layout->lineGlyphs[index] = GlyphIndexAt(layout, text, start);
+    return ReserveScratch(layout, end - start);
+}
+
+static void BuildTextLayout(RayDialTextLayout* layout, const char* text) {
+    layout->lineCount = 0;
+    layout->countedBytes = 0;
+    layout->countedGlyphs = 0;
+    if (!layout->lineGlyphs) {
+        layout->lineGlyphs = (int*)malloc(sizeof(int));
+        if (!layout->lineGlyphs) return;
+    }
+    layout->lineGlyphs[0] = 0;
+    if (!text) return;
+
+    int position = 0;
+    for (;;) {
+        // One paragraph per '\n'; greedy word wrap inside it
+        int lineStart = -1;
+        int lineEnd = -1;
+        float lineWidth = 0.0f;
+
+        for (;;) {
+            while (text[position] == ' ') position++;
+            if (text[position] == '\0' || text[position] == '\n') break;
+
+            int wordStart = position;
+            while (text[position] && text[position] != ' ' && text[position] != '\n') position++;
+            float wordWidth = MeasureRange(layout, text, wordStart, position);
+
+            if (lineStart < 0) {
+                lineStart = wordStart;
+                lineWidth = wordWidth;
+            } else {
+                // Joined width: the gap between words is measured as part of the line
+                float gapWidth = MeasureRange(layout, text, lineEnd, wordStart);
+                float joined = lineWidth + layout->spacing + gapWidth + layout->spacing + wordWidth;
+                if (joined > layout->maxWidth) {
+                    if (!AddLine(layout, text, lineStart, lineEnd)) return;
+                    lineStart = wordStart;
+                    lineWidth = wordWidth;
+                } else {
+                    lineWidth = joined;
+                }
+            }
+            lineEnd = position;
+        }
+
+        if (lineStart >= 0) {
+            if (!AddLine(layout, text, lineStart, lineEnd)) return;
+        } else if (text[position] == '\n') {
+            // Blank line between paragraphs
+            if (!AddLine(layout, text, position, position)) return;
+        }
+
+        if (text[position] == '\0') break;
+        position++; // Skip the '\n'
+    }
+    
+    layout->lineGlyphs[layout->lineCount] = GlyphIndexAt(layout, text, position);
+}
+
+bool UpdateTextLayout(RayDialTextLayout* layout, const char* text, float maxWidth, float fontSize, float spacing) {
+    if (!layout->dirty && layout->text == text && layout->maxWidth == maxWidth &&
+        layout->fontSize == fontSize && layout->spacing == spacing && layout->lineGlyphs) {
+        return false;
+    }
+
+    layout->text = text;
+    layout->maxWidth = maxWidth;
+    layout->fontSize = fontSize;
+    layout->spacing = spacing;
+    layout->dirty = false;
+    BuildTextLayout(layout, text);
+    return true;
+}
+
+void InvalidateTextLayout(RayDialTextLayout* layout) {
+    layout->dirty = true;
+}
+
+void FreeTextLayout(RayDialTextLayout* layout) {
+    if (!layout) return;
+    free(layout->lineStart);
+    free(layout->lineEnd);
+    free(layout->lineGlyphs);
+    free(layout->scratch);
+    memset(layout, 0, sizeof(RayDialTextLayout));
+}
+
+int FindTextLayoutLine(const RayDialTextLayout* layout, int glyph) {
+    int low = 0;
+    int high = layout->lineCount - 1;
+    if (high < 0) return 0;
+
+    // Last line whose first glyph is at or before the requested one
+    while (low < high) {
+        int mid = (low + high + 1) / 2;
+        if (layout->lineGlyphs[mid] <= glyph) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+const char* GetTextLayoutLine(RayDialTextLayout* layout, int line, int maxGlyphs) {
+    if (line < 0 || line >= layout->lineCount || !layout->scratch) return "";
+
+    int start = layout->lineStart[line];
+    int end = layout->lineEnd[line];
+    if (maxGlyphs >= 0) {
+        int position = start;
+        int glyphs = 0;
+        while (position < end) {
+            if (!IsContinuationByte(layout->text[position])) {
+                if (glyphs == maxGlyphs) break;
+                glyphs++;
+            }
+            position++;
+        }
+        end = position;
+    }
+
+    memcpy(layout->scratch, layout->text + start, end - start);
+    layout->scratch[end - start] = '\0';
+    return layout->scratch;
+}
+
+int NextTextCodepoint(const char* text, int* bytes) {
+    const unsigned char* c = (const unsigned char*)text;
+    *bytes = 1;
+    if (c[0] < 0x80) return c[0];
+    
+    // Malformed sequences decode to '?' one byte at a time
+    int length = (c[0] & 0xE0) == 0xC0 ? 2 : (c[0] & 0xF0) == 0xE0 ? 3 : (c[0] & 0xF8) == 0xF0 ? 4 : 0;
+    if (length == 0) return '?';
+    
+    int codepoint = c[0] & (0x7F >> length);
+    for (int i = 1; i < length; i++) {
+        if ((c[i] & 0xC0) != 0x80) return '?';
+        codepoint = (codepoint << 6) | (c[i] & 0x3F);
+    }
+    *bytes = length;
+    return codepoint;
+}
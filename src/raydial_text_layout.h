@@ -0,0 +1,50 @@
+#ifndef RAYDIAL_TEXT_LAYOUT_H
+#define RAYDIAL_TEXT_LAYOUT_H
+
+#include <stdbool.h>
+
+// Internal word-wrapped line index for plain text. Built once per (text, width,
+// font size) and reused every frame, so drawing only touches the visible lines.
+// Lines break at '\n' and between words; a word wider than the line stands alone.
+
+typedef struct RayDialTextLayout {
+    const char* text;       // Text the index was built for (borrowed)
+    float maxWidth;
+    float fontSize;
+    float spacing;
+    bool dirty;             // Forces a rebuild even if the inputs look unchanged
+
+    int* lineStart;         // Byte range of each line in text
+    int* lineEnd;
+    int* lineGlyphs;        // Glyph index in text where each line starts (lineCount + 1 entries,
+                            // the last is the glyph count of the whole text)
+    int lineCount;
+    int lineCapacity;
+    int countedBytes;       // Build cursor for the glyph count
+    int countedGlyphs;
+
+    char* scratch;          // NUL-terminated copy of one line for drawing, sized at build time
+    int scratchCapacity;
+} RayDialTextLayout;
+
+// Rebuild the index if the text pointer, width or font size changed or the layout
+// was invalidated. Returns true if a rebuild happened.
+bool UpdateTextLayout(RayDialTextLayout* layout, const char* text, float maxWidth, float fontSize, float spacing);
+
+// Force the next UpdateTextLayout to rebuild (for text edited in place)
+void InvalidateTextLayout(RayDialTextLayout* layout);
+
+void FreeTextLayout(RayDialTextLayout* layout);
+
+// Line holding a glyph index of text (binary search over lineGlyphs). Glyphs are
+// counted over the whole text, including the spaces and newlines lines break at.
+int FindTextLayoutLine(const RayDialTextLayout* layout, int glyph);
+
+// Line text as a C string, cut after maxGlyphs glyphs (negative for the whole line).
+// Points into the layout's scratch buffer and is valid until the next call.
+const char* GetTextLayoutLine(RayDialTextLayout* layout, int line, int maxGlyphs);
+
+// Decode the UTF-8 codepoint at text and store its length in bytes
+int NextTextCodepoint(const char* text, int* bytes);
+
+#endif // RAYDIAL_TEXT_LAYOUT_H
@@ -0,0 +1,538 @@
+#include "raydial_textures.h"
+#include "raydial_worker.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#define RAYDIAL_TEXTURE_MIN_SLOTS 64       // Initial hash index capacity (power of two)
+
+struct RayDialTextureHandle {
+    RayDialTextureCache* cache;
+    char* path;
+    int maxSize;                            // Requested on-screen size, 0 for the full image
+    unsigned int hash;
+    int refCount;
+    RayDialTextureState state;              // Only changed on the main thread
+    Image image;                            // Decoded by the worker, consumed by the upload
+    Texture2D texture;
+    size_t sourceBytes;                     // Size of the decoded file at full resolution
+    size_t residentBytes;                   // Size of what was uploaded, mip chain included
+    struct RayDialTextureHandle* nextDecoded;   // Worker-to-main-thread handoff stack
+    struct RayDialTextureHandle* nextUpload;    // Main thread upload queue
+};
+
+struct RayDialTextureCache {
+    RayDialWorkerPool* worker;
+    RayDialTextureHandle** slots;           // Open-addressed index by path
+    int slotCapacity;
+    int count;
+    int pendingCount;                       // Entries queued, decoding or waiting for upload
+    _Atomic(RayDialTextureHandle*) decoded; // Pushed by workers when a decode finishes
+    RayDialTextureHandle* uploadHead;       // Decoded entries in the order they finished
+    RayDialTextureHandle* uploadTail;
+    RayDialTextureMemory memory;            // Totals over the uploaded entries
+};
+
+// FNV-1a hash of a texture path
+static unsigned int HashTexturePath(const char* path) {
+    unsigned int hash = 2166136261u;
+    while (*path) {
+        hash ^= (unsigned char)*path++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Variants of one file are separate entries, so the size is part of the key
+static unsigned int HashTextureKey(const char* path, int maxSize) {
+    return HashTexturePath(path) ^ ((unsigned int)maxSize * 2654435761u);
+}
+
+static void InsertTextureSlot(RayDialTextureHandle** slots, int capacity, RayDialTextureHandle* handle) {
+    int mask = capacity - 1;
+    int index = handle->hash & mask;
+    while (slots[index]) index = (index + 1) & mask;
+    slots[index] = handle;
+}
+
+static bool GrowTextureSlots(RayDialTextureCache* cache) {
+    int capacity = cache->slotCapacity * 2;
+    RayDialTextureHandle** slots = (RayDialTextureHandle**)calloc(capacity, sizeof(RayDialTextureHandle*));
+    if (!slots) return false;
+
+    for (int i = 0; i < cache->slotCapacity; i++) {
+        if (cache->slots[i]) InsertTextureSlot(slots, capacity, cache->slots[i]);
+    }
+    free(cache->slots);
+    cache->slots = slots;
+    cache->slotCapacity = capacity;
+    return true;
+}
+
+// Worker thread entry point: decode the file into CPU memory only
+static void DecodeTextureJob(void* arg) {
+    RayDialTextureHandle* handle = (RayDialTextureHandle*)arg;
+    handle->image = LoadImage(handle->path);
+    Image* image = &handle->image;
+    if (image->data) {
+        handle->sourceBytes = GetPixelDataSize(image->width, image->height, image->format);
+
+        // Halve down to the smallest level still covering the requested size, then
+        // build the mip chain below it so smaller draws filter instead of aliasing
+        if (handle->maxSize > 0) {
+            int levels = 0;
+            int longest = image->width > image->height ? image->width : image->height;
+            while ((longest >> (levels + 1)) >= handle->maxSize) levels++;
+            if (levels > 0) {
+                int width = image->width >> levels;
+                int height = image->height >> levels;
+                ImageResize(image, width > 0 ? width : 1, height > 0 ? height : 1);
+            }
+            ImageMipmaps(image);
+        }
+
+        int width = image->width;
+        int height = image->height;
+        for (int level = 0; level < image->mipmaps; level++) {
+            handle->residentBytes += GetPixelDataSize(width, height, image->format);
+            if (width > 1) width /= 2;
+            if (height > 1) height /= 2;
+        }
+    }
+
+    RayDialTextureCache* cache = handle->cache;
+    RayDialTextureHandle* head = atomic_load_explicit(&cache->decoded, memory_order_relaxed);
+    do {
+        handle->nextDecoded = head;
+    } while (!atomic_compare_exchange_weak_explicit(&cache->decoded, &head, handle,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+RayDialTextureCache* CreateTextureCache(int workerThreads) {
+    RayDialTextureCache* cache = (RayDialTextureCache*)calloc(1, sizeof(RayDialTextureCache));
+    if (!cache) return NULL;
+
+    cache->slotCapacity = RAYDIAL_TEXTURE_MIN_SLOTS;
+    cache->slots = (RayDialTextureHandle**)calloc(cache->slotCapacity, sizeof(RayDialTextureHandle*));
+    cache->worker = CreateWorkerPool(workerThreads < 1 ? 1 : workerThreads);
+    atomic_init(&cache->decoded, NULL);
+
+    if (!cache->slots || !cache->worker) {
+        FreeWorkerPool(cache->worker);
+        free(cache->slots);
+        free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+static void FreeTextureHandle(RayDialTextureHandle* handle) {
+    if (handle->state == RAYDIAL_TEXTURE_READY) {
+        RayDialTextureMemory* memory = &handle->cache->memory;
+        memory->textureCount--;
+        memory->sourceBytes -= handle->sourceBytes;
+        memory->residentBytes -= handle->residentBytes;
+    }
+    if (handle->image.data) UnloadImage(handle->image);
+    if (handle->texture.id != 0) UnloadTexture(handle->texture);
+    free(handle->path);
+    free(handle);
+}
+
+void FreeTextureCache(RayDialTextureCache* cache) {
+    if (!cache) return;
+
+    // Jobs reference their entries, so let them finish first
+    FreeWorkerPool(cache->worker);
+    for (int i = 0; i < cache->slotCapacity; i++) {
+        if (cache->slots[i]) FreeTextureHandle(cache->slots[i]);
+    }
+    free(cache->slots);
+    free(cache);
+}
+
+RayDialTextureHandle* AcquireTexture(RayDialTextureCache* cache, const char* path) {
+    return AcquireTextureSized(cache, path, 0);
+}
+
+RayDialTextureHandle* AcquireTextureSized(RayDialTextureCache* cache, const char* path, int maxSize) {
+    if (!cache || !path) return NULL;
+    if (maxSize < 0) maxSize = 0;
+
+    unsigned int hash = HashTextureKey(path, maxSize);
+    int mask = cache->slotCapacity - 1;
+    for (int index = hash & mask; cache->slots[index]; index = (index + 1) & mask) {
+        RayDialTextureHandle* handle = cache->slots[index];
+        if (handle->hash == hash && handle->maxSize == maxSize && strcmp(handle->path, path) == 0) {
+            handle->refCount++;
+            return handle;
+        }
+    }
+
+    // Keep the index under 70% full
+    if ((cache->count + 1) * 10 > cache->slotCapacity * 7 && !GrowTextureSlots(cache)) return NULL;
+
+    RayDialTextureHandle* handle = (RayDialTextureHandle*)calloc(1, sizeof(RayDialTextureHandle));
+    if (!handle) return NULL;
+    handle->path = strdup(path);
+    if (!handle->path) {
+        free(handle);
+        return NULL;
+    }
+    handle->cache = cache;
+    handle->maxSize = maxSize;
+    handle->hash = hash;
+    handle->refCount = 1;
+    handle->state = RAYDIAL_TEXTURE_LOADING;
+
+    if (!SubmitWorkerJob(cache->worker, DecodeTextureJob, handle)) {
+        handle->state = RAYDIAL_TEXTURE_FAILED;
+    } else {
+        cache->pendingCount++;
+    }
+
+    InsertTextureSlot(cache->slots, cache->slotCapacity, handle);
+    cache->count++;
+    return handle;
+}
+
+void RetainTexture(RayDialTextureHandle* handle) {
+    if (handle) handle->refCount++;
+}
+
+// Dropping the last reference keeps the texture cached until TrimTextureCache
+void ReleaseTexture(RayDialTextureHandle* handle) {
+    if (handle && handle->refCount > 0) handle->refCount--;
+}
+
+RayDialTextureState GetTextureState(const RayDialTextureHandle* handle) {
+    return handle ? handle->state : RAYDIAL_TEXTURE_FAILED;
+}
+
+Texture2D GetHandleTexture(const RayDialTextureHandle* handle) {
+    if (!handle || handle->state != RAYDIAL_TEXTURE_READY) return (Texture2D){ 0 };
+    return handle->texture;
+}
+
+void UpdateTextureCache(RayDialTextureCache* cache, double budgetSeconds) {
+    if (!cache) return;
+
+    // Take everything the workers finished; the stack is newest first, so reverse
+    // it to upload in completion order
+    RayDialTextureHandle* decoded = atomic_exchange_explicit(&cache->decoded, NULL, memory_order_acquire);
+    RayDialTextureHandle* ordered = NULL;
+    while (decoded) {
+        RayDialTextureHandle* next = decoded->nextDecoded;
+        decoded->nextDecoded = ordered;
+        ordered = decoded;
+        decoded = next;
+    }
+    while (ordered) {
+        RayDialTextureHandle* next = ordered->nextDecoded;
+        ordered->nextUpload = NULL;
+        if (cache->uploadTail) {
+            cache->uploadTail->nextUpload = ordered;
+        } else {
+            cache->uploadHead = ordered;
+        }
+        cache->uploadTail = ordered;
+        ordered = next;
+    }
+
+    // GPU uploads only happen here, on the main thread, until the budget runs out
+    double start = GetTime();
+    while (cache->uploadHead) {
+        RayDialTextureHandle* handle = cache->uploadHead;
+        cache->uploadHead = handle->nextUpload;
+        if (!cache->uploadHead) cache->uploadTail = NULL;
+
+        if (handle->image.data) {
+            handle->texture = LoadTextureFromImage(handle->image);
+            if (handle->texture.id != 0 && handle->texture.mipmaps > 1) {
+                SetTextureFilter(handle->texture, TEXTURE_FILTER_TRILINEAR);
+            }
+            UnloadImage(handle->image);
+            handle->image.data = NULL;
+        }
+        handle->state = handle->texture.id != 0 ? RAYDIAL_TEXTURE_READY : RAYDIAL_TEXTURE_FAILED;
+        if (handle->state == RAYDIAL_TEXTURE_READY) {
+            cache->memory.textureCount++;
+            cache->memory.sourceBytes += handle->sourceBytes;
+            cache->memory.residentBytes += handle->residentBytes;
+        }
+        cache->pendingCount--;
+
+        if (GetTime() - start >= budgetSeconds) break;
+    }
+}
+
+void WaitTextureCache(RayDialTextureCache* cache) {
+    if (cache) WaitWorkerPool(cache->worker);
+}
+
+int GetTextureCachePendingCount(const RayDialTextureCache* cache) {
+    return cache ? cache->pendingCount : 0;
+}
+
+RayDialTextureMemory GetTextureCacheMemory(const RayDialTextureCache* cache) {
+    if (!cache) return (RayDialTextureMemory){ 0 };
+    return cache->memory;
+}
+
+int TrimTextureCache(RayDialTextureCache* cache) {
+    if (!cache) return 0;
+
+    RayDialTextureHandle** slots = (RayDialTextureHandle**)calloc(cache->slotCapacity, sizeof(RayDialTextureHandle*));
+    if (!slots) return 0;
+
+    // Entries still being decoded are referenced by a job and stay
+    int removed = 0;
+    for (int i = 0; i < cache->slotCapacity; i++) {
+        RayDialTextureHandle* handle = cache->slots[i];
+        if (!handle) continue;
+
+        if (handle->refCount == 0 && handle->state != RAYDIAL_TEXTURE_LOADING) {
+            FreeTextureHandle(handle);
+            removed++;
+        } else {
+            InsertTextureSlot(slots, cache->slotCapacity, handle);
+        }
+    }
+
+    free(cache->slots);
+    cache->slots = slots;
+    cache->count -= removed;
+    return removed;
+}
+
+// Portrait atlas
+
+#define RAYDIAL_ATLAS_WHITE_SIZE 4          // Solid block reserved for shapes; its inner 2x2 is sampled
+
+typedef struct {
+    char* name;                             // NULL for the reserved white block
+    unsigned int hash;
+    Image image;                            // CPU copy until the atlas is built
+    int page;
+    Rectangle rect;                         // Placement inside the page
+} RayDialAtlasEntry;
+
+struct RayDialPortraitAtlas {
+    int pageSize;
+    int padding;
+    bool built;
+    RayDialAtlasEntry* entries;             // Entry 0 is the white block
+    int entryCount;
+    int entryCapacity;
+    int* slots;                             // Open-addressed index of entries by name (-1 empty)
+    int slotCapacity;
+    Texture2D* pages;
+    int pageCount;
+};
+
+static int FindAtlasEntry(const RayDialPortraitAtlas* atlas, const char* name, unsigned int hash) {
+    int mask = atlas->slotCapacity - 1;
+    for (int index = hash & mask; atlas->slots[index] >= 0; index = (index + 1) & mask) {
+        const RayDialAtlasEntry* entry = &atlas->entries[atlas->slots[index]];
+        if (entry->hash == hash && strcmp(entry->name, name) == 0) return atlas->slots[index];
+    }
+    return -1;
+}
+
+static void InsertAtlasSlot(RayDialPortraitAtlas* atlas, int entryIndex) {
+    int mask = atlas->slotCapacity - 1;
+    int index = atlas->entries[entryIndex].hash & mask;
+    while (atlas->slots[index] >= 0) index = (index + 1) & mask;
+    atlas->slots[index] = entryIndex;
+}
+
+static bool ReserveAtlasEntry(RayDialPortraitAtlas* atlas) {
+    if (atlas->entryCount == atlas->entryCapacity) {
+        int capacity = atlas->entryCapacity ? atlas->entryCapacity * 2 : 16;
+        RayDialAtlasEntry* entries = (RayDialAtlasEntry*)realloc(atlas->entries, capacity * sizeof(RayDialAtlasEntry));
+        if (!entries) return false;
+        atlas->entries = entries;
+        atlas->entryCapacity = capacity;
+    }
+
+    // Keep the name index under 70% full
+    if ((atlas->entryCount + 1) * 10 > atlas->slotCapacity * 7) {
+        int capacity = atlas->slotCapacity ? atlas->slotCapacity * 2 : 32;
+        int* slots = (int*)malloc(capacity * sizeof(int));
+        if (!slots) return false;
+        free(atlas->slots);
+        atlas->slots = slots;
+        atlas->slotCapacity = capacity;
+        for (int i = 0; i < capacity; i++) atlas->slots[i] = -1;
+        for (int i = 1; i < atlas->entryCount; i++) InsertAtlasSlot(atlas, i);
+    }
+    return true;
+}
+
+RayDialPortraitAtlas* CreatePortraitAtlas(int pageSize, int padding) {
+    if (pageSize <= RAYDIAL_ATLAS_WHITE_SIZE || padding < 0) return NULL;
+
+    RayDialPortraitAtlas* atlas = (RayDialPortraitAtlas*)calloc(1, sizeof(RayDialPortraitAtlas));
+    if (!atlas) return NULL;
+    atlas->pageSize = pageSize;
+    atlas->padding = padding;
+
+    if (!ReserveAtlasEntry(atlas)) {
+        FreePortraitAtlas(atlas);
+        return NULL;
+    }
+    RayDialAtlasEntry* white = &atlas->entries[atlas->entryCount++];
+    memset(white, 0, sizeof(RayDialAtlasEntry));
+    white->image = GenImageColor(RAYDIAL_ATLAS_WHITE_SIZE, RAYDIAL_ATLAS_WHITE_SIZE, WHITE);
+    return atlas;
+}
+
+void FreePortraitAtlas(RayDialPortraitAtlas* atlas) {
+    if (!atlas) return;
+
+    for (int i = 0; i < atlas->entryCount; i++) {
+        free(atlas->entries[i].name);
+        if (atlas->entries[i].image.data) UnloadImage(atlas->entries[i].image);
+    }
+    for (int i = 0; i < atlas->pageCount; i++) {
+        UnloadTexture(atlas->pages[i]);
+    }
+    free(atlas->entries);
+    free(atlas->slots);
+    free(atlas->pages);
+    free(atlas);
+}
+
+bool AddAtlasImage(RayDialPortraitAtlas* atlas, const char* name, Image image) {
+    if (!atlas || !name || atlas->built || !image.data) return false;
+    if (image.width + atlas->padding * 2 > atlas->pageSize || image.height + atlas->padding * 2 > atlas->pageSize) return false;
+
+    unsigned int hash = HashTexturePath(name);
+    if (atlas->slots && FindAtlasEntry(atlas, name, hash) >= 0) return false;
+    if (!ReserveAtlasEntry(atlas)) return false;
+
+    char* nameCopy = strdup(name);
+    if (!nameCopy) return false;
+
+    RayDialAtlasEntry* entry = &atlas->entries[atlas->entryCount];
+    memset(entry, 0, sizeof(RayDialAtlasEntry));
+    entry->name = nameCopy;
+    entry->hash = hash;
+    entry->image = ImageCopy(image);
+    if (!entry->image.data) {
+        free(nameCopy);
+        return false;
+    }
+
+    InsertAtlasSlot(atlas, atlas->entryCount++);
+    return true;
+}
+
+bool AddAtlasImageFile(RayDialPortraitAtlas* atlas, const char* name, const char* path) {
+    if (!atlas || !path) return false;
+
+    Image image = LoadImage(path);
+    if (!image.data) return false;
+    bool added = AddAtlasImage(atlas, name, image);
+    UnloadImage(image);
+    return added;
+}
+
+bool BuildPortraitAtlas(RayDialPortraitAtlas* atlas) {
+    if (!atlas || atlas->built) return false;
+
+    int* order = (int*)malloc(atlas->entryCount * sizeof(int));
+    if (!order) return false;
+    for (int i = 0; i < atlas->entryCount; i++) order[i] = i;
+
+    // Tallest images first gives the shelf packer fewer half-empty rows. Insertion
+    // sort keeps equal heights in the order they were added; the white block stays
+    // first so it always lands on page 0.
+    for (int i = 2; i < atlas->entryCount; i++) {
+        int index = order[i];
+        int height = atlas->entries[index].image.height;
+        int j = i;
+        while (j > 1 && atlas->entries[order[j - 1]].image.height < height) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = index;
+    }
+
+    // Shelf packing: fill rows left to right, start a new row or page when full
+    int pad = atlas->padding;
+    int page = 0;
+    int x = pad;
+    int y = pad;
+    int shelfHeight = 0;
+    for (int i = 0; i < atlas->entryCount; i++) {
+        RayDialAtlasEntry* entry = &atlas->entries[order[i]];
+        int width = entry->image.width;
+        int height = entry->image.height;
+
+        if (x + width + pad > atlas->pageSize) {
+            x = pad;
+            y += shelfHeight + pad;
+            shelfHeight = 0;
+        }
+        if (y + height + pad > atlas->pageSize) {
+            page++;
+            x = pad;
+            y = pad;
+            shelfHeight = 0;
+        }
+
+        entry->page = page;
+        entry->rect = (Rectangle){ (float)x, (float)y, (float)width, (float)height };
+        x += width + pad;
+        if (height > shelfHeight) shelfHeight = height;
+    }
+    free(order);
+
+    atlas->pages = (Texture2D*)calloc(page + 1, sizeof(Texture2D));
+    if (!atlas->pages) return false;
+
+    // Compose and upload one page at a time to bound CPU memory
+    for (int p = 0; p <= page; p++) {
+        Image pageImage = GenImageColor(atlas->pageSize, atlas->pageSize, BLANK);
+        for (int i = 0; i < atlas->entryCount; i++) {
+            RayDialAtlasEntry* entry = &atlas->entries[i];
+            if (entry->page != p) continue;
+            Rectangle source = { 0, 0, (float)entry->image.width, (float)entry->image.height };
+            ImageDraw(&pageImage, entry->image, source, entry->rect, WHITE);
+            UnloadImage(entry->image);
+            entry->image.data = NULL;
+        }
+        atlas->pages[p] = LoadTextureFromImage(pageImage);
+        UnloadImage(pageImage);
+        atlas->pageCount++;
+    }
+
+    atlas->built = true;
+    return true;
+}
+
+int GetAtlasPageCount(const RayDialPortraitAtlas* atlas) {
+    return atlas ? atlas->pageCount : 0;
+}
+
+bool GetAtlasRegion(const RayDialPortraitAtlas* atlas, const char* name, RayDialAtlasRegion* region) {
+    if (!atlas || !name || !region || !atlas->built || !atlas->slots) return false;
+
+    int index = FindAtlasEntry(atlas, name, HashTexturePath(name));
+    if (index < 0) return false;
+
+    region->texture = atlas->pages[atlas->entries[index].page];
+    region->source = atlas->entries[index].rect;
+    return true;
+}
+
+bool GetAtlasWhiteRegion(const RayDialPortraitAtlas* atlas, RayDialAtlasRegion* region) {
+    if (!atlas || !region || !atlas->built) return false;
+
+    // Sample the middle of the block so filtering never reaches a neighbour
+    Rectangle rect = atlas->entries[0].rect;
+    region->texture = atlas->pages[0];
+    region->source = (Rectangle){ rect.x + 1, rect.y + 1, rect.width - 2, rect.height - 2 };
+    return true;
+}
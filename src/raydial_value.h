@@ -0,0 +1,20 @@
+#ifndef RAYDIAL_VALUE_H
+#define RAYDIAL_VALUE_H
+
+#include "raydial_vars.h"
+
+// Internal value semantics shared by the condition evaluator and the script VM,
+// so both agree on truth, arithmetic and comparison.
+
+bool IsValueTrue(const RayDialValue* value);
+
+// a = a op b, where op is one of + - * / %
+void ApplyValueArithmetic(char op, RayDialValue* a, const RayDialValue* b);
+
+// Three-way compare into order; false (with order nonzero) when a string meets a number
+bool CompareValues(const RayDialValue* a, const RayDialValue* b, int* order);
+
+// Intern a string into the store's set; equal strings share one pointer
+const char* InternVariableString(RayDialVariables* variables, const char* string, int length);
+
+#endif // RAYDIAL_VALUE_H
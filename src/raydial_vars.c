@@ -0,0 +1,1029 @@
+#include "raydial_vars.h"
+#include "raydial_value.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <math.h>
+
+#define RAYDIAL_VARS_MIN_SLOTS 32          // Initial name index capacity (power of two)
+#define RAYDIAL_VARS_MIN_STRINGS 32        // Initial interned string set capacity (power of two)
+#define RAYDIAL_CONDITION_MAX_STACK 32     // Evaluation stack of a single condition
+#define RAYDIAL_CONDITION_MAX_NESTING 64   // Parentheses and unary operators in a row
+
+typedef struct {
+    RayDialVariableType type;
+    union {
+        int i;
+        float f;
+        bool b;
+        const char* s;                      // Interned
+    } value;
+    unsigned int version;                   // Store version of the last change
+    int firstSubscription;                  // -1 when nobody listens
+} RayDialVariableSlot;
+
+typedef struct {
+    int variable;
+    RayDialVariableCallback callback;       // NULL once unsubscribed; the entry is reused
+    void* userData;
+    int next;                               // Next subscription of the same variable
+} RayDialSubscription;
+
+struct RayDialVariables {
+    char** names;
+    unsigned int* hashes;
+    RayDialVariableSlot* values;
+    int count;
+    int capacity;
+    int* slots;                             // Open-addressed index of ids by name (-1 empty)
+    int slotCapacity;
+    char** strings;                         // Interned string set (NULL empty)
+    int stringCapacity;
+    int stringCount;
+    RayDialSubscription* subscriptions;
+    int subscriptionCount;
+    int subscriptionCapacity;
+    unsigned int version;
+};
+
+// Condition bytecode. Operands follow their opcode inline: PUSH has a 32-bit int,
+// PUSH_FLOAT a float, PUSH_STRING an interned string pointer, LOAD a 16-bit
+// variable id and the jumps a 16-bit code offset.
+typedef enum {
+    RAYDIAL_COND_PUSH,
+    RAYDIAL_COND_PUSH_FLOAT,
+    RAYDIAL_COND_PUSH_STRING,
+    RAYDIAL_COND_LOAD,
+    RAYDIAL_COND_NOT,
+    RAYDIAL_COND_NEG,
+    RAYDIAL_COND_BOOL,          // Normalize the top to 0 or 1
+    RAYDIAL_COND_ADD,
+    RAYDIAL_COND_SUB,
+    RAYDIAL_COND_MUL,
+    RAYDIAL_COND_DIV,
+    RAYDIAL_COND_MOD,
+    RAYDIAL_COND_LT,
+    RAYDIAL_COND_LE,
+    RAYDIAL_COND_GT,
+    RAYDIAL_COND_GE,
+    RAYDIAL_COND_EQ,
+    RAYDIAL_COND_NE,
+    RAYDIAL_COND_AND,           // Top is false: keep it and jump; otherwise pop it
+    RAYDIAL_COND_OR,            // Top is true: make it 1 and jump; otherwise pop it
+    RAYDIAL_COND_END
+} RayDialConditionOp;
+
+struct RayDialCondition {
+    unsigned char* code;
+    int length;
+    int* dependencies;                      // Variables the expression reads, each once
+    int dependencyCount;
+};
+
+// FNV-1a hash of a name or string
+static unsigned int HashVariableName(const char* name, int length) {
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void InsertVariableSlot(RayDialVariables* variables, int id) {
+    int mask = variables->slotCapacity - 1;
+    int index = variables->hashes[id] & mask;
+    while (variables->slots[index] >= 0) index = (index + 1) & mask;
+    variables->slots[index] = id;
+}
+
+static bool GrowVariableSlots(RayDialVariables* variables) {
+    int capacity = variables->slotCapacity ? variables->slotCapacity * 2 : RAYDIAL_VARS_MIN_SLOTS;
+    int* slots = (int*)malloc(capacity * sizeof(int));
+    if (!slots) return false;
+
+    free(variables->slots);
+    variables->slots = slots;
+    variables->slotCapacity = capacity;
+    for (int i = 0; i < capacity; i++) slots[i] = -1;
+    for (int id = 0; id < variables->count; id++) InsertVariableSlot(variables, id);
+    return true;
+}
+
+static int FindVariable(const RayDialVariables* variables, const char* name, int length, unsigned int hash) {
+    int mask = variables->slotCapacity - 1;
+    for (int index = hash & mask; variables->slots[index] >= 0; index = (index + 1) & mask) {
+        int id = variables->slots[index];
+        if (variables->hashes[id] == hash && strncmp(variables->names[id], name, length) == 0 &&
+            variables->names[id][length] == '\0') {
+            return id;
+        }
+    }
+    return -1;
+}
+
+// Find or add a variable named by name[0, length)
+static int InternVariable(RayDialVariables* variables, const char* name, int length) {
+    unsigned int hash = HashVariableName(name, length);
+    int id = FindVariable(variables, name, length, hash);
+    if (id >= 0) return id;
+    if (variables->count > UINT16_MAX) return -1;
+
+    // Keep the index under 70% full
+    if ((variables->count + 1) * 10 > variables->slotCapacity * 7 && !GrowVariableSlots(variables)) return -1;
+
+    if (variables->count == variables->capacity) {
+        int capacity = variables->capacity ? variables->capacity * 2 : 16;
+        char** names = (char**)realloc(variables->names, capacity * sizeof(char*));
+        if (!names) return -1;
+        variables->names = names;
+        unsigned int* hashes = (unsigned int*)realloc(variables->hashes, capacity * sizeof(unsigned int));
+        if (!hashes) return -1;
+        variables->hashes = hashes;
+        RayDialVariableSlot* values = (RayDialVariableSlot*)realloc(variables->values, capacity * sizeof(RayDialVariableSlot));
+        if (!values) return -1;
+        variables->values = values;
+        variables->capacity = capacity;
+    }
+
+    char* copy = (char*)malloc(length + 1);
+    if (!copy) return -1;
+    memcpy(copy, name, length);
+    copy[length] = '\0';
+
+    id = variables->count++;
+    variables->names[id] = copy;
+    variables->hashes[id] = hash;
+    memset(&variables->values[id], 0, sizeof(RayDialVariableSlot));
+    variables->values[id].type = RAYDIAL_VAR_INT;
+    variables->values[id].firstSubscription = -1;
+    InsertVariableSlot(variables, id);
+    return id;
+}
+
+static void InsertInternedString(char** strings, int capacity, char* string) {
+    int mask = capacity - 1;
+    int index = HashVariableName(string, (int)strlen(string)) & mask;
+    while (strings[index]) index = (index + 1) & mask;
+    strings[index] = string;
+}
+
+// One copy of every string value, so string comparisons are pointer comparisons
+const char* InternVariableString(RayDialVariables* variables, const char* string, int length) {
+    int mask = variables->stringCapacity - 1;
+    unsigned int hash = HashVariableName(string, length);
+    for (int index = hash & mask; variables->strings[index]; index = (index + 1) & mask) {
+        const char* candidate = variables->strings[index];
+        if (strncmp(candidate, string, length) == 0 && candidate[length] == '\0') return candidate;
+    }
+
+    if ((variables->stringCount + 1) * 10 > variables->stringCapacity * 7) {
+        int capacity = variables->stringCapacity * 2;
+        char** strings = (char**)calloc(capacity, sizeof(char*));
+        if (!strings) return NULL;
+        for (int i = 0; i < variables->stringCapacity; i++) {
+            if (variables->strings[i]) InsertInternedString(strings, capacity, variables->strings[i]);
+        }
+        free(variables->strings);
+        variables->strings = strings;
+        variables->stringCapacity = capacity;
+    }
+
+    char* copy = (char*)malloc(length + 1);
+    if (!copy) return NULL;
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+    InsertInternedString(variables->strings, variables->stringCapacity, copy);
+    variables->stringCount++;
+    return copy;
+}
+
+RayDialVariables* CreateVariableStore(void) {
+    RayDialVariables* variables = (RayDialVariables*)calloc(1, sizeof(RayDialVariables));
+    if (!variables) return NULL;
+
+    // Version 0 is never current, so a zeroed cache always starts stale
+    variables->version = 1;
+    variables->stringCapacity = RAYDIAL_VARS_MIN_STRINGS;
+    variables->strings = (char**)calloc(variables->stringCapacity, sizeof(char*));
+    if (!variables->strings || !GrowVariableSlots(variables)) {
+        FreeVariableStore(variables);
+        return NULL;
+    }
+    return variables;
+}
+
+void FreeVariableStore(RayDialVariables* variables) {
+    if (!variables) return;
+
+    for (int i = 0; i < variables->count; i++) {
+        free(variables->names[i]);
+    }
+    for (int i = 0; i < variables->stringCapacity; i++) {
+        free(variables->strings[i]);
+    }
+    free(variables->names);
+    free(variables->hashes);
+    free(variables->values);
+    free(variables->slots);
+    free(variables->strings);
+    free(variables->subscriptions);
+    free(variables);
+}
+
+int GetVariableId(RayDialVariables* variables, const char* name) {
+    if (!variables || !name || !*name) return -1;
+    return InternVariable(variables, name, (int)strlen(name));
+}
+
+int FindVariableId(const RayDialVariables* variables, const char* name) {
+    if (!variables || !name) return -1;
+    int length = (int)strlen(name);
+    return FindVariable(variables, name, length, HashVariableName(name, length));
+}
+
+int GetVariableCount(const RayDialVariables* variables) {
+    return variables ? variables->count : 0;
+}
+
+const char* GetVariableName(const RayDialVariables* variables, int id) {
+    if (!variables || id < 0 || id >= variables->count) return NULL;
+    return variables->names[id];
+}
+
+static const RayDialVariableSlot* GetSlot(const RayDialVariables* variables, int id) {
+    if (!variables || id < 0 || id >= variables->count) return NULL;
+    return &variables->values[id];
+}
+
+RayDialVariableType GetVariableType(const RayDialVariables* variables, int id) {
+    const RayDialVariableSlot* slot = GetSlot(variables, id);
+    return slot ? slot->type : RAYDIAL_VAR_INT;
+}
+
+int GetVariableInt(const RayDialVariables* variables, int id) {
+    const RayDialVariableSlot* slot = GetSlot(variables, id);
+    if (!slot) return 0;
+    switch (slot->type) {
+        case RAYDIAL_VAR_INT: return slot->value.i;
+        case RAYDIAL_VAR_FLOAT: return (int)slot->value.f;
+        case RAYDIAL_VAR_BOOL: return slot->value.b;
+        default: return 0;
+    }
+}
+
+float GetVariableFloat(const RayDialVariables* variables, int id) {
+    const RayDialVariableSlot* slot = GetSlot(variables, id);
+    if (!slot) return 0.0f;
+    switch (slot->type) {
+        case RAYDIAL_VAR_INT: return (float)slot->value.i;
+        case RAYDIAL_VAR_FLOAT: return slot->value.f;
+        case RAYDIAL_VAR_BOOL: return slot->value.b ? 1.0f : 0.0f;
+        default: return 0.0f;
+    }
+}
+
+bool GetVariableBool(const RayDialVariables* variables, int id) {
+    const RayDialVariableSlot* slot = GetSlot(variables, id);
+    if (!slot) return false;
+    switch (slot->type) {
+        case RAYDIAL_VAR_INT: return slot->value.i != 0;
+        case RAYDIAL_VAR_FLOAT: return slot->value.f != 0.0f;
+        case RAYDIAL_VAR_BOOL: return slot->value.b;
+        default: return slot->value.s[0] != '\0';
+    }
+}
+
+const char* GetVariableString(const RayDialVariables* variables, int id) {
+    const RayDialVariableSlot* slot = GetSlot(variables, id);
+    return slot && slot->type == RAYDIAL_VAR_STRING ? slot->value.s : "";
+}
+
+RayDialValue GetVariableValue(const RayDialVariables* variables, int id) {
+    RayDialValue value = { RAYDIAL_VAR_INT, { 0 } };
+    const RayDialVariableSlot* slot = GetSlot(variables, id);
+    if (!slot) return value;
+
+    value.type = slot->type;
+    switch (slot->type) {
+        case RAYDIAL_VAR_FLOAT: value.value.f = slot->value.f; break;
+        case RAYDIAL_VAR_BOOL: value.value.i = slot->value.b; break;
+        case RAYDIAL_VAR_STRING: value.value.s = slot->value.s; break;
+        default: value.value.i = slot->value.i; break;
+    }
+    return value;
+}
+
+// Record a change and tell the subscribers. Entries are never unlinked, so the
+// walk stays valid while callbacks subscribe, unsubscribe or set more variables.
+static void VariableChanged(RayDialVariables* variables, int id) {
+    variables->values[id].version = ++variables->version;
+
+    for (int index = variables->values[id].firstSubscription; index >= 0; index = variables->subscriptions[index].next) {
+        RayDialSubscription subscription = variables->subscriptions[index];
+        if (subscription.callback) subscription.callback(variables, id, subscription.userData);
+    }
+}
+
+void SetVariableInt(RayDialVariables* variables, int id, int value) {
+    RayDialVariableSlot* slot = (RayDialVariableSlot*)GetSlot(variables, id);
+    if (!slot || (slot->type == RAYDIAL_VAR_INT && slot->value.i == value)) return;
+
+    slot->type = RAYDIAL_VAR_INT;
+    slot->value.i = value;
+    VariableChanged(variables, id);
+}
+
+void SetVariableFloat(RayDialVariables* variables, int id, float value) {
+    RayDialVariableSlot* slot = (RayDialVariableSlot*)GetSlot(variables, id);
+    if (!slot || (slot->type == RAYDIAL_VAR_FLOAT && slot->value.f == value)) return;
+
+    slot->type = RAYDIAL_VAR_FLOAT;
+    slot->value.f = value;
+    VariableChanged(variables, id);
+}
+
+void SetVariableBool(RayDialVariables* variables, int id, bool value) {
+    RayDialVariableSlot* slot = (RayDialVariableSlot*)GetSlot(variables, id);
+    if (!slot || (slot->type == RAYDIAL_VAR_BOOL && slot->value.b == value)) return;
+
+    slot->type = RAYDIAL_VAR_BOOL;
+    slot->value.b = value;
+    VariableChanged(variables, id);
+}
+
+void SetVariableString(RayDialVariables* variables, int id, const char* value) {
+    RayDialVariableSlot* slot = (RayDialVariableSlot*)GetSlot(variables, id);
+    if (!slot) return;
+
+    const char* interned = InternVariableString(variables, value ? value : "", value ? (int)strlen(value) : 0);
+    if (!interned || (slot->type == RAYDIAL_VAR_STRING && slot->value.s == interned)) return;
+
+    slot->type = RAYDIAL_VAR_STRING;
+    slot->value.s = interned;
+    VariableChanged(variables, id);
+}
+
+void SetVariableValue(RayDialVariables* variables, int id, RayDialValue value) {
+    switch (value.type) {
+        case RAYDIAL_VAR_FLOAT: SetVariableFloat(variables, id, value.value.f); break;
+        case RAYDIAL_VAR_BOOL: SetVariableBool(variables, id, value.value.i != 0); break;
+        case RAYDIAL_VAR_STRING: SetVariableString(variables, id, value.value.s); break;
+        default: SetVariableInt(variables, id, value.value.i); break;
+    }
+}
+
+unsigned int GetVariableStoreVersion(const RayDialVariables* variables) {
+    return variables ? variables->version : 0;
+}
+
+unsigned int GetVariableVersion(const RayDialVariables* variables, int id) {
+    const RayDialVariableSlot* slot = GetSlot(variables, id);
+    return slot ? slot->version : 0;
+}
+
+int SubscribeVariable(RayDialVariables* variables, int id, RayDialVariableCallback callback, void* userData) {
+    if (!variables || !callback || id < 0 || id >= variables->count) return -1;
+
+    // Reuse an entry of this variable that was unsubscribed, else append one
+    int last = -1;
+    for (int index = variables->values[id].firstSubscription; index >= 0; index = variables->subscriptions[index].next) {
+        if (!variables->subscriptions[index].callback) {
+            variables->subscriptions[index].callback = callback;
+            variables->subscriptions[index].userData = userData;
+            return index;
+        }
+        last = index;
+    }
+
+    if (variables->subscriptionCount == variables->subscriptionCapacity) {
+        int capacity = variables->subscriptionCapacity ? variables->subscriptionCapacity * 2 : 16;
+        RayDialSubscription* subscriptions = (RayDialSubscription*)realloc(variables->subscriptions, capacity * sizeof(RayDialSubscription));
+        if (!subscriptions) return -1;
+        variables->subscriptions = subscriptions;
+        variables->subscriptionCapacity = capacity;
+    }
+
+    int index = variables->subscriptionCount++;
+    variables->subscriptions[index] = (RayDialSubscription){ id, callback, userData, -1 };
+    if (last >= 0) {
+        variables->subscriptions[last].next = index;
+    } else {
+        variables->values[id].firstSubscription = index;
+    }
+    return index;
+}
+
+void UnsubscribeVariable(RayDialVariables* variables, int subscription) {
+    if (!variables || subscription < 0 || subscription >= variables->subscriptionCount) return;
+    variables->subscriptions[subscription].callback = NULL;
+    variables->subscriptions[subscription].userData = NULL;
+}
+
+// Condition compiler: recursive descent over the source, one function per
+// precedence level, emitting stack bytecode as it goes
+
+typedef struct {
+    RayDialVariables* variables;
+    const char* source;
+    const char* cursor;
+    unsigned char* code;
+    int length;
+    int capacity;
+    int depth;                              // Stack depth at this point of the code
+    int maxDepth;
+    int nesting;
+    int* dependencies;
+    int dependencyCount;
+    int dependencyCapacity;
+    char* error;
+    int errorSize;
+    bool failed;
+} RayDialConditionCompiler;
+
+static void ConditionError(RayDialConditionCompiler* compiler, const char* message) {
+    if (compiler->failed) return;
+    compiler->failed = true;
+    if (compiler->error && compiler->errorSize > 0) {
+        snprintf(compiler->error, compiler->errorSize, "%s at column %d", message,
+                 (int)(compiler->cursor - compiler->source) + 1);
+    }
+}
+
+static void EmitBytes(RayDialConditionCompiler* compiler, const void* bytes, int count) {
+    if (compiler->failed) return;
+    if (compiler->length + count > UINT16_MAX) {
+        ConditionError(compiler, "Expression too long");
+        return;
+    }
+    if (compiler->length + count > compiler->capacity) {
+        int capacity = compiler->capacity ? compiler->capacity * 2 : 64;
+        while (capacity < compiler->length + count) capacity *= 2;
+        unsigned char* code = (unsigned char*)realloc(compiler->code, capacity);
+        if (!code) {
+            ConditionError(compiler, "Out of memory");
+            return;
+        }
+        compiler->code = code;
+        compiler->capacity = capacity;
+    }
+    memcpy(compiler->code + compiler->length, bytes, count);
+    compiler->length += count;
+}
+
+// Emit an opcode and track its effect on the stack depth
+static void EmitOp(RayDialConditionCompiler* compiler, RayDialConditionOp op, int stackEffect) {
+    unsigned char byte = (unsigned char)op;
+    EmitBytes(compiler, &byte, 1);
+
+    compiler->depth += stackEffect;
+    if (compiler->depth > compiler->maxDepth) compiler->maxDepth = compiler->depth;
+    if (compiler->maxDepth > RAYDIAL_CONDITION_MAX_STACK) ConditionError(compiler, "Expression too complex");
+}
+
+static void SkipSpaces(RayDialConditionCompiler* compiler) {
+    while (isspace((unsigned char)*compiler->cursor)) compiler->cursor++;
+}
+
+// Consume an operator if it comes next (and is not the start of a longer one)
+static bool MatchOperator(RayDialConditionCompiler* compiler, const char* op) {
+    SkipSpaces(compiler);
+    size_t length = strlen(op);
+    if (strncmp(compiler->cursor, op, length) != 0) return false;
+    if (length == 1 && (op[0] == '<' || op[0] == '>' || op[0] == '!') && compiler->cursor[1] == '=') return false;
+
+    compiler->cursor += length;
+    return true;
+}
+
+static void CompileOr(RayDialConditionCompiler* compiler);
+
+static void AddConditionDependency(RayDialConditionCompiler* compiler, int id) {
+    for (int i = 0; i < compiler->dependencyCount; i++) {
+        if (compiler->dependencies[i] == id) return;
+    }
+    if (compiler->dependencyCount == compiler->dependencyCapacity) {
+        int capacity = compiler->dependencyCapacity ? compiler->dependencyCapacity * 2 : 4;
+        int* dependencies = (int*)realloc(compiler->dependencies, capacity * sizeof(int));
+        if (!dependencies) {
+            ConditionError(compiler, "Out of memory");
+            return;
+        }
+        compiler->dependencies = dependencies;
+        compiler->dependencyCapacity = capacity;
+    }
+    compiler->dependencies[compiler->dependencyCount++] = id;
+}
+
+static void CompilePrimary(RayDialConditionCompiler* compiler) {
+    SkipSpaces(compiler);
+    const char* start = compiler->cursor;
+
+    if (MatchOperator(compiler, "(")) {
+        CompileOr(compiler);
+        if (!MatchOperator(compiler, ")")) ConditionError(compiler, "Expected ')'");
+        return;
+    }
+
+    if (isdigit((unsigned char)*start)) {
+        long long value = 0;
+        while (isdigit((unsigned char)*compiler->cursor)) {
+            value = value * 10 + (*compiler->cursor++ - '0');
+            if (value > INT32_MAX) {
+                ConditionError(compiler, "Number too large");
+                return;
+            }
+        }
+        if (*compiler->cursor == '.' && isdigit((unsigned char)compiler->cursor[1])) {
+            float constant = strtof(start, (char**)&compiler->cursor);
+            EmitOp(compiler, RAYDIAL_COND_PUSH_FLOAT, 1);
+            EmitBytes(compiler, &constant, sizeof(constant));
+            return;
+        }
+        int32_t constant = (int32_t)value;
+        EmitOp(compiler, RAYDIAL_COND_PUSH, 1);
+        EmitBytes(compiler, &constant, sizeof(constant));
+        return;
+    }
+
+    if (*start == '"' || *start == '\'') {
+        const char* end = strchr(start + 1, *start);
+        if (!end) {
+            ConditionError(compiler, "Unterminated string");
+            return;
+        }
+        const char* constant = InternVariableString(compiler->variables, start + 1, (int)(end - start - 1));
+        if (!constant) {
+            ConditionError(compiler, "Out of memory");
+            return;
+        }
+        compiler->cursor = end + 1;
+        EmitOp(compiler, RAYDIAL_COND_PUSH_STRING, 1);
+        EmitBytes(compiler, &constant, sizeof(constant));
+        return;
+    }
+
+    if (isalpha((unsigned char)*start) || *start == '_') {
+        while (isalnum((unsigned char)*compiler->cursor) || *compiler->cursor == '_' || *compiler->cursor == '.') {
+            compiler->cursor++;
+        }
+        int length = (int)(compiler->cursor - start);
+
+        if ((length == 4 && strncmp(start, "true", 4) == 0) || (length == 5 && strncmp(start, "false", 5) == 0)) {
+            int32_t constant = length == 4;
+            EmitOp(compiler, RAYDIAL_COND_PUSH, 1);
+            EmitBytes(compiler, &constant, sizeof(constant));
+            return;
+        }
+
+        int id = InternVariable(compiler->variables, start, length);
+        if (id < 0) {
+            ConditionError(compiler, "Too many variables");
+            return;
+        }
+        uint16_t operand = (uint16_t)id;
+        EmitOp(compiler, RAYDIAL_COND_LOAD, 1);
+        EmitBytes(compiler, &operand, sizeof(operand));
+        AddConditionDependency(compiler, id);
+        return;
+    }
+
+    ConditionError(compiler, *start ? "Unexpected character" : "Unexpected end of expression");
+}
+
+static void CompileUnary(RayDialConditionCompiler* compiler) {
+    if (++compiler->nesting > RAYDIAL_CONDITION_MAX_NESTING) {
+        ConditionError(compiler, "Expression nested too deeply");
+        return;
+    }
+
+    if (MatchOperator(compiler, "!")) {
+        CompileUnary(compiler);
+        EmitOp(compiler, RAYDIAL_COND_NOT, 0);
+    } else if (MatchOperator(compiler, "-")) {
+        CompileUnary(compiler);
+        EmitOp(compiler, RAYDIAL_COND_NEG, 0);
+    } else {
+        CompilePrimary(compiler);
+    }
+    compiler->nesting--;
+}
+
+// Binary operators of one precedence level, longest spelling first
+typedef struct {
+    const char* text;
+    RayDialConditionOp op;
+} RayDialConditionOperator;
+
+static void CompileBinaryLevel(RayDialConditionCompiler* compiler, void (*operand)(RayDialConditionCompiler*),
+                               const RayDialConditionOperator* operators, int operatorCount) {
+    operand(compiler);
+    while (!compiler->failed) {
+        int matched = -1;
+        for (int i = 0; i < operatorCount && matched < 0; i++) {
+            if (MatchOperator(compiler, operators[i].text)) matched = i;
+        }
+        if (matched < 0) return;
+
+        operand(compiler);
+        EmitOp(compiler, operators[matched].op, -1);
+    }
+}
+
+static void CompileMultiplicative(RayDialConditionCompiler* compiler) {
+    static const RayDialConditionOperator operators[] = {
+        { "*", RAYDIAL_COND_MUL }, { "/", RAYDIAL_COND_DIV }, { "%", RAYDIAL_COND_MOD }
+    };
+    CompileBinaryLevel(compiler, CompileUnary, operators, 3);
+}
+
+static void CompileAdditive(RayDialConditionCompiler* compiler) {
+    static const RayDialConditionOperator operators[] = {
+        { "+", RAYDIAL_COND_ADD }, { "-", RAYDIAL_COND_SUB }
+    };
+    CompileBinaryLevel(compiler, CompileMultiplicative, operators, 2);
+}
+
+static void CompileRelational(RayDialConditionCompiler* compiler) {
+    static const RayDialConditionOperator operators[] = {
+        { "<=", RAYDIAL_COND_LE }, { ">=", RAYDIAL_COND_GE }, { "<", RAYDIAL_COND_LT }, { ">", RAYDIAL_COND_GT }
+    };
+    CompileBinaryLevel(compiler, CompileAdditive, operators, 4);
+}
+
+static void CompileEquality(RayDialConditionCompiler* compiler) {
+    static const RayDialConditionOperator operators[] = {
+        { "==", RAYDIAL_COND_EQ }, { "!=", RAYDIAL_COND_NE }
+    };
+    CompileBinaryLevel(compiler, CompileRelational, operators, 2);
+}
+
+// && and || jump over their right operand once the result is known
+static void CompileShortCircuit(RayDialConditionCompiler* compiler, void (*operand)(RayDialConditionCompiler*),
+                                const char* text, RayDialConditionOp op) {
+    operand(compiler);
+    while (!compiler->failed && MatchOperator(compiler, text)) {
+        EmitOp(compiler, op, -1);
+        int patch = compiler->length;
+        uint16_t target = 0;
+        EmitBytes(compiler, &target, sizeof(target));
+
+        operand(compiler);
+        EmitOp(compiler, RAYDIAL_COND_BOOL, 0);
+        if (compiler->failed) return;
+
+        target = (uint16_t)compiler->length;
+        memcpy(compiler->code + patch, &target, sizeof(target));
+    }
+}
+
+static void CompileAnd(RayDialConditionCompiler* compiler) {
+    CompileShortCircuit(compiler, CompileEquality, "&&", RAYDIAL_COND_AND);
+}
+
+static void CompileOr(RayDialConditionCompiler* compiler) {
+    CompileShortCircuit(compiler, CompileAnd, "||", RAYDIAL_COND_OR);
+}
+
+RayDialCondition* CompileCondition(RayDialVariables* variables, const char* source, char* error, int errorSize) {
+    if (error && errorSize > 0) error[0] = '\0';
+    if (!variables || !source) return NULL;
+
+    RayDialConditionCompiler compiler = { 0 };
+    compiler.variables = variables;
+    compiler.source = source;
+    compiler.cursor = source;
+    compiler.error = error;
+    compiler.errorSize = errorSize;
+
+    CompileOr(&compiler);
+    SkipSpaces(&compiler);
+    if (*compiler.cursor) ConditionError(&compiler, "Unexpected character");
+    EmitOp(&compiler, RAYDIAL_COND_END, 0);
+
+    RayDialCondition* condition = compiler.failed ? NULL : (RayDialCondition*)malloc(sizeof(RayDialCondition));
+    if (!condition) {
+        free(compiler.code);
+        free(compiler.dependencies);
+        return NULL;
+    }
+    condition->code = compiler.code;
+    condition->length = compiler.length;
+    condition->dependencies = compiler.dependencies;
+    condition->dependencyCount = compiler.dependencyCount;
+    return condition;
+}
+
+void FreeCondition(RayDialCondition* condition) {
+    if (!condition) return;
+    free(condition->code);
+    free(condition->dependencies);
+    free(condition);
+}
+
+static bool DependenciesChangedSince(const int* dependencies, int count, const RayDialVariables* variables, unsigned int version) {
+    for (int i = 0; i < count; i++) {
+        if (GetVariableVersion(variables, dependencies[i]) > version) return true;
+    }
+    return false;
+}
+
+bool ConditionChangedSince(const RayDialCondition* condition, const RayDialVariables* variables, unsigned int version) {
+    if (!condition) return false;
+    return DependenciesChangedSince(condition->dependencies, condition->dependencyCount, variables, version);
+}
+
+bool IsValueTrue(const RayDialValue* value) {
+    switch (value->type) {
+        case RAYDIAL_VAR_FLOAT: return value->value.f != 0.0f;
+        case RAYDIAL_VAR_STRING: return value->value.s[0] != '\0';
+        default: return value->value.i != 0;
+    }
+}
+
+static float GetValueFloat(const RayDialValue* value) {
+    return value->type == RAYDIAL_VAR_FLOAT ? value->value.f : (float)value->value.i;
+}
+
+static void SetValueInt(RayDialValue* value, int result) {
+    value->type = RAYDIAL_VAR_INT;
+    value->value.i = result;
+}
+
+// Arithmetic: ints (and bools) stay int, wrapping, with division by zero giving 0.
+// A float operand makes it float, and strings take no part (the result is 0).
+void ApplyValueArithmetic(char op, RayDialValue* a, const RayDialValue* b) {
+    if (a->type == RAYDIAL_VAR_STRING || b->type == RAYDIAL_VAR_STRING) {
+        SetValueInt(a, 0);
+        return;
+    }
+
+    if (a->type != RAYDIAL_VAR_FLOAT && b->type != RAYDIAL_VAR_FLOAT) {
+        unsigned int x = (unsigned int)a->value.i;
+        unsigned int y = (unsigned int)b->value.i;
+        int divisor = b->value.i;
+        bool safe = divisor != 0 && !(a->value.i == INT32_MIN && divisor == -1);
+        a->type = RAYDIAL_VAR_INT;
+        switch (op) {
+            case '+': a->value.i = (int)(x + y); break;
+            case '-': a->value.i = (int)(x - y); break;
+            case '*': a->value.i = (int)(x * y); break;
+            case '/': a->value.i = safe ? a->value.i / divisor : 0; break;
+            default: a->value.i = safe ? a->value.i % divisor : 0; break;
+        }
+        return;
+    }
+
+    float x = GetValueFloat(a);
+    float y = GetValueFloat(b);
+    a->type = RAYDIAL_VAR_FLOAT;
+    switch (op) {
+        case '+': a->value.f = x + y; break;
+        case '-': a->value.f = x - y; break;
+        case '*': a->value.f = x * y; break;
+        case '/': a->value.f = y != 0.0f ? x / y : 0.0f; break;
+        default: a->value.f = y != 0.0f ? fmodf(x, y) : 0.0f; break;
+    }
+}
+
+// Numbers compare by value, strings by pointer for equality (they are interned)
+// and by strcmp for ordering. A string and a number do not compare.
+bool CompareValues(const RayDialValue* a, const RayDialValue* b, int* order) {
+    if (a->type == RAYDIAL_VAR_STRING && b->type == RAYDIAL_VAR_STRING) {
+        *order = a->value.s == b->value.s ? 0 : strcmp(a->value.s, b->value.s);
+    } else if (a->type == RAYDIAL_VAR_STRING || b->type == RAYDIAL_VAR_STRING) {
+        *order = 1;
+        return false;
+    } else if (a->type != RAYDIAL_VAR_FLOAT && b->type != RAYDIAL_VAR_FLOAT) {
+        *order = (a->value.i > b->value.i) - (a->value.i < b->value.i);
+    } else {
+        float x = GetValueFloat(a);
+        float y = GetValueFloat(b);
+        *order = (x > y) - (x < y);
+    }
+    return true;
+}
+
+static void ApplyComparison(RayDialConditionOp op, RayDialValue* a, const RayDialValue* b) {
+    int order;
+    bool comparable = CompareValues(a, b, &order);
+    switch (op) {
+        case RAYDIAL_COND_LT: SetValueInt(a, comparable && order < 0); break;
+        case RAYDIAL_COND_LE: SetValueInt(a, comparable && order <= 0); break;
+        case RAYDIAL_COND_GT: SetValueInt(a, comparable && order > 0); break;
+        case RAYDIAL_COND_GE: SetValueInt(a, comparable && order >= 0); break;
+        case RAYDIAL_COND_EQ: SetValueInt(a, comparable && order == 0); break;
+        default: SetValueInt(a, !comparable || order != 0); break;
+    }
+}
+
+bool EvaluateCondition(const RayDialCondition* condition, const RayDialVariables* variables) {
+    if (!condition) return true;
+
+    // The compiler bounded the depth, so the stack needs no checks
+    RayDialValue stack[RAYDIAL_CONDITION_MAX_STACK];
+    int top = -1;
+    const unsigned char* code = condition->code;
+    int pc = 0;
+
+    for (;;) {
+        RayDialConditionOp op = (RayDialConditionOp)code[pc++];
+        switch (op) {
+            case RAYDIAL_COND_PUSH: {
+                int32_t constant;
+                memcpy(&constant, code + pc, sizeof(constant));
+                pc += sizeof(constant);
+                SetValueInt(&stack[++top], constant);
+                break;
+            }
+            case RAYDIAL_COND_PUSH_FLOAT: {
+                top++;
+                stack[top].type = RAYDIAL_VAR_FLOAT;
+                memcpy(&stack[top].value.f, code + pc, sizeof(float));
+                pc += sizeof(float);
+                break;
+            }
+            case RAYDIAL_COND_PUSH_STRING: {
+                top++;
+                stack[top].type = RAYDIAL_VAR_STRING;
+                memcpy(&stack[top].value.s, code + pc, sizeof(const char*));
+                pc += sizeof(const char*);
+                break;
+            }
+            case RAYDIAL_COND_LOAD: {
+                uint16_t id;
+                memcpy(&id, code + pc, sizeof(id));
+                pc += sizeof(id);
+                stack[++top] = GetVariableValue(variables, id);
+                break;
+            }
+            case RAYDIAL_COND_NOT: SetValueInt(&stack[top], !IsValueTrue(&stack[top])); break;
+            case RAYDIAL_COND_BOOL: SetValueInt(&stack[top], IsValueTrue(&stack[top])); break;
+            case RAYDIAL_COND_NEG: {
+                RayDialValue operand = stack[top];
+                SetValueInt(&stack[top], 0);
+                ApplyValueArithmetic('-', &stack[top], &operand);
+                break;
+            }
+            case RAYDIAL_COND_ADD:
+            case RAYDIAL_COND_SUB:
+            case RAYDIAL_COND_MUL:
+            case RAYDIAL_COND_DIV:
+            case RAYDIAL_COND_MOD:
+                top--;
+                ApplyValueArithmetic("+-*/%"[op - RAYDIAL_COND_ADD], &stack[top], &stack[top + 1]);
+                break;
+            case RAYDIAL_COND_LT:
+            case RAYDIAL_COND_LE:
+            case RAYDIAL_COND_GT:
+            case RAYDIAL_COND_GE:
+            case RAYDIAL_COND_EQ:
+            case RAYDIAL_COND_NE:
+                top--;
+                ApplyComparison(op, &stack[top], &stack[top + 1]);
+                break;
+            case RAYDIAL_COND_AND:
+            case RAYDIAL_COND_OR: {
+                uint16_t target;
+                memcpy(&target, code + pc, sizeof(target));
+                pc += sizeof(target);
+                bool isAnd = op == RAYDIAL_COND_AND;
+                if (IsValueTrue(&stack[top]) != isAnd) {
+                    SetValueInt(&stack[top], !isAnd);
+                    pc = target;
+                } else {
+                    top--;
+                }
+                break;
+            }
+            case RAYDIAL_COND_END:
+            default:
+                return top >= 0 && IsValueTrue(&stack[top]);
+        }
+    }
+}
+
+// Text templates. The format is split once into literal runs and variable
+// references; formatting walks that list.
+
+typedef struct {
+    int start;                              // Literal: byte range in the format
+    int length;
+    int variable;                           // -1 for a literal
+} RayDialTextPart;
+
+struct RayDialVariableText {
+    char* format;
+    RayDialTextPart* parts;
+    int partCount;
+    int* dependencies;
+    int dependencyCount;
+};
+
+RayDialVariableText* CompileVariableText(RayDialVariables* variables, const char* format) {
+    if (!variables || !format) return NULL;
+
+    RayDialVariableText* text = (RayDialVariableText*)calloc(1, sizeof(RayDialVariableText));
+    if (!text) return NULL;
+
+    // A placeholder takes at least three bytes, so these bound the part counts
+    int length = (int)strlen(format);
+    text->format = (char*)malloc(length + 1);
+    text->parts = (RayDialTextPart*)malloc((length + 1) * sizeof(RayDialTextPart));
+    text->dependencies = (int*)malloc((length / 3 + 1) * sizeof(int));
+    if (!text->format || !text->parts || !text->dependencies) {
+        FreeVariableText(text);
+        return NULL;
+    }
+    memcpy(text->format, format, length + 1);
+
+    int literalStart = 0;
+    int position = 0;
+    while (position < length) {
+        if (format[position] != '{') {
+            position++;
+            continue;
+        }
+
+        int nameStart = position + 1;
+        int nameEnd = nameStart;
+        while (isalnum((unsigned char)format[nameEnd]) || format[nameEnd] == '_' || format[nameEnd] == '.') nameEnd++;
+        if (nameEnd == nameStart || format[nameEnd] != '}') {
+            position++;
+            continue;
+        }
+
+        int id = InternVariable(variables, format + nameStart, nameEnd - nameStart);
+        if (id < 0) {
+            FreeVariableText(text);
+            return NULL;
+        }
+        if (position > literalStart) {
+            text->parts[text->partCount++] = (RayDialTextPart){ literalStart, position - literalStart, -1 };
+        }
+        text->parts[text->partCount++] = (RayDialTextPart){ 0, 0, id };
+
+        bool known = false;
+        for (int i = 0; i < text->dependencyCount && !known; i++) known = text->dependencies[i] == id;
+        if (!known) text->dependencies[text->dependencyCount++] = id;
+
+        position = nameEnd + 1;
+        literalStart = position;
+    }
+    if (length > literalStart) {
+        text->parts[text->partCount++] = (RayDialTextPart){ literalStart, length - literalStart, -1 };
+    }
+    return text;
+}
+
+void FreeVariableText(RayDialVariableText* text) {
+    if (!text) return;
+    free(text->format);
+    free(text->parts);
+    free(text->dependencies);
+    free(text);
+}
+
+// Append to the output, still counting what no longer fits
+static void AppendText(char* buffer, int bufferSize, int* length, const char* text, int textLength) {
+    if (*length < bufferSize - 1) {
+        int room = bufferSize - 1 - *length;
+        memcpy(buffer + *length, text, textLength < room ? textLength : room);
+    }
+    *length += textLength;
+}
+
+int FormatVariableText(const RayDialVariableText* text, const RayDialVariables* variables, char* buffer, int bufferSize) {
+    if (!buffer) bufferSize = 0;
+    if (bufferSize > 0) buffer[0] = '\0';
+    if (!text) return 0;
+
+    int length = 0;
+    char number[32];
+    for (int i = 0; i < text->partCount; i++) {
+        const RayDialTextPart* part = &text->parts[i];
+        if (part->variable < 0) {
+            AppendText(buffer, bufferSize, &length, text->format + part->start, part->length);
+            continue;
+        }
+
+        const char* value = number;
+        switch (GetVariableType(variables, part->variable)) {
+            case RAYDIAL_VAR_FLOAT: snprintf(number, sizeof(number), "%g", GetVariableFloat(variables, part->variable)); break;
+            case RAYDIAL_VAR_BOOL: value = GetVariableBool(variables, part->variable) ? "true" : "false"; break;
+            case RAYDIAL_VAR_STRING: value = GetVariableString(variables, part->variable); break;
+            default: snprintf(number, sizeof(number), "%d", GetVariableInt(variables, part->variable)); break;
+        }
+        AppendText(buffer, bufferSize, &length, value, (int)strlen(value));
+    }
+
+    if (bufferSize > 0) buffer[length < bufferSize ? length : bufferSize - 1] = '\0';
+    return length;
+}
+
+bool VariableTextChangedSince(const RayDialVariableText* text, const RayDialVariables* variables, unsigned int version) {
+    if (!text) return false;
+    return DependenciesChangedSince(text->dependencies, text->dependencyCount, variables, version);
+}
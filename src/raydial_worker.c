@@ -0,0 +1,155 @@
+#include "raydial_worker.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+#define RAYDIAL_WORKER_MAX_THREADS 32
+
+typedef struct RayDialJob {
+    RayDialJobFunc func;
+    void* arg;
+    struct RayDialJob* next;
+} RayDialJob;
+
+struct RayDialWorkerPool {
+    pthread_t threads[RAYDIAL_WORKER_MAX_THREADS];
+    int threadCount;
+    pthread_mutex_t lock;
+    pthread_cond_t hasWork;     // Signalled when a job is queued or on shutdown
+    pthread_cond_t idle;        // Signalled when the last running job finishes
+    RayDialJob* head;
+    RayDialJob* tail;
+    RayDialJob* freeJobs;       // Recycled job nodes so steady-state submits don't allocate
+    int pending;                // Jobs queued or running
+    bool shuttingDown;
+};
+
+static void* WorkerThreadMain(void* arg) {
+    RayDialWorkerPool* pool = (RayDialWorkerPool*)arg;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->head && !pool->shuttingDown) {
+            pthread_cond_wait(&pool->hasWork, &pool->lock);
+        }
+        if (!pool->head) break; // Shutting down with an empty queue
+
+        RayDialJob* job = pool->head;
+        pool->head = job->next;
+        if (!pool->head) pool->tail = NULL;
+
+        RayDialJobFunc func = job->func;
+        void* jobArg = job->arg;
+        job->next = pool->freeJobs;
+        pool->freeJobs = job;
+
+        pthread_mutex_unlock(&pool->lock);
+        func(jobArg);
+        pthread_mutex_lock(&pool->lock);
+
+        pool->pending--;
+        if (pool->pending == 0) {
+            pthread_cond_broadcast(&pool->idle);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+RayDialWorkerPool* CreateWorkerPool(int threadCount) {
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > RAYDIAL_WORKER_MAX_THREADS) threadCount = RAYDIAL_WORKER_MAX_THREADS;
+
+    RayDialWorkerPool* pool = (RayDialWorkerPool*)calloc(1, sizeof(RayDialWorkerPool));
+    if (!pool) return NULL;
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->hasWork, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+
+    for (int i = 0; i < threadCount; i++) {
+        if (pthread_create(&pool->threads[i], NULL, WorkerThreadMain, pool) != 0) break;
+        pool->threadCount++;
+    }
+
+    if (pool->threadCount == 0) {
+        pthread_cond_destroy(&pool->idle);
+        pthread_cond_destroy(&pool->hasWork);
+        pthread_mutex_destroy(&pool->lock);
+        free(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+bool SubmitWorkerJob(RayDialWorkerPool* pool, RayDialJobFunc func, void* arg) {
+    if (!pool || !func) return false;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->shuttingDown) {
+        pthread_mutex_unlock(&pool->lock);
+        return false;
+    }
+
+    RayDialJob* job = pool->freeJobs;
+    if (job) {
+        pool->freeJobs = job->next;
+    } else {
+        job = (RayDialJob*)malloc(sizeof(RayDialJob));
+        if (!job) {
+            pthread_mutex_unlock(&pool->lock);
+            return false;
+        }
+    }
+
+    job->func = func;
+    job->arg = arg;
+    job->next = NULL;
+    if (pool->tail) {
+        pool->tail->next = job;
+    } else {
+        pool->head = job;
+    }
+    pool->tail = job;
+    pool->pending++;
+
+    pthread_cond_signal(&pool->hasWork);
+    pthread_mutex_unlock(&pool->lock);
+    return true;
+}
+
+void WaitWorkerPool(RayDialWorkerPool* pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->idle, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void FreeWorkerPool(RayDialWorkerPool* pool) {
+    if (!pool) return;
+
+    // Let queued jobs finish so their owners can safely free job arguments afterwards
+    pthread_mutex_lock(&pool->lock);
+    pool->shuttingDown = true;
+    pthread_cond_broadcast(&pool->hasWork);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->threadCount; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    RayDialJob* job = pool->freeJobs;
+    while (job) {
+        RayDialJob* next = job->next;
+        free(job);
+        job = next;
+    }
+
+    pthread_cond_destroy(&pool->idle);
+    pthread_cond_destroy(&pool->hasWork);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
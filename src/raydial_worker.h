@@ -0,0 +1,25 @@
+#ifndef RAYDIAL_WORKER_H
+#define RAYDIAL_WORKER_H
+
+#include <stdbool.h>
+
+// Internal background job queue shared by RayDial subsystems.
+// Jobs must never call into raylib functions that touch the GPU or window.
+
+typedef void (*RayDialJobFunc)(void* arg);
+
+typedef struct RayDialWorkerPool RayDialWorkerPool;
+
+// Start a pool with the given number of threads (at least one)
+RayDialWorkerPool* CreateWorkerPool(int threadCount);
+
+// Queue a job; returns false if the pool is shutting down or out of memory
+bool SubmitWorkerJob(RayDialWorkerPool* pool, RayDialJobFunc func, void* arg);
+
+// Block until every queued job has finished running
+void WaitWorkerPool(RayDialWorkerPool* pool);
+
+// Drain the queue, join all threads and free the pool
+void FreeWorkerPool(RayDialWorkerPool* pool);
+
+#endif // RAYDIAL_WORKER_H
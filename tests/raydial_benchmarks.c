@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "raylib.h"
+#include "raydial.h"
+#include "raydial_vars.h"
+#include "raydial_script.h"
+#include "raydial_context.h"
+
+// Standalone performance checks. Not part of the test suite: run the
+// raydial_benchmarks target manually and compare numbers between builds.
+
+#define SCROLL_BENCH_ROWS 100000
+#define SCROLL_BENCH_FRAMES 600
+#define SCRIPT_BENCH_LOOP 1000
+#define SCRIPT_BENCH_RUNS 20000
+#define CONTEXT_BENCH_MANAGERS 128
+#define CONTEXT_BENCH_ROWS 64
+#define CONTEXT_BENCH_FRAMES 300
+#define CONTEXT_BENCH_THREADS 4
+
+// 100k rows in a virtualized scroll area versus drawing every label directly
+static void BenchScrollArea(void) {
+    RayDialComponent* area = CreateScrollArea((Rectangle){ 20, 20, 400, 400 }, 0);
+    RayDialComponent** labels = (RayDialComponent**)malloc(SCROLL_BENCH_ROWS * sizeof(RayDialComponent*));
+    
+    for (int i = 0; i < SCROLL_BENCH_ROWS; i++) {
+        labels[i] = CreateLabel((Rectangle){ 20, 20 + i * 24.0f, 380, 24 }, "Benchmark row", false);
+        AddScrollAreaRow(area, labels[i]);
+    }
+    
+    double start = GetTime();
+    for (int frame = 0; frame < SCROLL_BENCH_FRAMES; frame++) {
+        ScrollToScrollAreaRow(area, (frame * 997) % SCROLL_BENCH_ROWS, false);
+        BeginDrawing();
+            ClearBackground(RAYWHITE);
+            UpdateComponent(area);
+            DrawComponent(area);
+        EndDrawing();
+    }
+    double virtualized = (GetTime() - start) * 1000.0 / SCROLL_BENCH_FRAMES;
+    
+    // Baseline: every row visited each frame, as with a panel full of labels
+    int baselineFrames = SCROLL_BENCH_FRAMES / 20;
+    start = GetTime();
+    for (int frame = 0; frame < baselineFrames; frame++) {
+        BeginDrawing();
+            ClearBackground(RAYWHITE);
+            BeginScissorMode(20, 20, 400, 400);
+            for (int i = 0; i < SCROLL_BENCH_ROWS; i++) {
+                UpdateComponent(labels[i]);
+                DrawComponent(labels[i]);
+            }
+            EndScissorMode();
+        EndDrawing();
+    }
+    double baseline = (GetTime() - start) * 1000.0 / baselineFrames;
+    
+    printf("scroll area, %d rows: %.3f ms/frame virtualized, %.3f ms/frame drawing every row\n",
+           SCROLL_BENCH_ROWS, virtualized, baseline);
+    
+    free(labels);
+    FreeComponent(area);
+}
+
+// Interpreter throughput on a tight loop: three instructions per iteration
+static void BenchScriptVM(void) {
+    RayDialVariables* variables = CreateVariableStore();
+    RayDialScriptHost* host = CreateScriptHost(variables);
+    char source[256];
+    snprintf(source, sizeof(source),
+             "load r0, 0\nloop:\nadd r0, r0, 1\nlt r1, r0, %d\njumpif r1, loop\nstore counter, r0\n",
+             SCRIPT_BENCH_LOOP);
+    RayDialScript* script = CompileScript(host, source, NULL, 0);
+    
+    double start = GetTime();
+    for (int run = 0; run < SCRIPT_BENCH_RUNS; run++) {
+        RunScript(script);
+    }
+    double seconds = GetTime() - start;
+    
+    // load, the loop body, store and the implicit end
+    double ops = (double)SCRIPT_BENCH_RUNS * (SCRIPT_BENCH_LOOP * 3 + 3);
+    printf("script vm, %d runs of a %d-iteration loop: %.1f M ops/sec\n",
+           SCRIPT_BENCH_RUNS, SCRIPT_BENCH_LOOP, ops / seconds / 1e6);
+    
+    FreeScript(script);
+    FreeScriptHost(host);
+    FreeVariableStore(variables);
+}
+
+// Background conversations, each a scroll area of typing labels, updated on the main
+// thread and then on worker threads
+static double RunContextBench(int threadCount) {
+    RayDialContext* context = CreateDialogueContext(NULL, NULL);
+    SetDialogueContextWorkers(context, threadCount);
+    RayDialNode* nodes[CONTEXT_BENCH_MANAGERS];
+    
+    for (int i = 0; i < CONTEXT_BENCH_MANAGERS; i++) {
+        nodes[i] = CreateDialogueNode("banter", "Banter");
+        RayDialComponent* area = CreateScrollArea((Rectangle){ 0, 0, 400, CONTEXT_BENCH_ROWS * 24.0f }, 0);
+        for (int row = 0; row < CONTEXT_BENCH_ROWS; row++) {
+            RayDialComponent* label = CreateLabel((Rectangle){ 0, row * 24.0f, 380, 24 },
+                                                  "Did you hear what happened at the old mill last night?", false);
+            StartTypewriter(label, 20.0f);
+            AddScrollAreaRow(area, label);
+        }
+        nodes[i]->components = area;
+        AddDialogueManager(context, CreateDialogueManager(nodes[i]), 0, 0.0);
+    }
+    
+    double start = GetTime();
+    for (int frame = 0; frame < CONTEXT_BENCH_FRAMES; frame++) {
+        UpdateDialogueContext(context);
+    }
+    double perFrame = (GetTime() - start) * 1000.0 / CONTEXT_BENCH_FRAMES;
+    
+    FreeDialogueContext(context);
+    for (int i = 0; i < CONTEXT_BENCH_MANAGERS; i++) {
+        FreeComponent(nodes[i]->components);
+        FreeDialogueNode(nodes[i]);
+    }
+    return perFrame;
+}
+
+static void BenchParallelContext(void) {
+    double serial = RunContextBench(0);
+    double parallel = RunContextBench(CONTEXT_BENCH_THREADS);
+    printf("context, %d managers: %.3f ms/frame on the main thread, %.3f ms/frame on %d workers\n",
+           CONTEXT_BENCH_MANAGERS, serial, parallel, CONTEXT_BENCH_THREADS);
+}
+
+int main(void) {
+    InitWindow(640, 480, "RayDial Benchmarks");
+    
+    // No frame limiting, so the numbers reflect CPU cost
+    SetTargetFPS(0);
+    
+    BenchScrollArea();
+    BenchScriptVM();
+    BenchParallelContext();
+    
+    CloseWindow();
+    return 0;
+}
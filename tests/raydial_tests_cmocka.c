@@ -1,12 +1,22 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <setjmp.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <cmocka.h>
 
 #include "raylib.h"
 #include "raydial.h"
+#include "raydial_i18n.h"
+#include "raydial_textures.h"
+#include "raydial_vars.h"
+#include "raydial_script.h"
+#include "raydial_graph.h"
+#include "raydial_snapshot.h"
+#include "raydial_history.h"
+#include "raydial_context.h"
+#include "raydial_replay.h"
 
 // Test fixture data
 typedef struct {
@@ -24,6 +34,18 @@ static void test_callback(void* userData) {
     state->userData++;
 }
 
+// Records the characters a typewriter reveals
+typedef struct {
+    int codepoints[64];
+    int count;
+} RevealLog;
+
+static void record_reveal(int codepoint, void* userData) {
+    RevealLog* log = (RevealLog*)userData;
+    if (log->count < 64) log->codepoints[log->count] = codepoint;
+    log->count++;
+}
+
 // Test fixtures: setup and teardown
 
 static int setup(void **state) {
@@ -105,6 +127,526 @@ static void test_panel_creation(void **state) {
     FreeComponent(panel);
 }
 
+// Textbox editing tests
+static void test_textbox_editing(void **state) {
+    RayDialComponent* textbox = CreateTextbox((Rectangle){50, 50, 200, 40}, 8);
+    assert_non_null(textbox);
+    assert_int_equal(textbox->type, RAYDIAL_TEXTBOX);
+    assert_string_equal(GetTextboxText(textbox), "");
+    
+    // Typing at the caret, then editing in the middle
+    InsertTextboxText(textbox, "Hero");
+    SetTextboxCursor(textbox, 2, false);
+    InsertTextboxText(textbox, "\xC3\xA9");    // UTF-8 e-acute counts as one character
+    assert_int_equal(GetTextboxCursor(textbox), 3);
+    assert_string_equal(GetTextboxText(textbox), "He\xC3\xA9ro");
+    
+    DeleteTextboxText(textbox, false);
+    assert_string_equal(GetTextboxText(textbox), "Hero");
+    DeleteTextboxText(textbox, true);
+    assert_string_equal(GetTextboxText(textbox), "Heo");
+    
+    // Selection is replaced by the next insert
+    SetTextboxCursor(textbox, 0, false);
+    SetTextboxCursor(textbox, 3, true);
+    InsertTextboxText(textbox, "Ada");
+    assert_string_equal(GetTextboxText(textbox), "Ada");
+    
+    // maxLength is measured in characters and never splits a codepoint
+    InsertTextboxText(textbox, "123456789");
+    assert_string_equal(GetTextboxText(textbox), "Ada12345");
+    
+    // Caret hit-testing maps screen x back to character boundaries
+    RayDialTextboxData* data = (RayDialTextboxData*)textbox->data;
+    data->scrollOffset = 0.0f;
+    assert_int_equal(GetTextboxIndexAt(textbox, textbox->bounds.x), 0);
+    assert_int_equal(GetTextboxIndexAt(textbox, textbox->bounds.x + 1000), 8);
+    
+    // Password masking draws without changing the stored text
+    data->isPassword = true;
+    DrawComponent(textbox);
+    assert_string_equal(GetTextboxText(textbox), "Ada12345");
+    
+    SetTextboxText(textbox, "Zed");
+    assert_int_equal(GetTextboxCursor(textbox), 3);
+    assert_string_equal(GetTextboxText(textbox), "Zed");
+    
+    FreeComponent(textbox);
+    
+    // data->text stays current across middle edits and buffer growth
+    textbox = CreateTextbox((Rectangle){50, 50, 200, 40}, 0);
+    data = (RayDialTextboxData*)textbox->data;
+    assert_string_equal(data->text, "");
+    InsertTextboxText(textbox, "Hero");
+    SetTextboxCursor(textbox, 1, false);
+    InsertTextboxText(textbox, "-");
+    assert_string_equal(data->text, "H-ero");
+    DeleteTextboxText(textbox, true);
+    assert_string_equal(data->text, "H-ro");
+    
+    char expected[1024] = "H-";
+    for (int i = 0; i < 200; i++) {
+        InsertTextboxText(textbox, "abcd");
+        strcat(expected, "abcd");
+    }
+    strcat(expected, "ro");
+    assert_string_equal(data->text, expected);
+    assert_ptr_equal(GetTextboxText(textbox), data->text);
+    
+    FreeComponent(textbox);
+}
+
+// Virtualized scroll area tests
+static void test_scroll_area_virtualization(void **state) {
+    RayDialComponent* area = CreateScrollArea((Rectangle){0, 0, 300, 200}, 0);
+    assert_non_null(area);
+    
+    const int rowCount = 100000;
+    for (int i = 0; i < rowCount; i++) {
+        AddScrollAreaRow(area, CreateLabel((Rectangle){0, 0, 280, 20}, "Row", false));
+    }
+    
+    // Only the rows inside the 200px viewport are visited
+    DrawComponent(area);
+    int first = -1;
+    int visible = GetScrollAreaVisibleRows(area, &first);
+    RayDialScrollAreaData* data = (RayDialScrollAreaData*)area->data;
+    assert_int_equal(first, 0);
+    assert_int_equal(visible, 10);
+    assert_true(data->contentHeight == rowCount * 20.0f);
+    
+    ScrollToScrollAreaRow(area, 50000, false);
+    DrawComponent(area);
+    visible = GetScrollAreaVisibleRows(area, &first);
+    assert_int_equal(first, 50000);
+    assert_int_equal(visible, 10);
+    assert_true(data->rows[50000]->bounds.y == area->bounds.y);
+    
+    // Growing a row re-lays out everything below it
+    SetScrollAreaRowHeight(area, 0, 120.0f);
+    ScrollToScrollAreaRow(area, 1, false);
+    DrawComponent(area);
+    GetScrollAreaVisibleRows(area, &first);
+    assert_int_equal(first, 1);
+    assert_true(data->contentHeight == rowCount * 20.0f + 100.0f);
+    
+    // Smooth scrolling eases towards the target and clamps at the end
+    ScrollToScrollAreaRow(area, rowCount - 1, true);
+    UpdateComponent(area);
+    assert_true(data->scrollPosition < data->scrollTarget);
+    assert_true(data->scrollTarget == data->contentHeight - area->bounds.height);
+    
+    FreeComponent(area);
+}
+
+static void test_label_line_index(void **state) {
+    const int paragraphs = 50000;
+    const char* paragraph = "abcd abcd\n";
+    size_t paragraphLength = strlen(paragraph);
+    char* text = (char*)malloc(paragraphs * paragraphLength + 1);
+    assert_non_null(text);
+    for (int i = 0; i < paragraphs; i++) {
+        memcpy(text + i * paragraphLength, paragraph, paragraphLength);
+    }
+    text[paragraphs * paragraphLength] = '\0';
+    
+    // Wide enough that only the newlines break lines
+    RayDialComponent* label = CreateLabel((Rectangle){0, 0, 10000, 300}, text, true);
+    RayDialLabelData* data = (RayDialLabelData*)label->data;
+    float lineHeight = data->fontSize * 1.5f;
+    assert_true(GetLabelContentHeight(label) == paragraphs * lineHeight);
+    
+    // The visible band maps straight to a range of lines
+    int first = -1;
+    assert_int_equal(GetLabelVisibleLines(label, &first), 10);
+    assert_int_equal(first, 0);
+    
+    data->scrollPosition = 30000 * lineHeight;
+    DrawComponent(label);
+    assert_int_equal(GetLabelVisibleLines(label, &first), 10);
+    assert_int_equal(first, 30000);
+    
+    data->scrollPosition = (paragraphs - 2) * lineHeight;
+    assert_int_equal(GetLabelVisibleLines(label, &first), 2);
+    assert_int_equal(first, paragraphs - 2);
+    
+    // Narrower than any word: every word gets its own line, blank lines are kept
+    SetLabelText(label, "one two three\n\nfour");
+    label->bounds.width = 20;
+    data->scrollPosition = 0;
+    assert_true(GetLabelContentHeight(label) == 5 * lineHeight);
+    
+    // A buffer rewritten in place is laid out again once marked changed
+    char buffer[32] = "Current value: 1";
+    SetLabelText(label, buffer);
+    label->bounds.width = 10000;
+    assert_true(GetLabelContentHeight(label) == lineHeight);
+    snprintf(buffer, sizeof(buffer), "Current\nvalue: 10");
+    MarkLabelTextChanged(label);
+    assert_true(GetLabelContentHeight(label) == 2 * lineHeight);
+    buffer[7] = ' ';
+    MarkLabelTextChanged(label);
+    assert_true(GetLabelContentHeight(label) == lineHeight);
+    assert_int_equal(GetLabelVisibleLines(label, &first), 1);
+    DrawComponent(label);
+    
+    // No text at all draws nothing
+    SetLabelText(label, NULL);
+    DrawComponent(label);
+    FreeComponent(label);
+    label = CreateLabel((Rectangle){0, 0, 200, 40}, NULL, true);
+    DrawComponent(label);
+    assert_int_equal(GetLabelVisibleLines(label, &first), 0);
+    RayDialComponent* portrait = CreatePortraitDialogue((Rectangle){0, 0, 300, 80}, "Guide", NULL, GRAY);
+    SetPortraitDialogueStyledText(portrait, "[color=red]Styled[/color] only");
+    DrawComponent(portrait);
+    FreeComponent(portrait);
+    
+    FreeComponent(label);
+    free(text);
+}
+
+static void test_typewriter_reveal(void **state) {
+    // 75 characters per second at 60 FPS reveals 1.25 characters per frame
+    RayDialComponent* label = CreateLabel((Rectangle){0, 0, 400, 100}, "h\xc3\xa9llo w\xc3\xb6rld", true);
+    RayDialLabelData* data = (RayDialLabelData*)label->data;
+    RevealLog log = {0};
+    StartTypewriter(label, 75.0f);
+    SetTypewriterCallback(label, record_reveal, &log);
+    assert_false(IsTypewriterFinished(label));
+    
+    UpdateComponent(label);
+    UpdateComponent(label);
+    assert_int_equal(data->typewriter.revealedGlyphs, 2);
+    assert_int_equal(log.count, 2);
+    assert_int_equal(log.codepoints[0], 'h');
+    assert_int_equal(log.codepoints[1], 0xE9);
+    
+    for (int i = 0; i < 4; i++) UpdateComponent(label);
+    assert_int_equal(data->typewriter.revealedGlyphs, 7);
+    assert_int_equal(log.codepoints[6], 'w');
+    assert_int_equal(data->typewriter.totalGlyphs, 11);
+    DrawComponent(label);
+    
+    // Skipping shows the rest without firing the callback
+    SkipTypewriter(label);
+    assert_true(IsTypewriterFinished(label));
+    assert_int_equal(data->typewriter.revealedGlyphs, 11);
+    assert_int_equal(log.count, 7);
+    
+    // New text types from the start again
+    SetLabelText(label, "next");
+    assert_false(IsTypewriterFinished(label));
+    for (int i = 0; i < 4; i++) UpdateComponent(label);
+    assert_true(IsTypewriterFinished(label));
+    assert_int_equal(log.count, 11);
+    assert_int_equal(log.codepoints[10], 't');
+    
+    // A buffer shortened in place under a running reveal stops at its new end
+    char buffer[16] = "abcdefghij";
+    SetLabelText(label, buffer);
+    for (int i = 0; i < 4; i++) UpdateComponent(label);
+    assert_int_equal(data->typewriter.revealedGlyphs, 5);
+    strcpy(buffer, "xyz");
+    MarkLabelTextChanged(label);
+    UpdateComponent(label);
+    assert_true(IsTypewriterFinished(label));
+    assert_int_equal(data->typewriter.totalGlyphs, 3);
+    
+    // A translation reload keeps the reveal going over the new text from where it was
+    RayDialI18N* i18n = CreateI18NManager();
+    AddLanguage(i18n, "en", "English");
+    SetCurrentLanguage(i18n, "en");
+    AddTranslation(i18n, "en", "greeting", "Good morning");
+    SetLocalizedLabelText(label, "greeting", i18n);
+    for (int i = 0; i < 4; i++) UpdateComponent(label);
+    assert_int_equal(data->typewriter.revealedGlyphs, 5);
+    int reveals = log.count;
+    AddTranslation(i18n, "en", "greeting", "Hi");
+    UpdateComponent(label);
+    assert_string_equal(data->text, "Hi");
+    assert_int_equal(data->typewriter.totalGlyphs, 2);
+    assert_int_equal(data->typewriter.revealedGlyphs, 2);
+    assert_ptr_equal(data->typewriter.onReveal, record_reveal);
+    AddTranslation(i18n, "en", "greeting", "Good evening, all");
+    UpdateComponent(label);
+    assert_int_equal(data->typewriter.totalGlyphs, 17);
+    assert_false(IsTypewriterFinished(label));
+    assert_int_equal(log.count, reveals + 1);
+    assert_int_equal(log.codepoints[log.count - 1], 'o');
+    FreeComponent(label);
+    FreeI18NManager(i18n);
+    
+    // Portrait dialogues reveal their plain text the same way
+    RayDialComponent* portrait = CreatePortraitDialogue((Rectangle){0, 0, 600, 200}, "Sage", "Welcome, traveller.", BLUE);
+    RayDialPortraitDialogueData* portraitData = (RayDialPortraitDialogueData*)portrait->data;
+    StartTypewriter(portrait, 75.0f);
+    UpdateComponent(portrait);
+    UpdateComponent(portrait);
+    assert_int_equal(portraitData->typewriter.revealedGlyphs, 2);
+    DrawComponent(portrait);
+    
+    SetPortraitDialogueText(portrait, "Farewell.");
+    assert_int_equal(portraitData->typewriter.revealedGlyphs, 0);
+    SkipTypewriter(portrait);
+    assert_int_equal(portraitData->typewriter.revealedGlyphs, 9);
+    FreeComponent(portrait);
+}
+
+static void test_styled_typewriter_reveal(void **state) {
+    RayDialComponent* portrait = CreatePortraitDialogue((Rectangle){0, 0, 600, 200}, "Sage", NULL, BLUE);
+    RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)portrait->data;
+    SetPortraitDialogueStyledText(portrait, "Hello [color=red]brave[/color]\nworld");
+    
+    // The reveal counts the characters that are drawn, never the tags
+    assert_string_equal(data->dialogueText, "Hello brave\nworld");
+    
+    RevealLog log = {0};
+    StartTypewriter(portrait, 75.0f);
+    SetTypewriterCallback(portrait, record_reveal, &log);
+    for (int i = 0; i < 7; i++) {
+        UpdateComponent(portrait);
+        DrawComponent(portrait);
+    }
+    assert_int_equal(data->typewriter.revealedGlyphs, 8);
+    assert_int_equal(log.codepoints[6], 'b');
+    assert_int_equal(log.codepoints[7], 'r');
+    assert_int_equal(data->styledWordsDrawn, 2);    // "Hello" and the cut-off "br"
+    
+    SkipTypewriter(portrait);
+    assert_int_equal(data->typewriter.revealedGlyphs, 17);
+    DrawComponent(portrait);
+    assert_int_equal(data->styledWordsDrawn, 3);    // The whole text is visible
+    
+    // Changing the default color needs no relayout: words without a color tag follow it
+    data->textColor = DARKBLUE;
+    DrawComponent(portrait);
+    FreeComponent(portrait);
+}
+
+static void test_portrait_texture_cache(void **state) {
+    const char* filename = "test_portrait.png";
+    Image image = GenImageColor(64, 64, RED);
+    assert_true(ExportImage(image, filename));
+    UnloadImage(image);
+    
+    RayDialTextureCache* cache = CreateTextureCache(2);
+    assert_non_null(cache);
+    
+    // Two portraits of the same character share one entry and one load
+    RayDialComponent* first = CreatePortraitDialogueWithTexturePath((Rectangle){0, 0, 600, 200}, "Sage", "Hello.", cache, filename, GRAY);
+    RayDialComponent* second = CreatePortraitDialogueWithTexturePath((Rectangle){0, 200, 600, 200}, "Sage", "Again.", cache, filename, GRAY);
+    RayDialTextureHandle* handle = ((RayDialPortraitDialogueData*)first->data)->textureHandle;
+    assert_non_null(handle);
+    assert_ptr_equal(((RayDialPortraitDialogueData*)second->data)->textureHandle, handle);
+    assert_int_equal(GetTextureState(handle), RAYDIAL_TEXTURE_LOADING);
+    assert_int_equal(GetTextureCachePendingCount(cache), 1);
+    
+    // The placeholder color is drawn until the upload happens on this thread
+    DrawComponent(first);
+    WaitTextureCache(cache);
+    assert_int_equal(GetTextureState(handle), RAYDIAL_TEXTURE_LOADING);
+    UpdateTextureCache(cache, 0.0);
+    assert_int_equal(GetTextureState(handle), RAYDIAL_TEXTURE_READY);
+    assert_int_equal(GetHandleTexture(handle).width, 64);
+    assert_int_equal(GetTextureCachePendingCount(cache), 0);
+    DrawComponent(first);
+    
+    // The 64px image is already smaller than the portrait, so it only gains mips
+    RayDialTextureMemory memory = GetTextureCacheMemory(cache);
+    assert_int_equal(memory.textureCount, 1);
+    assert_int_equal(GetHandleTexture(handle).width, 64);
+    
+    // A 16px variant is its own entry, halved twice before the upload
+    RayDialTextureHandle* small = AcquireTextureSized(cache, filename, 16);
+    assert_ptr_not_equal(small, handle);
+    WaitTextureCache(cache);
+    UpdateTextureCache(cache, 0.0);
+    assert_int_equal(GetHandleTexture(small).width, 16);
+    assert_true(GetHandleTexture(small).mipmaps > 1);
+    RayDialTextureMemory withSmall = GetTextureCacheMemory(cache);
+    assert_int_equal(withSmall.textureCount, 2);
+    assert_true(withSmall.residentBytes - memory.residentBytes < (withSmall.sourceBytes - memory.sourceBytes) / 8);
+    ReleaseTexture(small);
+    
+    // Missing files fail without blocking
+    RayDialTextureHandle* missing = AcquireTexture(cache, "missing_portrait.png");
+    WaitTextureCache(cache);
+    UpdateTextureCache(cache, 0.0);
+    assert_int_equal(GetTextureState(missing), RAYDIAL_TEXTURE_FAILED);
+    ReleaseTexture(missing);
+    
+    // Only entries nobody holds are unloaded
+    FreeComponent(first);
+    assert_int_equal(TrimTextureCache(cache), 2);
+    FreeComponent(second);
+    assert_int_equal(TrimTextureCache(cache), 1);
+    assert_int_equal(GetTextureCacheMemory(cache).textureCount, 0);
+    
+    FreeTextureCache(cache);
+    remove(filename);
+}
+
+static bool atlas_regions_overlap(Rectangle a, Rectangle b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+static void test_portrait_atlas(void **state) {
+    RayDialPortraitAtlas* atlas = CreatePortraitAtlas(256, 2);
+    assert_non_null(atlas);
+    
+    // One character with a few expressions of different sizes
+    const char* names[] = { "sage_neutral", "sage_happy", "sage_sad", "sage_angry" };
+    int sizes[] = { 96, 96, 64, 48 };
+    for (int i = 0; i < 4; i++) {
+        Image image = GenImageColor(sizes[i], sizes[i], RED);
+        assert_true(AddAtlasImage(atlas, names[i], image));
+        UnloadImage(image);
+    }
+    
+    // Names are unique and images must fit on a page
+    Image image = GenImageColor(16, 16, BLUE);
+    assert_false(AddAtlasImage(atlas, "sage_happy", image));
+    Image huge = GenImageColor(300, 300, BLUE);
+    assert_false(AddAtlasImage(atlas, "huge", huge));
+    UnloadImage(huge);
+    
+    assert_true(BuildPortraitAtlas(atlas));
+    assert_int_equal(GetAtlasPageCount(atlas), 1);
+    assert_false(AddAtlasImage(atlas, "late", image));
+    UnloadImage(image);
+    
+    // Every expression samples the same texture from its own rectangle
+    RayDialAtlasRegion regions[5];
+    for (int i = 0; i < 4; i++) {
+        assert_true(GetAtlasRegion(atlas, names[i], &regions[i]));
+        assert_int_equal((int)regions[i].source.width, sizes[i]);
+        assert_int_equal(regions[i].texture.id, regions[0].texture.id);
+        assert_true(regions[i].source.x + regions[i].source.width <= 256);
+        assert_true(regions[i].source.y + regions[i].source.height <= 256);
+    }
+    assert_true(GetAtlasWhiteRegion(atlas, &regions[4]));
+    assert_int_equal(regions[4].texture.id, regions[0].texture.id);
+    for (int i = 0; i < 5; i++) {
+        for (int j = i + 1; j < 5; j++) {
+            assert_false(atlas_regions_overlap(regions[i].source, regions[j].source));
+        }
+    }
+    assert_false(GetAtlasRegion(atlas, "missing", &regions[0]));
+    
+    // Switching expressions only changes the source rectangle
+    RayDialComponent* portrait = CreatePortraitDialogue((Rectangle){0, 0, 600, 200}, "Sage", "Hello.", GRAY);
+    SetPortraitDialogueAtlasRegion(portrait, regions[1]);
+    RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)portrait->data;
+    assert_true(data->useAtlasRegion);
+    assert_true(data->useTexture);
+    DrawComponent(portrait);
+    SetPortraitDialogueColor(portrait, BLUE);
+    assert_false(data->useAtlasRegion);
+    FreeComponent(portrait);
+    FreePortraitAtlas(atlas);
+    
+    // Images that do not fit spill onto further pages
+    atlas = CreatePortraitAtlas(128, 1);
+    for (int i = 0; i < 3; i++) {
+        Image expression = GenImageColor(100, 100, GREEN);
+        assert_true(AddAtlasImage(atlas, names[i], expression));
+        UnloadImage(expression);
+    }
+    assert_true(BuildPortraitAtlas(atlas));
+    assert_int_equal(GetAtlasPageCount(atlas), 3);
+    FreePortraitAtlas(atlas);
+}
+
+static void test_portrait_flipbook(void **state) {
+    // Frames only need distinct regions; nothing is loaded at runtime
+    RayDialAtlasRegion frames[3];
+    for (int i = 0; i < 3; i++) {
+        frames[i].texture = (Texture2D){ .id = 1, .width = 256, .height = 256 };
+        frames[i].source = (Rectangle){ i * 64.0f, 0, 64, 64 };
+    }
+    
+    RayDialComponent* portrait = CreatePortraitDialogue((Rectangle){0, 0, 600, 200}, "Sage", "Hello.", GRAY);
+    RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)portrait->data;
+    assert_false(SetPortraitDialogueFlipbook(portrait, frames, 0, 20.0f, RAYDIAL_FLIPBOOK_LOOP));
+    assert_true(SetPortraitDialogueFlipbook(portrait, frames, 3, 20.0f, RAYDIAL_FLIPBOOK_LOOP));
+    frames[1].source.x = -1;  // The component keeps its own copy
+    
+    // 20 frames per second at 60 updates per second: one frame every three updates
+    for (int i = 0; i < 4; i++) UpdateComponent(portrait);
+    assert_int_equal(data->flipbook.currentFrame, 1);
+    assert_true(data->flipbook.frames[1].source.x == 64.0f);
+    for (int i = 0; i < 6; i++) UpdateComponent(portrait);
+    assert_int_equal(data->flipbook.currentFrame, 0);
+    DrawComponent(portrait);
+    
+    // Talking animation: moves only while the typewriter reveals text
+    assert_true(SetPortraitDialogueFlipbook(portrait, frames, 3, 10.0f, RAYDIAL_FLIPBOOK_WHILE_TYPING));
+    UpdateComponent(portrait);
+    assert_int_equal(data->flipbook.currentFrame, 0);
+    StartTypewriter(portrait, 30.0f);
+    for (int i = 0; i < 7; i++) UpdateComponent(portrait);
+    assert_false(IsTypewriterFinished(portrait));
+    assert_int_equal(data->flipbook.currentFrame, 1);
+    while (!IsTypewriterFinished(portrait)) UpdateComponent(portrait);
+    UpdateComponent(portrait);
+    assert_int_equal(data->flipbook.currentFrame, 0);
+    
+    // A static image replaces the flipbook
+    SetPortraitDialogueAtlasRegion(portrait, frames[2]);
+    assert_int_equal(data->flipbook.frameCount, 0);
+    assert_null(data->flipbook.frames);
+    
+    // Played once, the last frame stays
+    assert_true(SetPortraitDialogueFlipbook(portrait, frames, 3, 20.0f, RAYDIAL_FLIPBOOK_ONCE));
+    for (int i = 0; i < 30; i++) UpdateComponent(portrait);
+    assert_int_equal(data->flipbook.currentFrame, 2);
+    FreeComponent(portrait);
+}
+
+static void test_nine_slice_frames(void **state) {
+    // 48x48 frame image at (16, 32) in a 256x256 page, with 8px borders
+    RayDialNineSlice slice = {
+        .region = { .texture = { .id = 1, .width = 256, .height = 256 }, .source = { 16, 32, 48, 48 } },
+        .left = 8, .top = 8, .right = 8, .bottom = 8,
+        .tint = WHITE
+    };
+    
+    RayDialComponent* panel = CreatePanel((Rectangle){100, 50, 200, 120}, RAYWHITE);
+    RayDialPanelData* data = (RayDialPanelData*)panel->data;
+    SetPanelNineSlice(panel, slice);
+    assert_true(data->frame.enabled);
+    DrawComponent(panel);
+    
+    // Corners keep their source size, the middle stretches
+    assert_true(data->frame.x[1] == 108.0f && data->frame.x[2] == 292.0f && data->frame.x[3] == 300.0f);
+    assert_true(data->frame.y[1] == 58.0f && data->frame.y[3] == 170.0f);
+    assert_true(data->frame.u[1] == 24.0f / 256.0f && data->frame.v[2] == 72.0f / 256.0f);
+    
+    // The grid is reused until the bounds change
+    data->frame.x[1] = -1.0f;
+    DrawComponent(panel);
+    assert_true(data->frame.x[1] == -1.0f);
+    panel->bounds.width = 10;
+    DrawComponent(panel);
+    assert_true(data->frame.x[1] == 105.0f && data->frame.x[2] == 105.0f);  // Borders shrink to fit
+    
+    // A slice without a texture goes back to flat colors
+    SetPanelNineSlice(panel, (RayDialNineSlice){ 0 });
+    assert_false(data->frame.enabled);
+    DrawComponent(panel);
+    FreeComponent(panel);
+    
+    RayDialComponent* portrait = CreatePortraitDialogue((Rectangle){0, 0, 600, 200}, "Sage", "Hello.", GRAY);
+    RayDialPortraitDialogueData* portraitData = (RayDialPortraitDialogueData*)portrait->data;
+    SetPortraitDialogueBoxNineSlice(portrait, slice);
+    SetPortraitDialogueNameTagNineSlice(portrait, slice);
+    DrawComponent(portrait);
+    assert_true(portraitData->boxFrame.x[3] == 600.0f);
+    assert_true(portraitData->nameTagFrame.x[3] - portraitData->nameTagFrame.x[0] == 120.0f);
+    FreeComponent(portrait);
+}
+
 // Component hierarchy tests
 static void test_component_hierarchy(void **state) {
     // Create components
@@ -168,6 +710,664 @@ static void test_dialogue_node_creation(void **state) {
     // Cleanup handled by teardown_dialogue_nodes
 }
 
+static void test_choice_conditions(void **state) {
+    RayDialVariables* variables = CreateVariableStore();
+    int gold = GetVariableId(variables, "gold");
+    assert_int_equal(FindVariableId(variables, "gold"), gold);
+    assert_int_equal(FindVariableId(variables, "hasSword"), -1);
+    
+    // Precedence, short circuit and unknown names (which start at 0)
+    char error[128];
+    struct { const char* source; bool expected; } cases[] = {
+        { "gold >= 50 && !hasSword", false },
+        { "1 + 2 * 3 == 7", true },
+        { "(1 + 2) * 3 == 9 || missing", true },
+        { "-gold < 1 && 7 % 4 == 3", true },
+        { "10 / 0 == 0", true },
+        { "true && !false", true },
+        { "hasSword || gold", false },
+    };
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++) {
+        RayDialCondition* condition = CompileCondition(variables, cases[i].source, error, sizeof(error));
+        assert_non_null(condition);
+        assert_int_equal(EvaluateCondition(condition, variables), cases[i].expected);
+        FreeCondition(condition);
+    }
+    assert_true(FindVariableId(variables, "hasSword") >= 0);
+    
+    // Syntax errors point at the column
+    assert_null(CompileCondition(variables, "gold >= ", error, sizeof(error)));
+    assert_non_null(strstr(error, "column 9"));
+    assert_null(CompileCondition(variables, "(gold", error, sizeof(error)));
+    assert_null(CompileCondition(variables, "gold = 5", error, sizeof(error)));
+    
+    // Shop: the sword shows while affordable and not owned
+    RayDialNode* shop = CreateDialogueNode("shop", "Shop");
+    RayDialNode* sword = CreateDialogueNode("sword", "Buy sword");
+    RayDialNode* leave = CreateDialogueNode("leave", "Leave");
+    assert_true(AddConditionalChoice(shop, sword, variables, "gold >= 50 && !hasSword"));
+    AddChoice(shop, leave);
+    assert_false(AddConditionalChoice(shop, sword, variables, "gold >="));
+    assert_int_equal(shop->choiceCount, 2);
+    
+    int count = 0;
+    RayDialNode** visible = GetVisibleChoices(shop, variables, &count);
+    assert_int_equal(count, 1);
+    assert_ptr_equal(visible[0], leave);
+    
+    SetVariableInt(variables, gold, 60);
+    visible = GetVisibleChoices(shop, variables, &count);
+    assert_int_equal(count, 2);
+    assert_ptr_equal(visible[0], sword);
+    
+    // Nothing changed: the cached list comes back without evaluating again
+    unsigned int version = GetVariableStoreVersion(variables);
+    SetVariableInt(variables, gold, 60);
+    assert_int_equal(GetVariableStoreVersion(variables), version);
+    shop->visibleChoices[0] = leave;
+    GetVisibleChoices(shop, variables, &count);
+    assert_ptr_equal(shop->visibleChoices[0], leave);
+    
+    SetVariableInt(variables, GetVariableId(variables, "hasSword"), 1);
+    visible = GetVisibleChoices(shop, variables, &count);
+    assert_int_equal(count, 1);
+    assert_ptr_equal(visible[0], leave);
+    
+    FreeDialogueNode(shop);
+    FreeDialogueNode(sword);
+    FreeDialogueNode(leave);
+    FreeVariableStore(variables);
+}
+
+static void CountVariableChange(RayDialVariables* variables, int id, void* userData) {
+    (void)variables;
+    (void)id;
+    (*(int*)userData)++;
+}
+
+static void test_variable_store(void **state) {
+    RayDialVariables* variables = CreateVariableStore();
+    int gold = GetVariableId(variables, "gold");
+    int ratio = GetVariableId(variables, "ratio");
+    int met = GetVariableId(variables, "met");
+    int name = GetVariableId(variables, "name");
+    assert_int_equal(GetVariableCount(variables), 4);
+    assert_string_equal(GetVariableName(variables, ratio), "ratio");
+    
+    // Setters set the type; getters convert between numbers
+    SetVariableFloat(variables, ratio, 2.5f);
+    SetVariableBool(variables, met, true);
+    SetVariableString(variables, name, "Mira");
+    assert_int_equal(GetVariableType(variables, ratio), RAYDIAL_VAR_FLOAT);
+    assert_int_equal(GetVariableInt(variables, ratio), 2);
+    assert_int_equal(GetVariableInt(variables, met), 1);
+    assert_int_equal(GetVariableInt(variables, name), 0);
+    assert_true(GetVariableBool(variables, name));
+    assert_string_equal(GetVariableString(variables, gold), "");
+    
+    // Equal strings are interned to one pointer
+    char copy[] = "Mira";
+    int other = GetVariableId(variables, "other");
+    SetVariableString(variables, other, copy);
+    assert_ptr_equal(GetVariableString(variables, other), GetVariableString(variables, name));
+    
+    // Each variable remembers the store version of its last change
+    unsigned int version = GetVariableStoreVersion(variables);
+    SetVariableInt(variables, gold, 10);
+    assert_true(GetVariableVersion(variables, gold) > version);
+    assert_true(GetVariableVersion(variables, ratio) <= version);
+    
+    // Subscriptions fire on real changes only; removed entries are reused
+    int goldChanges = 0;
+    int first = SubscribeVariable(variables, gold, CountVariableChange, &goldChanges);
+    assert_true(first >= 0);
+    SetVariableInt(variables, gold, 20);
+    SetVariableInt(variables, gold, 20);
+    SetVariableInt(variables, ratio, 1);
+    assert_int_equal(goldChanges, 1);
+    UnsubscribeVariable(variables, first);
+    SetVariableInt(variables, gold, 30);
+    assert_int_equal(goldChanges, 1);
+    assert_int_equal(SubscribeVariable(variables, gold, CountVariableChange, &goldChanges), first);
+    UnsubscribeVariable(variables, first);
+    
+    // Typed conditions
+    char error[128];
+    struct { const char* source; bool expected; } cases[] = {
+        { "ratio * 1.5 == 1.5", true },
+        { "7 / 2 == 3 && 7 / 2.0 == 3.5", true },
+        { "name == \"Mira\" && other == name", true },
+        { "name != 'Tomas' && name < \"Zed\"", true },
+        { "name == 0", false },
+        { "met && gold > 25", true },
+    };
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++) {
+        RayDialCondition* condition = CompileCondition(variables, cases[i].source, error, sizeof(error));
+        assert_non_null(condition);
+        assert_int_equal(EvaluateCondition(condition, variables), cases[i].expected);
+        FreeCondition(condition);
+    }
+    assert_null(CompileCondition(variables, "name == \"Mira", error, sizeof(error)));
+    
+    // Visible choices only re-evaluate after a variable their conditions read changed
+    RayDialNode* gate = CreateDialogueNode("gate", "Gate");
+    RayDialNode* pass = CreateDialogueNode("pass", "Pass");
+    RayDialNode* leave = CreateDialogueNode("leave", "Leave");
+    assert_true(AddConditionalChoice(gate, pass, variables, "met"));
+    AddChoice(gate, leave);
+    int count = 0;
+    GetVisibleChoices(gate, variables, &count);
+    assert_int_equal(count, 2);
+    SetVariableInt(variables, gold, 99);
+    gate->visibleChoices[0] = leave;
+    GetVisibleChoices(gate, variables, &count);
+    assert_ptr_equal(gate->visibleChoices[0], leave);
+    SetVariableBool(variables, met, false);
+    RayDialNode** visible = GetVisibleChoices(gate, variables, &count);
+    assert_int_equal(count, 1);
+    assert_ptr_equal(visible[0], leave);
+    
+    // Bound labels reformat when a variable they show changes
+    RayDialComponent* label = CreateLabel((Rectangle){ 0, 0, 200, 40 }, "", false);
+    RayDialLabelData* data = (RayDialLabelData*)label->data;
+    assert_true(BindLabelToVariables(label, variables, "{name}: {gold} gold, {met} {ratio} {x"));
+    assert_string_equal(data->text, "Mira: 99 gold, false 1 {x");
+    SetVariableFloat(variables, ratio, 0.25f);
+    UpdateComponent(label);
+    assert_string_equal(data->text, "Mira: 99 gold, false 0.25 {x");
+    SetLabelText(label, "Plain");
+    SetVariableInt(variables, gold, 1);
+    UpdateComponent(label);
+    assert_string_equal(data->text, "Plain");
+    FreeComponent(label);
+    
+    FreeDialogueNode(gate);
+    FreeDialogueNode(pass);
+    FreeDialogueNode(leave);
+    FreeVariableStore(variables);
+}
+
+static RayDialValue ScriptNativeSum(const RayDialValue* args, int argCount, void* userData) {
+    int sum = *(int*)userData;
+    for (int i = 0; i < argCount; i++) sum += args[i].value.i;
+    return (RayDialValue){ RAYDIAL_VAR_INT, { sum } };
+}
+
+static void RecordScriptEvent(const char* event, RayDialValue value, void* userData) {
+    char* log = (char*)userData;
+    snprintf(log + strlen(log), 64 - strlen(log), "%s=%d;", event, value.value.i);
+}
+
+static void test_node_scripts(void **state) {
+    RayDialVariables* variables = CreateVariableStore();
+    RayDialScriptHost* host = CreateScriptHost(variables);
+    int bias = 100;
+    char events[64] = "";
+    assert_true(RegisterScriptNative(host, "sum", ScriptNativeSum, &bias));
+    SetScriptEventHandler(host, RecordScriptEvent, events);
+    
+    // Loop, arithmetic on mixed types, comparisons, natives and events
+    char error[128];
+    RayDialScript* script = CompileScript(host,
+        "  load r0, 0          # counter\n"
+        "loop:\n"
+        "  add r0, r0, 1\n"
+        "  lt r1, r0, 10\n"
+        "  jumpif r1, loop\n"
+        "  store count, r0\n"
+        "  div r2, r0, 4.0\n"
+        "  store ratio, r2\n"
+        "  load r3, name\n"
+        "  eq r4, r3, \"Mira\"\n"
+        "  store isMira, r4\n"
+        "  ge r5, r0, 10\n"
+        "  load r6, 2\n"
+        "  load r7, 3\n"
+        "  call r5, sum, 2\n"
+        "  store total, r5\n"
+        "  emit \"done\", r0\n"
+        "  emit \"quiet\"\n",
+        error, sizeof(error));
+    assert_non_null(script);
+    SetVariableString(variables, GetVariableId(variables, "name"), "Mira");
+    assert_null(RunScript(script));
+    assert_int_equal(GetVariableInt(variables, FindVariableId(variables, "count")), 10);
+    assert_true(GetVariableFloat(variables, FindVariableId(variables, "ratio")) == 2.5f);
+    assert_int_equal(GetVariableInt(variables, FindVariableId(variables, "isMira")), 1);
+    assert_int_equal(GetVariableInt(variables, FindVariableId(variables, "total")), 105);
+    assert_string_equal(events, "done=10;quiet=0;");
+    FreeScript(script);
+    
+    // Errors name the line
+    assert_null(CompileScript(host, "load r0, 1\nadd r0, r0\n", error, sizeof(error)));
+    assert_non_null(strstr(error, "line 2"));
+    assert_null(CompileScript(host, "jump nowhere", error, sizeof(error)));
+    assert_null(CompileScript(host, "call r0, missing, 0", error, sizeof(error)));
+    assert_null(CompileScript(host, "load r64, 1", error, sizeof(error)));
+    
+    // Scripts stop one word short of 64K, so a label at the very end still fits in a jump
+    const char* filler = "load r1, 1\n";
+    size_t fillerLength = strlen(filler);
+    for (int extra = 0; extra < 2; extra++) {
+        int fillers = 65531 + extra;  // With the load, jump, store and closing end: 65535 words, then one more
+        char* source = (char*)malloc(fillers * fillerLength + 64);
+        assert_non_null(source);
+        char* cursor = source + sprintf(source, "load r1, 7\njump skip\n");
+        for (int i = 0; i < fillers; i++, cursor += fillerLength) memcpy(cursor, filler, fillerLength);
+        strcpy(cursor, "skip:\nstore far, r1\n");
+        script = CompileScript(host, source, error, sizeof(error));
+        free(source);
+        if (extra) {
+            assert_null(script);
+            assert_non_null(strstr(error, "too long"));
+            continue;
+        }
+        assert_non_null(script);
+        assert_null(RunScript(script));
+        assert_int_equal(GetVariableInt(variables, FindVariableId(variables, "far")), 7);
+        FreeScript(script);
+    }
+    
+    // Runaway loops are cut off
+    script = CompileScript(host, "top: jump top", error, sizeof(error));
+    assert_non_null(script);
+    assert_null(RunScript(script));
+    FreeScript(script);
+    
+    // TransitionToNode runs the script of the node it enters and follows goto
+    RayDialNode* root = CreateDialogueNode("root", "Root");
+    RayDialNode* gate = CreateDialogueNode("gate", "Gate");
+    RayDialNode* open = CreateDialogueNode("open", "Open");
+    AddChoice(root, gate);
+    AddChoice(gate, open);
+    assert_true(SetNodeScript(gate,  host, "load r0, visits\nadd r0, r0, 1\nstore visits, r0\ngt r1, r0, 1\njumpifnot r1, stay\ngoto \"open\"\nstay:\n"));
+    assert_false(SetNodeScript(open, host, "bogus r0"));
+    RayDialManager* manager = CreateDialogueManager(root);
+    TransitionToNode(manager, "gate");
+    assert_ptr_equal(manager->currentNode, gate);
+    TransitionToNode(manager, "gate");
+    assert_ptr_equal(manager->currentNode, open);
+    assert_int_equal(GetVariableInt(variables, FindVariableId(variables, "visits")), 2);
+    
+    FreeDialogueManager(manager);
+    FreeDialogueNode(root);
+    FreeDialogueNode(gate);
+    FreeDialogueNode(open);
+    FreeScriptHost(host);
+    FreeVariableStore(variables);
+}
+
+typedef struct {
+    int errors;
+    int warnings;
+    char last[256];
+} GraphReportLog;
+
+static void CollectGraphReport(bool isError, int line, const char* message, void* userData) {
+    GraphReportLog* log = (GraphReportLog*)userData;
+    if (isError) log->errors++; else log->warnings++;
+    snprintf(log->last, sizeof(log->last), "%d: %s", line, message);
+}
+
+static void test_dialogue_graph(void **state) {
+    const char* source =
+        "# Shop\n"
+        "node start\n"
+        "text: Welcome!\n"
+        "text: What will it be?\n"
+        "choice: sword if gold >= 50\n"
+        "choice: leave\n"
+        "choice: maze\n"
+        "\n"
+        "node sword\n"
+        "text: A fine blade.\n"
+        "script: load r0, gold\n"
+        "script: sub r0, r0, 50\n"
+        "script: store gold, r0\n"
+        "script: goto \"leave\"\n"
+        "\n"
+        "node leave\n"
+        "text: Goodbye.\n"
+        "\n"
+        "node orphan\n"
+        "text: Nobody links here.\n"
+        "\n"
+        "node maze\n"
+        "choice: maze2\n"
+        "node maze2\n"
+        "choice: maze\n"
+        "\n"
+        "node debug entry\n"
+        "choice: start\n";
+    
+    // Unreachable nodes and trapping cycles are warnings; the orphan is dropped
+    GraphReportLog log = { 0 };
+    unsigned char* data = NULL;
+    int size = 0;
+    assert_true(CompileDialogueGraph(source, &data, &size, CollectGraphReport, &log));
+    assert_int_equal(log.errors, 0);
+    assert_int_equal(log.warnings, 2);
+    assert_non_null(data);
+    
+    // A trapping cycle is reported at its first node, members named in source order
+    GraphReportLog cycleLog = { 0 };
+    unsigned char* cycleData = NULL;
+    int cycleSize = 0;
+    assert_true(CompileDialogueGraph("node start\nchoice: c\nnode a\nchoice: b\nnode b\nchoice: c\nnode c\nchoice: a\n",
+                                     &cycleData, &cycleSize, CollectGraphReport, &cycleLog));
+    assert_int_equal(cycleLog.warnings, 1);
+    assert_string_equal(cycleLog.last, "3: Nodes 'a', 'b', 'c' loop with no way out");
+    free(cycleData);
+    
+    // Errors stop the output and carry their line
+    const char* broken =
+        "node start\n"
+        "choice: nowhere\n"
+        "choice: start if gold >=\n"
+        "node start\n"
+        "script: goto \"missing\"\n"
+        "bogus line\n";
+    GraphReportLog brokenLog = { 0 };
+    unsigned char* brokenData = NULL;
+    int brokenSize = 0;
+    assert_false(CompileDialogueGraph(broken, &brokenData, &brokenSize, CollectGraphReport, &brokenLog));
+    assert_null(brokenData);
+    assert_int_equal(brokenLog.errors, 5);
+    
+    // Loading links the nodes; conditions and scripts compile against the runtime store
+    RayDialVariables* variables = CreateVariableStore();
+    RayDialScriptHost* host = CreateScriptHost(variables);
+    RayDialGraph* graph = LoadDialogueGraph(data, size, variables, host);
+    assert_non_null(graph);
+    assert_int_equal(GetGraphNodeCount(graph), 6);
+    assert_int_equal(FindGraphNodeIndex(graph, "orphan"), -1);
+    
+    RayDialNode* start = GetGraphNode(graph, 0);
+    assert_string_equal(start->id, "start");
+    assert_string_equal(start->text, "Welcome!\nWhat will it be?");
+    assert_int_equal(start->choiceCount, 3);
+    assert_ptr_equal(start->choices[1], GetGraphNode(graph, FindGraphNodeIndex(graph, "leave")));
+    
+    int count = 0;
+    GetVisibleChoices(start, variables, &count);
+    assert_int_equal(count, 2);
+    SetVariableInt(variables, GetVariableId(variables, "gold"), 80);
+    GetVisibleChoices(start, variables, &count);
+    assert_int_equal(count, 3);
+    
+    // Transitions by id go through the graph index; the sword script moves on by goto
+    RayDialManager* manager = CreateDialogueManagerFromGraph(graph);
+    assert_ptr_equal(manager->currentNode, start);
+    TransitionToNode(manager, "sword");
+    assert_string_equal(manager->currentNode->id, "leave");
+    assert_int_equal(GetVariableInt(variables, FindVariableId(variables, "gold")), 30);
+    TransitionToNodeIndex(manager, FindGraphNodeIndex(graph, "maze2"));
+    assert_string_equal(manager->currentNode->id, "maze2");
+    TransitionToNodeIndex(manager, 99);
+    assert_string_equal(manager->currentNode->id, "maze2");
+    FreeDialogueManager(manager);
+    FreeDialogueGraph(graph);
+    
+    // Damaged binaries are rejected rather than trusted
+    assert_null(LoadDialogueGraph(data, size - 1, variables, host));
+    unsigned char* damaged = (unsigned char*)malloc(size);
+    memcpy(damaged, data, size);
+    damaged[20 + 6 * 4 * 6] = 0xFF;
+    assert_null(LoadDialogueGraph(damaged, size, variables, host));
+    free(damaged);
+    
+    // Without a store, conditions cannot compile
+    assert_null(LoadDialogueGraph(data, size, NULL, host));
+    
+    free(data);
+    FreeScriptHost(host);
+    FreeVariableStore(variables);
+}
+
+static void write_chapter_file(const char* filename, const char* source) {
+    unsigned char* data = NULL;
+    int size = 0;
+    assert_true(CompileDialogueGraph(source, &data, &size, NULL, NULL));
+    FILE* file = fopen(filename, "wb");
+    assert_non_null(file);
+    fwrite(data, 1, size, file);
+    fclose(file);
+    free(data);
+}
+
+static void test_chapter_streaming(void **state) {
+    // Links into other chapters are exits, so the intro/stay loop is no warning
+    const char* chapterOne =
+        "node intro\n"
+        "text: Chapter one.\n"
+        "choice: two/arrive\n"
+        "choice: stay\n"
+        "node stay\n"
+        "choice: intro\n";
+    GraphReportLog log = { 0 };
+    unsigned char* data = NULL;
+    int size = 0;
+    assert_true(CompileDialogueGraph(chapterOne, &data, &size, CollectGraphReport, &log));
+    assert_int_equal(log.warnings, 0);
+    
+    GraphReportLog brokenLog = { 0 };
+    unsigned char* brokenData = NULL;
+    int brokenSize = 0;
+    assert_false(CompileDialogueGraph("node a/b\nnode c\nchoice: two/\nchoice: x/y/z\n", &brokenData, &brokenSize,
+                                      CollectGraphReport, &brokenLog));
+    assert_int_equal(brokenLog.errors, 3);
+    
+    // Loaded on its own, a chapter keeps its links as portal nodes outside the index
+    RayDialGraph* graph = LoadDialogueGraph(data, size, NULL, NULL);
+    assert_non_null(graph);
+    assert_int_equal(GetGraphNodeCount(graph), 2);
+    assert_string_equal(GetGraphNode(graph, 0)->choices[0]->id, "two/arrive");
+    assert_int_equal(FindGraphNodeIndex(graph, "two/arrive"), -1);
+    FreeDialogueGraph(graph);
+    free(data);
+    
+    write_chapter_file("raydial_test_one.rdg", chapterOne);
+    write_chapter_file("raydial_test_two.rdg",
+        "node arrive\n"
+        "text: You arrive.\n"
+        "choice: three/finale\n");
+    write_chapter_file("raydial_test_three.rdg",
+        "node finale\n"
+        "text: The end.\n"
+        "choice: one/intro\n");
+    
+    RayDialChapterSet* chapters = CreateChapterSet(NULL, NULL);
+    assert_true(AddChapter(chapters, "one", "raydial_test_one.rdg"));
+    assert_true(AddChapter(chapters, "two", "raydial_test_two.rdg"));
+    assert_true(AddChapter(chapters, "three", "raydial_test_three.rdg"));
+    assert_false(AddChapter(chapters, "two", "raydial_test_two.rdg"));
+    
+    // Starting a chapter prefetches the chapters it links to, and only those
+    RayDialManager* manager = CreateDialogueManagerFromChapters(chapters, "one");
+    assert_non_null(manager);
+    assert_string_equal(manager->currentNode->id, "intro");
+    WaitChapterSet(chapters);
+    UpdateDialogueManager(manager);
+    assert_true(IsChapterResident(chapters, "one"));
+    assert_true(IsChapterResident(chapters, "two"));
+    assert_false(IsChapterResident(chapters, "three"));
+    
+    // Once its chapter is in, a link reads like the node it leads to
+    RayDialNode* link = manager->currentNode->choices[0];
+    assert_string_equal(link->text, "You arrive.");
+    
+    // Crossing over moves the window: chapter one is evicted, three prefetched
+    TransitionToNode(manager, link->id);
+    assert_string_equal(manager->currentNode->id, "arrive");
+    assert_ptr_equal(manager->graph, GetCurrentChapterGraph(chapters));
+    WaitChapterSet(chapters);
+    UpdateDialogueManager(manager);
+    assert_false(IsChapterResident(chapters, "one"));
+    assert_true(IsChapterResident(chapters, "three"));
+    
+    // A chapter that isn't resident loads on demand
+    TransitionToNode(manager, "one/stay");
+    assert_string_equal(manager->currentNode->id, "stay");
+    assert_true(IsChapterResident(chapters, "one"));
+    TransitionToNode(manager, "intro");
+    assert_string_equal(manager->currentNode->id, "intro");
+    
+    // Unknown chapters fall back to the current chapter's first node
+    TransitionToNode(manager, "stay");
+    TransitionToNode(manager, "nowhere/x");
+    assert_string_equal(manager->currentNode->id, "intro");
+    
+    // Looking a node up loads its chapter without entering it, and a miss leaves nothing behind
+    UpdateDialogueManager(manager);
+    assert_false(IsChapterResident(chapters, "three"));
+    assert_null(GetChapterNode(chapters, "three", 5));
+    assert_false(IsChapterResident(chapters, "three"));
+    assert_string_equal(GetChapterNode(chapters, "three", 0)->id, "finale");
+    assert_string_equal(GetCurrentChapterName(chapters), "one");
+    
+    // Snapshots restore across chapters
+    unsigned char snapshot[128];
+    int snapshotSize = SaveDialogueSnapshot(manager, NULL, snapshot, sizeof(snapshot));
+    assert_true(snapshotSize > 0 && snapshotSize <= (int)sizeof(snapshot));
+    TransitionToNode(manager, "three/finale");
+    assert_string_equal(GetCurrentChapterName(chapters), "three");
+    assert_true(RestoreDialogueSnapshot(manager, NULL, snapshot, snapshotSize));
+    assert_string_equal(manager->currentNode->id, "intro");
+    assert_string_equal(GetCurrentChapterName(chapters), "one");
+    assert_ptr_equal(manager->graph, GetCurrentChapterGraph(chapters));
+    
+    FreeDialogueManager(manager);
+    FreeChapterSet(chapters);
+    remove("raydial_test_one.rdg");
+    remove("raydial_test_two.rdg");
+    remove("raydial_test_three.rdg");
+}
+
+// Recompute a snapshot's checksum after editing it, so the fuzzer reaches the section checks
+static void reseal_snapshot(unsigned char* data, int size) {
+    unsigned int hash = 2166136261u;
+    for (int i = 16; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    for (int i = 0; i < 4; i++) data[12 + i] = (unsigned char)(hash >> (8 * i));
+}
+
+static void test_dialogue_snapshot(void **state) {
+    // Trees are saved by pre-order position
+    RayDialNode* root = CreateDialogueNode("root", "Root");
+    RayDialNode* left = CreateDialogueNode("left", "Left");
+    RayDialNode* deep = CreateDialogueNode("deep", "Deep");
+    AddChoice(root, left);
+    AddChoice(left, deep);
+    RayDialNode* right = CreateDialogueNode("right", "Right");
+    AddChoice(root, right);
+    RayDialManager* tree = CreateDialogueManager(root);
+    TransitionToNode(tree, "deep");
+    unsigned char treeData[64];
+    int treeSize = SaveDialogueSnapshot(tree, NULL, treeData, sizeof(treeData));
+    assert_true(treeSize > 0 && treeSize <= (int)sizeof(treeData));
+    TransitionToNode(tree, "right");
+    assert_true(RestoreDialogueSnapshot(tree, NULL, treeData, treeSize));
+    assert_ptr_equal(tree->currentNode, deep);
+    FreeDialogueManager(tree);
+    FreeDialogueNode(root);
+    FreeDialogueNode(left);
+    FreeDialogueNode(deep);
+    FreeDialogueNode(right);
+    
+    const char* source =
+        "node a\nchoice: b\nchoice: c\n"
+        "node b\nchoice: c\n"
+        "node c\nchoice: d\n"
+        "node d\nchoice: a\n";
+    unsigned char* graphData = NULL;
+    int graphSize = 0;
+    assert_true(CompileDialogueGraph(source, &graphData, &graphSize, NULL, NULL));
+    RayDialGraph* graph = LoadDialogueGraph(graphData, graphSize, NULL, NULL);
+    RayDialManager* manager = CreateDialogueManagerFromGraph(graph);
+    
+    const char* words[] = { "", "sword", "a longer string value", "sword" };
+    unsigned char buffer[1024];
+    unsigned char damaged[1024];
+    srand(46);
+    for (int round = 0; round < 200; round++) {
+        // A random store and position. Damaged snapshots can restore variables with
+        // mangled names, so each round starts from a fresh store.
+        RayDialVariables* variables = CreateVariableStore();
+        int count = 1 + rand() % 12;
+        RayDialValue expected[12];
+        char names[12][8];
+        for (int v = 0; v < count; v++) {
+            snprintf(names[v], sizeof(names[v]), "v%d", rand() % 40);
+            int id = GetVariableId(variables, names[v]);
+            switch (rand() % 4) {
+                case 0: SetVariableInt(variables, id, rand() - RAND_MAX / 2); break;
+                case 1: SetVariableFloat(variables, id, (float)rand() / 7.0f); break;
+                case 2: SetVariableBool(variables, id, rand() % 2); break;
+                default: SetVariableString(variables, id, words[rand() % 4]); break;
+            }
+        }
+        for (int v = 0; v < count; v++) expected[v] = GetVariableValue(variables, FindVariableId(variables, names[v]));
+        int node = rand() % GetGraphNodeCount(graph);
+        TransitionToNodeIndex(manager, node);
+        
+        int size = SaveDialogueSnapshot(manager, variables, NULL, 0);
+        assert_true(size > 0 && size <= (int)sizeof(buffer));
+        assert_int_equal(SaveDialogueSnapshot(manager, variables, buffer, size - 1), size);
+        assert_int_equal(SaveDialogueSnapshot(manager, variables, buffer, sizeof(buffer)), size);
+        
+        // Disturb everything, then come back
+        for (int v = 0; v < count; v++) SetVariableString(variables, FindVariableId(variables, names[v]), "changed");
+        int later = GetVariableId(variables, "createdLater");
+        SetVariableInt(variables, later, 9);
+        TransitionToNodeIndex(manager, (node + 1) % GetGraphNodeCount(graph));
+        
+        assert_true(RestoreDialogueSnapshot(manager, variables, buffer, size));
+        assert_ptr_equal(manager->currentNode, GetGraphNode(graph, node));
+        assert_int_equal(GetVariableInt(variables, later), 0);
+        for (int v = 0; v < count; v++) {
+            RayDialValue value = GetVariableValue(variables, FindVariableId(variables, names[v]));
+            assert_int_equal(value.type, expected[v].type);
+            if (value.type == RAYDIAL_VAR_STRING) {
+                assert_ptr_equal(value.value.s, expected[v].value.s);
+            } else if (value.type == RAYDIAL_VAR_FLOAT) {
+                assert_true(value.value.f == expected[v].value.f);
+            } else {
+                assert_int_equal(value.value.i, expected[v].value.i);
+            }
+        }
+        
+        // Damage: a failed restore changes nothing, and nothing reads out of bounds
+        for (int attempt = 0; attempt < 20; attempt++) {
+            memcpy(damaged, buffer, size);
+            int damagedSize = size;
+            if (attempt % 5 == 4) {
+                damagedSize = rand() % size;
+            } else {
+                for (int flips = 1 + rand() % 3; flips > 0; flips--) damaged[rand() % size] ^= (unsigned char)(1 + rand() % 255);
+            }
+            if (attempt % 2) reseal_snapshot(damaged, damagedSize);
+            
+            unsigned int version = GetVariableStoreVersion(variables);
+            RayDialNode* current = manager->currentNode;
+            if (!RestoreDialogueSnapshot(manager, variables, damaged, damagedSize)) {
+                assert_int_equal(GetVariableStoreVersion(variables), version);
+                assert_ptr_equal(manager->currentNode, current);
+            }
+        }
+        assert_true(RestoreDialogueSnapshot(manager, variables, buffer, size));
+        FreeVariableStore(variables);
+    }
+    
+    // A snapshot of a tree position doesn't fit past the end of this graph
+    assert_false(RestoreDialogueSnapshot(manager, NULL, treeData, treeSize - 1));
+    
+    FreeDialogueManager(manager);
+    FreeDialogueGraph(graph);
+    free(graphData);
+}
+
 // Setup/teardown for dialogue manager tests
 static int setup_dialogue_nodes(void **state) {
     setup(state);
@@ -274,6 +1474,617 @@ static void test_null_parameters(void **state) {
     free(nullNode);
 }
 
+// Localization tests
+static void write_text_file(const char* filename, const char* contents) {
+    FILE* file = fopen(filename, "w");
+    assert_non_null(file);
+    fputs(contents, file);
+    fclose(file);
+}
+
+static void test_translation_file_loading(void **state) {
+    const char* filename = "raydial_test_en.txt";
+    write_text_file(filename,
+        "# comment line\n"
+        "greeting = Hello\r\n"
+        "\n"
+        "farewell=  Goodbye, friend\n"
+        "no separator here\n");
+    
+    RayDialI18N* i18n = CreateI18NManager();
+    AddLanguage(i18n, "en", "English");
+    
+    assert_true(LoadTranslationsFromFile(i18n, "en", filename));
+    assert_string_equal(GetLocalizedText(i18n, "greeting"), "Hello");
+    assert_string_equal(GetLocalizedText(i18n, "farewell"), "Goodbye, friend");
+    assert_string_equal(GetLocalizedText(i18n, "missing"), "missing");
+    
+    // Reloading the same file overrides values without duplicating keys
+    assert_true(LoadTranslationsFromFile(i18n, "en", filename));
+    int count = 0;
+    for (RayDialTranslationEntry* entry = GetCurrentLanguage(i18n)->translations; entry; entry = entry->next) {
+        count++;
+    }
+    assert_int_equal(count, 2);
+    
+    FreeI18NManager(i18n);
+    remove(filename);
+}
+
+static void test_dialogue_history(void **state) {
+    // The ring keeps the newest lines; the text arena drops the oldest when it runs out
+    RayDialHistory* history = CreateDialogueHistory(8, 96);
+    char expected[400][32];
+    srand(47);
+    for (int i = 0; i < 400; i++) {
+        int length = snprintf(expected[i], sizeof(expected[i]), "line %d", i);
+        for (int pad = rand() % 12; pad > 0 && length < 30; pad--) expected[i][length++] = (pad % 5) ? 'x' : '\n';
+        expected[i][length] = '\0';
+        assert_true(RecordDialogueLine(history, expected[i], (i % 3) ? "Guide" : NULL));
+        
+        int count = GetDialogueHistoryCount(history);
+        assert_true(count >= 1 && count <= 8);
+        for (int k = 0; k < count; k++) {
+            const RayDialHistoryEntry* entry = GetDialogueHistoryEntry(history, k);
+            int line = i - count + 1 + k;
+            assert_string_equal(entry->text, expected[line]);
+            assert_int_equal(entry->speaker != NULL, (line % 3) != 0);
+            if (k > 0) {
+                const RayDialHistoryEntry* previous = GetDialogueHistoryEntry(history, k - 1);
+                assert_true(entry->firstLine == previous->firstLine + previous->lineCount + (previous->speaker ? 1 : 0));
+            }
+        }
+    }
+    assert_null(GetDialogueHistoryEntry(history, 8));
+    
+    MarkNodeVisited(history, 2, 100);
+    MarkNodeVisited(history, -1, 3);
+    assert_true(IsNodeVisited(history, 2, 100));
+    assert_true(IsNodeVisited(history, -1, 3));
+    assert_false(IsNodeVisited(history, 1, 100));
+    assert_false(IsNodeVisited(history, 2, 99));
+    assert_false(IsNodeVisited(history, 2, 5000));
+    ClearDialogueHistory(history);
+    assert_int_equal(GetDialogueHistoryCount(history), 0);
+    assert_false(IsNodeVisited(history, 2, 100));
+    
+    // A manager records the portrait line of each node it stops at
+    RayDialNode* root = CreateDialogueNode("root", "Hello");
+    RayDialNode* ask = CreateDialogueNode("ask", "Ask");
+    ask->components = CreatePortraitDialogue((Rectangle){ 0, 0, 400, 100 }, "Mira", "Where to?\nNorth or south?", BLUE);
+    AddChoice(root, ask);
+    RayDialManager* manager = CreateDialogueManager(root);
+    SetDialogueHistory(manager, history);
+    TransitionToNode(manager, "ask");
+    TransitionToNode(manager, "root");
+    assert_int_equal(GetDialogueHistoryCount(history), 2);
+    const RayDialHistoryEntry* line = GetDialogueHistoryEntry(history, 0);
+    assert_string_equal(line->text, "Where to?\nNorth or south?");
+    assert_string_equal(line->speaker, "Mira");
+    assert_int_equal(line->nodeIndex, 1);
+    assert_int_equal(line->lineCount, 2);
+    assert_string_equal(GetDialogueHistoryEntry(history, 1)->text, "Hello");
+    assert_true(HasVisitedNode(manager, ask));
+    
+    // History travels with snapshots
+    unsigned char buffer[512];
+    int size = SaveDialogueSnapshot(manager, NULL, buffer, sizeof(buffer));
+    assert_true(size > 0 && size <= (int)sizeof(buffer));
+    ClearDialogueHistory(history);
+    RecordDialogueLine(history, "unsaved", NULL);
+    assert_true(RestoreDialogueSnapshot(manager, NULL, buffer, size));
+    assert_int_equal(GetDialogueHistoryCount(history), 2);
+    assert_string_equal(GetDialogueHistoryEntry(history, 0)->speaker, "Mira");
+    assert_true(HasVisitedNode(manager, ask));
+    FreeDialogueManager(manager);
+    FreeComponent(ask->components);
+    FreeDialogueNode(root);
+    FreeDialogueNode(ask);
+    
+    // The view reads lines in place and stays on them as old ones drop out
+    ClearDialogueHistory(history);
+    char lines[12][8];
+    for (int i = 0; i < 10; i++) {
+        snprintf(lines[i], sizeof(lines[i]), "line %d", i);
+        RecordDialogueLine(history, lines[i], NULL);
+    }
+    RayDialComponent* view = CreateHistoryView((Rectangle){ 0, 0, 200, 60 }, history, 10);
+    ScrollHistoryViewToEnd(view, false);
+    DrawComponent(view);
+    int first = -1;
+    assert_int_equal(GetHistoryViewVisibleEntries(view, &first), 4);
+    assert_string_equal(GetDialogueHistoryEntry(history, first)->text, "line 6");
+    
+    // 8 entries fit, so recording two more drops the first two
+    ClearDialogueHistory(history);
+    for (int i = 0; i < 8; i++) RecordDialogueLine(history, lines[i], NULL);
+    ScrollHistoryViewToEnd(view, false);
+    DrawComponent(view);
+    GetHistoryViewVisibleEntries(view, &first);
+    assert_string_equal(GetDialogueHistoryEntry(history, first)->text, "line 4");
+    for (int i = 8; i < 10; i++) RecordDialogueLine(history, lines[i], NULL);
+    DrawComponent(view);
+    GetHistoryViewVisibleEntries(view, &first);
+    assert_string_equal(GetDialogueHistoryEntry(history, first)->text, "line 4");
+    for (int frame = 0; frame < 120; frame++) UpdateComponent(view);
+    GetHistoryViewVisibleEntries(view, &first);
+    assert_string_equal(GetDialogueHistoryEntry(history, first)->text, "line 6");
+    
+    FreeComponent(view);
+    FreeDialogueHistory(history);
+}
+
+static void test_dialogue_context(void **state) {
+    RayDialNode* root = CreateDialogueNode("root", "Root");
+    RayDialContext* context = CreateDialogueContext(NULL, NULL);
+    RayDialManager* barks = CreateDialogueManager(root);
+    RayDialManager* banter = CreateDialogueManager(root);
+    RayDialManager* story = CreateDialogueManager(root);
+    assert_true(AddDialogueManager(context, barks, 0, 1.0));
+    assert_true(AddDialogueManager(context, banter, 0, 1.0));
+    assert_true(AddDialogueManager(context, story, 10, 0.0));
+    assert_false(AddDialogueManager(context, story, 10, 0.0));
+    assert_ptr_equal(GetDialogueContextManager(context, 0), story);
+    assert_ptr_equal(GetDialogueContextManager(context, 1), barks);
+    
+    // Without a frame budget everyone updates
+    RayDialManagerStats stats;
+    UpdateDialogueContext(context);
+    for (int i = 0; i < 3; i++) {
+        assert_true(GetDialogueManagerStats(context, GetDialogueContextManager(context, i), &stats));
+        assert_true(stats.updated);
+    }
+    
+    // Room for one budgeted manager a frame: the story always runs, barks and banter take turns
+    SetDialogueContextBudget(context, 1.5, 0.0);
+    bool barksRan[6];
+    for (int frame = 0; frame < 6; frame++) {
+        UpdateDialogueContext(context);
+        assert_true(GetDialogueManagerStats(context, story, &stats) && stats.updated);
+        RayDialManagerStats barksStats, banterStats;
+        GetDialogueManagerStats(context, barks, &barksStats);
+        GetDialogueManagerStats(context, banter, &banterStats);
+        assert_true(barksStats.updated != banterStats.updated);
+        assert_true(barksStats.deferredFrames <= 1 && banterStats.deferredFrames <= 1);
+        barksRan[frame] = barksStats.updated;
+    }
+    for (int frame = 1; frame < 6; frame++) assert_true(barksRan[frame] != barksRan[frame - 1]);
+    
+    // Workers admit managers by the same rule, so the rotation carries on unchanged
+    assert_true(SetDialogueContextWorkers(context, 2));
+    bool barksRanLast = barksRan[5];
+    for (int frame = 0; frame < 6; frame++) {
+        UpdateDialogueContext(context);
+        assert_true(GetDialogueManagerStats(context, barks, &stats));
+        assert_true(stats.updated != barksRanLast);
+        barksRanLast = stats.updated;
+    }
+    assert_true(SetDialogueContextWorkers(context, 0));
+    
+    // Priorities can change; removed managers go back to the caller
+    SetDialogueManagerPriority(context, banter, 20);
+    assert_ptr_equal(GetDialogueContextManager(context, 0), banter);
+    RemoveDialogueManager(context, barks);
+    assert_int_equal(GetDialogueContextManagerCount(context), 2);
+    assert_false(GetDialogueManagerStats(context, barks, &stats));
+    DrawDialogueContext(context);
+    
+    FreeDialogueManager(barks);
+    FreeDialogueContext(context);
+    FreeDialogueNode(root);
+}
+
+static void count_reveal(int codepoint, void* userData) {
+    (void)codepoint;
+    (*(int*)userData)++;
+}
+
+static void test_parallel_dialogue_context(void **state) {
+    // The same conversations updated on the main thread and on workers reveal the same text
+    enum { MANAGERS = 16 };
+    RayDialNode* nodes[2][MANAGERS];
+    int reveals[2][MANAGERS] = { { 0 } };
+    for (int pass = 0; pass < 2; pass++) {
+        RayDialContext* context = CreateDialogueContext(NULL, NULL);
+        if (pass) assert_true(SetDialogueContextWorkers(context, 4));
+        for (int i = 0; i < MANAGERS; i++) {
+            nodes[pass][i] = CreateDialogueNode("bark", "Bark");
+            RayDialComponent* line = CreatePortraitDialogue((Rectangle){ 0, 0, 300, 80 }, "Guard", "Move along, citizen.", GRAY);
+            StartTypewriter(line, 60.0f * (1 + i % 3));
+            SetTypewriterCallback(line, count_reveal, &reveals[pass][i]);
+            nodes[pass][i]->components = line;
+            assert_true(AddDialogueManager(context, CreateDialogueManager(nodes[pass][i]), i % 4, 0.0));
+        }
+        for (int frame = 0; frame < 10; frame++) UpdateDialogueContext(context);
+        DrawDialogueContext(context);
+        FreeDialogueContext(context);
+        for (int i = 0; i < MANAGERS; i++) {
+            FreeComponent(nodes[pass][i]->components);
+            FreeDialogueNode(nodes[pass][i]);
+        }
+    }
+    for (int i = 0; i < MANAGERS; i++) {
+        assert_true(reveals[0][i] > 0);
+        assert_int_equal(reveals[0][i], reveals[1][i]);
+    }
+}
+
+typedef struct {
+    RayDialManager* manager;
+    const char* target;
+} ReplayRoute;
+
+static void follow_route(void* userData) {
+    ReplayRoute* route = (ReplayRoute*)userData;
+    TransitionToNode(route->manager, route->target);
+}
+
+static void test_dialogue_replay(void **state) {
+    // root -> a -> b by buttons in different places, and back to root from b
+    RayDialNode* nodes[3] = { CreateDialogueNode("root", "Root"), CreateDialogueNode("a", "A"), CreateDialogueNode("b", "B") };
+    AddChoice(nodes[0], nodes[1]);
+    AddChoice(nodes[1], nodes[2]);
+    RayDialManager* manager = CreateDialogueManager(nodes[0]);
+    ReplayRoute routes[3] = { { manager, "a" }, { manager, "b" }, { manager, "root" } };
+    nodes[0]->components = CreateButton((Rectangle){ 0, 0, 100, 40 }, "Next", follow_route, &routes[0]);
+    nodes[1]->components = CreateButton((Rectangle){ 0, 50, 100, 40 }, "Next", follow_route, &routes[1]);
+    nodes[2]->components = CreateButton((Rectangle){ 0, 0, 100, 40 }, "Back", follow_route, &routes[2]);
+    
+    // Clicks at frames 2, 5 and 8 (the second also misses once first), idle in between
+    RayDialRecorder* recorder = CreateDialogueRecorder(manager);
+    assert_non_null(recorder);
+    const Vector2 clicks[3] = { { 10, 10 }, { 10, 60 }, { 10, 10 } };
+    for (int frame = 0; frame < 12; frame++) {
+        RayDialInputFrame input = { 0 };
+        input.frameTime = 1.0f / 60.0f;
+        input.time = 1.5 + frame / 60.0;
+        input.mouse = (Vector2){ 200, 200 };
+        if (frame == 4 || (frame % 3 == 2 && frame <= 8)) {
+            input.mouse = (frame == 4) ? (Vector2){ 10, 10 } : clicks[frame / 3];
+            input.mouseButtons = RAYDIAL_INPUT_MOUSE_PRESSED | RAYDIAL_INPUT_MOUSE_DOWN;
+        }
+        if (frame == 9) assert_true(PressInputKey(&input, KEY_ENTER));
+        RecordDialogueInput(recorder, &input);
+        UpdateDialogueManager(manager);
+    }
+    assert_ptr_equal(manager->currentNode, nodes[0]);
+    int size;
+    const unsigned char* recorded = GetDialogueRecording(recorder, &size);
+    assert_true(size > 0 && size < 12 * 16);
+    unsigned char* data = (unsigned char*)malloc(size);
+    memcpy(data, recorded, size);
+    FreeDialogueRecorder(recorder);
+    assert_null(manager->onTransition);
+    
+    // Same dialogue, same start: same nodes, frame for frame
+    RayDialReplayResult result = ReplayDialogueRecording(manager, data, size);
+    assert_true(result.passed);
+    assert_int_equal(result.frames, 12);
+    assert_int_equal(result.transitions, 3);
+    assert_int_equal(result.failedFrame, -1);
+    assert_ptr_equal(manager->currentNode, nodes[0]);
+    
+    // A dialogue that branches differently fails where it first goes elsewhere
+    routes[1].target = "root";
+    result = ReplayDialogueRecording(manager, data, size);
+    assert_false(result.passed);
+    assert_int_equal(result.failedFrame, 5);
+    assert_int_equal(result.expectedNode, GetManagerNodeIndex(manager, nodes[2]));
+    assert_int_equal(result.actualNode, GetManagerNodeIndex(manager, nodes[0]));
+    assert_int_equal(result.transitions, 1);
+    routes[1].target = "b";
+    
+    // Starting from another node, or from a damaged log, fails up front
+    TransitionToNode(manager, "a");
+    result = ReplayDialogueRecording(manager, data, size);
+    assert_false(result.passed);
+    assert_int_equal(result.failedFrame, 0);
+    assert_int_equal(result.frames, 0);
+    TransitionToNode(manager, "root");
+    result = ReplayDialogueRecording(manager, data, size - 3);
+    assert_false(result.passed);
+    data[0] = 'X';
+    assert_false(ReplayDialogueRecording(manager, data, size).passed);
+    
+    free(data);
+    FreeDialogueManager(manager);
+    for (int i = 0; i < 3; i++) {
+        FreeComponent(nodes[i]->components);
+        FreeDialogueNode(nodes[i]);
+    }
+}
+
+static void test_translation_hash_lookup(void **state) {
+    static char keys[500][16];
+    RayDialI18N* i18n = CreateI18NManager();
+    AddLanguage(i18n, "en", "English");
+    
+    for (int i = 0; i < 500; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "key_%d", i);
+        assert_true(AddTranslation(i18n, "en", keys[i], keys[i]));
+    }
+    for (int i = 0; i < 500; i++) {
+        assert_ptr_equal(GetLocalizedText(i18n, keys[i]), keys[i]);
+    }
+    
+    FreeI18NManager(i18n);
+}
+
+static void count_reload(void* userData) {
+    (*(int*)userData)++;
+}
+
+static void test_translation_hot_reload(void **state) {
+    const char* filename = "raydial_test_watch.txt";
+    write_text_file(filename, "title=Reloaded title\n");
+    
+    RayDialI18N* i18n = CreateI18NManager();
+    AddLanguage(i18n, "en", "English");
+    AddTranslation(i18n, "en", "title", "Original title");
+    
+    RayDialComponent* label = CreateLocalizedLabel((Rectangle){0, 0, 200, 40}, "title", false, i18n);
+    assert_string_equal(((RayDialLabelData*)label->data)->text, "Original title");
+    
+    int reloads = 0;
+    assert_true(AddI18NReloadListener(i18n, count_reload, &reloads));
+    
+    // The initial parse runs on the worker and is published by UpdateI18NManager
+    unsigned int generation = GetI18NGeneration(i18n);
+    assert_true(WatchTranslationFile(i18n, "en", filename));
+    double deadline = GetTime() + 5.0;
+    while (GetI18NGeneration(i18n) == generation && GetTime() < deadline) {
+        UpdateI18NManager(i18n);
+    }
+    assert_int_equal(reloads, 1);
+    assert_string_equal(GetLocalizedText(i18n, "title"), "Reloaded title");
+    
+    // Components re-resolve before touching their old pointer
+    UpdateComponent(label);
+    assert_string_equal(((RayDialLabelData*)label->data)->text, "Reloaded title");
+    
+    // Let the replaced table's grace period expire
+    for (int i = 0; i < 10; i++) {
+        UpdateI18NManager(i18n);
+    }
+    
+    UnwatchTranslationFile(i18n, "en");
+    RemoveI18NReloadListener(i18n, count_reload, &reloads);
+    FreeComponent(label);
+    FreeI18NManager(i18n);
+    remove(filename);
+}
+
+static void test_translation_string_pool(void **state) {
+    const char* filename = "raydial_test_pool.txt";
+    write_text_file(filename, "a=shared\nb=shared\nc=unique\nd=Hello {name}\n");
+    
+    RayDialI18N* i18n = CreateI18NManager();
+    AddLanguage(i18n, "en", "English");
+    AddLanguage(i18n, "fr", "Francais");
+    
+    // Identical values are interned once and repeated loads do not grow the pool
+    RayDialI18NStats first;
+    assert_true(LoadTranslationsFromFile(i18n, "en", filename));
+    assert_true(GetLanguageStats(i18n, "en", &first));
+    assert_int_equal(first.entryCount, 4);
+    assert_int_equal(first.ownedStrings, 7);
+    assert_int_equal(first.borrowedStrings, 0);
+    assert_ptr_equal(GetLocalizedText(i18n, "a"), GetLocalizedText(i18n, "b"));
+    
+    for (int i = 0; i < 500; i++) {
+        LoadTranslationsFromFile(i18n, "en", filename);
+    }
+    RayDialI18NStats repeated;
+    GetLanguageStats(i18n, "en", &repeated);
+    assert_int_equal(repeated.stringBytes, first.stringBytes);
+    assert_int_equal(repeated.totalBytes, first.totalBytes);
+    
+    // Compiled placeholder formats are kept too, even for borrowed values
+    static const char greeting[] = "Hi {name}";
+    char sameGreeting[16];
+    strcpy(sameGreeting, greeting);
+    AddTranslation(i18n, "en", "greeting", greeting);
+    GetLanguageStats(i18n, "en", &first);
+    for (int i = 0; i < 500; i++) AddTranslation(i18n, "en", "greeting", (i % 2) ? greeting : sameGreeting);
+    GetLanguageStats(i18n, "en", &repeated);
+    assert_int_equal(repeated.totalBytes, first.totalBytes);
+    
+    // Borrowed and copied strings are tracked separately
+    char buffer[16];
+    strcpy(buffer, "temporary");
+    AddTranslation(i18n, "fr", "static", "statique");
+    AddTranslationCopy(i18n, "fr", "copied", buffer);
+    buffer[0] = '\0';
+    
+    RayDialI18NStats fr;
+    GetLanguageStats(i18n, "fr", &fr);
+    assert_int_equal(fr.borrowedStrings, 2);
+    assert_int_equal(fr.ownedStrings, 2);
+    SetCurrentLanguage(i18n, "fr");
+    assert_string_equal(GetLocalizedText(i18n, "copied"), "temporary");
+    
+    // Reloading replaces the pool; the old one is released after the grace period
+    assert_true(ReloadTranslationsFromFile(i18n, "en", filename));
+    RayDialI18NStats total;
+    GetI18NStats(i18n, &total);
+    assert_int_equal(total.languageCount, 2);
+    assert_true(total.retiredBytes > 0);
+    for (int i = 0; i < 10; i++) {
+        UpdateI18NManager(i18n);
+    }
+    GetI18NStats(i18n, &total);
+    assert_int_equal(total.retiredBytes, 0);
+    
+    // Dropping the current language falls back to the first remaining one
+    assert_true(RemoveLanguage(i18n, "fr"));
+    assert_false(RemoveLanguage(i18n, "fr"));
+    assert_string_equal(GetCurrentLanguageCode(i18n), "en");
+    
+    FreeI18NManager(i18n);
+    remove(filename);
+}
+
+static void test_translation_fallback_chain(void **state) {
+    RayDialI18N* i18n = CreateI18NManager();
+    AddLanguage(i18n, "en", "English");
+    AddLanguage(i18n, "pt", "Portugues");
+    AddLanguage(i18n, "pt-BR", "Portugues (Brasil)");
+    
+    AddTranslation(i18n, "en", "hello", "Hello");
+    AddTranslation(i18n, "en", "bye", "Goodbye");
+    AddTranslation(i18n, "en", "save", "Save");
+    AddTranslation(i18n, "pt", "hello", "Ola");
+    AddTranslation(i18n, "pt", "bye", "Adeus");
+    AddTranslation(i18n, "pt-BR", "bye", "Tchau");
+    
+    assert_true(SetLanguageFallback(i18n, "pt-BR", "pt"));
+    assert_true(SetLanguageFallback(i18n, "pt", "en"));
+    assert_false(SetLanguageFallback(i18n, "en", "pt-BR")); // Would loop
+    assert_false(SetLanguageFallback(i18n, "en", "xx"));
+    
+    // Stale index: the chain is walked without touching the manager
+    SetCurrentLanguage(i18n, "pt-BR");
+    AddTranslation(i18n, "pt-BR", "extra", "Extra");
+    assert_string_equal(GetLocalizedText(i18n, "save"), "Save");
+    
+    ResolveLanguageFallbacks(i18n);
+    assert_string_equal(GetLocalizedText(i18n, "bye"), "Tchau");
+    assert_string_equal(GetLocalizedText(i18n, "hello"), "Ola");
+    assert_string_equal(GetLocalizedText(i18n, "save"), "Save");
+    assert_string_equal(GetLocalizedText(i18n, "missing"), "missing");
+    
+    RayDialFallbackKey report[4];
+    assert_int_equal(GetFallbackReport(i18n, "pt-BR", NULL, 0), 2);
+    assert_int_equal(GetFallbackReport(i18n, "pt-BR", report, 4), 2);
+    for (int i = 0; i < 2; i++) {
+        if (strcmp(report[i].key, "hello") == 0) {
+            assert_string_equal(report[i].languageCode, "pt");
+        } else {
+            assert_string_equal(report[i].key, "save");
+            assert_string_equal(report[i].languageCode, "en");
+        }
+    }
+    assert_int_equal(GetFallbackReport(i18n, "en", report, 4), 0);
+    
+    // Removing a link in the middle splices the chain
+    assert_true(RemoveLanguage(i18n, "pt"));
+    assert_string_equal(GetLocalizedText(i18n, "hello"), "Hello");
+    assert_int_equal(GetFallbackReport(i18n, "pt-BR", report, 4), 2);
+    
+    assert_true(SetLanguageFallback(i18n, "pt-BR", NULL));
+    assert_string_equal(GetLocalizedText(i18n, "hello"), "hello");
+    
+    FreeI18NManager(i18n);
+}
+
+static void test_styled_text_cache(void **state) {
+    RayDialI18N* i18n = CreateI18NManager();
+    AddLanguage(i18n, "en", "English");
+    AddLanguage(i18n, "es", "Espanol");
+    AddTranslation(i18n, "en", "warn", "Watch [color=red]out[/color]!");
+    AddTranslation(i18n, "es", "warn", "[b]Cuidado[/b]");
+    SetCurrentLanguage(i18n, "en");
+    
+    // Same (language, color, size) shares one parse
+    RayDialStyledText* first = AcquireLocalizedStyledText(i18n, "warn", BLACK, 20.0f);
+    RayDialStyledText* second = AcquireLocalizedStyledText(i18n, "warn", BLACK, 20.0f);
+    assert_non_null(first);
+    assert_ptr_equal(first, second);
+    assert_string_equal(GetStyledTextPlain(first), "Watch out!");
+    assert_int_equal(GetStyledTextCacheCount(i18n), 1);
+    
+    RayDialStyledText* larger = AcquireLocalizedStyledText(i18n, "warn", BLACK, 30.0f);
+    assert_ptr_not_equal(larger, first);
+    SetCurrentLanguage(i18n, "es");
+    RayDialStyledText* spanish = AcquireLocalizedStyledText(i18n, "warn", BLACK, 20.0f);
+    assert_string_equal(GetStyledTextPlain(spanish), "Cuidado");
+    assert_int_equal(GetStyledTextCacheCount(i18n), 3);
+    
+    // Changing translations invalidates the cache but held texts stay valid
+    AddTranslation(i18n, "es", "warn", "Ojo");
+    RayDialStyledText* updated = AcquireLocalizedStyledText(i18n, "warn", BLACK, 20.0f);
+    assert_ptr_not_equal(updated, spanish);
+    assert_string_equal(GetStyledTextPlain(updated), "Ojo");
+    assert_string_equal(GetStyledTextPlain(spanish), "Cuidado");
+    assert_int_equal(GetStyledTextCacheCount(i18n), 1);
+    
+    ReleaseStyledText(first);
+    ReleaseStyledText(second);
+    ReleaseStyledText(larger);
+    ReleaseStyledText(spanish);
+    ReleaseStyledText(updated);
+    
+    // Portraits borrow the cached runs and get tag-free plain text
+    SetCurrentLanguage(i18n, "en");
+    RayDialComponent* portrait = CreatePortraitDialogue((Rectangle){ 0, 0, 400, 120 }, "Guard", "", BLUE);
+    SetLocalizedPortraitDialogueStyledText(portrait, "warn", i18n);
+    RayDialPortraitDialogueData* data = (RayDialPortraitDialogueData*)portrait->data;
+    assert_string_equal(data->dialogueText, "Watch out!");
+    assert_true(data->useStyledText);
+    assert_non_null(data->styledText);
+    
+    // The component outlives the manager without touching freed memory
+    FreeI18NManager(i18n);
+    FreeComponent(portrait);
+}
+
+static void test_format_localized_text(void **state) {
+    const char* filename = "raydial_test_format.txt";
+    write_text_file(filename,
+        "gold={name} has {count, plural, =0 {no gold} one {# coin} other {# coins}}.\n"
+        "pronoun={who, select, her {She} him {He} other {They}} left.\n"
+        "broken=Missing {brace\n");
+    
+    RayDialI18N* i18n = CreateI18NManager();
+    AddLanguage(i18n, "en", "English");
+    assert_true(LoadTranslationsFromFile(i18n, "en", filename));
+    SetCurrentLanguage(i18n, "en");
+    
+    char buffer[64];
+    RayDialFormatArg args[] = { FormatArgString("name", "Ada"), FormatArgInt("count", 0) };
+    FormatLocalizedText(i18n, "gold", buffer, sizeof(buffer), args, 2);
+    assert_string_equal(buffer, "Ada has no gold.");
+    args[1] = FormatArgInt("count", 1);
+    FormatLocalizedText(i18n, "gold", buffer, sizeof(buffer), args, 2);
+    assert_string_equal(buffer, "Ada has 1 coin.");
+    args[1] = FormatArgInt("count", 250);
+    int length = FormatLocalizedText(i18n, "gold", buffer, sizeof(buffer), args, 2);
+    assert_string_equal(buffer, "Ada has 250 coins.");
+    assert_int_equal(length, 18);
+    
+    // Truncated output reports the full length, like snprintf
+    char small[8];
+    assert_int_equal(FormatLocalizedText(i18n, "gold", small, sizeof(small), args, 2), 18);
+    assert_string_equal(small, "Ada has");
+    
+    RayDialFormatArg who = FormatArgString("who", "her");
+    FormatLocalizedText(i18n, "pronoun", buffer, sizeof(buffer), &who, 1);
+    assert_string_equal(buffer, "She left.");
+    FormatLocalizedText(i18n, "pronoun", buffer, sizeof(buffer), NULL, 0);
+    assert_string_equal(buffer, "They left.");
+    
+    // Malformed formats and missing keys are copied verbatim
+    FormatLocalizedText(i18n, "broken", buffer, sizeof(buffer), NULL, 0);
+    assert_string_equal(buffer, "Missing {brace");
+    FormatLocalizedText(i18n, "missing_key", buffer, sizeof(buffer), NULL, 0);
+    assert_string_equal(buffer, "missing_key");
+    
+    // Labels format into a buffer they keep across frames
+    RayDialComponent* label = CreateLabel((Rectangle){ 0, 0, 200, 30 }, "", false);
+    SetLocalizedLabelFormat(label, "gold", i18n, args, 2);
+    RayDialLabelData* data = (RayDialLabelData*)label->data;
+    char* firstBuffer = data->formatBuffer;
+    assert_string_equal(data->text, "Ada has 250 coins.");
+    args[1] = FormatArgInt("count", 3);
+    SetLocalizedLabelFormat(label, "gold", i18n, args, 2);
+    assert_ptr_equal(data->formatBuffer, firstBuffer);
+    assert_string_equal(data->text, "Ada has 3 coins.");
+    
+    FreeComponent(label);
+    FreeI18NManager(i18n);
+    remove(filename);
+}
+
 int main(void) {
     // Initialize raylib (minimal window for testing)
     const int screenWidth = 640;
@@ -285,6 +2096,15 @@ int main(void) {
         cmocka_unit_test(test_button_creation),
         cmocka_unit_test(test_label_creation),
         cmocka_unit_test(test_panel_creation),
+        cmocka_unit_test(test_textbox_editing),
+        cmocka_unit_test(test_scroll_area_virtualization),
+        cmocka_unit_test(test_label_line_index),
+        cmocka_unit_test(test_typewriter_reveal),
+        cmocka_unit_test(test_styled_typewriter_reveal),
+        cmocka_unit_test(test_portrait_texture_cache),
+        cmocka_unit_test(test_portrait_atlas),
+        cmocka_unit_test(test_portrait_flipbook),
+        cmocka_unit_test(test_nine_slice_frames),
         cmocka_unit_test(test_component_hierarchy),
         cmocka_unit_test(test_component_properties),
     };
@@ -293,12 +2113,32 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_dialogue_node_creation, setup, teardown_dialogue_nodes),
         cmocka_unit_test_setup_teardown(test_dialogue_manager_creation, setup_dialogue_nodes, teardown_dialogue_nodes),
         cmocka_unit_test_setup_teardown(test_node_transition, setup_dialogue_nodes, teardown_dialogue_nodes),
+        cmocka_unit_test(test_choice_conditions),
+        cmocka_unit_test(test_variable_store),
+        cmocka_unit_test(test_node_scripts),
+        cmocka_unit_test(test_dialogue_graph),
+        cmocka_unit_test(test_chapter_streaming),
+        cmocka_unit_test(test_dialogue_snapshot),
+        cmocka_unit_test(test_dialogue_history),
+        cmocka_unit_test(test_dialogue_context),
+        cmocka_unit_test(test_parallel_dialogue_context),
+        cmocka_unit_test(test_dialogue_replay),
     };
     
     const struct CMUnitTest edge_tests[] = {
         cmocka_unit_test(test_null_parameters),
     };
     
+    const struct CMUnitTest i18n_tests[] = {
+        cmocka_unit_test(test_translation_file_loading),
+        cmocka_unit_test(test_translation_hash_lookup),
+        cmocka_unit_test(test_translation_hot_reload),
+        cmocka_unit_test(test_translation_string_pool),
+        cmocka_unit_test(test_translation_fallback_chain),
+        cmocka_unit_test(test_styled_text_cache),
+        cmocka_unit_test(test_format_localized_text),
+    };
+    
     // Run test groups
     printf("\n==== COMPONENT TESTS ====\n");
     int component_fails = cmocka_run_group_tests(component_tests, setup, teardown);
@@ -309,8 +2149,11 @@ int main(void) {
     printf("\n==== EDGE CASE TESTS ====\n");
     int edge_fails = cmocka_run_group_tests(edge_tests, setup, teardown);
     
+    printf("\n==== LOCALIZATION TESTS ====\n");
+    int i18n_fails = cmocka_run_group_tests(i18n_tests, NULL, NULL);
+    
     // Show visual results
-    int failed = component_fails + dialogue_fails + edge_fails;
+    int failed = component_fails + dialogue_fails + edge_fails + i18n_fails;
     
     while (!WindowShouldClose()) {
         BeginDrawing();